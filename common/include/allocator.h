@@ -3,7 +3,18 @@
 	The allocator hides the actual routines and data structures that are
 	used for memory allocation so that the decoder can be easily adapted
 	to use different memory allocation schemes.
-	
+
+	A null allocator or an allocator of the default type passes each request
+	to the standard C library.  The arena allocator keeps the blocks that are
+	freed in free lists indexed by the size class of the block, so a block
+	that is allocated and freed during each frame is reused in the next frame
+	without calling the system allocator.
+
+	Either type of allocator can record statistics about the memory in use.
+	Each request is attributed to a tag that identifies the kind of data
+	structure that is allocated, so the report printed by @ref PrintAllocatorStats
+	shows which data structures account for the peak memory usage.
+
 	(c) 2013 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
 	All rights reserved--use subject to compliance with end user license agreement.
 */
@@ -11,21 +22,123 @@
 #ifndef _ALLOCATOR_H
 #define _ALLOCATOR_H
 
+#if _THREADED
+#include <pthread.h>
+#endif
+
+//! Number of size classes in the free lists of the arena allocator
+#define ALLOCATOR_SIZE_CLASS_COUNT	128
+
+//! Alignment of every block returned by the allocator (one cache line)
+#define ALLOCATOR_ALIGNMENT			64
+
+/*!
+	@brief Round the size of a row in bytes up to a multiple of the alignment
+
+	Rows with an aligned pitch start on a cache line boundary when the first
+	row is aligned and the padding at the end of each row is a whole number
+	of vectors for every vector width up to the alignment.
+*/
+#define ALIGNED_PITCH(size)			(((size) + ALLOCATOR_ALIGNMENT - 1) & ~((size_t)ALLOCATOR_ALIGNMENT - 1))
+
+/*!
+	@brief Number of bytes after the last row of a buffer with an aligned pitch
+
+	Vectorized kernels may read or write up to one full vector past the end
+	of the last row without checking the number of columns that remain.
+*/
+#define ALLOCATOR_TAIL_PADDING		ALLOCATOR_ALIGNMENT
+
+//! Size of a buffer for one row with an aligned length and tail padding
+#define ROW_BUFFER_SIZE(size)		(ALIGNED_PITCH(size) + ALLOCATOR_TAIL_PADDING)
+
+/*!
+	@brief Memory allocation schemes implemented by the allocator
+*/
+typedef enum _allocator_type
+{
+	ALLOCATOR_TYPE_DEFAULT = 0,		//!< Each block is allocated and freed by the C library
+	ALLOCATOR_TYPE_ARENA,			//!< Freed blocks are kept in free lists for reuse
+
+} ALLOCATOR_TYPE;
+
+/*!
+	@brief Kinds of data structures that are tracked by the allocator statistics
+*/
+typedef enum _allocator_tag
+{
+	ALLOCATOR_TAG_OTHER = 0,		//!< Data structures that are not tracked separately
+	ALLOCATOR_TAG_WAVELET,			//!< Bands in the wavelet transforms
+	ALLOCATOR_TAG_IMAGE,			//!< Buffers for packed images
+	ALLOCATOR_TAG_COMPONENT_ARRAY,	//!< Component arrays in unpacked images
+	ALLOCATOR_TAG_CODEBOOK,			//!< Tables used for entropy coding
+	ALLOCATOR_TAG_TRANSFORM_BUFFER,	//!< Scratch rows used by the wavelet transforms
+
+	ALLOCATOR_TAG_COUNT				//!< Number of tags (must be last)
+
+} ALLOCATOR_TAG;
+
 /*!
-	@brief Opaque data type for the default memory allocator
+	@brief Statistics about the memory allocated for one tag or for all tags
+*/
+typedef struct _allocator_stats
+{
+	size_t allocation_count;		//!< Number of requests to allocate a block
+	size_t current_bytes;			//!< Number of bytes in blocks that have not been freed
+	size_t peak_bytes;				//!< Largest number of bytes in use at the same time
+
+} ALLOCATOR_STATS;
 
-	It is expected that actual decoder implementations will define more
-	sophisticated memory allocators.
+//! Header at the start of each block allocated by the arena allocator
+typedef struct _allocator_block ALLOCATOR_BLOCK;
+
+/*!
+	@brief Data structure for the memory allocator
+
+	The free lists and the list of all blocks obtained from the system are
+	only used by the arena allocator.  The arena allocator can be used by
+	more than one thread at a time.
 */
-typedef void *ALLOCATOR;
+typedef struct _allocator
+{
+	ALLOCATOR_TYPE type;			//!< Memory allocation scheme
+
+	//! Blocks that are available for reuse in each size class
+	ALLOCATOR_BLOCK *free_list[ALLOCATOR_SIZE_CLASS_COUNT];
+
+	//! All blocks allocated from the system by the arena allocator
+	ALLOCATOR_BLOCK *block_list;
+
+	bool stats_flag;				//!< Record statistics about the memory in use
+	ALLOCATOR_STATS total;			//!< Statistics for all blocks
+
+	//! Statistics for the blocks allocated with each tag
+	ALLOCATOR_STATS tag_stats[ALLOCATOR_TAG_COUNT];
+
+#if _THREADED
+	pthread_mutex_t mutex;			//!< Lock that protects the lists of blocks and the statistics
+#endif
+
+} ALLOCATOR;
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 void *Alloc(ALLOCATOR *allocator, size_t size);
+void *AllocTagged(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag);
 void Free(ALLOCATOR *allocator, void *block);
 
+CODEC_ERROR InitAllocator(ALLOCATOR *allocator, ALLOCATOR_TYPE type);
+
+CODEC_ERROR EnableAllocatorStats(ALLOCATOR *allocator);
+
+CODEC_ERROR PrintAllocatorStats(ALLOCATOR *allocator, FILE *file);
+
+CODEC_ERROR ResetAllocator(ALLOCATOR *allocator);
+
+CODEC_ERROR ReleaseAllocator(ALLOCATOR *allocator);
+
 #ifdef __cplusplus
 }
 #endif
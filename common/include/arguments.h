@@ -30,6 +30,14 @@ bool GetEnabledParts(const char *string, uint32_t *enabled_parts_out);
 
 bool GetBandfileInfo(const char *string, BANDFILE_INFO *bandfile);
 
+bool GetThreadCount(const char *string, int *thread_count_out);
+
+bool GetAllocatorType(const char *string, ALLOCATOR_TYPE *allocator_type_out);
+
+bool GetResolution(const char *string, RESOLUTION *resolution_out);
+
+bool GetRegionOfInterest(const char *string, ROI *roi_out);
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
 bool GetLayerCount(const char *string, COUNT *layer_count_out);
 #endif
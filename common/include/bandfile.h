@@ -119,6 +119,17 @@ int WriteWaveletBand(BANDFILE *bandfile,
 					 void *data,
 					 size_t size);
 
+int WriteWaveletBandRows(BANDFILE *bandfile,
+						 int frame,
+						 int channel,
+						 int wavelet,
+						 int band,
+						 int type,
+						 int width,
+						 int height,
+						 void *data,
+						 size_t pitch);
+
 int WriteFrameHeader(BANDFILE *bandfile, int frame);
 
 int WriteChannelHeader(BANDFILE *bandfile, int channel);
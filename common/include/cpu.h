@@ -0,0 +1,58 @@
+/*!	@file common/include/cpu.h
+
+	Declaration of the routines for detecting the processor features
+	used to select the vectorized implementations of the wavelet filters.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _CPU_H
+#define _CPU_H
+
+//! Vectorized filters for x86 processors are available in this build
+#if _SIMD && (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+#define _SIMD_X86 1
+#else
+#define _SIMD_X86 0
+#endif
+
+//! Vectorized filters for ARM processors are available in this build
+#if _SIMD && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define _SIMD_NEON 1
+#else
+#define _SIMD_NEON 0
+#endif
+
+//! Attributes that enable the instruction set used by a vectorized filter
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX2
+#endif
+
+/*!
+	@brief Processor features used by the vectorized filters
+*/
+typedef enum _cpu_feature
+{
+	CPU_FEATURE_NONE = 0,
+	CPU_FEATURE_SSE2 = (1 << 0),	//!< SSE2 instructions (128-bit integer vectors)
+	CPU_FEATURE_AVX2 = (1 << 1),	//!< AVX2 instructions (256-bit integer vectors)
+	CPU_FEATURE_NEON = (1 << 2),	//!< ARM Advanced SIMD instructions
+
+} CPU_FEATURE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t GetCPUFeatures(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -55,6 +55,7 @@ typedef enum _codec_error
     CODEC_ERROR_UMID_LABEL,                 //!< Incorrect UMID label
     CODEC_ERROR_BAD_SECTION_TAG,            //!< The specified tag does not correspond to a section header
     CODEC_ERROR_COULD_NOT_PARSE_FILENAME,   //!< Unable to obtain the image parameters from the filename
+    CODEC_ERROR_BUFFER_OVERFLOW,            //!< Encoded sample does not fit in the buffer provided by the caller
 
 
     /***** Reserve a block of error codes for the metadata subsystem *****/
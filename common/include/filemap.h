@@ -0,0 +1,42 @@
+/*!	@file common/include/filemap.h
+
+	Declaration of a file that is mapped into memory for reading.
+
+	The bitstream and image readers map the input file into memory instead of
+	copying the entire file into a buffer.  The pages of the file are shared
+	with the page cache until a page is modified, so the readers can process
+	the file in place.  The operating system is advised that the file will be
+	read sequentially so that the pages are read ahead of the reader.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _FILEMAP_H
+#define _FILEMAP_H
+
+/*!
+	@brief Data structure for a file mapped into memory
+
+	The address is null if the file has not been mapped.
+*/
+typedef struct _file_mapping
+{
+	void *address;		//!< Starting address of the file in memory
+	size_t size;		//!< Number of bytes in the file
+
+} FILE_MAPPING;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR MapFile(FILE_MAPPING *mapping, const char *pathname);
+
+CODEC_ERROR UnmapFile(FILE_MAPPING *mapping);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
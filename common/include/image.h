@@ -31,6 +31,7 @@ typedef struct _packed_image
 	void *buffer;				//!< Address of the buffer for the frame
 	size_t size;				//!< Allocated size of the buffer (in bytes)
 	size_t offset;				//!< Offset to the start of the frame
+	FILE_MAPPING mapping;		//!< File mapped into memory that is the buffer (if any)
 
 } PACKED_IMAGE;
 
@@ -143,6 +144,8 @@ CODEC_ERROR AllocImageSize(ALLOCATOR *allocator, IMAGE *image, size_t size);
 CODEC_ERROR AllocImageCopy(ALLOCATOR *allocator, IMAGE *image, IMAGE *prototype, PIXEL_FORMAT format);
 
 CODEC_ERROR ReleaseImage(ALLOCATOR *allocator, IMAGE *image);
+
+CODEC_ERROR MapImageFile(IMAGE *image, const char *pathname);
     
 CODEC_ERROR FreeImage(ALLOCATOR *allocator, IMAGE *image);
 
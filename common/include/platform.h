@@ -30,4 +30,37 @@
 
 #endif
 
+/*!
+	@brief Enable the use of POSIX threads
+
+	All processing is performed on the calling thread if threads are not enabled.
+*/
+#ifndef _THREADED
+#ifdef _WIN32
+#define _THREADED 0
+#else
+#define _THREADED 1
+#endif
+#endif
+
+/*!
+	@brief Enable the vectorized implementations of the wavelet filters
+
+	The vectorized filters are selected at runtime using the processor features
+	reported by @ref GetCPUFeatures and compute the same results as the scalar filters.
+*/
+#ifndef _SIMD
+#define _SIMD 1
+#endif
+
+/*!
+	@brief Enable reading input files through a memory mapping
+
+	Input files are read into a buffer allocated by the C library if mappings
+	are not enabled or if the file cannot be mapped.
+*/
+#ifndef _MAPPED_FILES
+#define _MAPPED_FILES 1
+#endif
+
 #endif
@@ -49,6 +49,7 @@ typedef enum _stream_error
 {
     STREAM_ERROR_OKAY = 0,      //!< No error
     STREAM_ERROR_EOF,           //!< Could not obtain more bytes from the stream
+    STREAM_ERROR_OVERFLOW,      //!< No room for more bytes in the memory buffer
     
 } STREAM_ERROR;
 
@@ -59,9 +60,10 @@ typedef enum _stream_error
 	The byte stream encapsulates the location of encoded images and the
 	means for reading (writing) encoded images samples.  The byte stream
 	could be a binary file that has been opened for reading (writing) or
-	a buffer in memory.  The reference codec uses a binary file as the byte
-	stream so the functionality for streams attached to memory buffers has
-	not been tested.
+	a buffer in memory.  A stream opened for reading a buffer in memory by
+	@ref OpenStreamBuffer borrows the buffer from the caller without copying
+	the bytes and reports @ref STREAM_ERROR_EOF if a read would go past the
+	end of the buffer.
 
 	It is intended that the byte stream can be enhanced to read (write)
 	encoded images from (into) a track in a media container.
@@ -88,6 +90,9 @@ typedef struct _stream
 			void *buffer;	//!< Memory buffer that contains the stream
 			size_t size;	//!< Length of the stream (in bytes)
 			size_t count;	//!< Number of bytes that have been written
+			ALLOCATOR *allocator;	//!< Allocator for a buffer that grows as bytes are written
+			bool growable;	//!< True if the buffer is owned by the stream and can be enlarged
+			FILE_MAPPING mapping;	//!< File mapped into memory that is the buffer (if any)
 
 		} memory;		//!< Parameters for a stream in a memory buffer
 
@@ -122,10 +127,22 @@ CODEC_ERROR PadBytes(STREAM *stream, size_t size);
 
 CODEC_ERROR FlushStream(STREAM *stream);
 
+CODEC_ERROR PutBytes(STREAM *stream, const void *block, size_t size);
+
 CODEC_ERROR CreateStreamBuffer(STREAM *stream, void *buffer, size_t size);
 
+CODEC_ERROR CreateGrowableStream(STREAM *stream, ALLOCATOR *allocator, size_t size);
+
+CODEC_ERROR OpenStreamBuffer(STREAM *stream, void *buffer, size_t size);
+
+CODEC_ERROR OpenMappedStream(STREAM *stream, const char *pathname);
+
 CODEC_ERROR GetStreamBuffer(STREAM *stream, void **buffer_out, size_t *size_out);
 
+CODEC_ERROR DetachStreamBuffer(STREAM *stream, void **buffer_out, size_t *size_out);
+
+CODEC_ERROR PutStreamBuffer(STREAM *output, STREAM *stream);
+
 CODEC_ERROR GetBlock(STREAM *stream, void *buffer, size_t size, size_t offset);
 
 CODEC_ERROR PutBlock(STREAM *stream, void *buffer, size_t size, size_t offset);
@@ -0,0 +1,82 @@
+/*!	@file common/include/taskgraph.h
+
+	Declaration of a scheduler for a graph of tasks with dependencies.
+
+	Each task in the graph is submitted to a thread pool after all of the tasks
+	that it depends on have finished, so independent tasks run concurrently and
+	a task starts as soon as the results that it needs are available.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _TASKGRAPH_H
+#define _TASKGRAPH_H
+
+//! Maximum number of tasks that can depend on a task in the graph
+#define MAX_TASK_SUCCESSORS		8
+
+//! Routine that performs the work in a task in the graph
+typedef CODEC_ERROR (* GRAPH_ROUTINE)(void *argument);
+
+/*!
+	@brief Task in the graph and the tasks that depend on it
+*/
+typedef struct _task_node
+{
+	struct _task_graph *graph;	//!< Graph that contains the task
+	GRAPH_ROUTINE routine;		//!< Routine that performs the work
+	void *argument;				//!< Argument passed to the routine
+
+	//! Number of tasks that must finish before this task can start
+	int dependency_count;
+
+	//! Number of tasks that depend on this task
+	int successor_count;
+
+	//! Indices of the tasks that depend on this task
+	int successor[MAX_TASK_SUCCESSORS];
+
+} TASK_NODE;
+
+/*!
+	@brief Graph of tasks with dependencies
+
+	If a task returns an error, the tasks that have not started are skipped
+	and the first error is returned after all tasks in the graph are finished.
+*/
+typedef struct _task_graph
+{
+	ALLOCATOR *allocator;		//!< Allocator used for the table of tasks
+	TASK_NODE *node;			//!< Table of tasks in the graph
+	int node_count;				//!< Number of tasks in the graph
+	int node_limit;				//!< Number of entries allocated for the table of tasks
+	int finished_count;			//!< Number of tasks that have finished or were skipped
+	THREAD_POOL *pool;			//!< Thread pool that executes the tasks
+	CODEC_ERROR error;			//!< First error returned by any task
+
+#if _THREADED
+	pthread_mutex_t mutex;		//!< Lock that protects the dependency counts and the error
+#endif
+
+} TASK_GRAPH;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR InitTaskGraph(TASK_GRAPH *graph, ALLOCATOR *allocator, int node_limit);
+
+CODEC_ERROR ReleaseTaskGraph(TASK_GRAPH *graph);
+
+int AddGraphTask(TASK_GRAPH *graph, GRAPH_ROUTINE routine, void *argument);
+
+CODEC_ERROR AddGraphDependency(TASK_GRAPH *graph, int predecessor, int successor);
+
+CODEC_ERROR RunTaskGraph(TASK_GRAPH *graph, THREAD_POOL *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
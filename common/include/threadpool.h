@@ -0,0 +1,134 @@
+/*!	@file common/include/threadpool.h
+
+	Declaration of a pool of worker threads that execute tasks with work stealing.
+
+	Each worker thread has a queue of tasks.  A task submitted by a worker is added
+	to the end of the queue for that worker and the worker takes the most recently
+	submitted task from its own queue, so tasks that depend on the results of the
+	previous task are likely to find the results in the processor cache.  A worker
+	that runs out of tasks steals the oldest task from the queue of another worker.
+
+	The thread that waits for the tasks to finish also executes tasks, so a pool
+	with a thread count of one executes all tasks on the calling thread.  All tasks
+	are executed on the calling thread if threads are not enabled.
+
+	Tasks can be submitted as members of a wait group so that a thread can wait for
+	a subset of the tasks in the pool, including tasks submitted by a task that is
+	running in the pool.  The rows in an image or wavelet can be divided into ranges
+	of rows that are processed by the tasks in a wait group.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _THREADPOOL_H
+#define _THREADPOOL_H
+
+#if _THREADED
+#include <pthread.h>
+#endif
+
+//! Maximum number of threads in a thread pool
+#define MAX_POOL_THREADS	64
+
+//! Routine that performs the work in a task
+typedef void (* TASK_ROUTINE)(void *argument);
+
+//! Routine that processes the rows from the first row up to but not including the last row
+typedef CODEC_ERROR (* ROW_ROUTINE)(void *argument, int first_row, int last_row);
+
+/*!
+	@brief Set of tasks that can be waited for independently of the other tasks in the pool
+
+	The count is protected by the lock for the thread pool.
+*/
+typedef struct _wait_group
+{
+	int pending_count;			//!< Number of tasks in the group that have not finished
+
+} WAIT_GROUP;
+
+/*!
+	@brief Routine and argument for a task in the queue of a worker
+*/
+typedef struct _pool_task
+{
+	TASK_ROUTINE routine;		//!< Routine that performs the work
+	void *argument;				//!< Argument passed to the routine
+	WAIT_GROUP *group;			//!< Wait group that contains the task (or null)
+
+} POOL_TASK;
+
+/*!
+	@brief Circular queue of tasks that have not been started
+
+	The owner of the queue adds and takes tasks at the end of the queue
+	and other threads steal tasks from the front of the queue.
+*/
+typedef struct _task_queue
+{
+	struct _thread_pool *pool;	//!< Thread pool that contains this queue
+	int index;					//!< Index of this queue in the thread pool
+	POOL_TASK *task;			//!< Circular buffer of tasks
+	int size;					//!< Number of entries in the circular buffer
+	int head;					//!< Index of the oldest task in the queue
+	int count;					//!< Number of tasks in the queue
+
+#if _THREADED
+	pthread_mutex_t mutex;		//!< Lock that protects the queue
+#endif
+
+} TASK_QUEUE;
+
+/*!
+	@brief Pool of worker threads and the queues of tasks for each thread
+
+	The last queue is used for the tasks submitted by threads that are not
+	in the pool, including the thread that waits for the tasks to finish.
+*/
+typedef struct _thread_pool
+{
+	ALLOCATOR *allocator;		//!< Allocator used for the queues and threads
+	int thread_count;			//!< Number of threads that execute tasks (including the waiting thread)
+	int queue_count;			//!< Number of task queues (one more than the number of worker threads)
+	TASK_QUEUE *queue;			//!< Table of task queues
+	int queued_count;			//!< Number of tasks in all queues
+	int pending_count;			//!< Number of tasks that have been submitted but not finished
+	bool stop;					//!< True if the worker threads should exit
+
+#if _THREADED
+	pthread_t *thread;			//!< Worker threads
+	int started_count;			//!< Number of worker threads that were started
+	pthread_key_t queue_key;	//!< Index of the queue for the current thread (plus one)
+	pthread_mutex_t mutex;		//!< Lock that protects the counts and the stop flag
+	pthread_cond_t work_available;	//!< Signalled when a task is submitted
+	pthread_cond_t task_finished;	//!< Signalled when a task is finished
+#endif
+
+} THREAD_POOL;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR InitThreadPool(THREAD_POOL *pool, ALLOCATOR *allocator, int thread_count);
+
+CODEC_ERROR ReleaseThreadPool(THREAD_POOL *pool);
+
+CODEC_ERROR SubmitTask(THREAD_POOL *pool, TASK_ROUTINE routine, void *argument);
+
+CODEC_ERROR WaitThreadPool(THREAD_POOL *pool);
+
+void InitWaitGroup(WAIT_GROUP *group);
+
+CODEC_ERROR SubmitGroupTask(THREAD_POOL *pool, WAIT_GROUP *group, TASK_ROUTINE routine, void *argument);
+
+CODEC_ERROR WaitForGroup(THREAD_POOL *pool, WAIT_GROUP *group);
+
+CODEC_ERROR ParallelForRows(THREAD_POOL *pool, int row_count, int min_rows, ROW_ROUTINE routine, void *argument);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
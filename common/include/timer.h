@@ -2,8 +2,11 @@
 
 	Implementation of a high-resolution performance timer.
 
-	Note: The timer is not implemented on all platforms.
-	
+	The timer uses the performance counter on Windows and the monotonic clock
+	on other platforms.  Starting and stopping a timer is thread safe, so the
+	same timer can be used by tasks running concurrently on different threads
+	to measure the total time spent by all threads in a stage of processing.
+
 	(c) 2013 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
 	All rights reserved--use subject to compliance with end user license agreement.
 */
@@ -19,13 +22,25 @@
 #define ASSERT assert
 #endif
 
-#if _TIMING
+/*!
+	@brief Return the address of the timer for a stage or null if timing is not enabled
 
-#if _WIN32
+	The timing argument is a pointer to a data structure with a timer for each
+	stage of processing.  The start and stop routines ignore a null timer.
+*/
+#define STAGE_TIMER(timing, stage)	(((timing) != NULL) ? &(timing)->stage : NULL)
+
+#if _TIMING
 
 typedef struct timer
 {
-	__int64 time;
+#if _WIN32
+	__int64 time;		//!< Elapsed time in clock ticks
+	__int64 count;		//!< Number of times that the timer was stopped
+#else
+	int64_t time;		//!< Elapsed time in nanoseconds
+	int64_t count;		//!< Number of times that the timer was stopped
+#endif
 
 } TIMER;
 
@@ -35,6 +50,8 @@ void StartTimer(TIMER *timer);
 
 void StopTimer(TIMER *timer);
 
+void AddTimer(TIMER *total, const TIMER *timer);
+
 float TimeSecs(TIMER *timer);
 
 float TimeMS(TIMER *timer);
@@ -43,13 +60,6 @@ float TimerPercentage(TIMER *timer1, TIMER *timer2);
 
 #else
 
-// This is not a Windows build
-#error Timing code is only available for Windows
-
-#endif
-
-#else
-
 // Define a null timer for use when timing is disabled
 
 typedef void *TIMER;
@@ -69,6 +79,12 @@ inline static void StopTimer(TIMER *timer)
 	(void)timer;
 }
 
+inline static void AddTimer(TIMER *total, const TIMER *timer)
+{
+	(void)total;
+	(void)timer;
+}
+
 #endif
 
 #endif
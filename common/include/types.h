@@ -56,6 +56,36 @@ enum
 	PRECISION_MAX = 32,
 };
 
+/*!
+	@brief Resolution of the decoded image relative to the encoded image
+
+	The value is the number of wavelet levels that are not inverted, so the
+	dimensions of the decoded image are reduced by a factor of two per level.
+*/
+typedef enum _resolution
+{
+	RESOLUTION_FULL = 0,		//!< Decode the image at the encoded dimensions
+	RESOLUTION_HALF,			//!< Decode the lowpass band in the wavelet at level one
+	RESOLUTION_QUARTER,			//!< Decode the lowpass band in the wavelet at level two
+	RESOLUTION_EIGHTH,			//!< Decode the lowpass band in the wavelet at level three
+
+} RESOLUTION;
+
+/*!
+	@brief Rectangular region of interest in an image
+
+	The region is specified by the position of the upper left corner and the
+	dimensions of the region.  A region with zero width or height is empty.
+*/
+typedef struct _roi
+{
+	DIMENSION x;			//!< Column of the upper left corner of the region
+	DIMENSION y;			//!< Row of the upper left corner of the region
+	DIMENSION width;		//!< Number of columns in the region
+	DIMENSION height;		//!< Number of rows in the region
+
+} ROI;
+
 /*!
 	@brief Data type for the channel number
 */
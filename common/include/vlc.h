@@ -139,13 +139,72 @@ typedef struct _rlc {	// Codebook entries for runs of zeros
 	uint32_t bits;			//!< Code word bits (right justified)
 } RLC;
 
+/*!
+	@brief Number of bits used to index the primary table for decoding codewords
+
+	Most codewords in the codebook, including the sign bit that follows a
+	non-zero magnitude, are shorter than this number of bits and are decoded
+	by a single lookup in the primary table.
+*/
+#define VLD_TABLE_BITS 12
+
+//! Maximum number of bits used to index a sub-table for decoding long codewords
+#define VLD_SUBTABLE_BITS 7
+
+/*!
+	@brief Flags that describe an entry in the table for decoding codewords
+*/
+typedef enum _vld_flags
+{
+	VLD_FLAGS_NONE = 0x00,			//!< Run of zeros, special codeword, or unused entry
+	VLD_FLAGS_SIGNED = 0x01,		//!< Value includes the sign bit that follows the codeword
+	VLD_FLAGS_SIGN_FOLLOWS = 0x02,	//!< Sign bit must be read from the bitstream after the codeword
+	VLD_FLAGS_SUBTABLE = 0x04,		//!< Entry is a link to a sub-table for longer codewords
+
+} VLD_FLAGS;
+
+/*!
+	@brief Entry in the table for decoding codewords
+
+	The table for decoding codewords is indexed by the next bits in the bitstream.
+	Each entry is either a decoded codeword or a link to a sub-table that is indexed
+	by the bits that follow the bits used to index the current table.
+
+	For a decoded codeword, the size is the number of bits in the codeword not counting
+	the sign bit and the count and value are the run length and value.  If the sign bit
+	was included in the bits used to index the table, then the value is signed.
+
+	For a link to a sub-table, the size is the number of bits used to index the sub-table
+	and the count is the offset to the sub-table from the start of the table entries.
+
+	An entry with a size of zero does not correspond to any codeword in the codebook.
+*/
+typedef struct _vld {
+	uint8_t size;			//!< Size of code word in bits or number of bits that index the sub-table
+	uint8_t flags;			//!< Flags that describe the entry (see @ref VLD_FLAGS)
+	uint16_t count;			//!< Run length or offset to the sub-table
+	int16_t value;			//!< Run value (signed if the sign bit was decoded)
+} VLD;
+
+/*!
+	@brief Table for decoding codewords derived from the codebook
+
+	The table for decoding codewords is the primary table indexed by @ref VLD_TABLE_BITS
+	followed by the sub-tables for codewords that are longer than the primary index.
+*/
+typedef struct _decoding_table
+{
+	uint32_t length;		//!< Number of entries in the primary table and all sub-tables
+							// The length is followed by the VLD entries
+} VLD_TABLE;
+
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-CODEC_ERROR GetRlv(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
-CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
+CODEC_ERROR GetRlv(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, RUN *run);
+CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, RUN *run);
 
 //CODEC_ERROR PutRlv(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
 //CODEC_ERROR PutRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run);
@@ -112,6 +112,22 @@ CODEC_ERROR TransformInverseSpatialQuantArray(ALLOCATOR *allocator,
 											  size_t output_pitch,
 											  PRESCALE prescale);
 
+CODEC_ERROR TransformInverseSpatialRegion(ALLOCATOR *allocator,
+										  WAVELET *input,
+										  PIXEL *output_buffer,
+										  size_t output_pitch,
+										  DIMENSION output_width,
+										  DIMENSION output_height,
+										  const ROI *region,
+										  PRESCALE prescale);
+
+CODEC_ERROR TransformLowpassArray(WAVELET *input,
+								  const ROI *region,
+								  COMPONENT_VALUE *output_buffer,
+								  size_t output_pitch,
+								  int shift,
+								  PRECISION bits_per_component);
+
 CODEC_ERROR SetTransformScale(TRANSFORM *transform);
 
 CODEC_ERROR SetTransformPrescale(TRANSFORM *transform, int precision);
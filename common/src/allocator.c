@@ -1,6 +1,6 @@
 /*!	@file common/src/allocator.c
 
-	Implementation of a default memory allocator.
+	Implementation of a default memory allocator and an arena allocator.
 
 	The default memory allocator uses the routine malloc from the
 	standard C library, but decoder implementations are free to
@@ -8,7 +8,7 @@
 	a better memory allocation policy.
 
 	See the discussion in the file documentation for allocator.h
-	
+
 	Some memory allocation schemes may choose to ignore a request to
 	free memory and subsequent calls to @ref Alloc may reuse blocks
 	that were previously allocated for decoding an earlier sample.
@@ -20,19 +20,327 @@
 	always freed by the same routine that allocated the block and a block
 	of the same size will be allocated and freed again by the same routine.
 
+	The arena allocator takes advantage of this pattern.  Each request is
+	rounded up to a size class and a block that is freed is added to the
+	free list for its size class instead of being returned to the system,
+	so after the first frame the blocks allocated during each frame are
+	taken from the free lists.  There are four size classes in each power
+	of two, so a block is never more than 25% larger than the request.
+
+	If statistics are enabled, the size and tag of each block are recorded
+	in the block header so that the statistics can be updated when the block
+	is freed.  The default scheme adds a header to each block for this purpose
+	only when statistics are enabled.
+
+	Both allocation schemes return blocks that are aligned to a cache line
+	(see @ref ALLOCATOR_ALIGNMENT) so that the rows of wavelet bands and
+	component arrays with aligned pitches can be loaded with aligned vector
+	instructions and a row never shares a cache line with another row.
+
 	(c) 2013 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
 	All rights reserved--use subject to compliance with end user license agreement.
 */
 
 #include "headers.h"
 
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+//! Size of the smallest size class in the arena allocator
+#define ALLOCATOR_MIN_BLOCK_SIZE	64
+
+//! Value in the header of each block that is used to detect blocks from another allocator
+#define ALLOCATOR_BLOCK_MAGIC		0x56433541
+
+//! Number of bytes reserved for the header so that the memory after the header is aligned
+#define ALLOCATOR_HEADER_SIZE		ALLOCATOR_ALIGNMENT
+
+/*!
+	@brief Header at the start of each block allocated by the arena allocator
+*/
+struct _allocator_block
+{
+	ALLOCATOR_BLOCK *next_block;	//!< Next block in the list of all blocks
+	ALLOCATOR_BLOCK *next_free;		//!< Next block in the free list for the size class
+	uint32_t magic;					//!< Marker used to check that the block is valid
+	int size_class;					//!< Size class of the memory after the header
+	bool in_use;					//!< True if the block has not been freed
+	size_t size;					//!< Number of bytes requested by the caller
+	ALLOCATOR_TAG tag;				//!< Kind of data structure stored in the block
+};
+
+/*!
+	@brief Header at the start of each block allocated by the default allocator with statistics
+*/
+typedef struct _allocator_record
+{
+	size_t size;					//!< Number of bytes requested by the caller
+	ALLOCATOR_TAG tag;				//!< Kind of data structure stored in the block
+
+} ALLOCATOR_RECORD;
+
+//! Names of the allocator tags in the statistics report
+static const char *allocator_tag_name[ALLOCATOR_TAG_COUNT] =
+{
+	"other",
+	"wavelet",
+	"image",
+	"component array",
+	"codebook",
+	"transform buffer",
+};
+
+
+/*!
+	@brief Allocate memory from the system that is aligned to a cache line
+*/
+static void *AlignedMalloc(size_t size)
+{
+#ifdef _WIN32
+	return _aligned_malloc(size, ALLOCATOR_ALIGNMENT);
+#else
+	void *memory = NULL;
+	if (posix_memalign(&memory, ALLOCATOR_ALIGNMENT, (size > 0) ? size : 1) != 0) {
+		return NULL;
+	}
+	return memory;
+#endif
+}
+
+/*!
+	@brief Return memory allocated by @ref AlignedMalloc to the system
+*/
+static void AlignedFree(void *memory)
+{
+#ifdef _WIN32
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+/*!
+	@brief Add an allocated block to the statistics
+*/
+static void AddBlockStats(ALLOCATOR_STATS *stats, size_t size)
+{
+	stats->allocation_count++;
+	stats->current_bytes += size;
+	if (stats->peak_bytes < stats->current_bytes) {
+		stats->peak_bytes = stats->current_bytes;
+	}
+}
+
+/*!
+	@brief Add a block to the statistics for all blocks and for the tag
+
+	The caller must hold the lock for the allocator.
+*/
+static void RecordAlloc(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag)
+{
+	AddBlockStats(&allocator->total, size);
+	AddBlockStats(&allocator->tag_stats[tag], size);
+}
+
+/*!
+	@brief Remove a block from the statistics
+
+	The caller must hold the lock for the allocator.
+*/
+static void RecordFree(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag)
+{
+	assert(allocator->tag_stats[tag].current_bytes >= size);
+
+	allocator->total.current_bytes -= size;
+	allocator->tag_stats[tag].current_bytes -= size;
+}
+
+/*!
+	@brief Return the number of bytes in a block of the specified size class
+*/
+static size_t SizeClassBytes(int size_class)
+{
+	return (size_t)(4 + (size_class % 4)) << (size_class / 4 + 4);
+}
+
+/*!
+	@brief Return the smallest size class that can hold the specified number of bytes
+
+	Returns a negative number if the size is larger than the largest size class.
+*/
+static int SizeClass(size_t size)
+{
+	int size_class = 0;
+
+	// Skip the powers of two that are smaller than the size
+	while (size_class < ALLOCATOR_SIZE_CLASS_COUNT && (size_t)(2 * ALLOCATOR_MIN_BLOCK_SIZE) << (size_class / 4) < size) {
+		size_class += 4;
+	}
+
+	while (size_class < ALLOCATOR_SIZE_CLASS_COUNT && SizeClassBytes(size_class) < size) {
+		size_class++;
+	}
+
+	return (size_class < ALLOCATOR_SIZE_CLASS_COUNT) ? size_class : -1;
+}
+
+/*!
+	@brief Take a block from the free list or allocate a new block from the system
+*/
+static void *ArenaAlloc(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag)
+{
+	ALLOCATOR_BLOCK *block;
+	int size_class = SizeClass(size);
+
+	if (size_class < 0) {
+		return NULL;
+	}
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	block = allocator->free_list[size_class];
+	if (block != NULL)
+	{
+		allocator->free_list[size_class] = block->next_free;
+	}
+	else
+	{
+		block = (ALLOCATOR_BLOCK *)AlignedMalloc(ALLOCATOR_HEADER_SIZE + SizeClassBytes(size_class));
+		if (block != NULL)
+		{
+			block->magic = ALLOCATOR_BLOCK_MAGIC;
+			block->size_class = size_class;
+			block->next_block = allocator->block_list;
+			allocator->block_list = block;
+		}
+	}
+
+	if (block != NULL)
+	{
+		block->next_free = NULL;
+		block->in_use = true;
+		block->size = size;
+		block->tag = tag;
+
+		if (allocator->stats_flag) {
+			RecordAlloc(allocator, size, tag);
+		}
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+
+	return (block != NULL) ? (void *)((uint8_t *)block + ALLOCATOR_HEADER_SIZE) : NULL;
+}
+
+/*!
+	@brief Add a block to the free list for its size class
+*/
+static void ArenaFree(ALLOCATOR *allocator, void *memory)
+{
+	ALLOCATOR_BLOCK *block = (ALLOCATOR_BLOCK *)((uint8_t *)memory - ALLOCATOR_HEADER_SIZE);
+
+	assert(sizeof(ALLOCATOR_BLOCK) <= ALLOCATOR_HEADER_SIZE);
+
+	// The block must have been allocated by an arena allocator and not freed
+	assert(block->magic == ALLOCATOR_BLOCK_MAGIC && block->in_use);
+	if (! (block->magic == ALLOCATOR_BLOCK_MAGIC && block->in_use)) {
+		return;
+	}
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	block->in_use = false;
+	block->next_free = allocator->free_list[block->size_class];
+	allocator->free_list[block->size_class] = block;
+
+	if (allocator->stats_flag) {
+		RecordFree(allocator, block->size, block->tag);
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+}
+
+/*!
+	@brief Allocate a block from the system with a header for the statistics
+*/
+static void *RecordedAlloc(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag)
+{
+	ALLOCATOR_RECORD *record = (ALLOCATOR_RECORD *)AlignedMalloc(ALLOCATOR_HEADER_SIZE + size);
+	if (record == NULL) {
+		return NULL;
+	}
+
+	record->size = size;
+	record->tag = tag;
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	RecordAlloc(allocator, size, tag);
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+
+	return (uint8_t *)record + ALLOCATOR_HEADER_SIZE;
+}
+
+/*!
+	@brief Return a block with a header for the statistics to the system
+*/
+static void RecordedFree(ALLOCATOR *allocator, void *memory)
+{
+	ALLOCATOR_RECORD *record = (ALLOCATOR_RECORD *)((uint8_t *)memory - ALLOCATOR_HEADER_SIZE);
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	RecordFree(allocator, record->size, record->tag);
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+
+	AlignedFree(record);
+}
+
 /*!
 	@brief Allocate a block with the specified size
+
+	The block is aligned to @ref ALLOCATOR_ALIGNMENT bytes.
 */
 void *Alloc(ALLOCATOR *allocator, size_t size)
 {
-	(void)allocator;
-	return malloc(size);
+	return AllocTagged(allocator, size, ALLOCATOR_TAG_OTHER);
+}
+
+/*!
+	@brief Allocate a block that is recorded in the statistics for the specified tag
+*/
+void *AllocTagged(ALLOCATOR *allocator, size_t size, ALLOCATOR_TAG tag)
+{
+	assert(0 <= tag && tag < ALLOCATOR_TAG_COUNT);
+
+	if (allocator != NULL && allocator->type == ALLOCATOR_TYPE_ARENA) {
+		return ArenaAlloc(allocator, size, tag);
+	}
+
+	if (allocator != NULL && allocator->stats_flag) {
+		return RecordedAlloc(allocator, size, tag);
+	}
+
+	return AlignedMalloc(size);
 }
 
 /*!
@@ -43,8 +351,168 @@ void *Alloc(ALLOCATOR *allocator, size_t size)
 */
 void Free(ALLOCATOR *allocator, void *block)
 {
-	(void)allocator;
-	if (block != NULL) {
-		free(block);
+	if (block == NULL) {
+		return;
+	}
+
+	if (allocator != NULL && allocator->type == ALLOCATOR_TYPE_ARENA) {
+		ArenaFree(allocator, block);
+		return;
+	}
+
+	if (allocator != NULL && allocator->stats_flag) {
+		RecordedFree(allocator, block);
+		return;
+	}
+
+	AlignedFree(block);
+}
+
+/*!
+	@brief Initialize an allocator that implements the specified allocation scheme
+*/
+CODEC_ERROR InitAllocator(ALLOCATOR *allocator, ALLOCATOR_TYPE type)
+{
+	assert(allocator != NULL);
+	if (! (allocator != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	memset(allocator, 0, sizeof(ALLOCATOR));
+	allocator->type = type;
+
+#if _THREADED
+	pthread_mutex_init(&allocator->mutex, NULL);
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Return every block allocated by the arena allocator to the free lists
+
+	This routine is called at the end of each frame after all data structures
+	that use the allocator have been released.  Any blocks that were not freed
+	during the frame are made available for reuse in the next frame, but the
+	memory is not returned to the system.
+*/
+CODEC_ERROR ResetAllocator(ALLOCATOR *allocator)
+{
+	ALLOCATOR_BLOCK *block;
+
+	if (allocator == NULL || allocator->type != ALLOCATOR_TYPE_ARENA) {
+		return CODEC_ERROR_OKAY;
+	}
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	memset(allocator->free_list, 0, sizeof(allocator->free_list));
+
+	for (block = allocator->block_list; block != NULL; block = block->next_block)
+	{
+		if (block->in_use && allocator->stats_flag) {
+			RecordFree(allocator, block->size, block->tag);
+		}
+
+		block->in_use = false;
+		block->next_free = allocator->free_list[block->size_class];
+		allocator->free_list[block->size_class] = block;
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Return all memory obtained by the allocator to the system
+
+	All blocks allocated by the arena allocator are invalid after this routine
+	returns, including blocks that have not been freed.
+*/
+CODEC_ERROR ReleaseAllocator(ALLOCATOR *allocator)
+{
+	ALLOCATOR_BLOCK *block;
+
+	if (allocator == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	block = allocator->block_list;
+	while (block != NULL)
+	{
+		ALLOCATOR_BLOCK *next_block = block->next_block;
+		AlignedFree(block);
+		block = next_block;
+	}
+
+	allocator->block_list = NULL;
+	memset(allocator->free_list, 0, sizeof(allocator->free_list));
+
+#if _THREADED
+	pthread_mutex_destroy(&allocator->mutex);
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Start recording statistics about the memory allocated by the allocator
+
+	Statistics must be enabled before the first block is allocated, since the
+	default allocator cannot free a block that was allocated without statistics
+	after statistics are enabled.
+*/
+CODEC_ERROR EnableAllocatorStats(ALLOCATOR *allocator)
+{
+	assert(allocator != NULL && allocator->total.allocation_count == 0);
+	if (! (allocator != NULL && allocator->total.allocation_count == 0)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	allocator->stats_flag = true;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Print a table of the memory statistics for each tag
+
+	The tags that were not used to allocate any blocks are omitted.
+*/
+CODEC_ERROR PrintAllocatorStats(ALLOCATOR *allocator, FILE *file)
+{
+	int tag;
+
+	if (allocator == NULL || !allocator->stats_flag) {
+		return CODEC_ERROR_OKAY;
+	}
+
+#if _THREADED
+	pthread_mutex_lock(&allocator->mutex);
+#endif
+
+	fprintf(file, "%-18s %12s %14s %14s\n", "Memory", "Allocations", "Current bytes", "Peak bytes");
+
+	for (tag = 0; tag < ALLOCATOR_TAG_COUNT; tag++)
+	{
+		ALLOCATOR_STATS *stats = &allocator->tag_stats[tag];
+		if (stats->allocation_count > 0) {
+			fprintf(file, "%-18s %12zu %14zu %14zu\n", allocator_tag_name[tag],
+					stats->allocation_count, stats->current_bytes, stats->peak_bytes);
+		}
 	}
+
+	fprintf(file, "%-18s %12zu %14zu %14zu\n", "total",
+			allocator->total.allocation_count, allocator->total.current_bytes, allocator->total.peak_bytes);
+
+#if _THREADED
+	pthread_mutex_unlock(&allocator->mutex);
+#endif
+
+	return CODEC_ERROR_OKAY;
 }
@@ -249,6 +249,119 @@ bool GetBandfileInfo(const char *string, BANDFILE_INFO *bandfile)
 }
 
 
+/*!
+	@brief Convert a command-line argument to the number of threads
+
+	The number of threads must be at least one.
+ */
+bool GetThreadCount(const char *string, int *thread_count_out)
+{
+    int value;
+    if (string != NULL && thread_count_out != NULL && sscanf(string, "%d", &value) == 1 && value > 0) {
+        *thread_count_out = value;
+        return true;
+    }
+    return false;
+}
+
+/*!
+	@brief Convert a command-line argument to the memory allocation scheme
+ */
+bool GetAllocatorType(const char *string, ALLOCATOR_TYPE *allocator_type_out)
+{
+    if (string == NULL || allocator_type_out == NULL) {
+        return false;
+    }
+
+    if (strcmp(string, "default") == 0) {
+        *allocator_type_out = ALLOCATOR_TYPE_DEFAULT;
+        return true;
+    }
+
+    if (strcmp(string, "arena") == 0) {
+        *allocator_type_out = ALLOCATOR_TYPE_ARENA;
+        return true;
+    }
+
+    return false;
+}
+
+/*!
+	@brief Convert a command-line argument to the decoded resolution
+
+	The resolution can be specified by name or by the reduction in the image
+	dimensions (1, 2, 4, or 8).
+ */
+bool GetResolution(const char *string, RESOLUTION *resolution_out)
+{
+    static const struct
+    {
+        const char *name;
+        const char *scale;
+        RESOLUTION resolution;
+
+    } resolution_table[] =
+    {
+        {"full", "1", RESOLUTION_FULL},
+        {"half", "2", RESOLUTION_HALF},
+        {"quarter", "4", RESOLUTION_QUARTER},
+        {"eighth", "8", RESOLUTION_EIGHTH},
+    };
+
+    const int resolution_table_length = sizeof(resolution_table)/sizeof(resolution_table[0]);
+    int index;
+
+    if (string == NULL || resolution_out == NULL) {
+        return false;
+    }
+
+    for (index = 0; index < resolution_table_length; index++)
+    {
+        if (strcmp(string, resolution_table[index].name) == 0 ||
+            strcmp(string, resolution_table[index].scale) == 0)
+        {
+            *resolution_out = resolution_table[index].resolution;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+	@brief Convert a command-line argument to a region of interest
+
+	The region is specified as four integers separated by commas: the column and row
+	of the upper left corner followed by the width and height of the region.
+ */
+bool GetRegionOfInterest(const char *string, ROI *roi_out)
+{
+    int x, y, width, height;
+
+    if (string == NULL || roi_out == NULL) {
+        return false;
+    }
+
+    if (sscanf(string, "%d,%d,%d,%d", &x, &y, &width, &height) != 4) {
+        return false;
+    }
+
+    if (! (0 <= x && x <= UINT16_MAX && 0 <= y && y <= UINT16_MAX)) {
+        return false;
+    }
+
+    if (! (0 < width && width <= UINT16_MAX && 0 < height && height <= UINT16_MAX)) {
+        return false;
+    }
+
+    roi_out->x = (DIMENSION)x;
+    roi_out->y = (DIMENSION)y;
+    roi_out->width = (DIMENSION)width;
+    roi_out->height = (DIMENSION)height;
+
+    return true;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
 
 #if 0
@@ -327,6 +327,38 @@ int CreateBandFile(BANDFILE *bandfile, const char *pathname)
 	return BANDFILE_ERROR_OKAY;
 }
 
+/*!
+	@brief Write the headers that must precede the band data in the band file
+*/
+static void WriteBandHeaders(BANDFILE *bandfile,
+							 int frame,
+							 int channel,
+							 int wavelet,
+							 int band,
+							 int type,
+							 int width,
+							 int height,
+							 size_t size)
+{
+	assert(bandfile->file_header_flag);
+
+	if (!bandfile->frame_header_flag || bandfile->frame != (uint32_t)frame) {
+		WriteFrameHeader(bandfile, frame);
+	}
+
+	if (!bandfile->channel_header_flag || bandfile->channel != channel) {
+		WriteChannelHeader(bandfile, channel);
+	}
+
+	if (!bandfile->wavelet_header_flag || bandfile->wavelet != wavelet) {
+		WriteWaveletHeader(bandfile, wavelet);
+	}
+
+	if (!bandfile->band_header_flag || bandfile->band != band || bandfile->type != type) {
+		WriteBandHeader(bandfile, band, type, width, height, size);
+	}
+}
+
 /*!
 	@brief Write the band data to the band file
 
@@ -347,25 +379,41 @@ int WriteWaveletBand(BANDFILE *bandfile,
 					 void *data,
 					 size_t size)
 {
-	assert(bandfile->file_header_flag);
+	WriteBandHeaders(bandfile, frame, channel, wavelet, band, type, width, height, size);
 
-	if (!bandfile->frame_header_flag || bandfile->frame != (uint32_t)frame) {
-		WriteFrameHeader(bandfile, frame);
-	}
+	WriteBandData(bandfile, data, size);
 
-	if (!bandfile->channel_header_flag || bandfile->channel != channel) {
-		WriteChannelHeader(bandfile, channel);
-	}
+	return BANDFILE_ERROR_OKAY;
+}
 
-	if (!bandfile->wavelet_header_flag || bandfile->wavelet != wavelet) {
-		WriteWaveletHeader(bandfile, wavelet);
-	}
+/*!
+	@brief Write the rows of band data with the specified pitch to the band file
 
-	if (!bandfile->band_header_flag || bandfile->band != band || bandfile->type != type) {
-		WriteBandHeader(bandfile, band, type, width, height, size);
-	}
+	The padding at the end of each row is not written to the band file, so the
+	band data in the file is the same as the data written by @ref WriteWaveletBand
+	for a band without padding.  The band data must be 16-bit values.
+*/
+int WriteWaveletBandRows(BANDFILE *bandfile,
+						 int frame,
+						 int channel,
+						 int wavelet,
+						 int band,
+						 int type,
+						 int width,
+						 int height,
+						 void *data,
+						 size_t pitch)
+{
+	size_t row_size = width * sizeof(uint16_t);
+	int row;
 
-	WriteBandData(bandfile, data, size);
+	assert(type == BAND_TYPE_UINT16 || type == BAND_TYPE_SINT16);
+
+	WriteBandHeaders(bandfile, frame, channel, wavelet, band, type, width, height, height * row_size);
+
+	for (row = 0; row < height; row++) {
+		WriteBandData(bandfile, (uint8_t *)data + row * pitch, row_size);
+	}
 
 	return BANDFILE_ERROR_OKAY;
 }
@@ -0,0 +1,77 @@
+/*!	@file common/src/cpu.c
+
+	Implementation of the routines for detecting the processor features
+	used to select the vectorized implementations of the wavelet filters.
+
+	The features are only reported if the vectorized filters that use
+	the features are compiled into the program.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "platform.h"
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+#if _SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+
+/*!
+	@brief Return the processor features that can be used by the vectorized filters
+
+	The AVX2 instructions are only reported if the operating system saves the
+	extended registers, which is checked by the compiler runtime or by reading
+	the extended control register.
+*/
+uint32_t GetCPUFeatures(void)
+{
+	uint32_t features = CPU_FEATURE_NONE;
+
+#if _SIMD_X86 && defined(__GNUC__)
+
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("sse2")) {
+		features |= CPU_FEATURE_SSE2;
+	}
+
+	if (__builtin_cpu_supports("avx2")) {
+		features |= CPU_FEATURE_AVX2;
+	}
+
+#elif _SIMD_X86 && defined(_MSC_VER)
+
+	int info[4];
+
+	__cpuid(info, 1);
+
+	// SSE2 is reported in bit 26 of EDX
+	if (info[3] & (1 << 26)) {
+		features |= CPU_FEATURE_SSE2;
+	}
+
+	// The extended registers must be enabled by the operating system (OSXSAVE and AVX)
+	if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x06) == 0x06)
+	{
+		// AVX2 is reported in bit 5 of EBX in the extended features
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5)) {
+			features |= CPU_FEATURE_AVX2;
+		}
+	}
+
+#elif _SIMD_NEON
+
+	// Advanced SIMD is always available if the compiler generates NEON instructions
+	features |= CPU_FEATURE_NEON;
+
+#endif
+
+	return features;
+}
@@ -282,9 +282,16 @@ CODEC_ERROR DPX_ReadFile(IMAGE *image, const char *pathname)
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	size_t file_size;
 	size_t result;
+	FILE *file;
+
+	// Read the image directly from the file if the file can be mapped into memory
+	InitImage(image);
+	if (MapImageFile(image, pathname) == CODEC_ERROR_OKAY) {
+		return CODEC_ERROR_OKAY;
+	}
 
 	// Open the file that contains the DPX image
-	FILE *file = fopen(pathname, "rb");
+	file = fopen(pathname, "rb");
 	if (file == NULL) {
 		//fprintf(stderr, "File open error: %s\n", pathname); 
 		return CODEC_ERROR_OPEN_FILE_FAILED;
@@ -0,0 +1,154 @@
+/*!	@file common/src/filemap.c
+
+	Implementation of files that are mapped into memory for reading.
+
+	The mapping is private, so a reader that modifies the image in place gets
+	its own copy of the modified pages and the file is not changed.  An empty
+	file cannot be mapped, so the caller must read the file by other means if
+	the mapping fails.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "platform.h"
+
+#if _MAPPED_FILES
+
+#if _WIN32
+
+#define WIN32_LEAN_AND_MEAN		// Exclude rarely-used stuff from Windows headers
+
+// Windows Header Files
+#include <windows.h>
+
+#else
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#endif
+
+#endif
+
+#include "headers.h"
+
+
+/*!
+	@brief Map the entire file into memory for reading
+
+	The operating system is advised that the file will be read sequentially
+	and that all of the file will be needed soon.
+*/
+CODEC_ERROR MapFile(FILE_MAPPING *mapping, const char *pathname)
+{
+	assert(mapping != NULL);
+	if (! (mapping != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	mapping->address = NULL;
+	mapping->size = 0;
+
+#if _MAPPED_FILES
+#if _WIN32
+	{
+		HANDLE file;
+		HANDLE section;
+		LARGE_INTEGER size;
+		void *address;
+
+		file = CreateFileA(pathname, GENERIC_READ, FILE_SHARE_READ, NULL,
+						   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return CODEC_ERROR_OPEN_FILE_FAILED;
+		}
+
+		if (! GetFileSizeEx(file, &size) || size.QuadPart == 0 || (ULONGLONG)size.QuadPart > SIZE_MAX)
+		{
+			CloseHandle(file);
+			return CODEC_ERROR_FILE_SIZE_FAILED;
+		}
+
+		section = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+		CloseHandle(file);
+		if (section == NULL) {
+			return CODEC_ERROR_READ_FILE_FAILED;
+		}
+
+		// The view keeps the section open after the handle is closed
+		address = MapViewOfFile(section, FILE_MAP_COPY, 0, 0, 0);
+		CloseHandle(section);
+		if (address == NULL) {
+			return CODEC_ERROR_READ_FILE_FAILED;
+		}
+
+		mapping->address = address;
+		mapping->size = (size_t)size.QuadPart;
+	}
+#else
+	{
+		struct stat info;
+		void *address;
+		int fd;
+
+		fd = open(pathname, O_RDONLY);
+		if (fd < 0) {
+			return CODEC_ERROR_OPEN_FILE_FAILED;
+		}
+
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			close(fd);
+			return CODEC_ERROR_FILE_SIZE_FAILED;
+		}
+
+		address = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (address == MAP_FAILED) {
+			return CODEC_ERROR_READ_FILE_FAILED;
+		}
+
+		// The advice is only a hint so errors are ignored
+		(void)madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+		(void)madvise(address, (size_t)info.st_size, MADV_WILLNEED);
+
+		mapping->address = address;
+		mapping->size = (size_t)info.st_size;
+	}
+#endif
+
+	return CODEC_ERROR_OKAY;
+#else
+	(void)pathname;
+	return CODEC_ERROR_READ_FILE_FAILED;
+#endif
+}
+
+/*!
+	@brief Remove a file mapping from memory
+
+	It is not an error to unmap a file that has not been mapped.
+*/
+CODEC_ERROR UnmapFile(FILE_MAPPING *mapping)
+{
+	if (mapping == NULL || mapping->address == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+#if _MAPPED_FILES
+#if _WIN32
+	UnmapViewOfFile(mapping->address);
+#else
+	munmap(mapping->address, mapping->size);
+#endif
+#endif
+
+	mapping->address = NULL;
+	mapping->size = 0;
+
+	return CODEC_ERROR_OKAY;
+}
@@ -29,6 +29,8 @@ CODEC_ERROR InitImage(IMAGE *image)
 		image->format = PIXEL_FORMAT_UNKNOWN;
 		image->buffer = NULL;
 		image->size = 0;
+		image->mapping.address = NULL;
+		image->mapping.size = 0;
 		return CODEC_ERROR_OKAY;
 	}
 
@@ -98,7 +100,7 @@ CODEC_ERROR AllocImage(ALLOCATOR *allocator, IMAGE *image, DIMENSION width, DIME
 	assert(size > 0);
 
 	// Allocate the image buffer
-	image->buffer = Alloc(allocator, size);
+	image->buffer = AllocTagged(allocator, size, ALLOCATOR_TAG_IMAGE);
 	if (image->buffer != NULL)
 	{
 		image->width = width;
@@ -122,7 +124,7 @@ CODEC_ERROR AllocImageSize(ALLOCATOR *allocator, IMAGE *image, size_t size)
 {
 	assert(image != NULL);
 	InitImage(image);
-	image->buffer = Alloc(allocator, size);
+	image->buffer = AllocTagged(allocator, size, ALLOCATOR_TAG_IMAGE);
 	if (image->buffer != NULL) {
 		image->size = size;
 		return CODEC_ERROR_OKAY;
@@ -171,7 +173,57 @@ CODEC_ERROR AllocImageCopy(ALLOCATOR *allocator, IMAGE *image, IMAGE *prototype,
 */
 CODEC_ERROR ReleaseImage(ALLOCATOR *allocator, IMAGE *image)
 {
-	Free(allocator, image->buffer);
+	if (image->mapping.address != NULL) {
+		UnmapFile(&image->mapping);
+	}
+	else {
+		Free(allocator, image->buffer);
+	}
+	image->buffer = NULL;
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Bind the image buffer to a file that is mapped into memory
+
+	The buffer that was allocated for the image by the caller using the default
+	allocator is released, so the pixels are read directly from the file.  An
+	image without a buffer takes the size of the file.  The image is not changed
+	if the file cannot be mapped or is smaller than the image buffer.
+*/
+CODEC_ERROR MapImageFile(IMAGE *image, const char *pathname)
+{
+	FILE_MAPPING mapping;
+	CODEC_ERROR error;
+
+	assert(image != NULL);
+	if (! (image != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	error = MapFile(&mapping, pathname);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// The file must contain all of the pixels in the image
+	if (mapping.size < image->size)
+	{
+		UnmapFile(&mapping);
+		return CODEC_ERROR_FILE_SIZE_FAILED;
+	}
+
+	if (image->buffer != NULL) {
+		ReleaseImage(NULL, image);
+	}
+
+	if (image->size == 0) {
+		image->size = mapping.size;
+	}
+
+	image->buffer = mapping.address;
+	image->mapping = mapping;
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -182,7 +234,7 @@ CODEC_ERROR FreeImage(ALLOCATOR *allocator, IMAGE *image)
 {
     if (image != NULL)
     {
-        Free(allocator, image->buffer);
+        ReleaseImage(allocator, image);
         Free(allocator, image);
     }
     return CODEC_ERROR_OKAY;
@@ -502,10 +554,10 @@ CODEC_ERROR AllocateComponentArray(ALLOCATOR *allocator,
 {
     //COMPONENT_ARRAY *component_array = Alloc(allocator, sizeof(COMPONENT_ARRAY));
     
-    // Allocate space for the data in the component array
-    size_t pitch = width * sizeof(COMPONENT_VALUE);
-    size_t size = height * pitch;
-    void *buffer = Alloc(allocator, size);
+    // Allocate space for the data in the component array with aligned rows and tail padding
+    size_t pitch = ALIGNED_PITCH(width * sizeof(COMPONENT_VALUE));
+    size_t size = height * pitch + ALLOCATOR_TAIL_PADDING;
+    void *buffer = AllocTagged(allocator, size, ALLOCATOR_TAG_COMPONENT_ARRAY);
     assert(buffer != NULL);
     if (! (buffer != NULL)) {
         return CODEC_ERROR_OUTOFMEMORY;
@@ -13,6 +13,13 @@
 	All rights reserved--use subject to compliance with end user license agreement.
 */
 
+#include "platform.h"
+
+#if _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
 #include "headers.h"
 
 // Local functions
@@ -20,6 +27,7 @@ CODEC_ERROR GetBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 CODEC_ERROR PutBlockFile(STREAM *stream, void *buffer, size_t size, size_t offset);
 CODEC_ERROR GetBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset);
 CODEC_ERROR PutBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset);
+CODEC_ERROR ReserveStreamBuffer(STREAM *stream, size_t size);
 
 /*!
 	@brief Open a stream for reading bytes from the specified file
@@ -53,8 +61,11 @@ CODEC_ERROR OpenStream(STREAM *stream, const char *pathname)
 }
 
 /*!
-	@brief Create a stream for reading bytes from the specified file
+	@brief Create a stream for writing bytes to the specified file
 
+	The pathname "-" binds the stream to the standard output.  The standard
+	output may be a pipe or socket that cannot seek, so the bytes must be
+	written in order (see @ref PutStreamBuffer).
 */
 CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 {
@@ -67,7 +78,18 @@ CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 	memset(stream, 0, sizeof(STREAM));
 
 	// Open the file and bind it to the stream
-	stream->location.file.iobuf = fopen(pathname, "wb+");
+	if (strcmp(pathname, "-") == 0)
+	{
+#if _WIN32
+		// The bitstream must not be changed by translation of line endings
+		_setmode(_fileno(stdout), _O_BINARY);
+#endif
+		stream->location.file.iobuf = stdout;
+	}
+	else
+	{
+		stream->location.file.iobuf = fopen(pathname, "wb+");
+	}
 	assert(stream->location.file.iobuf != NULL);
 	if (! (stream->location.file.iobuf != NULL)) {
 		return CODEC_ERROR_CREATE_FILE_FAILED;
@@ -85,14 +107,34 @@ CODEC_ERROR CreateStream(STREAM *stream, const char *pathname)
 
 /*!
     @brief Close the stream
+
+    The buffer bound to a growable memory stream is owned by the stream
+    and is deallocated when the stream is closed.  The file mapped into
+    memory by @ref OpenMappedStream is unmapped.
 */
 CODEC_ERROR CloseStream(STREAM *stream)
 {
-    if (stream != NULL && stream->location.file.iobuf != NULL)
+    // Only streams bound to a binary file must be closed
+    if (stream != NULL && stream->type == STREAM_TYPE_FILE && stream->location.file.iobuf != NULL)
     {
         fclose(stream->location.file.iobuf);
         stream->location.file.iobuf = NULL;
     }
+
+    if (stream != NULL && stream->type == STREAM_TYPE_MEMORY && stream->location.memory.growable)
+    {
+        Free(stream->location.memory.allocator, stream->location.memory.buffer);
+        stream->location.memory.buffer = NULL;
+        stream->location.memory.size = 0;
+        stream->location.memory.growable = false;
+    }
+
+    if (stream != NULL && stream->type == STREAM_TYPE_MEMORY && stream->location.memory.mapping.address != NULL)
+    {
+        UnmapFile(&stream->location.memory.mapping);
+        stream->location.memory.buffer = NULL;
+        stream->location.memory.size = 0;
+    }
     
     return CODEC_ERROR_OKAY;
 }
@@ -104,29 +146,81 @@ CODEC_ERROR CloseStream(STREAM *stream)
 	A word is the number of bytes that can be stored in the internal buffer
 	used by the bitstream.
 
-	@todo Need to modify the routine to return an indication of end of file
-	or an error reading from the byte stream.
+	A word is copied directly from a memory buffer without calling the C
+	library.  The stream error is set to @ref STREAM_ERROR_EOF and zero is
+	returned if the stream does not contain a whole word.
 */
 uint32_t GetWord(STREAM *stream)
 {
 	uint32_t buffer;
-	size_t count = fread(&buffer, sizeof(buffer), 1, stream->location.file.iobuf);
-    if (count != 1)
-    {
-        stream->error = STREAM_ERROR_EOF;
-        return 0;
-    }
-    
+
+	switch (stream->type)
+	{
+	case STREAM_TYPE_FILE:
+		if (fread(&buffer, sizeof(buffer), 1, stream->location.file.iobuf) != 1)
+		{
+			stream->error = STREAM_ERROR_EOF;
+			return 0;
+		}
+		break;
+
+	case STREAM_TYPE_MEMORY:
+		if (stream->location.memory.size - stream->location.memory.count < sizeof(buffer))
+		{
+			stream->location.memory.count = stream->location.memory.size;
+			stream->error = STREAM_ERROR_EOF;
+			return 0;
+		}
+		memcpy(&buffer, (const uint8_t *)stream->location.memory.buffer + stream->location.memory.count, sizeof(buffer));
+		stream->location.memory.count += sizeof(buffer);
+		break;
+
+	default:
+		assert(0);
+		stream->error = STREAM_ERROR_EOF;
+		return 0;
+	}
+
 	stream->byte_count += sizeof(buffer);
 	return buffer;
 }
 
 /*!
 	@brief Read a byte from a byte stream
+
+	The stream error is set to @ref STREAM_ERROR_EOF and zero is returned
+	if there are no more bytes in the stream.
 */
 uint8_t GetByte(STREAM *stream)
 {
-	int byte = fgetc(stream->location.file.iobuf);
+	int byte;
+
+	switch (stream->type)
+	{
+	case STREAM_TYPE_FILE:
+		byte = fgetc(stream->location.file.iobuf);
+		if (byte == EOF)
+		{
+			stream->error = STREAM_ERROR_EOF;
+			return 0;
+		}
+		break;
+
+	case STREAM_TYPE_MEMORY:
+		if (stream->location.memory.count >= stream->location.memory.size)
+		{
+			stream->error = STREAM_ERROR_EOF;
+			return 0;
+		}
+		byte = ((const uint8_t *)stream->location.memory.buffer)[stream->location.memory.count++];
+		break;
+
+	default:
+		assert(0);
+		stream->error = STREAM_ERROR_EOF;
+		return 0;
+	}
+
 	stream->byte_count++;
 	assert(byte >= 0 && (byte & ~0xFF) == 0);
 	return (uint8_t)byte;
@@ -156,7 +250,10 @@ CODEC_ERROR PutWord(STREAM *stream, uint32_t word)
 		break;
 
 	case STREAM_TYPE_MEMORY:
-		memcpy((uint8_t *)stream->location.memory.buffer + stream->location.memory.count, &word, sizeof(word));
+		// Bytes that do not fit in the buffer are counted but not written
+		if (ReserveStreamBuffer(stream, sizeof(word)) == CODEC_ERROR_OKAY) {
+			memcpy((uint8_t *)stream->location.memory.buffer + stream->location.memory.count, &word, sizeof(word));
+		}
 		stream->location.memory.count += sizeof(word);
 		break;
 
@@ -189,7 +286,11 @@ CODEC_ERROR PutByte(STREAM *stream, uint8_t byte)
 		break;
 
 	case STREAM_TYPE_MEMORY:
-		((uint8_t *)stream->location.memory.buffer)[stream->location.memory.count++] = byte;
+		// Bytes that do not fit in the buffer are counted but not written
+		if (ReserveStreamBuffer(stream, sizeof(byte)) == CODEC_ERROR_OKAY) {
+			((uint8_t *)stream->location.memory.buffer)[stream->location.memory.count] = byte;
+		}
+		stream->location.memory.count++;
 		break;
 
 	default:
@@ -202,6 +303,45 @@ CODEC_ERROR PutByte(STREAM *stream, uint8_t byte)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Write a block of bytes to a byte stream
+
+	The bytes are written at the current position in the stream and
+	the number of bytes written to the stream is updated.
+*/
+CODEC_ERROR PutBytes(STREAM *stream, const void *block, size_t size)
+{
+	assert(stream != NULL);
+	if (! (stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	switch (stream->type)
+	{
+	case STREAM_TYPE_FILE:
+		if (size > 0 && fwrite(block, size, 1, stream->location.file.iobuf) != 1) {
+			return CODEC_ERROR_FILE_WRITE;
+		}
+		break;
+
+	case STREAM_TYPE_MEMORY:
+		// Bytes that do not fit in the buffer are counted but not written
+		if (ReserveStreamBuffer(stream, size) == CODEC_ERROR_OKAY) {
+			memcpy((uint8_t *)stream->location.memory.buffer + stream->location.memory.count, block, size);
+		}
+		stream->location.memory.count += size;
+		break;
+
+	default:
+		assert(0);
+		break;
+	}
+
+	stream->byte_count += size;
+
+	return CODEC_ERROR_OKAY;
+}
+
 /*!
 	@brief Rewind the stream to the beginning of the buffer or file
 */
@@ -237,12 +377,32 @@ CODEC_ERROR RewindStream(STREAM *stream)
 
 /*!
 	@brief Skip the specified number of bytes in the stream
+
+	The bytes in a memory buffer are skipped without reading the bytes.
 */
 CODEC_ERROR SkipBytes(STREAM *stream, size_t size)
 {
+	if (stream->type == STREAM_TYPE_MEMORY)
+	{
+		if (size > stream->location.memory.size - stream->location.memory.count)
+		{
+			// The bytes extend past the end of the buffer
+			stream->location.memory.count = stream->location.memory.size;
+			stream->error = STREAM_ERROR_EOF;
+			return CODEC_ERROR_FILE_READ;
+		}
+
+		stream->location.memory.count += size;
+		stream->byte_count += size;
+		return CODEC_ERROR_OKAY;
+	}
+
 	for (; size > 0; size--)
 	{
 		(void)GetByte(stream);
+		if (stream->error != STREAM_ERROR_OKAY) {
+			return CODEC_ERROR_FILE_READ;
+		}
 	}
 	return CODEC_ERROR_OKAY;
 }
@@ -309,6 +469,176 @@ CODEC_ERROR CreateStreamBuffer(STREAM *stream, void *buffer, size_t size)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Create a byte stream for a memory buffer that grows as bytes are written
+
+	The buffer is allocated using the specified allocator and is owned by the stream.
+	The buffer is reallocated with twice the size when more space is needed, so the
+	size argument is only the initial size of the buffer.  The buffer is deallocated
+	by @ref CloseStream.
+*/
+CODEC_ERROR CreateGrowableStream(STREAM *stream, ALLOCATOR *allocator, size_t size)
+{
+	void *buffer;
+	CODEC_ERROR error;
+
+	assert(stream != NULL);
+	if (! (stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	if (size == 0) {
+		size = 4096;
+	}
+
+	buffer = Alloc(allocator, size);
+	assert(buffer != NULL);
+	if (! (buffer != NULL)) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	error = CreateStreamBuffer(stream, buffer, size);
+	if (error != CODEC_ERROR_OKAY) {
+		Free(allocator, buffer);
+		return error;
+	}
+
+	// The stream owns the buffer
+	stream->location.memory.allocator = allocator;
+	stream->location.memory.growable = true;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Make room in a memory stream for the specified number of bytes
+
+	A buffer that is owned by the stream is enlarged if the bytes do not fit.
+	The size of the buffer is doubled until the bytes fit, so the number of
+	times that the buffer is copied grows with the logarithm of the size.
+
+	The buffer provided by the caller for other memory streams is not enlarged.
+	The stream error is set to @ref STREAM_ERROR_OVERFLOW if the bytes do not fit
+	in the buffer or the buffer cannot be enlarged.  The bytes that do not fit are
+	counted but not written, so the positions in the stream remain consistent and
+	the byte count is the size of the buffer that would have been required.  The
+	size of the buffer is reduced to the number of bytes that were written.
+
+	The routines that write to the stream do not return an error if bytes are
+	discarded, so the encoder can finish the sample.  The caller must check the
+	stream error or compare the byte count with the size of the buffer.
+*/
+CODEC_ERROR ReserveStreamBuffer(STREAM *stream, size_t size)
+{
+	size_t count = stream->location.memory.count;
+	size_t buffer_size = stream->location.memory.size;
+	ALLOCATOR *allocator = stream->location.memory.allocator;
+	void *buffer;
+
+	if (count + size <= buffer_size) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	// The bytes that were discarded cannot be recovered by enlarging the buffer
+	if (count > buffer_size) {
+		return stream->location.memory.growable ? CODEC_ERROR_OUTOFMEMORY : CODEC_ERROR_BUFFER_OVERFLOW;
+	}
+
+	if (! (stream->location.memory.growable)) {
+		stream->location.memory.size = count;
+		stream->error = STREAM_ERROR_OVERFLOW;
+		return CODEC_ERROR_BUFFER_OVERFLOW;
+	}
+
+	if (buffer_size == 0) {
+		buffer_size = 4096;
+	}
+
+	while (buffer_size < count + size) {
+		buffer_size *= 2;
+	}
+
+	buffer = Alloc(allocator, buffer_size);
+	if (buffer == NULL) {
+		stream->location.memory.size = count;
+		stream->error = STREAM_ERROR_OVERFLOW;
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	memcpy(buffer, stream->location.memory.buffer, count);
+	Free(allocator, stream->location.memory.buffer);
+
+	stream->location.memory.buffer = buffer;
+	stream->location.memory.size = buffer_size;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Open a stream for reading bytes from a buffer in memory
+
+	The buffer is owned by the caller and must contain the entire sample.
+	The bitstream attached to the stream reads the buffer directly.
+*/
+CODEC_ERROR OpenStreamBuffer(STREAM *stream, void *buffer, size_t size)
+{
+	assert(stream != NULL);
+	if (! (stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	// Clear all members of the stream data structure
+	memset(stream, 0, sizeof(STREAM));
+
+	// Bind the stream to the buffer
+	stream->location.memory.buffer = buffer;
+	stream->location.memory.size = size;
+	stream->location.memory.count = 0;
+
+	// Set the stream type and access
+	stream->type = STREAM_TYPE_MEMORY;
+	stream->access = STREAM_ACCESS_READ;
+
+	// Clear the number of bytes read from the stream
+	stream->byte_count = 0;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Open a stream for reading bytes from a file mapped into memory
+
+	The stream is a memory stream, so the bitstream attached to the stream
+	reads the sample directly from the pages of the file.  The file is
+	unmapped by @ref CloseStream.
+*/
+CODEC_ERROR OpenMappedStream(STREAM *stream, const char *pathname)
+{
+	FILE_MAPPING mapping;
+	CODEC_ERROR error;
+
+	assert(stream != NULL);
+	if (! (stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	error = MapFile(&mapping, pathname);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	error = OpenStreamBuffer(stream, mapping.address, mapping.size);
+	if (error != CODEC_ERROR_OKAY) {
+		UnmapFile(&mapping);
+		return error;
+	}
+
+	// The stream owns the mapping
+	stream->location.memory.mapping = mapping;
+
+	return CODEC_ERROR_OKAY;
+}
+
 /*!
 	@brief Return the starting address and number of bytes in a buffer
 
@@ -324,6 +654,11 @@ CODEC_ERROR GetStreamBuffer(STREAM *stream, void **buffer_out, size_t *size_out)
 
 	assert(stream->type == STREAM_TYPE_MEMORY);
 
+	// The buffer does not contain the bytes that were discarded after an overflow
+	if (stream->location.memory.count > stream->location.memory.size) {
+		return stream->location.memory.growable ? CODEC_ERROR_OUTOFMEMORY : CODEC_ERROR_BUFFER_OVERFLOW;
+	}
+
 	if (buffer_out != NULL) {
 		*buffer_out = stream->location.memory.buffer;
 	}
@@ -335,6 +670,76 @@ CODEC_ERROR GetStreamBuffer(STREAM *stream, void **buffer_out, size_t *size_out)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Write the bytes in a memory stream to another stream
+
+	The sample is assembled in the memory stream, including the chunk sizes
+	that are filled in after the chunk payload is written, and is written to
+	the output stream in a single block.  The output stream is never asked
+	to seek, so the output can be a pipe.
+*/
+CODEC_ERROR PutStreamBuffer(STREAM *output, STREAM *stream)
+{
+	CODEC_ERROR error;
+	void *buffer;
+	size_t size;
+
+	assert(output != NULL && stream != NULL);
+	if (! (output != NULL && stream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	error = GetStreamBuffer(stream, &buffer, &size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	error = PutBytes(output, buffer, size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	return FlushStream(output);
+}
+
+/*!
+	@brief Return the buffer and number of bytes written to a memory stream
+
+	The caller becomes the owner of the buffer in a growable stream and must
+	free the buffer using the allocator that was passed to @ref CreateGrowableStream.
+	The stream is no longer bound to the buffer.
+*/
+CODEC_ERROR DetachStreamBuffer(STREAM *stream, void **buffer_out, size_t *size_out)
+{
+	CODEC_ERROR error;
+
+	error = GetStreamBuffer(stream, buffer_out, size_out);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	stream->location.memory.buffer = NULL;
+	stream->location.memory.size = 0;
+	stream->location.memory.count = 0;
+	stream->location.memory.growable = false;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Return the number of bytes in the buffer of a memory stream
+
+	The bytes written to a stream after the buffer overflowed are counted
+	but are not in the buffer.
+*/
+static size_t StoredByteCount(STREAM *stream)
+{
+	if (stream->access == STREAM_ACCESS_WRITE && stream->location.memory.count < stream->location.memory.size) {
+		return stream->location.memory.count;
+	}
+	return stream->location.memory.size;
+}
+
 /*!
 	@brief Read a block of data at the specified offset in the byte stream
 */
@@ -396,7 +801,19 @@ CODEC_ERROR GetBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 */
 CODEC_ERROR GetBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset)
 {
-	uint8_t *block = (uint8_t *)stream->location.memory.buffer + offset;
+	uint8_t *block;
+	size_t count = StoredByteCount(stream);
+
+	// The block must be inside the bytes in the memory buffer
+	if (! (offset <= count && size <= count - offset)) {
+		// The error from an overflow in a stream opened for writing is not replaced
+		if (stream->access == STREAM_ACCESS_READ) {
+			stream->error = STREAM_ERROR_EOF;
+		}
+		return CODEC_ERROR_FILE_READ;
+	}
+
+	block = (uint8_t *)stream->location.memory.buffer + offset;
 	memcpy(buffer, block, size);
 	return CODEC_ERROR_OKAY;
 }
@@ -462,7 +879,15 @@ CODEC_ERROR PutBlockFile(STREAM *stream, void *buffer, size_t size, size_t offse
 */
 CODEC_ERROR PutBlockMemory(STREAM *stream, void *buffer, size_t size, size_t offset)
 {
-	uint8_t *block = (uint8_t *)stream->location.memory.buffer + offset;
+	uint8_t *block;
+	size_t count = StoredByteCount(stream);
+
+	// The block must replace bytes that have already been written
+	if (! (offset <= count && size <= count - offset)) {
+		return CODEC_ERROR_BUFFER_OVERFLOW;
+	}
+
+	block = (uint8_t *)stream->location.memory.buffer + offset;
 	memcpy(block, buffer, size);
 	return CODEC_ERROR_OKAY;
 }
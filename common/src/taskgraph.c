@@ -0,0 +1,228 @@
+/*!	@file common/src/taskgraph.c
+
+	Implementation of a scheduler for a graph of tasks with dependencies.
+
+	The graph is built on a single thread by adding tasks and the dependencies
+	between tasks.  When the graph is run, the tasks that do not depend on any
+	other tasks are submitted to the thread pool.  When a task finishes, the
+	dependency count of each task that depends on it is decremented and the
+	tasks with no remaining dependencies are submitted to the thread pool by
+	the thread that ran the finished task, so the work stealing thread pool
+	tends to run a dependent task on the same thread as its last dependency.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+
+/*!
+	@brief Run one task and submit the tasks that are ready to run
+*/
+static void RunGraphTask(void *argument)
+{
+	TASK_NODE *node = (TASK_NODE *)argument;
+	TASK_GRAPH *graph = node->graph;
+	int ready[MAX_TASK_SUCCESSORS];
+	int ready_count = 0;
+	CODEC_ERROR error;
+	bool skip;
+	int index;
+
+#if _THREADED
+	pthread_mutex_lock(&graph->mutex);
+#endif
+	skip = (graph->error != CODEC_ERROR_OKAY);
+#if _THREADED
+	pthread_mutex_unlock(&graph->mutex);
+#endif
+
+	// Skip the task if another task has failed
+	error = skip ? CODEC_ERROR_OKAY : node->routine(node->argument);
+
+#if _THREADED
+	pthread_mutex_lock(&graph->mutex);
+#endif
+
+	if (graph->error == CODEC_ERROR_OKAY) {
+		graph->error = error;
+	}
+
+	graph->finished_count++;
+
+	for (index = 0; index < node->successor_count; index++)
+	{
+		TASK_NODE *successor = &graph->node[node->successor[index]];
+		if (--successor->dependency_count == 0) {
+			ready[ready_count++] = node->successor[index];
+		}
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&graph->mutex);
+#endif
+
+	for (index = 0; index < ready_count; index++)
+	{
+		error = SubmitTask(graph->pool, RunGraphTask, &graph->node[ready[index]]);
+		if (error != CODEC_ERROR_OKAY) {
+			// Run the task on this thread if it cannot be submitted
+			RunGraphTask(&graph->node[ready[index]]);
+		}
+	}
+}
+
+/*!
+	@brief Initialize an empty graph with room for the specified number of tasks
+*/
+CODEC_ERROR InitTaskGraph(TASK_GRAPH *graph, ALLOCATOR *allocator, int node_limit)
+{
+	assert(graph != NULL && node_limit > 0);
+	if (! (graph != NULL && node_limit > 0)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	memset(graph, 0, sizeof(TASK_GRAPH));
+
+	graph->node = (TASK_NODE *)Alloc(allocator, node_limit * sizeof(TASK_NODE));
+	if (graph->node == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	graph->allocator = allocator;
+	graph->node_limit = node_limit;
+
+#if _THREADED
+	pthread_mutex_init(&graph->mutex, NULL);
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Free the table of tasks in the graph
+*/
+CODEC_ERROR ReleaseTaskGraph(TASK_GRAPH *graph)
+{
+	if (graph == NULL || graph->node == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	Free(graph->allocator, graph->node);
+	graph->node = NULL;
+	graph->node_count = 0;
+
+#if _THREADED
+	pthread_mutex_destroy(&graph->mutex);
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Add a task to the graph
+
+	Returns the index of the task in the graph or a negative number
+	if the table of tasks is full.
+*/
+int AddGraphTask(TASK_GRAPH *graph, GRAPH_ROUTINE routine, void *argument)
+{
+	TASK_NODE *node;
+
+	assert(graph->node_count < graph->node_limit);
+	if (! (graph->node_count < graph->node_limit)) {
+		return -1;
+	}
+
+	node = &graph->node[graph->node_count];
+	memset(node, 0, sizeof(TASK_NODE));
+	node->graph = graph;
+	node->routine = routine;
+	node->argument = argument;
+
+	return graph->node_count++;
+}
+
+/*!
+	@brief Specify that the successor cannot start until the predecessor has finished
+*/
+CODEC_ERROR AddGraphDependency(TASK_GRAPH *graph, int predecessor, int successor)
+{
+	TASK_NODE *node;
+
+	assert(0 <= predecessor && predecessor < graph->node_count &&
+		   0 <= successor && successor < graph->node_count && predecessor != successor);
+	if (! (0 <= predecessor && predecessor < graph->node_count &&
+		   0 <= successor && successor < graph->node_count && predecessor != successor)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	node = &graph->node[predecessor];
+
+	assert(node->successor_count < MAX_TASK_SUCCESSORS);
+	if (! (node->successor_count < MAX_TASK_SUCCESSORS)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	node->successor[node->successor_count++] = successor;
+	graph->node[successor].dependency_count++;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Run all tasks in the graph using the thread pool and wait for the tasks to finish
+
+	The calling thread also runs tasks while waiting for the tasks to finish.
+	Returns the first error reported by any task.  An error is also returned if
+	some tasks could not be run because the dependencies contain a cycle.
+*/
+CODEC_ERROR RunTaskGraph(TASK_GRAPH *graph, THREAD_POOL *pool)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	int index;
+
+	graph->pool = pool;
+	graph->finished_count = 0;
+	graph->error = CODEC_ERROR_OKAY;
+
+	// Tasks cannot finish and release other tasks until all initial tasks are submitted
+#if _THREADED
+	pthread_mutex_lock(&graph->mutex);
+#endif
+
+	// Start the tasks that do not depend on any other tasks
+	for (index = 0; index < graph->node_count; index++)
+	{
+		if (graph->node[index].dependency_count == 0)
+		{
+			error = SubmitTask(pool, RunGraphTask, &graph->node[index]);
+			if (error != CODEC_ERROR_OKAY) {
+				break;
+			}
+		}
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&graph->mutex);
+#endif
+
+	WaitThreadPool(pool);
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	if (graph->error != CODEC_ERROR_OKAY) {
+		return graph->error;
+	}
+
+	// All tasks should have run unless the graph contains a cycle
+	assert(graph->finished_count == graph->node_count);
+	if (! (graph->finished_count == graph->node_count)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
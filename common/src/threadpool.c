@@ -0,0 +1,606 @@
+/*!	@file common/src/threadpool.c
+
+	Implementation of a pool of worker threads that execute tasks with work stealing.
+
+	Each queue is protected by its own lock, so a worker that takes tasks from its
+	own queue does not contend with the other workers except when a task is stolen.
+	The counts of queued and pending tasks are protected by the lock for the pool
+	and are used for deciding when a thread can sleep and when all tasks are finished.
+	The count of pending tasks in each wait group is also protected by the lock for
+	the pool, so a thread that waits for a group sleeps on the same condition as a
+	thread that waits for all tasks in the pool.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+//! Initial number of entries in each task queue
+#define TASK_QUEUE_SIZE 64
+
+/*!
+	@brief Range of rows processed by one task in a parallel loop over rows
+*/
+typedef struct _row_range
+{
+	ROW_ROUTINE routine;		//!< Routine that processes the rows
+	void *argument;				//!< Argument passed to the routine
+	int first_row;				//!< First row in the range
+	int last_row;				//!< Row after the last row in the range
+	CODEC_ERROR error;			//!< Error code returned by the routine
+
+} ROW_RANGE;
+
+
+/*!
+	@brief Add a task to the end of a queue
+
+	The circular buffer is doubled in size if the queue is full.
+	The caller must hold the lock for the queue.
+*/
+static CODEC_ERROR PushTask(ALLOCATOR *allocator, TASK_QUEUE *queue, const POOL_TASK *task)
+{
+	if (queue->count == queue->size)
+	{
+		int size = 2 * queue->size;
+		POOL_TASK *buffer = (POOL_TASK *)Alloc(allocator, size * sizeof(POOL_TASK));
+		int index;
+
+		if (buffer == NULL) {
+			return CODEC_ERROR_OUTOFMEMORY;
+		}
+
+		// Copy the tasks to the new buffer starting with the oldest task
+		for (index = 0; index < queue->count; index++) {
+			buffer[index] = queue->task[(queue->head + index) % queue->size];
+		}
+
+		Free(allocator, queue->task);
+		queue->task = buffer;
+		queue->size = size;
+		queue->head = 0;
+	}
+
+	queue->task[(queue->head + queue->count) % queue->size] = *task;
+	queue->count++;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Take the most recently submitted task from a queue
+*/
+static bool PopTask(TASK_QUEUE *queue, POOL_TASK *task)
+{
+	bool found = false;
+
+#if _THREADED
+	pthread_mutex_lock(&queue->mutex);
+#endif
+
+	if (queue->count > 0)
+	{
+		queue->count--;
+		*task = queue->task[(queue->head + queue->count) % queue->size];
+		found = true;
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&queue->mutex);
+#endif
+
+	return found;
+}
+
+/*!
+	@brief Take the oldest task from a queue
+*/
+static bool StealTask(TASK_QUEUE *queue, POOL_TASK *task)
+{
+	bool found = false;
+
+#if _THREADED
+	pthread_mutex_lock(&queue->mutex);
+#endif
+
+	if (queue->count > 0)
+	{
+		*task = queue->task[queue->head];
+		queue->head = (queue->head + 1) % queue->size;
+		queue->count--;
+		found = true;
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&queue->mutex);
+#endif
+
+	return found;
+}
+
+/*!
+	@brief Return the index of the queue owned by the calling thread
+
+	Threads that are not in the pool use the last queue.
+*/
+static int CurrentQueueIndex(THREAD_POOL *pool)
+{
+#if _THREADED
+	intptr_t index = (intptr_t)pthread_getspecific(pool->queue_key);
+	if (index > 0) {
+		return (int)(index - 1);
+	}
+#endif
+
+	return pool->queue_count - 1;
+}
+
+/*!
+	@brief Find a task for the thread that owns the specified queue
+
+	The thread takes the newest task from its own queue or steals the
+	oldest task from the queue of another thread.
+*/
+static bool FindTask(THREAD_POOL *pool, int queue_index, POOL_TASK *task)
+{
+	bool found = PopTask(&pool->queue[queue_index], task);
+	int offset;
+
+	for (offset = 1; !found && offset < pool->queue_count; offset++) {
+		found = StealTask(&pool->queue[(queue_index + offset) % pool->queue_count], task);
+	}
+
+	if (found)
+	{
+#if _THREADED
+		pthread_mutex_lock(&pool->mutex);
+#endif
+		pool->queued_count--;
+#if _THREADED
+		pthread_mutex_unlock(&pool->mutex);
+#endif
+	}
+
+	return found;
+}
+
+/*!
+	@brief Execute a task and record that the task is finished
+*/
+static void RunTask(THREAD_POOL *pool, const POOL_TASK *task)
+{
+	task->routine(task->argument);
+
+#if _THREADED
+	pthread_mutex_lock(&pool->mutex);
+#endif
+
+	pool->pending_count--;
+
+	if (task->group != NULL) {
+		task->group->pending_count--;
+	}
+
+#if _THREADED
+	pthread_cond_broadcast(&pool->task_finished);
+	pthread_mutex_unlock(&pool->mutex);
+#endif
+}
+
+#if _THREADED
+/*!
+	@brief Execute tasks until the pool is released
+*/
+static void *PoolWorker(void *arg)
+{
+	TASK_QUEUE *queue = (TASK_QUEUE *)arg;
+	THREAD_POOL *pool = queue->pool;
+
+	// Remember the queue owned by this thread for submitting tasks
+	pthread_setspecific(pool->queue_key, (void *)(intptr_t)(queue->index + 1));
+
+	for (;;)
+	{
+		POOL_TASK task;
+		bool stop;
+
+		if (FindTask(pool, queue->index, &task)) {
+			RunTask(pool, &task);
+			continue;
+		}
+
+		pthread_mutex_lock(&pool->mutex);
+		while (!pool->stop && pool->queued_count == 0) {
+			pthread_cond_wait(&pool->work_available, &pool->mutex);
+		}
+		stop = pool->stop;
+		pthread_mutex_unlock(&pool->mutex);
+
+		if (stop) {
+			break;
+		}
+	}
+
+	return NULL;
+}
+#endif
+
+/*!
+	@brief Initialize a thread pool and start the worker threads
+
+	The thread count includes the thread that waits for the tasks to finish,
+	so one less than the thread count worker threads are started.  The pool
+	uses fewer threads if some of the worker threads cannot be started.
+*/
+CODEC_ERROR InitThreadPool(THREAD_POOL *pool, ALLOCATOR *allocator, int thread_count)
+{
+	int index;
+
+	assert(pool != NULL);
+	if (! (pool != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	memset(pool, 0, sizeof(THREAD_POOL));
+
+	if (!_THREADED || thread_count < 1) {
+		thread_count = 1;
+	}
+	if (thread_count > MAX_POOL_THREADS) {
+		thread_count = MAX_POOL_THREADS;
+	}
+
+	pool->allocator = allocator;
+	pool->thread_count = thread_count;
+	pool->queue_count = thread_count;
+
+#if _THREADED
+	pthread_key_create(&pool->queue_key, NULL);
+	pthread_mutex_init(&pool->mutex, NULL);
+	pthread_cond_init(&pool->work_available, NULL);
+	pthread_cond_init(&pool->task_finished, NULL);
+#endif
+
+	pool->queue = (TASK_QUEUE *)Alloc(allocator, pool->queue_count * sizeof(TASK_QUEUE));
+	if (pool->queue == NULL) {
+#if _THREADED
+		pthread_cond_destroy(&pool->task_finished);
+		pthread_cond_destroy(&pool->work_available);
+		pthread_mutex_destroy(&pool->mutex);
+		pthread_key_delete(pool->queue_key);
+#endif
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+	memset(pool->queue, 0, pool->queue_count * sizeof(TASK_QUEUE));
+
+	for (index = 0; index < pool->queue_count; index++)
+	{
+		TASK_QUEUE *queue = &pool->queue[index];
+
+		queue->pool = pool;
+		queue->index = index;
+		queue->size = TASK_QUEUE_SIZE;
+		queue->task = (POOL_TASK *)Alloc(allocator, queue->size * sizeof(POOL_TASK));
+		if (queue->task == NULL) {
+			ReleaseThreadPool(pool);
+			return CODEC_ERROR_OUTOFMEMORY;
+		}
+
+#if _THREADED
+		pthread_mutex_init(&queue->mutex, NULL);
+#endif
+	}
+
+#if _THREADED
+	if (thread_count > 1)
+	{
+		pool->thread = (pthread_t *)Alloc(allocator, (thread_count - 1) * sizeof(pthread_t));
+		if (pool->thread == NULL) {
+			ReleaseThreadPool(pool);
+			return CODEC_ERROR_OUTOFMEMORY;
+		}
+
+		// The last queue is used by the threads that are not in the pool
+		for (index = 0; index < thread_count - 1; index++)
+		{
+			if (pthread_create(&pool->thread[index], NULL, PoolWorker, &pool->queue[index]) != 0) {
+				break;
+			}
+			pool->started_count++;
+		}
+	}
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Stop the worker threads and free the queues in the thread pool
+
+	All tasks must be finished before the pool is released.
+*/
+CODEC_ERROR ReleaseThreadPool(THREAD_POOL *pool)
+{
+	int index;
+
+	if (pool == NULL || pool->queue == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	assert(pool->pending_count == 0);
+
+#if _THREADED
+	pthread_mutex_lock(&pool->mutex);
+	pool->stop = true;
+	pthread_cond_broadcast(&pool->work_available);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (index = 0; index < pool->started_count; index++) {
+		pthread_join(pool->thread[index], NULL);
+	}
+
+	Free(pool->allocator, pool->thread);
+	pool->thread = NULL;
+	pool->started_count = 0;
+
+	pthread_cond_destroy(&pool->task_finished);
+	pthread_cond_destroy(&pool->work_available);
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_key_delete(pool->queue_key);
+#endif
+
+	for (index = 0; index < pool->queue_count; index++)
+	{
+		if (pool->queue[index].task != NULL)
+		{
+			Free(pool->allocator, pool->queue[index].task);
+#if _THREADED
+			pthread_mutex_destroy(&pool->queue[index].mutex);
+#endif
+		}
+	}
+
+	Free(pool->allocator, pool->queue);
+	pool->queue = NULL;
+	pool->queue_count = 0;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Submit a task for execution by the thread pool
+
+	A task submitted by a worker thread is added to the queue owned by that
+	thread.  The task may start before this routine returns.
+*/
+CODEC_ERROR SubmitTask(THREAD_POOL *pool, TASK_ROUTINE routine, void *argument)
+{
+	return SubmitGroupTask(pool, NULL, routine, argument);
+}
+
+/*!
+	@brief Execute tasks on the calling thread until all submitted tasks are finished
+*/
+CODEC_ERROR WaitThreadPool(THREAD_POOL *pool)
+{
+	int queue_index;
+
+	assert(pool != NULL && pool->queue != NULL);
+	if (! (pool != NULL && pool->queue != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	queue_index = CurrentQueueIndex(pool);
+
+	for (;;)
+	{
+		POOL_TASK task;
+		bool finished;
+
+		if (FindTask(pool, queue_index, &task)) {
+			RunTask(pool, &task);
+			continue;
+		}
+
+#if _THREADED
+		pthread_mutex_lock(&pool->mutex);
+		if (pool->pending_count > 0 && pool->queued_count == 0) {
+			pthread_cond_wait(&pool->task_finished, &pool->mutex);
+		}
+#endif
+		finished = (pool->pending_count == 0);
+#if _THREADED
+		pthread_mutex_unlock(&pool->mutex);
+#endif
+
+		if (finished) {
+			break;
+		}
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Initialize a wait group that does not contain any tasks
+*/
+void InitWaitGroup(WAIT_GROUP *group)
+{
+	group->pending_count = 0;
+}
+
+/*!
+	@brief Submit a task that is a member of the wait group
+
+	The wait group may be null if the task is not a member of any group.
+*/
+CODEC_ERROR SubmitGroupTask(THREAD_POOL *pool, WAIT_GROUP *group, TASK_ROUTINE routine, void *argument)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	TASK_QUEUE *queue;
+	POOL_TASK task;
+
+	assert(pool != NULL && pool->queue != NULL && routine != NULL);
+	if (! (pool != NULL && pool->queue != NULL && routine != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	task.routine = routine;
+	task.argument = argument;
+	task.group = group;
+
+	queue = &pool->queue[CurrentQueueIndex(pool)];
+
+#if _THREADED
+	pthread_mutex_lock(&pool->mutex);
+	pthread_mutex_lock(&queue->mutex);
+#endif
+
+	error = PushTask(pool->allocator, queue, &task);
+
+#if _THREADED
+	pthread_mutex_unlock(&queue->mutex);
+#endif
+
+	if (error == CODEC_ERROR_OKAY)
+	{
+		pool->queued_count++;
+		pool->pending_count++;
+		if (group != NULL) {
+			group->pending_count++;
+		}
+#if _THREADED
+		pthread_cond_signal(&pool->work_available);
+#endif
+	}
+
+#if _THREADED
+	pthread_mutex_unlock(&pool->mutex);
+#endif
+
+	return error;
+}
+
+/*!
+	@brief Execute tasks on the calling thread until all tasks in the wait group are finished
+
+	The calling thread may execute tasks that are not in the wait group, so this
+	routine can be called by a task that is running in the pool without blocking
+	the worker thread while the tasks in the group are waiting in a queue.
+*/
+CODEC_ERROR WaitForGroup(THREAD_POOL *pool, WAIT_GROUP *group)
+{
+	int queue_index;
+
+	assert(pool != NULL && pool->queue != NULL && group != NULL);
+	if (! (pool != NULL && pool->queue != NULL && group != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	queue_index = CurrentQueueIndex(pool);
+
+	for (;;)
+	{
+		POOL_TASK task;
+		bool finished;
+
+#if _THREADED
+		pthread_mutex_lock(&pool->mutex);
+#endif
+		finished = (group->pending_count == 0);
+#if _THREADED
+		pthread_mutex_unlock(&pool->mutex);
+#endif
+
+		if (finished) {
+			break;
+		}
+
+		if (FindTask(pool, queue_index, &task)) {
+			RunTask(pool, &task);
+			continue;
+		}
+
+#if _THREADED
+		// Sleep until a task in the group finishes on another thread
+		pthread_mutex_lock(&pool->mutex);
+		if (group->pending_count > 0 && pool->queued_count == 0) {
+			pthread_cond_wait(&pool->task_finished, &pool->mutex);
+		}
+		pthread_mutex_unlock(&pool->mutex);
+#endif
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Process a range of rows in a parallel loop
+*/
+static void RunRowRange(void *argument)
+{
+	ROW_RANGE *range = (ROW_RANGE *)argument;
+	range->error = range->routine(range->argument, range->first_row, range->last_row);
+}
+
+/*!
+	@brief Divide the rows into ranges that are processed in parallel by the thread pool
+
+	The rows are divided into at most one range per thread in the pool and each
+	range contains at least the minimum number of rows, so the overhead of starting
+	a task is small compared to the work performed on the rows in each range.
+	The calling thread processes all of the rows if the pool is null.
+
+	Returns the first error reported by the routine for any range of rows.
+*/
+CODEC_ERROR ParallelForRows(THREAD_POOL *pool, int row_count, int min_rows, ROW_ROUTINE routine, void *argument)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	WAIT_GROUP group;
+	ROW_RANGE *range_table;
+	int range_count = 1;
+	int index;
+
+	if (pool != NULL && min_rows > 0) {
+		range_count = min(pool->thread_count, row_count / min_rows);
+	}
+
+	if (range_count < 2) {
+		return routine(argument, 0, row_count);
+	}
+
+	range_table = (ROW_RANGE *)Alloc(pool->allocator, range_count * sizeof(ROW_RANGE));
+	if (range_table == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	InitWaitGroup(&group);
+
+	for (index = 0; index < range_count; index++)
+	{
+		ROW_RANGE *range = &range_table[index];
+
+		range->routine = routine;
+		range->argument = argument;
+		range->first_row = (index * row_count) / range_count;
+		range->last_row = ((index + 1) * row_count) / range_count;
+		range->error = CODEC_ERROR_OKAY;
+
+		if (SubmitGroupTask(pool, &group, RunRowRange, range) != CODEC_ERROR_OKAY) {
+			// Process the rows on the calling thread if the task cannot be submitted
+			RunRowRange(range);
+		}
+	}
+
+	WaitForGroup(pool, &group);
+
+	// Return the first error reported by any range of rows
+	for (index = 0; error == CODEC_ERROR_OKAY && index < range_count; index++) {
+		error = range_table[index].error;
+	}
+
+	Free(pool->allocator, range_table);
+
+	return error;
+}
@@ -3,9 +3,12 @@
 	Implementation of a high-resolution performance timer
 
 	This module implements an interface to the high-resolution timer on
-	Windows.  The same interface can be used for timers on other platforms.
-	
-	@todo Implement a high-resolution timer on Linux and Macintosh.
+	Windows and to the monotonic clock on other platforms.
+
+	The elapsed time is accumulated by subtracting the current time when the
+	timer is started and adding the current time when the timer is stopped.
+	The updates are atomic, so a timer that is started and stopped by several
+	threads at the same time records the sum of the intervals on all threads.
 
 	(c) 2013 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
 	All rights reserved--use subject to compliance with end user license agreement.
@@ -27,6 +30,14 @@
 // Standard C Library
 #include <assert.h>
 
+#else
+
+// Standard C Library
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+#include <time.h>
+
 #endif
 
 #ifndef ASSERT
@@ -37,9 +48,40 @@
 
 #if _TIMING
 
+#if _WIN32
+
 //! Frequency of the performance timer (clock ticks per second)
 static __int64 frequency = 0;
 
+//! Add a value to a timer field that may be updated by more than one thread
+#define ATOMIC_ADD(field, value)	InterlockedExchangeAdd64(&(field), (value))
+
+//! Current value of the performance counter
+static __int64 CurrentTime(void)
+{
+	LARGE_INTEGER current_time;
+	QueryPerformanceCounter(&current_time);
+	return current_time.QuadPart;
+}
+
+#else
+
+//! Frequency of the monotonic clock (nanoseconds per second)
+static const int64_t frequency = 1000000000;
+
+//! Add a value to a timer field that may be updated by more than one thread
+#define ATOMIC_ADD(field, value)	__sync_fetch_and_add(&(field), (value))
+
+//! Current value of the monotonic clock in nanoseconds
+static int64_t CurrentTime(void)
+{
+	struct timespec current_time;
+	clock_gettime(CLOCK_MONOTONIC, &current_time);
+	return (int64_t)current_time.tv_sec * frequency + current_time.tv_nsec;
+}
+
+#endif
+
 /*!
 	@brief Initialize a timer
 	
@@ -48,6 +90,7 @@ static __int64 frequency = 0;
 */
 void InitTimer(TIMER *timer)
 {
+#if _WIN32
 	// Has the timer frequency been set?
 	if (frequency == 0)
 	{
@@ -57,24 +100,47 @@ void InitTimer(TIMER *timer)
 			ASSERT(0);
 		}
 	}
+#endif
 	ASSERT(frequency > 0);
 
 	// Initialize the timer value to zero
 	timer->time = 0;
+	timer->count = 0;
 }
 
+/*!
+	@brief Start measuring an interval of time
+
+	A null timer is ignored so that timers for optional measurements
+	can be obtained with @ref STAGE_TIMER.
+*/
 void StartTimer(TIMER *timer)
 {
-	LARGE_INTEGER current_time;
-	QueryPerformanceCounter(&current_time);
-	timer->time -= current_time.QuadPart;
+	if (timer != NULL) {
+		ATOMIC_ADD(timer->time, -CurrentTime());
+	}
 }
 
+/*!
+	@brief Add the interval since the timer was started to the elapsed time
+*/
 void StopTimer(TIMER *timer)
 {
-	LARGE_INTEGER current_time;
-	QueryPerformanceCounter(&current_time);
-	timer->time += current_time.QuadPart;
+	if (timer != NULL) {
+		ATOMIC_ADD(timer->time, CurrentTime());
+		ATOMIC_ADD(timer->count, 1);
+	}
+}
+
+/*!
+	@brief Add the elapsed time and count of a stopped timer to another timer
+*/
+void AddTimer(TIMER *total, const TIMER *timer)
+{
+	if (total != NULL && timer != NULL) {
+		ATOMIC_ADD(total->time, timer->time);
+		ATOMIC_ADD(total->count, timer->count);
+	}
 }
 
 float TimeSecs(TIMER *timer)
@@ -87,7 +153,7 @@ float TimeMS(TIMER *timer)
 	return (1000 * TimeSecs(timer));
 }
 
-float Percentage(TIMER *timer1, TIMER *timer2)
+float TimerPercentage(TIMER *timer1, TIMER *timer2)
 {
 	if (timer2->time > 0)
 	{
@@ -76,6 +76,9 @@ CODEC_ERROR ReadImage(IMAGE *image, const char *pathname)
 	format must be determined by other means.  The image buffer must
 	be allocated before this routine is called and the image dimensions
 	and format must be set before the image is sent to the encoder.
+
+	The image buffer is replaced by the file mapped into memory if the
+	file can be mapped, otherwise the file is read into the buffer.
 */
 CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname)
 {
@@ -85,6 +88,11 @@ CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname)
 	size_t size;
 	size_t result;
 
+	// Read the image directly from the file if the file can be mapped into memory
+	if (MapImageFile(image, pathname) == CODEC_ERROR_OKAY) {
+		return CODEC_ERROR_OKAY;
+	}
+
 	// Open the file that contains the image
 	file = fopen(pathname, "rb");
 	if (file == NULL) {
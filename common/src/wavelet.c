@@ -44,6 +44,10 @@ CODEC_ERROR InitWavelet(WAVELET *wavelet, DIMENSION width, DIMENSION height)
 
 /*!
 	@brief Allocate a wavelet data structure with the specified dimensions
+
+	The pitch is rounded up to a multiple of the allocator alignment and each
+	band is followed by tail padding, so the vectorized filters can process
+	whole vectors at the end of each row.
 */
 CODEC_ERROR AllocWavelet(ALLOCATOR *allocator, WAVELET *wavelet, DIMENSION width, DIMENSION height)
 {
@@ -54,15 +58,14 @@ CODEC_ERROR AllocWavelet(ALLOCATOR *allocator, WAVELET *wavelet, DIMENSION width
 	{
 		int band;
 
-		//TODO: Align the pitch?
-		DIMENSION pitch = width * sizeof(PIXEL);
+		DIMENSION pitch = (DIMENSION)ALIGNED_PITCH(width * sizeof(PIXEL));
 
-		size_t band_data_size = height * pitch;
+		size_t band_data_size = height * pitch + ALLOCATOR_TAIL_PADDING;
 
 		// Allocate the wavelet bands
 		for (band = 0; band < MAX_BAND_COUNT; band++)
 		{
-			wavelet->data[band] = (PIXEL *)Alloc(allocator, band_data_size);
+			wavelet->data[band] = (PIXEL *)AllocTagged(allocator, band_data_size, ALLOCATOR_TAG_WAVELET);
 			if (wavelet->data[band] == NULL) {
 				ReleaseWavelet(allocator, wavelet);
 				return CODEC_ERROR_OUTOFMEMORY;
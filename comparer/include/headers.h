@@ -43,6 +43,8 @@
 #include "macros.h"
 #include "error.h"
 #include "allocator.h"
+#include "filemap.h"
+#include "threadpool.h"
 #include "pixel.h"
 #include "color.h"
 #include "unpack.h"
@@ -34,6 +34,9 @@ typedef struct _parameters
 		PIXEL_FORMAT format;
 	} image;
 
+	//! Number of threads used for reading the images
+	int thread_count;
+
 } PARAMETERS;
 
 #ifdef __cplusplus
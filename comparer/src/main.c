@@ -29,6 +29,21 @@
 // Forward reference
 CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname);
 CODEC_ERROR DPX_ReadImage(IMAGE *image, const char *pathname);
+CODEC_ERROR DPX_ParseImage(IMAGE *image);
+
+/*!
+	@brief Input image that is read by a task in the thread pool
+*/
+typedef struct _read_image_task
+{
+	const char *pathname;		//!< Pathname of the file that contains the image
+	IMAGE *image;				//!< Image that receives the contents of the file
+	DIMENSION width;			//!< Width of a raw image
+	DIMENSION height;			//!< Height of a raw image
+	PIXEL_FORMAT format;		//!< Pixel format of a raw image
+	CODEC_ERROR error;			//!< Error code from reading the image
+
+} READ_IMAGE_TASK;
 
 
 /*!
@@ -71,6 +86,11 @@ CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname)
 	int fd;
 	size_t result;
 
+	// Read the image directly from the file if the file can be mapped into memory
+	if (MapImageFile(image, pathname) == CODEC_ERROR_OKAY) {
+		return CODEC_ERROR_OKAY;
+	}
+
 	// Open the file that contains the image
 	file = fopen(pathname, "rb");
 	if (file == NULL) {
@@ -105,12 +125,25 @@ CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname)
 */
 CODEC_ERROR DPX_ReadImage(IMAGE *image, const char *pathname)
 {
-	DPX_FileInfo info;
-	DIMENSION pitch;
-
 	// Read the entire file including the DPX file header
 	DPX_ReadFile(image, pathname);
 
+	// Set the image dimensions and format from the DPX file header
+	return DPX_ParseImage(image);
+}
+
+/*!
+	@brief Set the image dimensions and format from the header in a DPX file
+
+	The image must contain the entire DPX file read by @ref DPX_ReadFile.
+	The DPX header parser sets the byte swapping flag that is shared by all of
+	the DPX routines, so headers must not be parsed by more than one thread.
+*/
+CODEC_ERROR DPX_ParseImage(IMAGE *image)
+{
+	DPX_FileInfo info;
+	DIMENSION pitch;
+
 	// Parse the header in the DPX file
 	DPX_ParseHeader(image, &info);
 
@@ -195,6 +228,61 @@ CODEC_ERROR ReadInputImage(const char *pathname,
 	return error;
 }
 
+/*!
+	@brief Read the input image assigned to a task
+*/
+static void ReadImageTask(void *argument)
+{
+	READ_IMAGE_TASK *task = (READ_IMAGE_TASK *)argument;
+
+	if (GetFileType(task->pathname) == FILE_TYPE_DPX)
+	{
+		// The DPX file header is parsed after all of the files have been read
+		task->error = DPX_ReadFile(task->image, task->pathname);
+	}
+	else
+	{
+		task->error = ReadInputImage(task->pathname, task->image, task->width, task->height, task->format);
+	}
+}
+
+/*!
+	@brief Read both input images using the thread pool
+
+	The images are independent, so the second file is read while the first
+	file is being read if the pool has more than one thread.  The DPX file
+	headers are parsed one at a time on the calling thread after the files
+	have been read since the DPX header parser is not thread safe.
+*/
+CODEC_ERROR ReadInputImages(THREAD_POOL *pool,
+							READ_IMAGE_TASK *task_table,
+							int task_count)
+{
+	CODEC_ERROR error;
+	int index;
+
+	for (index = 0; index < task_count; index++)
+	{
+		if (SubmitTask(pool, ReadImageTask, &task_table[index]) != CODEC_ERROR_OKAY) {
+			// Read the image on the calling thread if the task cannot be submitted
+			ReadImageTask(&task_table[index]);
+		}
+	}
+
+	error = WaitThreadPool(pool);
+
+	for (index = 0; index < task_count; index++)
+	{
+		READ_IMAGE_TASK *task = &task_table[index];
+
+		if (task->error == CODEC_ERROR_OKAY && GetFileType(task->pathname) == FILE_TYPE_DPX) {
+			task->error = DPX_ParseImage(task->image);
+		}
+	}
+
+	return error;
+}
+
 /*!
 	@brief Main entry point for the program that computes PSNR
 
@@ -217,12 +305,15 @@ int main(int argc, char *argv[])
 
 #if 1
 	PARAMETERS parameters;
+	THREAD_POOL pool;
+	READ_IMAGE_TASK read_task[2];
 
 	DIMENSION image_width = 1920;
 	DIMENSION image_height = 1080;
 	PIXEL_FORMAT image_format = PIXEL_FORMAT_UNKNOWN;
 
 	int stats = 0;
+	int index;
 
 	InitParameters(&parameters);
 
@@ -295,13 +386,35 @@ int main(int argc, char *argv[])
 	//TODO: Modify the code to allow different pixel formats for each image
 
 	// Allocate and read the input images
-	error = ReadInputImage(argv[1], &image1, image_width, image_height, image_format);
+	read_task[0].pathname = argv[1];
+	read_task[0].image = &image1;
+	read_task[1].pathname = argv[2];
+	read_task[1].image = &image2;
+
+	for (index = 0; index < 2; index++)
+	{
+		read_task[index].width = image_width;
+		read_task[index].height = image_height;
+		read_task[index].format = image_format;
+		read_task[index].error = CODEC_ERROR_OKAY;
+	}
+
+	error = InitThreadPool(&pool, NULL, parameters.thread_count);
+	if (error != CODEC_ERROR_OKAY) {
+		fprintf(stderr, "Could not create the thread pool\n");
+		return error;
+	}
+
+	ReadInputImages(&pool, read_task, 2);
+	ReleaseThreadPool(&pool);
+
+	error = read_task[0].error;
 	if (error != CODEC_ERROR_OKAY) {
 		fprintf(stderr, "Could not read input image one: %s\n", argv[1]);
 		return error;
 	}
 
-	ReadInputImage(argv[2], &image2, image_width, image_height, image_format);
+	error = read_task[1].error;
 	if (error != CODEC_ERROR_OKAY) {
 		fprintf(stderr, "Could not read input image two: %s\n", argv[2]);
 		return error;
@@ -33,5 +33,9 @@
 CODEC_ERROR InitParameters(PARAMETERS *parameters)
 {
 	memset(parameters, 0, sizeof(PARAMETERS));
+
+	// Read the images on the calling thread by default
+	parameters->thread_count = 1;
+
 	return CODEC_ERROR_OKAY;
 }
@@ -33,6 +33,9 @@ static const char help_message[] =
 	"\t-f PixelFormat\n"
 	"\t\tformat of packed image output by the image repacking process.\n"
 	"\n"
+	"\t-t ThreadCount\n"
+	"\t\tnumber of threads used for reading the images.\n"
+	"\n"
 };
 
 
@@ -75,6 +78,21 @@ bool GetPixelFormat(const char *string, PIXEL_FORMAT *format_out)
 	return false;
 }
 
+/*!
+	@brief Convert a command-line argument to the number of threads
+
+	The number of threads must be at least one.
+*/
+bool GetThreadCount(const char *string, int *thread_count_out)
+{
+	int value;
+	if (string != NULL && thread_count_out != NULL && sscanf(string, "%d", &value) == 1 && value > 0) {
+		*thread_count_out = value;
+		return true;
+	}
+	return false;
+}
+
 /*!
 	@brief Parse the program command-line arguments to get the encoding parameters
 
@@ -101,6 +119,7 @@ CODEC_ERROR ParseParameters(int *argc_ref, char *argv[], PARAMETERS *parameters)
 		{"width", 1, 0, 0},
 		{"height", 1, 0, 0},
 		{"pixel", 1, 0, 0},
+		{"threads", 1, 0, 0},
 		{"verbose", 0, 0, 0},
 		{"help", 0, 0, 0},
 		{NULL, 0, NULL, 0}
@@ -109,7 +128,7 @@ CODEC_ERROR ParseParameters(int *argc_ref, char *argv[], PARAMETERS *parameters)
 
 	// Map long options to short options
 	static char short_options[] = {
-		'w', 'h', 'p', 'v', '?', 0,
+		'w', 'h', 'p', 't', 'v', '?', 0,
 	};
 	const int short_options_length = sizeof(short_options)/sizeof(short_options[0]);
 
@@ -119,7 +138,7 @@ CODEC_ERROR ParseParameters(int *argc_ref, char *argv[], PARAMETERS *parameters)
 
 	// Process the command-line options
 	//while ((c = getopt_long(argc, argv, "w:h:p:v", long_options, &option_index)) != -1)
-	while ((c = getopt_long(argc, argv, "w:h:p:v", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, argv, "w:h:p:t:v", long_options, &option_index)) != -1)
 	{
 		//int this_option_optind = optind ? optind : 1;
 
@@ -154,6 +173,13 @@ CODEC_ERROR ParseParameters(int *argc_ref, char *argv[], PARAMETERS *parameters)
 			}
 			break;
 
+		case 't':
+			if (!GetThreadCount(optarg, &parameters->thread_count)) {
+				printf("Bad thread count\n");
+				help_flag = true;
+			}
+			break;
+
 		case 'v':
 			verbose_flag = true;
 			break;
@@ -171,7 +197,7 @@ CODEC_ERROR ParseParameters(int *argc_ref, char *argv[], PARAMETERS *parameters)
 
 	if (help_flag)
 	{
-		printf("Usage: convert [-w width] [-h height] [-p input_pixel_format] [-o output_pixel_format] infile outfile\n");
+		printf("Usage: convert [-w width] [-h height] [-p input_pixel_format] [-o output_pixel_format] [-t threads] infile outfile\n");
 		return 0;
 	}
 
@@ -14,6 +14,23 @@
 #include "fileinfo.h"
 #include "getopt.h"
 
+//! Minimum number of rows converted by each task in the thread pool
+#define MIN_CONVERT_ROWS	32
+
+//! Routine that converts a range of rows in the input image
+typedef CODEC_ERROR (* CONVERT_ROUTINE)(IMAGE *input, IMAGE *output, int first_row, int last_row);
+
+/*!
+	@brief Input and output images and the routine that converts the rows
+*/
+typedef struct _conversion
+{
+	CONVERT_ROUTINE routine;	//!< Routine that converts a range of rows
+	IMAGE *input;				//!< Image in the input pixel format
+	IMAGE *output;				//!< Image in the output pixel format
+
+} CONVERSION;
+
 #ifndef __GNUC__
 #define stat _stat
 #define fstat _fstat
@@ -36,25 +53,30 @@ CODEC_ERROR RAW_ReadImage(IMAGE *image, const char *pathname, DIMENSION width, D
 	size_t result;
 	DIMENSION pitch;
 
-	// Open the file that contains the image
-	file = fopen(pathname, "rb");
-	if (file == NULL) {
-		return CODEC_ERROR_OPEN_FILE_FAILED;
-	}
+	// Read the image directly from the file if the file can be mapped into memory
+	InitImage(image);
+	if (MapImageFile(image, pathname) != CODEC_ERROR_OKAY)
+	{
+		// Open the file that contains the image
+		file = fopen(pathname, "rb");
+		if (file == NULL) {
+			return CODEC_ERROR_OPEN_FILE_FAILED;
+		}
 
-	// Get the size of the file
-	fd = fileno(file);
-	result = fstat(fd, &info);
-	if (result != 0) {
-		return CODEC_ERROR_FILE_SIZE_FAILED;
-	}
+		// Get the size of the file
+		fd = fileno(file);
+		result = fstat(fd, &info);
+		if (result != 0) {
+			return CODEC_ERROR_FILE_SIZE_FAILED;
+		}
 
-	// Allocate the image buffer
-	AllocImageSize(NULL, image, info.st_size);
+		// Allocate the image buffer
+		AllocImageSize(NULL, image, info.st_size);
 
-	result = fread(image->buffer, info.st_size, 1, file);
-	if (result != 1) {
-		return CODEC_ERROR_READ_FILE_FAILED;
+		result = fread(image->buffer, info.st_size, 1, file);
+		if (result != 1) {
+			return CODEC_ERROR_READ_FILE_FAILED;
+		}
 	}
 
 	//TODO: Attempt to determine the image dimensions from the image size
@@ -99,13 +121,13 @@ CODEC_ERROR DPX_ReadImage(IMAGE *image, const char *pathname)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertDPXToBYR3(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertDPXToBYR3(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Reduce the precision to the 10-bit precision of the BYR3 format
 	int descale_shift = 6;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint32_t *input_row_ptr = (uint32_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row1_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -133,7 +155,7 @@ CODEC_ERROR ConvertDPXToBYR3(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertDPXToBYR4(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertDPXToBYR4(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	DIMENSION output_width = output->width;
 	DIMENSION output_height = output->height;
@@ -146,7 +168,7 @@ CODEC_ERROR ConvertDPXToBYR4(IMAGE *input, IMAGE *output)
 	output_height /= 2;
 	output_pitch *= 2;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint32_t *input_row_ptr = (uint32_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row1_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output_pitch);
@@ -172,12 +194,12 @@ CODEC_ERROR ConvertDPXToBYR4(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertDPXToB64A(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertDPXToB64A(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	const uint16_t A = UINT16_MAX;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint32_t *input_row_ptr = (uint32_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -199,11 +221,11 @@ CODEC_ERROR ConvertDPXToB64A(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertB64AToDPX(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertB64AToDPX(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row_ptr = (uint16_t *)RowAddress(input, row);
 		uint32_t *output_row_ptr = (uint32_t *)RowAddress(output, row);
@@ -225,11 +247,11 @@ CODEC_ERROR ConvertB64AToDPX(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertB64AToRG48(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertB64AToRG48(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row_ptr = (uint16_t *)RowAddress(input, row);
 		uint16_t *output_row_ptr = (uint16_t *)RowAddress(output, row);
@@ -253,11 +275,11 @@ CODEC_ERROR ConvertB64AToRG48(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertRG48ToDPX(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertRG48ToDPX(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row_ptr = (uint16_t *)RowAddress(input, row);
 		uint32_t *output_row_ptr = (uint32_t *)RowAddress(output, row);
@@ -278,13 +300,13 @@ CODEC_ERROR ConvertRG48ToDPX(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertBYR3ToBYR4(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertBYR3ToBYR4(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Scale the 10-bit precision of BYR3 to the 16-bit precision of BYR4
 	int scale_shift = 6;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row1_ptr = (uint16_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row1_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -318,13 +340,13 @@ CODEC_ERROR ConvertBYR3ToBYR4(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertBYR3ToDPX(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertBYR3ToDPX(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Scale the 10-bit precision of BYR3 to the 16-bit precision of DPX
 	int scale_shift = 6;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row1_ptr = (uint16_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint32_t *output_row_ptr = (uint32_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -356,13 +378,13 @@ CODEC_ERROR ConvertBYR3ToDPX(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertBYR3ToRG48(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertBYR3ToRG48(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Scale the 10-bit precision of BYR3 to the 16-bit precision of RG48
 	int scale_shift = 6;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row1_ptr = (uint16_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -395,13 +417,13 @@ CODEC_ERROR ConvertBYR3ToRG48(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertBYR4ToBYR3(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertBYR4ToBYR3(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Reduce the precision to the 10-bit precision of the BYR3 format
 	int descale_shift = 6;
 	int row;
 
-	for (row = 0; row < input->height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row1_ptr = (uint16_t *)((uint8_t *)ImageData(input) + row * input->pitch);
 		uint16_t *output_row1_ptr = (uint16_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -435,23 +457,21 @@ CODEC_ERROR ConvertBYR4ToBYR3(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertBYR4ToDPX(IMAGE *input, IMAGE *output)
+CODEC_ERROR ConvertBYR4ToDPX(IMAGE *input, IMAGE *output, int first_row, int last_row)
 {
 	// Scale the 10-bit precision of BYR3 to the 16-bit precision of DPX
 	//int scale_shift = 6;
 
 	DIMENSION input_width = input->width;
-	DIMENSION input_height = input->height;
 	size_t input_pitch = input->pitch;
 
 	int row;
 
 	// Adjust the dimensions to the size of the grid of pattern elements
 	input_width /= 2;
-	input_height /= 2;
 	input_pitch *= 2;
 
-	for (row = 0; row < input_height; row++)
+	for (row = first_row; row < last_row; row++)
 	{
 		uint16_t *input_row1_ptr = (uint16_t *)((uint8_t *)ImageData(input) + row * input_pitch);
 		uint32_t *output_row_ptr = (uint32_t *)((uint8_t *)ImageData(output) + row * output->pitch);
@@ -480,8 +500,28 @@ CODEC_ERROR ConvertBYR4ToDPX(IMAGE *input, IMAGE *output)
 	return CODEC_ERROR_OKAY;
 }
 
-CODEC_ERROR ConvertImage(IMAGE *input, IMAGE *output)
+/*!
+	@brief Convert the rows in one range of rows in the input image
+*/
+static CODEC_ERROR ConvertRows(void *argument, int first_row, int last_row)
 {
+	CONVERSION *conversion = (CONVERSION *)argument;
+	return conversion->routine(conversion->input, conversion->output, first_row, last_row);
+}
+
+/*!
+	@brief Convert the input image to the pixel format of the output image
+
+	The rows are divided into ranges that are converted in parallel by the
+	thread pool.  The image is converted on the calling thread if the pool
+	is null.
+*/
+CODEC_ERROR ConvertImage(THREAD_POOL *pool, IMAGE *input, IMAGE *output)
+{
+	CONVERSION conversion;
+	CONVERT_ROUTINE routine = NULL;
+	int row_count = input->height;
+
 	//assert(input->format == PIXEL_FORMAT_DPX_50);
 
 	switch (input->format)
@@ -490,92 +530,110 @@ CODEC_ERROR ConvertImage(IMAGE *input, IMAGE *output)
 		switch (output->format)
 		{
 		case PIXEL_FORMAT_BYR3:
-			return ConvertDPXToBYR3(input, output);
+			routine = ConvertDPXToBYR3;
 			break;
 
 		case PIXEL_FORMAT_BYR4:
-			return ConvertDPXToBYR4(input, output);
+			routine = ConvertDPXToBYR4;
 			break;
 
 		case PIXEL_FORMAT_B64A:
-			return ConvertDPXToB64A(input, output);
+			routine = ConvertDPXToB64A;
 			break;
 
 		default:
 			assert(0);
 			break;
 		}
+		break;
 
 	case PIXEL_FORMAT_BYR3:
 		switch (output->format)
 		{
 		case PIXEL_FORMAT_BYR4:
-			return ConvertBYR3ToBYR4(input, output);
+			routine = ConvertBYR3ToBYR4;
 			break;
 
 		case PIXEL_FORMAT_DPX_50:
-			return ConvertBYR3ToDPX(input, output);
+			routine = ConvertBYR3ToDPX;
 			break;
 
 		case PIXEL_FORMAT_RG48:
-			return ConvertBYR3ToRG48(input, output);
+			routine = ConvertBYR3ToRG48;
 			break;
 
 		default:
 			assert(0);
 			break;
 		}
+		break;
 
 	case PIXEL_FORMAT_BYR4:
 		switch (output->format)
 		{
 		case PIXEL_FORMAT_BYR3:
-			return ConvertBYR4ToBYR3(input, output);
+			routine = ConvertBYR4ToBYR3;
 			break;
 
 		case PIXEL_FORMAT_DPX_50:
-			return ConvertBYR4ToDPX(input, output);
+			routine = ConvertBYR4ToDPX;
 			break;
 
 		default:
 			assert(0);
 			break;
 		}
+		break;
 
 	case PIXEL_FORMAT_B64A:
 		switch (output->format)
 		{
 		case PIXEL_FORMAT_DPX_50:
-			return ConvertB64AToDPX(input, output);
+			routine = ConvertB64AToDPX;
 			break;
 
 		case PIXEL_FORMAT_RG48:
-			return ConvertB64AToRG48(input, output);
+			routine = ConvertB64AToRG48;
 			break;
 
 		default:
 			assert(0);
 			break;
 		}
+		break;
 
 	case PIXEL_FORMAT_RG48:
 		switch (output->format)
 		{
 		case PIXEL_FORMAT_DPX_50:
-			return ConvertRG48ToDPX(input, output);
+			routine = ConvertRG48ToDPX;
 			break;
 
 		default:
 			assert(0);
 			break;
 		}
+		break;
 
 	default:
 		assert(0);
 		break;
 	}
 
-	return CODEC_ERROR_PIXEL_FORMAT;
+	if (routine == NULL) {
+		return CODEC_ERROR_PIXEL_FORMAT;
+	}
+
+	// Each row of BYR4 pattern elements is converted to one row of DPX pixels
+	if (routine == ConvertBYR4ToDPX) {
+		row_count /= 2;
+	}
+
+	conversion.routine = routine;
+	conversion.input = input;
+	conversion.output = output;
+
+	return ParallelForRows(pool, row_count, MIN_CONVERT_ROWS, ConvertRows, &conversion);
 }
 
 bool GetDimension(const char *string, DIMENSION *dimension_out)
@@ -588,6 +646,16 @@ bool GetDimension(const char *string, DIMENSION *dimension_out)
 	return false;
 }
 
+bool GetThreadCount(const char *string, int *thread_count_out)
+{
+	int value;
+	if (string != NULL && thread_count_out != NULL && sscanf(string, "%d", &value) == 1 && value > 0) {
+		*thread_count_out = value;
+		return true;
+	}
+	return false;
+}
+
 bool GetPixelFormat(const char *string, PIXEL_FORMAT *format_out)
 {
 	if (string != NULL && format_out != NULL)
@@ -615,6 +683,9 @@ int main(int argc, char *argv[])
 	IMAGE input;
 	IMAGE output;
 
+	THREAD_POOL pool;
+	int thread_count = 1;
+
 	// Set the default image dimensions
 	DIMENSION image_width = 1920;
 	DIMENSION image_height = 1080;
@@ -638,13 +709,14 @@ int main(int argc, char *argv[])
 		{"output", 1, 0, 0},
 		{"verbose", 0, 0, 0},
 		{"help", 0, 0, 0},
+		{"threads", 1, 0, 0},
 		{NULL, 0, NULL, 0}
 	};
     const int long_options_length = sizeof(long_options)/sizeof(long_options[0]);
 
 	// Map long options to short options
 	static char short_options[] = {
-		0, 'w', 'h', 'p', 'o', 'v', '?'
+		'w', 'h', 'p', 'o', 'v', '?', 't', 0
 	};
 	const int short_options_length = sizeof(short_options)/sizeof(short_options[0]);
 
@@ -656,7 +728,7 @@ int main(int argc, char *argv[])
 	InitImage(&output);
 
 	// Process the command-line options
-	while ((c = getopt_long(argc, argv, "w:h:p:v", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, argv, "w:h:p:t:v", long_options, &option_index)) != -1)
 	{
 		//int this_option_optind = optind ? optind : 1;
 
@@ -696,6 +768,13 @@ int main(int argc, char *argv[])
 			}
 			break;
 
+		case 't':
+			if (!GetThreadCount(optarg, &thread_count)) {
+				printf("Bad thread count\n");
+				help_flag = true;
+			}
+			break;
+
 		case 'v':
 			verbose_flag = true;
 			break;
@@ -713,7 +792,7 @@ int main(int argc, char *argv[])
 
 	if (help_flag)
 	{
-		printf("Usage: convert [-w width] [-h height] [-p input_pixel_format] [-o output_pixel_format] infile outfile\n");
+		printf("Usage: convert [-w width] [-h height] [-p input_pixel_format] [-o output_pixel_format] [-t threads] infile outfile\n");
 		return 0;
 	}
 
@@ -781,8 +860,20 @@ int main(int argc, char *argv[])
 	// Allocate the output image
 	AllocImageCopy(NULL, &output, &input, output_format);
 
-	// Convert the DPX image to the output image in BYR4 format
-	ConvertImage(&input, &output);
+	// Convert the rows in the input image in parallel
+	error = InitThreadPool(&pool, NULL, thread_count);
+	if (error != CODEC_ERROR_OKAY) {
+		printf("Could not create the thread pool\n");
+		return 1;
+	}
+
+	error = ConvertImage(&pool, &input, &output);
+	ReleaseThreadPool(&pool);
+
+	if (error != CODEC_ERROR_OKAY) {
+		printf("Could not convert the input image: %s\n", argv[input_file_index]);
+		return 1;
+	}
 
 	switch (info.type)
 	{
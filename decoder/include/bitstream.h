@@ -34,12 +34,16 @@ typedef enum _bitstream_error
 } BITSTREAM_ERROR;
 
 
-typedef uint32_t BITWORD;			//!< Data type of the internal bitstream buffer
+typedef uint32_t BITWORD;			//!< Data type of the bits read from the bitstream
+typedef uint64_t BITBUFFER;			//!< Data type of the internal bitstream buffer
 typedef uint_fast8_t BITCOUNT;		//!< Number of bits in the bitsteam buffer
 
 //! Maximum number of bits in a bit word
 static const BITCOUNT bit_word_count = 32;
 
+//! Maximum number of bits in the internal bitstream buffer
+static const BITCOUNT bit_buffer_count = 64;
+
 //! Maximum value of a bit word
 #define BIT_WORD_MAX 0xFFFFFFFF
 
@@ -52,14 +56,26 @@ static const BITCOUNT bit_word_count = 32;
 	The bitstream uses a byte stream to read bytes from a file or a buffer
 	in memory.  This isolates that bitstream module from the type of byte
 	stream.
+
+	The internal buffer is a reservoir of up to 64 bits aligned to the most
+	significant bit.  The unused bits in the buffer are always zero.
+
+	If the byte stream is a buffer in memory that contains the entire sample,
+	then the bitstream reads the sample directly and refills the internal buffer
+	with a single unaligned load.  Otherwise, the internal buffer is refilled one
+	word at a time from the byte stream.
 */
 typedef struct _bitstream
 {
 	BITSTREAM_ERROR error;		//!< Error while processing the bitstream
 	struct _stream *stream;		//!< Stream for reading bytes into the buffer
-	BITWORD buffer;				//!< Internal buffer holds remaining bits
+	BITBUFFER buffer;			//!< Internal buffer holds remaining bits
 	BITCOUNT count;				//!< Number of bits remaining in the buffer
 
+	const uint8_t *span;		//!< Sample in memory read directly by the bitstream (or NULL)
+	size_t span_size;			//!< Number of bytes in the sample in memory
+	size_t span_offset;			//!< Offset to the next byte in the sample to load into the buffer
+
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
 	/*!
 		The sample offset stack is used to record offsets to the start of nested
@@ -95,11 +111,14 @@ CODEC_ERROR InitBitstream(BITSTREAM *bitstream);
 // Bind the bitstream to a byte stream
 CODEC_ERROR AttachBitstream(struct _bitstream *bitstream, struct _stream *stream);
 
+// Bind the bitstream to a sample in memory
+CODEC_ERROR AttachBitstreamBuffer(BITSTREAM *bitstream, const void *buffer, size_t size);
+
 CODEC_ERROR ReleaseBitstream(BITSTREAM *stream);
 
 BITWORD GetBits(BITSTREAM *stream, BITCOUNT count);
 
-BITWORD GetBuffer(BITSTREAM *stream);
+CODEC_ERROR GetBuffer(BITSTREAM *stream);
 
 // Rewind the bitstream and the associated byte stream
 CODEC_ERROR RewindBitstream(BITSTREAM *bitstream);
@@ -111,6 +130,9 @@ CODEC_ERROR SkipPayload(BITSTREAM *bitstream, int chunk_size);
 // Return the current position of the bitstream pointer in the sample
 size_t GetBitstreamPosition(BITSTREAM *stream);
 
+// Return the number of bits that have been read from the sample
+size_t GetBitstreamBitCount(BITSTREAM *bitstream);
+
 CODEC_ERROR AlignBitsByte(BITSTREAM *bitstream);
 CODEC_ERROR AlignBitsWord(BITSTREAM *bitstream);
 
@@ -130,4 +152,46 @@ BITSTREAM_ERROR BitstreamErrorStream(STREAM_ERROR error);
 
 bool EndOfBitsteam(BITSTREAM *bitstream);
 
+/*!
+	@brief Refill the bit buffer if it contains less than a word of bits
+
+	If the bitstream is reading a sample in memory, then the bit buffer will
+	contain at least 57 bits after this call unless the end of the sample has
+	been reached.  Otherwise, the bit buffer will contain at least one word.
+
+	The caller can peek and consume up to one word of bits after calling
+	this routine without checking whether the bit buffer must be refilled.
+*/
+static inline void FillBits(BITSTREAM *bitstream)
+{
+	if (bitstream->count < bit_word_count) {
+		GetBuffer(bitstream);
+	}
+}
+
+/*!
+	@brief Return the next bits in the bit buffer without removing the bits
+
+	The number of bits must be between one and the size of a bit word.
+	The caller is responsible for checking that enough bits are in the buffer.
+*/
+static inline BITWORD PeekBits(const BITSTREAM *bitstream, BITCOUNT count)
+{
+	assert(0 < count && count <= bit_word_count);
+	return (BITWORD)(bitstream->buffer >> (bit_buffer_count - count));
+}
+
+/*!
+	@brief Remove the specified number of bits from the bit buffer
+
+	The number of bits must be less than the size of the bit buffer and
+	not more than the number of bits remaining in the bit buffer.
+*/
+static inline void ConsumeBits(BITSTREAM *bitstream, BITCOUNT count)
+{
+	assert(count < bit_buffer_count && count <= bitstream->count);
+	bitstream->buffer <<= count;
+	bitstream->count -= count;
+}
+
 #endif
@@ -0,0 +1,92 @@
+/*! @file decoder/include/cascade.h
+
+	Declaration of the line-based cascade of inverse wavelet transforms.
+
+	The inverse transforms at every wavelet level in a channel are computed together,
+	one pair of output rows at a time, so the lowpass bands in the intermediate wavelets
+	are kept in small ring buffers instead of being reconstructed in full.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _CASCADE_H
+#define _CASCADE_H
+
+/*!
+	@brief Number of rows in the ring buffer of rows output by each level in the cascade
+
+	The inverse vertical filter uses three lowpass rows and the rows are computed
+	in pairs, so at most four rows output by a level are in use at any time.
+*/
+#define CASCADE_RING_LENGTH		4
+
+/*!
+	@brief State of the inverse transform at one wavelet level in the cascade
+
+	Each level inverts one wavelet.  The rows output by every level except the
+	lowest level are the lowpass band in the wavelet at the next lower level and
+	are stored in a ring buffer until they are no longer needed by the next level.
+*/
+typedef struct _cascade_level
+{
+	WAVELET *wavelet;			//!< Wavelet inverted by this level
+	int descale;				//!< Prescale removed by the inverse transform (zero if none)
+
+	DIMENSION output_width;		//!< Width of the rows output by this level
+	DIMENSION output_height;	//!< Number of rows output by this level
+
+	int input_row;				//!< Next row in the wavelet bands
+	int output_row_count;		//!< Number of rows stored in the ring buffer
+
+	PIXEL *ring[CASCADE_RING_LENGTH];	//!< Most recent rows output by this level
+	PIXEL *buffer;				//!< Scratch space for the results of the inverse vertical filter
+
+} CASCADE_LEVEL;
+
+/*!
+	@brief Line-based cascade of inverse wavelet transforms in one channel
+
+	The level at index zero inverts the wavelet at level one and outputs the rows
+	in the component array.  The level with the highest index inverts the wavelet
+	that contains the lowpass band decoded from the bitstream.
+*/
+typedef struct _cascade
+{
+	ALLOCATOR *allocator;		//!< Allocator used for the ring buffers and scratch space
+	int level_count;			//!< Number of wavelet levels in the cascade
+
+	CASCADE_LEVEL level[MAX_WAVELET_COUNT];
+
+} CASCADE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR InitCascade(CASCADE *cascade,
+						ALLOCATOR *allocator,
+						TRANSFORM *transform,
+						int wavelet_count,
+						const PRESCALE prescale_table[],
+						DIMENSION output_width,
+						DIMENSION output_height);
+
+CODEC_ERROR ReleaseCascade(CASCADE *cascade);
+
+CODEC_ERROR CascadeOutputRows(CASCADE *cascade, PIXEL *even_row, PIXEL *odd_row);
+
+CODEC_ERROR TransformInverseCascade(ALLOCATOR *allocator,
+									TRANSFORM *transform,
+									int wavelet_count,
+									const PRESCALE prescale_table[],
+									COMPONENT_VALUE *output_buffer,
+									DIMENSION output_width,
+									DIMENSION output_height,
+									size_t output_pitch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
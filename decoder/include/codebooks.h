@@ -0,0 +1,29 @@
+/*! @file decoder/include/codebooks.h
+
+	Declaration of the routines for computing the decoding tables from a codebook.
+
+	The decoding table is derived from the codebook so that most codewords,
+	including the sign bit that follows a coefficient magnitude, can be decoded
+	by looking up the next bits in the bitstream in a table.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _CODEBOOKS_H
+#define _CODEBOOKS_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR CreateDecodingTable(ALLOCATOR *allocator, const CODEBOOK *codebook, const VLD_TABLE **table_out);
+
+CODEC_ERROR ReleaseDecodingTable(ALLOCATOR *allocator, const VLD_TABLE **table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
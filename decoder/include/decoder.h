@@ -8,6 +8,41 @@
 #define _DECODER_H
 
 
+/*!
+	@brief Location of a codeblock in the sample and the codec state at the codeblock
+
+	Codeblocks are recorded when the channels are decoded in parallel so that each
+	channel can be decoded later with the same codec state that would have been used
+	if the codeblock had been decoded when it was found in the bitstream.
+*/
+typedef struct _codeblock
+{
+	CODEC_STATE codec;			//!< Codec state when the codeblock was found in the bitstream
+	size_t offset;				//!< Offset to the codeblock payload in the sample (in bytes)
+	size_t size;				//!< Size of the codeblock payload (in bytes)
+
+} CODEBLOCK;
+
+/*!
+	@brief Timers for the stages of the decoding process
+
+	The timers record the time spent by all threads in each stage, so the time
+	for a stage can exceed the elapsed time if the channels are decoded in parallel.
+	The inverse transforms computed one row at a time by the cascade are interleaved,
+	so the time for all levels is recorded by a separate timer.  When decoding to a
+	lower resolution, the time for copying the lowpass band into the component array
+	is recorded by the timer for the level of the wavelet that contains the lowpass band.
+*/
+typedef struct _decoder_timing
+{
+	TIMER read;							//!< Time for reading the encoded sample into memory
+	TIMER decoding[MAX_SUBBAND_COUNT];	//!< Time for entropy decoding each subband
+	TIMER inverse[MAX_WAVELET_COUNT];	//!< Time for the inverse wavelet transforms at each level
+	TIMER cascade;						//!< Time for the inverse transforms at all levels in the cascade
+	TIMER repack;						//!< Time for packing the component arrays into the output image
+
+} DECODER_TIMING;
+
 /*!
 	Data structure for the buffers and information used by
 	the decoder.
@@ -137,6 +172,33 @@ typedef struct _decoder
 	//! Pointer to the active codebook for variable-length codes
 	CODEBOOK *codebook;
 
+	//! Table for decoding the codewords in the active codebook (owned by the decoder)
+	const VLD_TABLE *decoding_table;
+
+	int thread_count;			//!< Number of threads used for decoding the channels
+
+	//! Timers for measuring decoder performance (null if the stages are not timed)
+	DECODER_TIMING *timing;
+
+	//! Resolution of the decoded image (number of wavelet levels that are not inverted)
+	RESOLUTION resolution;
+
+	//! Region of the image that is decoded in full resolution coordinates (empty for the entire image)
+	ROI roi;
+
+	//! Codeblocks recorded for decoding the channels in parallel
+	struct _deferred
+	{
+		bool enabled;			//!< Record each codeblock instead of decoding the codeblock
+
+		//! Codeblocks in each channel in the order found in the bitstream
+		CODEBLOCK codeblock[MAX_CHANNEL_COUNT][MAX_SUBBAND_COUNT];
+
+		//! Number of codeblocks recorded for each channel
+		int codeblock_count[MAX_CHANNEL_COUNT];
+
+	} deferred;
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
     uint8_t image_sequence_identifier[16];      //!< UUID for the unique image sequence identifier
     uint32_t image_sequence_number;             //!< Number of the image in the image sequence
@@ -271,6 +333,10 @@ extern "C" {
 
 CODEC_ERROR InitDecoder(DECODER *decoder, ALLOCATOR *allocator);
 
+CODEC_ERROR InitDecoderTiming(DECODER_TIMING *timing);
+
+CODEC_ERROR PrintDecoderTiming(DECODER_TIMING *timing, FILE *file);
+
 CODEC_ERROR InitMetadataDatabase(DATABASE **database_out, const PARAMETERS *parameters, bool duplicates_flag);
 
 CODEC_ERROR SetDecoderLogfile(DECODER *decoder, FILE *logfile);
@@ -291,6 +357,11 @@ CODEC_ERROR SetOutputImageFormat(DECODER *decoder,
 								 DIMENSION *height_out,
 								 PIXEL_FORMAT *format_out);
 
+CODEC_ERROR ReduceOutputDimensions(const DECODER *decoder,
+								   PIXEL_FORMAT output_format,
+								   DIMENSION *width,
+								   DIMENSION *height);
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
 CODEC_ERROR SetDisplayImageFormat(DECODER *decoder,
 								  const PARAMETERS *parameters,
@@ -332,6 +403,8 @@ CODEC_ERROR DecodeStream(STREAM *stream, UNPACKED_IMAGE *image, DATABASE *databa
 
 CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *image, DATABASE *database, const PARAMETERS *parameters);
 
+CODEC_ERROR DecodeThumbnail(STREAM *stream, PACKED_IMAGE *thumbnail, DATABASE *database, const PARAMETERS *parameters);
+
 CODEC_ERROR DecodingProcess(DECODER *decoder, BITSTREAM *stream, UNPACKED_IMAGE *image, DATABASE *database, const PARAMETERS *parameters);
 
 CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE *image);
@@ -340,6 +413,26 @@ CODEC_ERROR DecodeSampleLayer(DECODER *decoder, BITSTREAM *input, IMAGE *image);
 
 CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chunk_size);
 
+CODEC_ERROR DecodeSubbandCoefficients(DECODER *decoder, BITSTREAM *input, size_t chunk_size);
+
+CODEC_ERROR UpdateDecodedSubband(DECODER *decoder, int channel_number, int subband_number);
+
+CODEC_ERROR SkipChannelSubband(DECODER *decoder, BITSTREAM *input, int chunk_size);
+
+bool IsWaveletDecoded(const DECODER *decoder, int wavelet_index);
+
+bool IsSubbandDecoded(const DECODER *decoder, int subband);
+
+int DecodedSubbandCount(const DECODER *decoder);
+
+bool IsRegionDecoded(const DECODER *decoder);
+
+bool IsCascadeDecoded(const DECODER *decoder);
+
+CODEC_ERROR GetChannelRegion(const DECODER *decoder, int channel_number, int level, ROI *region_out);
+
+int PrescaleSum(const PRESCALE *prescale_table, int wavelet_level);
+
 CODEC_ERROR ReconstructWaveletBand(DECODER *decoder, int channel, WAVELET *wavelet, int index);
 
 CODEC_ERROR ParseChannelIndex(BITSTREAM *stream, uint32_t *channel_size, int channel_count);
@@ -359,9 +452,13 @@ CODEC_ERROR DecodeLowpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wave
 
 CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wavelet, int band);
 
-CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
+CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, PIXEL *data,
 						   DIMENSION width, DIMENSION height, DIMENSION pitch);
 
+CODEC_ERROR DecodeBandRunsDequantized(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, PIXEL *data,
+									  DIMENSION width, DIMENSION height, DIMENSION pitch,
+									  QUANT quantization);
+
 CODEC_ERROR DecodeBandTrailer(BITSTREAM *stream);
 
 CODEC_ERROR DecodeSampleChannelHeader(DECODER *decoder, BITSTREAM *stream);
@@ -388,6 +485,10 @@ bool IsDecodingComplete(DECODER *decoder);
 
 CODEC_ERROR ReconstructUnpackedImage(DECODER *decoder, UNPACKED_IMAGE *image);
 
+CODEC_ERROR AllocateComponentArrayList(DECODER *decoder, UNPACKED_IMAGE *image);
+
+CODEC_ERROR ReconstructComponentArray(DECODER *decoder, UNPACKED_IMAGE *image, int channel_number);
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
     CODEC_ERROR ReconstructLayerImage(DECODER *decoder, IMAGE *image);
 #endif
@@ -7,8 +7,16 @@
 #ifndef _QUANTIZE_H
 #define _QUANTIZE_H
 
+//! Largest magnitude of a value decoded from the codebook (before companding is inverted)
+#define DEQUANTIZATION_TABLE_MAGNITUDE	255
+
+//! Number of entries in the table of dequantized values (negative and positive values)
+#define DEQUANTIZATION_TABLE_LENGTH		(2 * DEQUANTIZATION_TABLE_MAGNITUDE + 1)
+
 CODEC_ERROR DequantizeBandRow16s(PIXEL *input, int width, int quantization, PIXEL *output);
 
 PIXEL DequantizedValue(int32_t value, int quantization);
 
+CODEC_ERROR ComputeDequantizationTable(int quantization, PIXEL table[DEQUANTIZATION_TABLE_LENGTH]);
+
 #endif
@@ -37,9 +37,14 @@
 
 #include "types.h"
 #include "config.h"
+#include "timer.h"
 #include "macros.h"
 #include "error.h"
 #include "allocator.h"
+#include "filemap.h"
+#include "cpu.h"
+#include "threadpool.h"
+#include "taskgraph.h"
 #include "filelist.h"
 #include "color.h"
 #include "pixel.h"
@@ -53,6 +58,8 @@
 #include "syntax.h"
 #include "swap.h"
 #include "inverse.h"
+#include "kernels.h"
+#include "cascade.h"
 #include "companding.h"
 #include "dequantize.h"
 //#include "metadata.h"
@@ -61,6 +68,7 @@
 #include "interlaced.h"
 #include "vlc.h"
 #include "codeset.h"
+#include "codebooks.h"
 #include "transperm.h"
 
 #if VC5_ENABLED_PART(VC5_PART_METADATA)
@@ -84,6 +92,7 @@ typedef struct _database DATABASE;
 #endif
 
 #include "decoder.h"
+#include "parallel.h"
 
 #include "component.h"
 #include "utilities.h"
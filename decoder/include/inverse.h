@@ -33,6 +33,25 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 										 //ROI roi, PIXEL *buffer, size_t buffer_size,
 										 int descale, QUANT quantization[]);
 
+CODEC_ERROR InvertSpatial16s(ALLOCATOR *allocator,
+							 PIXEL *lowlow_band, int lowlow_pitch,
+							 PIXEL *lowhigh_band, int lowhigh_pitch,
+							 PIXEL *highlow_band, int highlow_pitch,
+							 PIXEL *highhigh_band, int highhigh_pitch,
+							 PIXEL *output_image, int output_pitch,
+							 DIMENSION input_width, DIMENSION input_height,
+							 DIMENSION output_width, DIMENSION output_height);
+
+CODEC_ERROR InvertSpatialDescale16s(ALLOCATOR *allocator,
+									PIXEL *lowlow_band, int lowlow_pitch,
+									PIXEL *lowhigh_band, int lowhigh_pitch,
+									PIXEL *highlow_band, int highlow_pitch,
+									PIXEL *highhigh_band, int highhigh_pitch,
+									PIXEL *output_image, int output_pitch,
+									DIMENSION input_width, DIMENSION input_height,
+									DIMENSION output_width, DIMENSION output_height,
+									int descale);
+
 CODEC_ERROR InvertSpatialWavelet(ALLOCATOR *allocator,
 								 PIXEL *lowlow_band, int lowlow_pitch,
 								 PIXEL *lowhigh_band, int lowhigh_pitch,
@@ -64,6 +83,30 @@ CODEC_ERROR InvertSpatialBottomRow(PIXEL **input_data[], DIMENSION input_width[]
 								   int input_row, int channel_count, int precision, QUANT *quantization[],
 								   ALLOCATOR *allocator);
 
+CODEC_ERROR InvertSpatialSupport(const ROI *output_region,
+								 DIMENSION input_width, DIMENSION input_height,
+								 ROI *input_region);
+
+CODEC_ERROR InvertSpatialRegion16s(ALLOCATOR *allocator,
+								   PIXEL *lowlow_band, int lowlow_pitch,
+								   PIXEL *lowhigh_band, int lowhigh_pitch,
+								   PIXEL *highlow_band, int highlow_pitch,
+								   PIXEL *highhigh_band, int highhigh_pitch,
+								   PIXEL *output_image, int output_pitch,
+								   DIMENSION input_width, DIMENSION input_height,
+								   DIMENSION output_width, DIMENSION output_height,
+								   const ROI *region, int descale);
+
+CODEC_ERROR InvertSpatialRow16s(const PIXEL *lowlow_row[3],
+								const PIXEL *lowhigh_row[3],
+								const PIXEL *highlow_row,
+								const PIXEL *highhigh_row,
+								PIXEL *even_output, PIXEL *odd_output,
+								int row, PIXEL *buffer,
+								DIMENSION input_width, DIMENSION input_height,
+								DIMENSION output_width, DIMENSION output_height,
+								int descale);
+
 CODEC_ERROR InvertHorizontalScaled16s(PIXEL *lowpass,
 									  PIXEL *highpass,
 									  PIXEL *output,
@@ -71,4 +114,37 @@ CODEC_ERROR InvertHorizontalScaled16s(PIXEL *lowpass,
 									  DIMENSION output_width,
 									  int precision);
 
+/*!
+	@brief Return the first lowpass coefficient used by the inverse filter at the specified position
+
+	The interior filter uses the coefficients on either side of the position and
+	the border filters use the first or last three coefficients.
+*/
+static inline int LowpassSupportFirst(int position, int length)
+{
+	int first = position - 1;
+
+	// The border filter at the end uses the last three coefficients
+	if (first > length - 3) {
+		first = length - 3;
+	}
+
+	return (first < 0) ? 0 : first;
+}
+
+/*!
+	@brief Return the last lowpass coefficient used by the inverse filter at the specified position
+*/
+static inline int LowpassSupportLast(int position, int length)
+{
+	int last = position + 1;
+
+	// The border filter at the start uses the first three coefficients
+	if (last < 2) {
+		last = 2;
+	}
+
+	return (last > length - 1) ? length - 1 : last;
+}
+
 #endif
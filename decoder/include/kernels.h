@@ -0,0 +1,69 @@
+/*! @file decoder/include/kernels.h
+
+	Declaration of the kernels that apply the interior inverse wavelet filters.
+
+	The kernels compute the even and odd results of the inverse filter at the
+	interior positions in a row (horizontal filter) or across three rows (vertical
+	filter).  The scalar kernels are the reference implementation and the vectorized
+	kernels, selected at runtime using the processor features, compute the same results.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _KERNELS_H
+#define _KERNELS_H
+
+/*!
+	@brief Apply the interior inverse vertical filter to the columns in three rows of lowpass coefficients
+
+	The three lowpass rows are the rows before, at, and after the input row.  The results
+	are divided by two and clamped to the range of the pixel values.
+*/
+typedef void (*INVERT_ROWS_KERNEL)(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+								   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+								   int count);
+
+/*!
+	@brief Apply the interior inverse horizontal filter to the columns in a row
+
+	The lowpass and highpass arguments point to the first column and the output points to
+	the even output value for the first column.  The even and odd results are interleaved
+	in the output.  The results are shifted left by the shift argument (to remove the scaling
+	applied during encoding) or shifted right if the shift is negative (to divide by two)
+	and clamped to the range of the pixel values.
+*/
+typedef void (*INVERT_COLUMNS_KERNEL)(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+									  int count, int shift);
+
+/*!
+	@brief Table of the kernels used for the interior inverse wavelet filters
+*/
+typedef struct _inverse_kernels
+{
+	const char *name;						//!< Name of the instruction set used by the kernels
+	INVERT_ROWS_KERNEL invert_rows;			//!< Inverse vertical filter
+	INVERT_COLUMNS_KERNEL invert_columns;	//!< Inverse horizontal filter
+
+} INVERSE_KERNELS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const INVERSE_KERNELS *SelectInverseKernels(uint32_t cpu_features);
+
+const INVERSE_KERNELS *GetInverseKernels(void);
+
+void InvertInteriorRows16s(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+						   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+						   int count);
+
+void InvertInteriorColumns16s(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+							  int count, int shift);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
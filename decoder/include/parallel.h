@@ -0,0 +1,30 @@
+/*! @file decoder/include/parallel.h
+
+	Declaration of the routines for decoding the channels in parallel.
+
+	The codeblocks in each channel are located during a pass through the bitstream
+	that skips the codeblock payloads using the chunk sizes.  The codeblocks are then
+	decoded and the wavelets are inverted by a graph of tasks that is run by a thread
+	pool, with each inverse transform starting as soon as the bands in the wavelet
+	have been decoded.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+CODEC_ERROR RecordChannelSubband(DECODER *decoder, BITSTREAM *stream, int chunk_size);
+
+CODEC_ERROR DecodeDeferredChannels(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE *image);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -135,6 +135,30 @@ typedef struct _parameters
 	//! Suppress all output to the terminal
 	bool quiet_flag;
 
+	//! Print statistics about the memory and time used by the decoder
+	bool stats_flag;
+
+	//! Number of threads used for decoding (values less than two decode on the calling thread)
+	int thread_count;
+
+	//! Memory allocation scheme selected on the command line
+	ALLOCATOR_TYPE allocator_type;
+
+	//! Memory allocator used by the decoder (null for the default allocator)
+	ALLOCATOR *allocator;
+
+	//! Timers for the stages of the decoding process (null if the stages are not timed)
+	struct _decoder_timing *timing;
+
+	//! Resolution of the decoded image (the image is decoded at full resolution by default)
+	RESOLUTION resolution;
+
+	//! Decode a thumbnail image (the resolution is set to one eighth)
+	bool thumbnail_flag;
+
+	//! Region of the image to decode in full resolution coordinates (empty to decode the entire image)
+	ROI roi;
+
 	//! Information for writing the bandfile
 	BANDFILE_INFO bandfile;
 
@@ -4,9 +4,12 @@
 
 	The bitstream is connected to a byte stream to read bytes from an input
 	source.  The stream may be a binary file, memory buffer, or a track in
-	a media container.  The bitstream data structure stores the last word
-	read from the byte stream and the count of the number of bits that remain
-	in the bit buffer.
+	a media container.  The bitstream data structure stores the bits read
+	from the byte stream that have not been used and the count of the number
+	of bits that remain in the bit buffer.
+
+	If the entire sample is in memory, then the bitstream reads the sample
+	directly without calling the byte stream for each word.
 
 	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
 	All rights reserved--use subject to compliance with end user license agreement.
@@ -43,6 +46,9 @@ CODEC_ERROR InitBitstream(BITSTREAM *bitstream)
 		bitstream->stream = NULL;
 		bitstream->buffer = 0;
 		bitstream->count = 0;
+		bitstream->span = NULL;
+		bitstream->span_size = 0;
+		bitstream->span_offset = 0;
 		return CODEC_ERROR_OKAY;
 	}
 
@@ -55,11 +61,53 @@ CODEC_ERROR InitBitstream(BITSTREAM *bitstream)
 	It is permitted for the byte stream to be NULL, in which case the
 	bitstream will not be able to replenish its internal buffer and the
 	consequences are undefined.
+
+	If the byte stream is a memory buffer opened for reading, then the
+	bitstream reads the bytes that remain in the memory buffer directly.
 */
 CODEC_ERROR AttachBitstream(struct _bitstream *bitstream, struct _stream *stream)
 {
 	assert(bitstream != NULL);
 	bitstream->stream = stream;
+
+	if (stream != NULL && stream->type == STREAM_TYPE_MEMORY && stream->access == STREAM_ACCESS_READ)
+	{
+		const uint8_t *buffer = (const uint8_t *)stream->location.memory.buffer;
+		size_t count = stream->location.memory.count;
+		size_t size = stream->location.memory.size;
+
+		// Read the sample directly from the memory buffer
+		return AttachBitstreamBuffer(bitstream, buffer + count, size - count);
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Attach a bitstream to a sample in memory
+
+	The bitstream reads the sample directly from the buffer and refills the
+	bit buffer with one unaligned load of eight bytes, except at the end of
+	the sample where the remaining bytes are loaded one byte at a time.
+
+	The buffer is owned by the caller and must not be freed until decoding
+	is finished.  The bitstream does not read past the end of the buffer.
+*/
+CODEC_ERROR AttachBitstreamBuffer(BITSTREAM *bitstream, const void *buffer, size_t size)
+{
+	assert(bitstream != NULL);
+	if (! (bitstream != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	bitstream->span = (const uint8_t *)buffer;
+	bitstream->span_size = size;
+	bitstream->span_offset = 0;
+
+	// Discard any bits remaining in the bit buffer
+	bitstream->buffer = 0;
+	bitstream->count = 0;
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -82,9 +130,7 @@ CODEC_ERROR ReleaseBitstream(BITSTREAM *bitstream)
 */
 BITWORD GetBits(BITSTREAM *stream, BITCOUNT count)
 {
-    CODEC_ERROR error = CODEC_ERROR_OKAY;
-
-    // Return zero if the request cannot be satisfied
+	// Return zero if the request cannot be satisfied
 	BITWORD bits = 0;
 
 	// Check that the number of requested bits is valid
@@ -92,62 +138,38 @@ BITWORD GetBits(BITSTREAM *stream, BITCOUNT count)
 	assert(count <= bit_word_count);
 
 	// Check that the unused portion of the bit buffer is empty
-	assert((stream->buffer & BitMask(bit_word_count - stream->count)) == 0);
+	assert(stream->count == bit_buffer_count || (stream->buffer << stream->count) == 0);
 
 	if (count == 0) goto finish;
 
 	// Are there enough bits in the buffer to satisfy the request?
-	if (count <= stream->count)
-	{
-		// Right align the requested number of bits in the bit buffer
-		bits = (stream->buffer >> (bit_word_count - count));
-
-		// Reduce the number of bits in the bit buffer
-		stream->buffer <<= count;
-		stream->count = (stream->count - count);
-	}
-	else
+	if (stream->count < count)
 	{
-		BITCOUNT low_bit_count;
-
-		// Use the remaining bits in the bit buffer
-		assert(stream->count > 0 || stream->buffer == 0);
-		bits = (stream->buffer >> (bit_word_count - count));
-
-		// Compute the number of bits to be used from the next word
-		low_bit_count = count - stream->count;
-		stream->count = 0;
-		assert(low_bit_count > 0);
-
 		// Fill the bit buffer from the byte stream
-		assert(stream->count == 0);
-		error = GetBuffer(stream);
-        if (error != CODEC_ERROR_OKAY) {
-            return 0;
-        }
-		assert(stream->count >= low_bit_count);
-
-		// Use the new bits in the bit buffer
-		bits |= (stream->buffer >> (bit_word_count - low_bit_count));
-
-		// Reduce the number of bits in the bit buffer
-		if (low_bit_count < bit_word_count) {
-			stream->buffer <<= low_bit_count;
+		CODEC_ERROR error = GetBuffer(stream);
+		if (error != CODEC_ERROR_OKAY) {
+			return 0;
 		}
-		else {
-			stream->buffer = 0;
+
+		if (stream->count < count)
+		{
+			// Reached the end of the sample in memory
+			stream->error = BitstreamErrorStream(STREAM_ERROR_EOF);
+			return 0;
 		}
-		assert(low_bit_count <= stream->count);
-		stream->count = (stream->count - low_bit_count);
 	}
 
+	// Remove the requested number of bits from the bit buffer
+	bits = PeekBits(stream, count);
+	ConsumeBits(stream, count);
+
 finish:
 	// The bit count should never be negative or larger than the size of the bit buffer
-	//assert(0 <= stream->count && stream->count <= bit_word_count);
-	assert(stream->count <= bit_word_count);
+	//assert(0 <= stream->count && stream->count <= bit_buffer_count);
+	assert(stream->count <= bit_buffer_count);
 
 	// The unused bits in the bit buffer should all be zero
-	assert((stream->buffer & BitMask(bit_word_count - stream->count)) == 0);
+	assert(stream->count == bit_buffer_count || (stream->buffer << stream->count) == 0);
 
 	// The unused bits in the result should all be zero
 	assert((bits & ~BitMask(count)) == 0);
@@ -158,36 +180,93 @@ finish:
 /*!
 	@brief Fill the internal bitstream buffer by reading a byte stream
 
-	@todo Need to modify this routine to return an error code if it cannot
-	read from the byte stream associated with the bitstream.
+	If the bitstream is reading a sample in memory, then as many whole bytes
+	as fit in the bit buffer are loaded using a single unaligned load and byte
+	swap.  The last few bytes in the sample are loaded one byte at a time so
+	that the bitstream never reads past the end of the sample.
+
+	Otherwise, the next word is read from the byte stream if the bit buffer
+	has room for another word.
 */
 CODEC_ERROR GetBuffer(BITSTREAM *bitstream)
 {
-    STREAM_ERROR error = STREAM_ERROR_OKAY;
-    
+	STREAM_ERROR error = STREAM_ERROR_OKAY;
+	BITWORD word;
+
+	// Reading the sample directly from memory?
+	if (bitstream->span != NULL)
+	{
+		// Number of whole bytes that can be added to the bit buffer
+		int byte_count = (bit_buffer_count - bitstream->count) / 8;
+
+		if (bitstream->span_offset + sizeof(BITBUFFER) <= bitstream->span_size)
+		{
+			BITBUFFER bits;
+
+			if (byte_count == 0) {
+				return CODEC_ERROR_OKAY;
+			}
+
+			// Load the next eight bytes in the sample (the address may not be aligned)
+			memcpy(&bits, bitstream->span + bitstream->span_offset, sizeof(bits));
+			bits = Swap64(bits);
+
+			// Keep only the bytes that fit in the bit buffer
+			bits &= ~((BITBUFFER)0) << (bit_buffer_count - 8 * byte_count);
+
+			bitstream->buffer |= (bits >> bitstream->count);
+			bitstream->count += 8 * byte_count;
+			bitstream->span_offset += byte_count;
+		}
+		else
+		{
+			// Signal an underflow if the sample has been read and the bit buffer is empty
+			if (bitstream->span_offset == bitstream->span_size && bitstream->count == 0)
+			{
+				bitstream->error = BitstreamErrorStream(STREAM_ERROR_EOF);
+				return CodecErrorBitstream(bitstream->error);
+			}
+
+			// Load the bytes at the end of the sample one byte at a time
+			for (; byte_count > 0 && bitstream->span_offset < bitstream->span_size; byte_count--)
+			{
+				BITBUFFER byte = bitstream->span[bitstream->span_offset++];
+				bitstream->buffer |= byte << (bit_buffer_count - 8 - bitstream->count);
+				bitstream->count += 8;
+			}
+		}
+
+		return CODEC_ERROR_OKAY;
+	}
+
 	// Need to signal an underflow error?
 	assert(bitstream != NULL && bitstream->stream != NULL);
 	if (! (bitstream != NULL && bitstream->stream != NULL)) {
 		return (bitstream->error = BITSTREAM_ERROR_UNDERFLOW);
 	}
 
-	// The bit buffer should be empty
-	assert(bitstream->count == 0);
+	// Does the bit buffer have room for another word?
+	if (bitstream->count > bit_buffer_count - bit_word_count) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	// Read the next word from the byte stream
+	word = Swap32(GetWord(bitstream->stream));
+
+	error = bitstream->stream->error;
+	if (error != STREAM_ERROR_OKAY)
+	{
+		// Record the error in the bitstream
+		bitstream->error = BitstreamErrorStream(error);
+
+		// Return a codec error code corresponding to the bitstream error
+		return CodecErrorBitstream(bitstream->error);
+	}
+
+	// Append the word to the bits remaining in the bit buffer
+	bitstream->buffer |= ((BITBUFFER)word << (bit_buffer_count - bit_word_count - bitstream->count));
+	bitstream->count += bit_word_count;
 
-	// Fill the bit buffer with a word from the byte stream
-	bitstream->buffer = Swap32(GetWord(bitstream->stream));
-    
-    error = bitstream->stream->error;
-    if (error != STREAM_ERROR_OKAY)
-    {
-        // Record the error in the bitstream
-        bitstream->error = BitstreamErrorStream(error);
-        
-        // Return a codec error code corresponding to the bitstream error
-        return CodecErrorBitstream(bitstream->error);
-    }
-    
-	bitstream->count = bit_word_count;
 	return CODEC_ERROR_OKAY;
 }
 
@@ -217,6 +296,7 @@ CODEC_ERROR RewindBitstream(BITSTREAM *bitstream)
 	// Reset the bitstream internal state
 	bitstream->buffer = 0;
 	bitstream->count = 0;
+	bitstream->span_offset = 0;
 	bitstream->error = BITSTREAM_ERROR_OKAY;
 
 	return CODEC_ERROR_OKAY;
@@ -253,8 +333,32 @@ CODEC_ERROR SkipPayload(BITSTREAM *bitstream, int chunk_size)
 	// The chunk size is in units of 32-bit words
 	size_t size = 4 * chunk_size;
 
-	// This routine assumes that the bit buffer is empty
-	assert(bitstream->count == 0);
+	// This routine assumes that the bitstream is aligned to a segment boundary
+	assert(IsAlignedSegment(bitstream));
+
+	// Skip the bytes that remain in the bit buffer
+	for (; size > 0 && bitstream->count >= 8; size--) {
+		ConsumeBits(bitstream, 8);
+	}
+
+	if (size == 0) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	// Reading the sample directly from memory?
+	if (bitstream->span != NULL)
+	{
+		if (size > bitstream->span_size - bitstream->span_offset)
+		{
+			// The payload extends past the end of the sample
+			bitstream->span_offset = bitstream->span_size;
+			bitstream->error = BitstreamErrorStream(STREAM_ERROR_EOF);
+			return CodecErrorBitstream(bitstream->error);
+		}
+
+		bitstream->span_offset += size;
+		return CODEC_ERROR_OKAY;
+	}
 
 	// Skip the specified number of bytes in the stream
 	return SkipBytes(bitstream->stream, size);
@@ -273,9 +377,31 @@ CODEC_ERROR SkipPayload(BITSTREAM *bitstream, int chunk_size)
 */
 size_t GetBitstreamPosition(BITSTREAM *bitstream)
 {
-	// The bit buffer must be empty
-	assert(bitstream->count == 0);
-	return (bitstream->stream->byte_count);
+	size_t bit_count = GetBitstreamBitCount(bitstream);
+
+	// The bitstream must be aligned to a byte boundary
+	assert((bit_count % 8) == 0);
+	return (bit_count / 8);
+}
+
+/*!
+	@brief Return the number of bits that have been read from the sample
+
+	The bits that have been loaded into the bit buffer but not used are
+	not counted as read.
+*/
+size_t GetBitstreamBitCount(BITSTREAM *bitstream)
+{
+	size_t byte_count = 0;
+
+	if (bitstream->span != NULL) {
+		byte_count = bitstream->span_offset;
+	}
+	else if (bitstream->stream != NULL) {
+		byte_count = bitstream->stream->byte_count;
+	}
+
+	return (8 * byte_count - bitstream->count);
 }
 
 /*!
@@ -296,15 +422,15 @@ CODEC_ERROR AlignBitsByte(BITSTREAM *bitstream)
 /*!
 	@brief Align the bitstream to the next word boundary
 
-	All of the bits in the bitstream buffer are flushed unless
-	the bitstream buffer is completely empty or completely full.
+	Enough bits are removed from the bitstream buffer to align
+	the bitstream to the next word in the sample.
 */
 CODEC_ERROR AlignBitsWord(BITSTREAM *bitstream)
 {
-	BITCOUNT count = bitstream->count;
+	BITCOUNT count = GetBitstreamBitCount(bitstream) % bit_word_count;
 
-	if (0 < count && count < bit_word_count) {
-		GetBits(bitstream, count);
+	if (count > 0) {
+		GetBits(bitstream, bit_word_count - count);
 	}
 
 	return CODEC_ERROR_OKAY;
@@ -358,7 +484,7 @@ CODEC_ERROR GetByteArray(BITSTREAM *bitstream, uint8_t *array, size_t size)
  */
 bool IsAlignedSegment(BITSTREAM *stream)
 {
-    return (stream->count == 0 || stream->count == bit_word_count);
+    return ((GetBitstreamBitCount(stream) % bit_word_count) == 0);
 }
 
 /*!
@@ -380,6 +506,11 @@ bool EndOfBitsteam(BITSTREAM *bitstream)
 		return false;
 	}
 
+	if (bitstream->span != NULL) {
+		// Reading the sample directly from memory
+		return (bitstream->span_offset == bitstream->span_size);
+	}
+
 	STREAM *stream = bitstream->stream;
 
 	return EndOfStream(stream);
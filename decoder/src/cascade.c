@@ -0,0 +1,320 @@
+/*!	@file decoder/src/cascade.c
+
+	Implementation of the line-based cascade of inverse wavelet transforms.
+
+	The inverse transforms at all wavelet levels in a channel are computed together,
+	one pair of output rows at a time.  The rows output by each level except the lowest
+	level are the lowpass band in the wavelet at the next lower level.  These rows are
+	computed on demand when the next lower level needs them and are kept in a ring buffer
+	that holds the few rows used by the inverse vertical filter, so the lowpass bands in
+	the intermediate wavelets are never reconstructed in full.
+
+	The highpass bands in every wavelet and the lowpass band in the wavelet at the highest
+	level must have been decoded before the cascade is started.  The output rows are the
+	same as the rows computed by applying the inverse transform at each level in turn.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+
+/*!
+	@brief Return the address of a row in one band of a wavelet
+*/
+static inline const PIXEL *WaveletBandRow(const WAVELET *wavelet, int band, int row)
+{
+	return (const PIXEL *)((const uint8_t *)wavelet->data[band] + row * wavelet->pitch);
+}
+
+static CODEC_ERROR ComputeCascadeRows(CASCADE *cascade, int index, PIXEL *even_row, PIXEL *odd_row);
+
+/*!
+	@brief Return a row in the lowpass band used by the specified level in the cascade
+
+	The lowpass band at the highest level was decoded from the bitstream.  The lowpass
+	rows at the other levels are output by the next higher level, which computes more
+	rows until the requested row is in its ring buffer.  The rows are requested in the
+	order used by the inverse vertical filter, so the requested row is never a row that
+	has been overwritten in the ring buffer.
+*/
+static CODEC_ERROR CascadeLowpassRow(CASCADE *cascade, int index, int row, const PIXEL **row_out)
+{
+	CASCADE_LEVEL *source;
+
+	if (index == cascade->level_count - 1)
+	{
+		// The lowpass band in the wavelet at the highest level was decoded from the bitstream
+		*row_out = WaveletBandRow(cascade->level[index].wavelet, LL_BAND, row);
+		return CODEC_ERROR_OKAY;
+	}
+
+	// The lowpass band is output by the next higher level in the cascade
+	source = &cascade->level[index + 1];
+
+	while (source->output_row_count <= row)
+	{
+		PIXEL *even_row = source->ring[(source->output_row_count + 0) % CASCADE_RING_LENGTH];
+		PIXEL *odd_row = source->ring[(source->output_row_count + 1) % CASCADE_RING_LENGTH];
+
+		CODEC_ERROR error = ComputeCascadeRows(cascade, index + 1, even_row, odd_row);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		source->output_row_count += 2;
+	}
+
+	// Check that the row has not been overwritten by a more recent row
+	assert(row >= source->output_row_count - CASCADE_RING_LENGTH);
+	if (! (row >= source->output_row_count - CASCADE_RING_LENGTH)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	*row_out = source->ring[row % CASCADE_RING_LENGTH];
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Compute the next pair of output rows at the specified level in the cascade
+
+	The odd output row is not computed if it is past the end of the output.
+*/
+static CODEC_ERROR ComputeCascadeRows(CASCADE *cascade, int index, PIXEL *even_row, PIXEL *odd_row)
+{
+	CASCADE_LEVEL *level = &cascade->level[index];
+	WAVELET *wavelet = level->wavelet;
+	const int row = level->input_row;
+
+	// The inverse vertical filter uses three rows in the lowlow and lowhigh bands
+	const int first = LowpassSupportFirst(row, wavelet->height);
+
+	const PIXEL *lowlow_row[3];
+	const PIXEL *lowhigh_row[3];
+	CODEC_ERROR error;
+	int i;
+
+	assert(row < wavelet->height);
+	if (! (row < wavelet->height)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		error = CascadeLowpassRow(cascade, index, first + i, &lowlow_row[i]);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		lowhigh_row[i] = WaveletBandRow(wavelet, LH_BAND, first + i);
+	}
+
+	error = InvertSpatialRow16s(lowlow_row, lowhigh_row,
+								WaveletBandRow(wavelet, HL_BAND, row),
+								WaveletBandRow(wavelet, HH_BAND, row),
+								even_row, odd_row, row, level->buffer,
+								wavelet->width, wavelet->height,
+								level->output_width, level->output_height,
+								level->descale);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	level->input_row++;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Initialize the cascade of inverse transforms for the wavelets in one channel
+
+	The output dimensions are the dimensions of the component array.  The rows output
+	by the other levels have the dimensions of the wavelet at the next lower level.
+	The lowpass band in the wavelet at the highest level must be decoded, but the
+	lowpass bands in the other wavelets are not used and do not have to be allocated.
+*/
+CODEC_ERROR InitCascade(CASCADE *cascade,
+						ALLOCATOR *allocator,
+						TRANSFORM *transform,
+						int wavelet_count,
+						const PRESCALE prescale_table[],
+						DIMENSION output_width,
+						DIMENSION output_height)
+{
+	int index;
+
+	assert(cascade != NULL);
+	if (! (cascade != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	memset(cascade, 0, sizeof(CASCADE));
+
+	assert(0 < wavelet_count && wavelet_count <= MAX_WAVELET_COUNT);
+	if (! (0 < wavelet_count && wavelet_count <= MAX_WAVELET_COUNT)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	cascade->allocator = allocator;
+	cascade->level_count = wavelet_count;
+
+	for (index = 0; index < wavelet_count; index++)
+	{
+		CASCADE_LEVEL *level = &cascade->level[index];
+		WAVELET *wavelet = transform->wavelet[index];
+		PRESCALE prescale = prescale_table[index];
+
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			ReleaseCascade(cascade);
+			return CODEC_ERROR_UNEXPECTED;
+		}
+
+		// The inverse vertical filter needs at least three rows and columns in each band
+		assert(wavelet->width >= 3 && wavelet->height >= 3);
+		if (! (wavelet->width >= 3 && wavelet->height >= 3)) {
+			ReleaseCascade(cascade);
+			return CODEC_ERROR_IMAGE_DIMENSIONS;
+		}
+
+		// Only the prescale values used by the other inverse transforms are supported
+		assert(prescale == 0 || prescale == 2);
+
+		level->wavelet = wavelet;
+		level->descale = (prescale > 1) ? prescale : 0;
+
+		if (index == 0)
+		{
+			// The lowest level outputs the rows in the component array
+			level->output_width = output_width;
+			level->output_height = output_height;
+		}
+		else
+		{
+			// The other levels output the lowpass band in the next lower wavelet
+			WAVELET *lowpass = transform->wavelet[index - 1];
+
+			assert(lowpass != NULL);
+			if (! (lowpass != NULL)) {
+				ReleaseCascade(cascade);
+				return CODEC_ERROR_UNEXPECTED;
+			}
+
+			level->output_width = lowpass->width;
+			level->output_height = lowpass->height;
+		}
+
+		// The output rows must be the size of the inverse of the wavelet bands
+		assert(level->output_width <= 2 * wavelet->width && level->output_height <= 2 * wavelet->height);
+
+		// Allocate scratch space for the results of the inverse vertical filter
+		level->buffer = (PIXEL *)AllocTagged(allocator, 4 * ALIGNED_PITCH(wavelet->width * sizeof(PIXEL)) + ALLOCATOR_TAIL_PADDING, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+		if (level->buffer == NULL) {
+			ReleaseCascade(cascade);
+			return CODEC_ERROR_OUTOFMEMORY;
+		}
+
+		if (index > 0)
+		{
+			// Allocate the ring buffer for the rows output by this level
+			size_t row_size = ROW_BUFFER_SIZE(2 * wavelet->width * sizeof(PIXEL));
+			int i;
+
+			for (i = 0; i < CASCADE_RING_LENGTH; i++)
+			{
+				level->ring[i] = (PIXEL *)AllocTagged(allocator, row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+				if (level->ring[i] == NULL) {
+					ReleaseCascade(cascade);
+					return CODEC_ERROR_OUTOFMEMORY;
+				}
+			}
+		}
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Free the ring buffers and scratch space allocated for the cascade
+*/
+CODEC_ERROR ReleaseCascade(CASCADE *cascade)
+{
+	int index;
+
+	for (index = 0; index < cascade->level_count; index++)
+	{
+		CASCADE_LEVEL *level = &cascade->level[index];
+		int i;
+
+		for (i = 0; i < CASCADE_RING_LENGTH; i++) {
+			Free(cascade->allocator, level->ring[i]);
+			level->ring[i] = NULL;
+		}
+
+		Free(cascade->allocator, level->buffer);
+		level->buffer = NULL;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Compute the next pair of rows output by the cascade
+
+	The rows are output from the top of the component array to the bottom.  The odd
+	row is not computed if the component array has an odd number of rows and the even
+	row is the last row, so the output rows can be written directly into the component
+	array or passed to the next stage of a streaming output path.
+*/
+CODEC_ERROR CascadeOutputRows(CASCADE *cascade, PIXEL *even_row, PIXEL *odd_row)
+{
+	return ComputeCascadeRows(cascade, 0, even_row, odd_row);
+}
+
+/*!
+	@brief Apply the inverse wavelet transforms in one channel to reconstruct a component array
+
+	This routine computes the same component array as reconstructing the lowpass band
+	at each level with @ref TransformInverseSpatialQuantLowpass and then applying
+	@ref TransformInverseSpatialQuantArray, but the intermediate lowpass bands are
+	computed one row at a time as the component array is computed.
+*/
+CODEC_ERROR TransformInverseCascade(ALLOCATOR *allocator,
+									TRANSFORM *transform,
+									int wavelet_count,
+									const PRESCALE prescale_table[],
+									COMPONENT_VALUE *output_buffer,
+									DIMENSION output_width,
+									DIMENSION output_height,
+									size_t output_pitch)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CASCADE cascade;
+	uint8_t *output_row_ptr = (uint8_t *)output_buffer;
+	int row;
+
+	assert(output_width > 0 && output_height > 0 && output_pitch > 0 && output_buffer != NULL);
+
+	error = InitCascade(&cascade, allocator, transform, wavelet_count, prescale_table, output_width, output_height);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	for (row = 0; row < output_height; row += 2)
+	{
+		PIXEL *even_row = (PIXEL *)output_row_ptr;
+		PIXEL *odd_row = (PIXEL *)(output_row_ptr + output_pitch);
+
+		error = CascadeOutputRows(&cascade, even_row, odd_row);
+		if (error != CODEC_ERROR_OKAY) {
+			break;
+		}
+
+		output_row_ptr += 2 * output_pitch;
+	}
+
+	ReleaseCascade(&cascade);
+
+	return error;
+}
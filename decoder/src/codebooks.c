@@ -0,0 +1,216 @@
+/*!	@file decoder/src/codebooks.c
+
+	Implementation of the routines for computing the decoding tables from a codebook.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+static int FillDecodingTable(const RLV *codes, int length, VLD *table, int offset,
+							 uint32_t prefix, int prefix_size, int table_bits);
+
+/*!
+	@brief Create a more efficient table for decoding the codewords in a codebook
+
+	This routine takes the original codebook and creates a table of decoded runs
+	and values indexed by the next bits in the bitstream.  This allows most codewords
+	and the sign bit that follows a coefficient magnitude to be decoded with a single
+	table lookup.
+
+	The decoding table is owned by the caller and must be released with the same
+	allocator by @ref ReleaseDecodingTable.  Each decoder creates its own table, so
+	decoders that use different allocators or run concurrently do not share a table.
+*/
+CODEC_ERROR CreateDecodingTable(ALLOCATOR *allocator, const CODEBOOK *codebook, const VLD_TABLE **table_out)
+{
+	// Initialize the codebook entries used to compute the decoding table
+	const RLV *codes = (const RLV *)(((const uint8_t *)codebook) + sizeof(CODEBOOK));
+	int length = codebook->length;
+
+	VLD_TABLE *decoding_table;
+	VLD *decoding_table_entries;
+	int decoding_table_length;
+	size_t decoding_table_size;
+
+	assert(table_out != NULL);
+	if (! (table_out != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	// Compute the number of entries in the primary table and all sub-tables
+	decoding_table_length = FillDecodingTable(codes, length, NULL, 0, 0, 0, VLD_TABLE_BITS);
+
+	// The offsets to the sub-tables must fit in the decoding table entries
+	assert(0 < decoding_table_length && decoding_table_length <= UINT16_MAX);
+	if (! (0 < decoding_table_length && decoding_table_length <= UINT16_MAX)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// Allocate the table for decoding runs and values
+	decoding_table_size = decoding_table_length * sizeof(VLD) + sizeof(VLD_TABLE);
+	decoding_table = AllocTagged(allocator, decoding_table_size, ALLOCATOR_TAG_CODEBOOK);
+	if (decoding_table == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	decoding_table_entries = (VLD *)(((uint8_t *)decoding_table) + sizeof(VLD_TABLE));
+
+	// Fill the primary table and the sub-tables for longer codewords
+	FillDecodingTable(codes, length, decoding_table_entries, 0, 0, 0, VLD_TABLE_BITS);
+
+	// Return the new table for decoding runs and values
+	decoding_table->length = decoding_table_length;
+	*table_out = decoding_table;
+
+	// The decoding table has been created successfully
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Free a table for decoding codewords created by @ref CreateDecodingTable
+
+	It is not an error to release a table that has not been created.
+*/
+CODEC_ERROR ReleaseDecodingTable(ALLOCATOR *allocator, const VLD_TABLE **table)
+{
+	if (table != NULL && *table != NULL)
+	{
+		Free(allocator, (void *)*table);
+		*table = NULL;
+	}
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Fill a table for decoding codewords with the specified prefix
+
+	The table is indexed by the table bits that follow the prefix in the bitstream.
+	Codewords that are not longer than the prefix and table bits are entered into
+	every table entry that starts with the codeword.  The sign bit that follows a
+	coefficient magnitude is included in the table entry if the sign bit is within
+	the table bits.
+
+	A sub-table is created for each table entry that is the prefix of longer codewords.
+	The sub-tables are allocated immediately after the table in depth-first order.
+
+	If the table is NULL, the routine only computes the number of table entries.
+
+	@return The number of entries in this table and all of its sub-tables.
+*/
+static int FillDecodingTable(const RLV *codes, int length, VLD *table, int offset,
+							 uint32_t prefix, int prefix_size, int table_bits)
+{
+	int table_length = (1 << table_bits);
+	int next_offset = offset + table_length;
+	int index;
+	int i;
+
+	if (table != NULL)
+	{
+		// Clear the table so that unused entries do not match any codeword
+		memset(&table[offset], 0, table_length * sizeof(VLD));
+
+		for (i = 0; i < length; i++)
+		{
+			int size = codes[i].size;
+			int remaining_size = size - prefix_size;
+			uint32_t remaining_bits;
+			int fill_bits;
+			uint32_t first;
+			bool signed_flag;
+
+			// Skip codewords that do not start with the prefix or extend past the table bits
+			if (! (0 < remaining_size && remaining_size <= table_bits)) continue;
+			if ((codes[i].bits >> remaining_size) != prefix) continue;
+
+			remaining_bits = codes[i].bits & BitMask(remaining_size);
+			fill_bits = table_bits - remaining_size;
+			first = (remaining_bits << fill_bits);
+
+			// Coefficient magnitudes are followed by the sign bit
+			signed_flag = (codes[i].count != 0 && codes[i].value != 0);
+
+			if (signed_flag && fill_bits > 0)
+			{
+				// The sign bit is included in the bits used to index the table
+				int half = (1 << (fill_bits - 1));
+				int j;
+
+				for (j = 0; j < 2 * half; j++)
+				{
+					VLD *entry = &table[offset + first + j];
+					bool negative = (j >= half);
+					assert(negative == (((first + j) >> (fill_bits - 1) & 1) == VLC_NEGATIVE_CODE));
+
+					entry->size = (uint8_t)size;
+					entry->flags = VLD_FLAGS_SIGNED;
+					entry->count = (uint16_t)codes[i].count;
+					entry->value = (int16_t)(negative ? neg(codes[i].value) : codes[i].value);
+				}
+			}
+			else
+			{
+				int j;
+
+				for (j = 0; j < (1 << fill_bits); j++)
+				{
+					VLD *entry = &table[offset + first + j];
+
+					entry->size = (uint8_t)size;
+					entry->flags = (signed_flag ? VLD_FLAGS_SIGN_FOLLOWS : VLD_FLAGS_NONE);
+					entry->count = (uint16_t)codes[i].count;
+					entry->value = (int16_t)codes[i].value;
+				}
+			}
+		}
+	}
+
+	// Create a sub-table for each table entry that is the prefix of longer codewords
+	for (index = 0; index < table_length; index++)
+	{
+		uint32_t subtable_prefix = (prefix << table_bits) | index;
+		int subtable_prefix_size = prefix_size + table_bits;
+		int subtable_bits = 0;
+
+		// Find the longest codeword that starts with the prefix for the sub-table
+		for (i = 0; i < length; i++)
+		{
+			int remaining_size = codes[i].size - subtable_prefix_size;
+
+			if (remaining_size > 0 && (codes[i].bits >> remaining_size) == subtable_prefix) {
+				if (remaining_size > subtable_bits) {
+					subtable_bits = remaining_size;
+				}
+			}
+		}
+
+		if (subtable_bits > 0)
+		{
+			// Limit the size of the sub-table (longer codewords are decoded using more sub-tables)
+			if (subtable_bits > VLD_SUBTABLE_BITS) {
+				subtable_bits = VLD_SUBTABLE_BITS;
+			}
+
+			if (table != NULL)
+			{
+				VLD *entry = &table[offset + index];
+
+				// The entry cannot be a codeword since the prefix of a longer codeword
+				assert(entry->size == 0);
+
+				entry->size = (uint8_t)subtable_bits;
+				entry->flags = VLD_FLAGS_SUBTABLE;
+				entry->count = (uint16_t)next_offset;
+				entry->value = 0;
+			}
+
+			// Allocate the sub-table after the tables that have already been allocated
+			next_offset += FillDecodingTable(codes, length, table, next_offset,
+											 subtable_prefix, subtable_prefix_size, subtable_bits);
+		}
+	}
+
+	return (next_offset - offset);
+}
@@ -46,6 +46,113 @@ CODEC_ERROR InitDecoder(DECODER *decoder, ALLOCATOR *allocator)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Initialize the timers for the stages of the decoding process
+
+	The application passes the timers to the decoder in the decoding parameters,
+	so the times are accumulated over all images decoded with the same parameters.
+*/
+CODEC_ERROR InitDecoderTiming(DECODER_TIMING *timing)
+{
+	int index;
+
+	assert(timing != NULL);
+	if (! (timing != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	InitTimer(&timing->read);
+
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++) {
+		InitTimer(&timing->decoding[index]);
+	}
+
+	for (index = 0; index < MAX_WAVELET_COUNT; index++) {
+		InitTimer(&timing->inverse[index]);
+	}
+
+	InitTimer(&timing->cascade);
+	InitTimer(&timing->repack);
+
+	return CODEC_ERROR_OKAY;
+}
+
+#if _TIMING
+/*!
+	@brief Print one row in the table of decoding times
+*/
+static void PrintTimingRow(FILE *file, const char *stage, TIMER *timer, TIMER *total)
+{
+	fprintf(file, "%-20s %8lld %12.3f %7.1f%%\n", stage, (long long)timer->count,
+			TimeMS(timer), TimerPercentage(timer, total));
+}
+#endif
+
+/*!
+	@brief Print the time spent in each stage of the decoding process
+
+	The subbands and wavelet transforms that were not decoded are omitted
+	from the table.  The percentages are relative to the sum of the times
+	for all stages.
+*/
+CODEC_ERROR PrintDecoderTiming(DECODER_TIMING *timing, FILE *file)
+{
+#if _TIMING
+	TIMER total;
+	char stage[32];
+	int index;
+
+	if (timing == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	InitTimer(&total);
+	AddTimer(&total, &timing->read);
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++) {
+		AddTimer(&total, &timing->decoding[index]);
+	}
+	for (index = 0; index < MAX_WAVELET_COUNT; index++) {
+		AddTimer(&total, &timing->inverse[index]);
+	}
+	AddTimer(&total, &timing->cascade);
+	AddTimer(&total, &timing->repack);
+
+	fprintf(file, "%-20s %8s %12s %8s\n", "Stage", "Calls", "Time (ms)", "Percent");
+
+	PrintTimingRow(file, "read", &timing->read, &total);
+
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++)
+	{
+		if (timing->decoding[index].count > 0) {
+			sprintf(stage, "decode subband %d", index);
+			PrintTimingRow(file, stage, &timing->decoding[index], &total);
+		}
+	}
+
+	// The inverse transforms are listed in the order in which the transforms are computed
+	for (index = MAX_WAVELET_COUNT - 1; index >= 0; index--)
+	{
+		if (timing->inverse[index].count > 0) {
+			sprintf(stage, "inverse level %d", index + 1);
+			PrintTimingRow(file, stage, &timing->inverse[index], &total);
+		}
+	}
+
+	if (timing->cascade.count > 0) {
+		PrintTimingRow(file, "inverse (all levels)", &timing->cascade, &total);
+	}
+
+	PrintTimingRow(file, "repack", &timing->repack, &total);
+
+	fprintf(file, "%-20s %8s %12.3f %7.1f%%\n", "total", "", TimeMS(&total), 100.0);
+#else
+	(void)timing;
+	(void)file;
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_METADATA)
 
 /*!
@@ -106,6 +213,9 @@ CODEC_ERROR ReleaseDecoder(DECODER *decoder)
 	ReleaseDecoderTransforms(decoder);
 	ReleaseDecoderBuffers(decoder);
 
+	// Free the table for decoding runs and values
+	ReleaseDecodingTable(decoder->allocator, &decoder->decoding_table);
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -158,6 +268,11 @@ CODEC_ERROR DecodeStream(STREAM *stream, UNPACKED_IMAGE *unpacked_image, DATABAS
 
 	// Decode the bitstream sample into a image buffer
 	error = DecodingProcess(&decoder, &bitstream, unpacked_image, database, parameters);
+	if (error != CODEC_ERROR_OKAY) {
+		ReleaseDecoder(&decoder);
+		ReleaseBitstream(&bitstream);
+		return error;
+	}
 
 #if (0 && DEBUG)
 	// Print the quantization values used for decoding (for debugging)
@@ -252,6 +367,11 @@ CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *packed_image, DATABASE *database,
 
 	// Decode the bitstream sample into a image buffer
 	error = DecodingProcess(&decoder, &bitstream, &unpacked_image, database, parameters);
+	if (error != CODEC_ERROR_OKAY) {
+		ReleaseDecoder(&decoder);
+		ReleaseBitstream(&bitstream);
+		return error;
+	}
 
 #if (0 && DEBUG)
 	// Print the quantization values used for decoding (for debugging)
@@ -269,7 +389,9 @@ CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *packed_image, DATABASE *database,
 	AllocImage(decoder.allocator, packed_image, packed_width, packed_height, packed_format);
 
 	// Pack the component arrays into the output image
+	StartTimer(STAGE_TIMER(decoder.timing, repack));
 	ImageRepackingProcess(&unpacked_image, packed_image, database, parameters);
+	StopTimer(STAGE_TIMER(decoder.timing, repack));
 
 #if (0 && DEBUG)
 	DumpTransformSubbands(&decoder, channel_mask, subband_mask, pathname);
@@ -312,6 +434,25 @@ CODEC_ERROR DecodeImage(STREAM *stream, IMAGE *packed_image, DATABASE *database,
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Decode a thumbnail image from the bitstream
+
+	This routine is the same as calling @ref DecodeImage with the resolution in the
+	parameters set to @ref RESOLUTION_EIGHTH.  The thumbnail is one eighth the width
+	and height of the image and is packed into the output pixel format specified by
+	the parameters.  A thumbnail decoded from a Bayer image is a Bayer image that can
+	be converted to RGB like the full resolution image.
+*/
+CODEC_ERROR DecodeThumbnail(STREAM *stream, PACKED_IMAGE *thumbnail, DATABASE *database, const PARAMETERS *parameters)
+{
+	PARAMETERS thumbnail_parameters = *parameters;
+
+	// Decode the image at the resolution of the lowpass band in the last wavelet
+	thumbnail_parameters.resolution = RESOLUTION_EIGHTH;
+
+	return DecodeImage(stream, thumbnail, database, &thumbnail_parameters);
+}
+
 
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
 
@@ -454,7 +595,9 @@ CODEC_ERROR DecodeLayer(DECODER *decoder, BITSTREAM *input, PACKED_IMAGE *output
     AllocImage(decoder->allocator, output, packed_width, packed_height, packed_format);
     
     // Pack the component arrays into the output image
+    StartTimer(STAGE_TIMER(decoder->timing, repack));
     ImageRepackingProcess(&unpacked_image, output, database, parameters);
+    StopTimer(STAGE_TIMER(decoder->timing, repack));
     
 #if (0 && DEBUG)
     DumpTransformSubbands(&decoder, channel_mask, subband_mask, pathname);
@@ -677,7 +820,9 @@ CODEC_ERROR DecodeImageSection(DECODER *decoder, BITSTREAM *input, PACKED_IMAGE
     AllocImage(decoder->allocator, output, packed_width, packed_height, packed_format);
     
     // Pack the component arrays into the output image
+    StartTimer(STAGE_TIMER(decoder->timing, repack));
     ImageRepackingProcess(&unpacked_image, output, database, parameters);
+    StopTimer(STAGE_TIMER(decoder->timing, repack));
     
 #if (0 && DEBUG)
     DumpTransformSubbands(&decoder, channel_mask, subband_mask, pathname);
@@ -804,6 +949,9 @@ CODEC_ERROR PrepareDecoder(DECODER *decoder, ALLOCATOR *allocator, DATABASE *dat
 		return error;
 	}
 
+	// Use the fastest inverse wavelet filters supported by the processor
+	SelectInverseKernels(GetCPUFeatures());
+
 	//TODO: Do the parameters need to be copied to the decoder in this routine?
 
 	if (parameters != NULL)
@@ -820,6 +968,22 @@ CODEC_ERROR PrepareDecoder(DECODER *decoder, ALLOCATOR *allocator, DATABASE *dat
         decoder->debug_flag = parameters->debug_flag;
         decoder->quiet_flag = parameters->quiet_flag;
 
+        // Set the number of threads used for decoding the channels
+        decoder->thread_count = parameters->thread_count;
+
+        // Record the time spent in each stage if requested by the application
+        decoder->timing = parameters->timing;
+
+        // Set the resolution of the decoded image
+        assert(RESOLUTION_FULL <= parameters->resolution && parameters->resolution <= MAX_WAVELET_COUNT);
+        if (! (RESOLUTION_FULL <= parameters->resolution && parameters->resolution <= MAX_WAVELET_COUNT)) {
+            return CODEC_ERROR_BAD_ARGUMENT;
+        }
+        decoder->resolution = parameters->resolution;
+
+        // Set the region of the image that is decoded (the entire image if the region is empty)
+        decoder->roi = parameters->roi;
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
         if (IsPartEnabled(parameters->enabled_parts, VC5_PART_LAYERS))
         {
@@ -894,8 +1058,8 @@ CODEC_ERROR DecodingProcess(DECODER *decoder, BITSTREAM *stream, UNPACKED_IMAGE
 
     //if (parameters->debug_flag) printf("DecodingProcess database: %p\n", database);
 
-	// Initialize the decoder with a default allocator
-	PrepareDecoder(decoder, NULL, database, parameters);
+	// Initialize the decoder with the allocator selected by the caller
+	PrepareDecoder(decoder, parameters->allocator, database, parameters);
 
 	// Get the bitstream start marker
 	segment = GetSegment(stream);
@@ -918,6 +1082,9 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
+	// Record the codeblocks for decoding the channels in parallel if the sample is in memory
+	decoder->deferred.enabled = (_THREADED && decoder->thread_count > 1 && input->span != NULL);
+
 	// Process tag value pairs until the layer has been decoded
 	for (;;)
 	{
@@ -991,6 +1158,13 @@ CODEC_ERROR DecodeSingleImage(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE
 	WriteLowpassBands(decoder, 3, "lowpass%d.dpx");
 #endif
 
+	// Were the codeblocks recorded instead of decoded?
+	if (decoder->deferred.enabled)
+	{
+		// Decode the codeblocks and reconstruct the output image with one thread per channel
+		return DecodeDeferredChannels(decoder, input, image);
+	}
+
 	// Reconstruct the output image using the last decoded wavelet in each channel
 	return ReconstructUnpackedImage(decoder, image);
 }
@@ -1139,6 +1313,27 @@ CODEC_ERROR SetImageChannelParameters(DECODER *decoder, int channel_number)
 }
 #endif
 
+/*!
+	@brief Create a wavelet at the specified level in the wavelet tree for one channel
+
+	The lowpass bands in the wavelets below the highest level are not used if the
+	inverse transforms are computed by the line-based cascade, which keeps the rows
+	of the intermediate lowpass bands in small ring buffers, so the lowpass bands
+	are released after the wavelet is created.
+*/
+static WAVELET *CreateDecoderWavelet(DECODER *decoder, int wavelet_index, DIMENSION width, DIMENSION height)
+{
+	WAVELET *wavelet = CreateWavelet(decoder->allocator, width, height);
+
+	if (wavelet != NULL && IsCascadeDecoded(decoder) && wavelet_index < decoder->wavelet_count - 1)
+	{
+		Free(decoder->allocator, wavelet->data[LL_BAND]);
+		wavelet->data[LL_BAND] = NULL;
+	}
+
+	return wavelet;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
 /*!
 	@brief Allocate all of the wavelets used during decoding
@@ -1155,9 +1350,6 @@ CODEC_ERROR SetImageChannelParameters(DECODER *decoder, int channel_number)
 */
 CODEC_ERROR AllocDecoderTransforms(DECODER *decoder)
 {
-	// Use the default allocator for the decoder
-
-	ALLOCATOR *allocator = decoder->allocator;
 	int channel_number;
 	int wavelet_index;
 
@@ -1208,7 +1400,12 @@ CODEC_ERROR AllocDecoderTransforms(DECODER *decoder)
 			wavelet_width /= 2;
 			wavelet_height /= 2;
 
-			wavelet = CreateWavelet(allocator, wavelet_width, wavelet_height);
+			// Do not allocate wavelets that are not used at the decoded resolution
+			if (!IsWaveletDecoded(decoder, wavelet_index)) {
+				continue;
+			}
+
+			wavelet = CreateDecoderWavelet(decoder, wavelet_index, wavelet_width, wavelet_height);
 			decoder->transform[channel_number].wavelet[wavelet_index] = wavelet;
 		}
 	}
@@ -1232,6 +1429,10 @@ CODEC_ERROR ReleaseDecoderTransforms(DECODER *decoder)
 		for (wavelet_index = 0; wavelet_index < decoder->wavelet_count; wavelet_index++)
 		{
 			WAVELET *wavelet = decoder->transform[channel_index].wavelet[wavelet_index];
+
+			// Wavelets that are not used at the decoded resolution are not allocated
+			if (wavelet == NULL) continue;
+
 			DeleteWavelet(decoder->allocator, wavelet);
             decoder->transform[channel_index].wavelet[wavelet_index] = NULL;
 		}
@@ -1320,9 +1521,10 @@ CODEC_ERROR AllocateChannelWavelets(DECODER *decoder, int channel_number)
 			}
 		}
 
-		if (wavelet == NULL)
+		// Do not allocate wavelets that are not used at the decoded resolution
+		if (wavelet == NULL && IsWaveletDecoded(decoder, wavelet_index))
 		{
-			wavelet = CreateWavelet(allocator, wavelet_width, wavelet_height);
+			wavelet = CreateDecoderWavelet(decoder, wavelet_index, wavelet_width, wavelet_height);
 			assert(wavelet != NULL);
 
 			decoder->transform[channel_number].wavelet[wavelet_index] = wavelet;
@@ -1369,6 +1571,15 @@ CODEC_ERROR PrepareDecoderState(DECODER *decoder, const PARAMETERS *parameters)
 	// Set the codebook
 	decoder->codebook = (CODEBOOK *)cs17.codebook;
 
+	// Compute the table for decoding runs and values from the codebook
+	if (decoder->decoding_table == NULL)
+	{
+		error = CreateDecodingTable(decoder->allocator, decoder->codebook, &decoder->decoding_table);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
+
 #if _DEBUG
 	// Record the pixel format of the image input to the encoder (for debugging)
 	decoder->input.format = parameters->input.format;
@@ -1413,6 +1624,10 @@ CODEC_ERROR PrepareDecoderTransforms(DECODER *decoder)
 		for (wavelet_index = 0; wavelet_index < wavelet_count; wavelet_index++)
 		{
 			WAVELET *wavelet = decoder->transform[channel_index].wavelet[wavelet_index];
+
+			// Wavelets that are not used at the decoded resolution are not allocated
+			if (wavelet == NULL) continue;
+
 			wavelet->valid_band_mask = 0;
 		}
 	}
@@ -1488,6 +1703,64 @@ CODEC_ERROR ImageRepackingProcess(const UNPACKED_IMAGE *unpacked_image,
 	return CODEC_ERROR_UNSUPPORTED_FORMAT;
 }
 
+/*!
+	@brief Set the output dimensions to the dimensions of the image decoded at reduced resolution
+
+	The dimensions of the component arrays are the dimensions of the lowpass band in the
+	wavelet at the decoded resolution or the dimensions of the region of interest in the
+	first channel.  The dimensions of a Bayer image are twice the dimensions of the grid
+	of Bayer pattern elements.  The dimensions are not changed if the entire image is
+	decoded at full resolution.
+*/
+CODEC_ERROR ReduceOutputDimensions(const DECODER *decoder,
+								   PIXEL_FORMAT output_format,
+								   DIMENSION *width,
+								   DIMENSION *height)
+{
+	const WAVELET *wavelet;
+
+	if (IsRegionDecoded(decoder))
+	{
+		ROI region;
+		CODEC_ERROR error = GetChannelRegion(decoder, 0, decoder->resolution, &region);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		*width = region.width;
+		*height = region.height;
+
+		if (IsBayerFormat(output_format))
+		{
+			*width *= 2;
+			*height *= 2;
+		}
+
+		return CODEC_ERROR_OKAY;
+	}
+
+	if (decoder->resolution == RESOLUTION_FULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	wavelet = decoder->transform[0].wavelet[decoder->resolution - 1];
+	assert(wavelet != NULL);
+	if (! (wavelet != NULL)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	*width = wavelet->width;
+	*height = wavelet->height;
+
+	if (IsBayerFormat(output_format))
+	{
+		*width *= 2;
+		*height *= 2;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
 /*!
 	@brief Compute default parameters for the repacked image
@@ -1553,6 +1826,9 @@ CODEC_ERROR SetOutputImageFormat(DECODER *decoder,
     
 	assert(output_format != PIXEL_FORMAT_UNKNOWN);
 
+	// Reduce the output dimensions if the image is decoded at reduced resolution
+	ReduceOutputDimensions(decoder, output_format, &output_width, &output_height);
+
 	if (width_out != NULL) {
 		*width_out = output_width;
 	}
@@ -1604,6 +1880,9 @@ CODEC_ERROR SetOutputImageFormat(DECODER *decoder,
 		output_height *= 2;
 	}
 
+	// Reduce the output dimensions if the image is decoded at reduced resolution
+	ReduceOutputDimensions(decoder, output_format, &output_width, &output_height);
+
 	if (width_out != NULL) {
 		*width_out = output_width;
 	}
@@ -2328,8 +2607,21 @@ CODEC_ERROR UpdateCodecState(DECODER *decoder, BITSTREAM *stream, TAGVALUE segme
             decoder->channel[channel_number].found_first_codeblock = true;
         }
         
-		// Decode the subband into its wavelet band
-		error = DecodeChannelSubband(decoder, stream, chunk_size);
+		if (!IsSubbandDecoded(decoder, codec->subband_number))
+		{
+			// Skip the subband since it is not used at the decoded resolution
+			error = SkipChannelSubband(decoder, stream, chunk_size);
+		}
+		else if (decoder->deferred.enabled)
+		{
+			// Record the location of the subband for decoding the channel in parallel
+			error = RecordChannelSubband(decoder, stream, chunk_size);
+		}
+		else
+		{
+			// Decode the subband into its wavelet band
+			error = DecodeChannelSubband(decoder, stream, chunk_size);
+		}
 	}
 
 	return error;
@@ -2720,65 +3012,11 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
 	const int channel_number = codec->channel_number;
 	const int subband_number = codec->subband_number;
 
-	// Get the index to the wavelet corresponding to this subband
-	const int index = SubbandWaveletIndex(subband_number);
-
-	// Get the index of the wavelet band corresponding to this subband
-	const int band = SubbandBandIndex(subband_number);
-
-	// Wavelet containing the band to decode
-	WAVELET *wavelet = NULL;
-
-	//TODO: Need to check that the codeblock matches the chunk size
-	(void)chunk_size;
-
 	// Allocate the wavelets for this channel if not already allocated
 	AllocateChannelWavelets(decoder, channel_number);
 
-	// Is this a highpass band?
-	if (subband_number > 0)
-	{
-		// Decode a highpass band
-
-		// Get the wavelet that contains the highpass band
-		wavelet = decoder->transform[channel_number].wavelet[index];
-
-		// The wavelets are preallocated
-		assert(wavelet != NULL);
-
-		error = DecodeHighpassBand(decoder, input, wavelet, band);
-		if (error == CODEC_ERROR_OKAY)
-		{
-			// Update the wavelet band valid flags
-			UpdateWaveletValidBandMask(wavelet, band);
-		}
-
-		// Save the quantization factor
-		wavelet->quant[band] = codec->band.quantization;
-	}
-	else
-	{
-		// Decode a lowpass band
-
-		// Get the wavelet that contains the lowpass band
-		wavelet = decoder->transform[channel_number].wavelet[index];
-
-		// The lowpass band must be subband zero
-		assert(subband_number == 0);
-
-		// The lowpass data is always stored in wavelet band zero
-		assert(band == 0);
-
-		// The wavelets are preallocated
-		assert(wavelet != NULL);
-
-		error = DecodeLowpassBand(decoder, input, wavelet);
-		if (error == CODEC_ERROR_OKAY)
-		{
-			// Update the wavelet band valid flags
-			UpdateWaveletValidBandMask(wavelet, band);
-		}
-	}
+	// Decode the coefficients in the subband into its wavelet band
+	error = DecodeSubbandCoefficients(decoder, input, chunk_size);
 
 	// Set the subband number for the next band expected in the bitstream
 	codec->subband_number++;
@@ -2788,27 +3026,13 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
 	{
 		// Record that this subband has been decoded successfully
 		SetDecodedBandMask(codec, subband_number);
+
+		// Mark the band as valid and invert the wavelet if all bands have been decoded
+		error = UpdateDecodedSubband(decoder, channel_number, subband_number);
 	}
     
     //printf("Decoded subband number: %d\n", subband_number);
 
-	// Ready to invert this wavelet to get the lowpass band in the lower wavelet?
-	if (BandsAllValid(wavelet))
-	{
-		// Apply the inverse wavelet transform to reconstruct the lower level wavelet
-		error = ReconstructWaveletBand(decoder, channel_number, wavelet, index);
-
-#if (0 && DEBUG)
-		if (ChannelLowpassBandsAllValid(decoder, index))
-		{
-			int wavelet_level = index + 1;
-
-			// Output the lowpass bands at this wavelet level (for debugging)
-			WriteLowpassBands(decoder, wavelet_level, "lowpass%d.dpx");
-		}
-#endif
-	}
-
 	// Done decoding all subbands in this channel?
 	if (codec->subband_number == codec->subband_count)
 	{
@@ -2823,68 +3047,440 @@ CODEC_ERROR DecodeChannelSubband(DECODER *decoder, BITSTREAM *input, size_t chun
 }
 
 /*!
-	@brief Invert the wavelet to reconstruct a lowpass band
-
-	The bands in the wavelet at one level are used to compute the lowpass
-	band in the wavelet at the next lower level in the transform.  Wavelet
-	levels are numbered starting at zero for the original image.  The
-	reference codec for the baseline profile uses the classic wavelet
-	tree where each wavelet at a high level depends only on the wavelet
-	at the next lower level and each wavelet is a spatial wavelet with
-	four bands.
+	@brief Decode the coefficients in the current subband into its wavelet band
 
-	This routine is called during decoding after all bands in a wavelet
-	have been decoded and the lowpass band in the wavelet at the next
-	lower level can be computed by applying the inverse wavelet transform.
+	The channel and subband are specified by the codec state.  The band is not
+	marked as valid and the codec state is not advanced to the next subband, so
+	the subbands in a channel can be decoded in any order.
 
-	This routine is not called for the wavelet at level one to reconstruct the
-	decoded component arrays.  Special routines are used to compute each component
-	array using the wavelet at level one in each channel.
-	
-	See @ref ReconstructUnpackedImage.
+	The chunk size is the size of the codeblock in segments.  If the chunk size
+	is not zero, the decoded subband must not extend past the end of the codeblock.
 */
-CODEC_ERROR ReconstructWaveletBand(DECODER *decoder, int channel, WAVELET *wavelet, int index)
+CODEC_ERROR DecodeSubbandCoefficients(DECODER *decoder, BITSTREAM *input, size_t chunk_size)
 {
-	PRESCALE prescale = decoder->codec.prescale_table[index];
-    
-#if (0 && DEBUG)
-    // Dump the lowpass bands in the wavelets at the current level
-    int wavelet_level = index + 1;
-    char pathname[PATH_MAX];
-    sprintf(pathname, "decoded-%d.nv12", wavelet_level);
-    CODEC_STATE *codec = &decoder->codec;
-    DumpTransformWavelets(decoder->transform, codec->channel_count, wavelet_level, pathname);
-#endif
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CODEC_STATE *codec = &decoder->codec;
 
-	// Is the current wavelet at a higher level than wavelet level one?
-	if (index > 0)
-	{
-		// Reconstruct the lowpass band in the lower wavelet
-		const int lowpass_index = index - 1;
-		WAVELET *lowpass;
-		int lowpass_width;
-		int lowpass_height;
+	const int channel_number = codec->channel_number;
+	const int subband_number = codec->subband_number;
 
-		lowpass = decoder->transform[channel].wavelet[lowpass_index];
-		assert(lowpass != NULL);
-		if (! (lowpass != NULL)) {
-			return CODEC_ERROR_UNEXPECTED;
-		}
+	// Get the index to the wavelet corresponding to this subband
+	const int index = SubbandWaveletIndex(subband_number);
 
-		lowpass_width = lowpass->width;
-		lowpass_height = lowpass->height;
+	// Get the index of the wavelet band corresponding to this subband
+	const int band = SubbandBandIndex(subband_number);
 
-		// Check that the reconstructed wavelet is valid
-		assert(lowpass_width > 0 && lowpass_height > 0);
+	// Wavelet containing the band to decode
+	WAVELET *wavelet = decoder->transform[channel_number].wavelet[index];
 
-		// Check that the lowpass band has not already been reconstructed
-		assert((lowpass->valid_band_mask & BandValidMask(0)) == 0);
+	// Position of the codeblock payload in the bitstream
+	size_t start = GetBitstreamPosition(input);
 
-		// Check that all of the wavelet bands have been decoded
-		assert(BandsAllValid(wavelet));
+	// The wavelets are preallocated
+	assert(wavelet != NULL);
+	if (! (wavelet != NULL)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
 
-		// Decode the lowpass band in the wavelet one lower level than the input wavelet
-		TransformInverseSpatialQuantLowpass(decoder->allocator, wavelet, lowpass, prescale);
+	StartTimer(STAGE_TIMER(decoder->timing, decoding[subband_number]));
+
+	// Is this a highpass band?
+	if (subband_number > 0)
+	{
+		// Decode a highpass band
+		error = DecodeHighpassBand(decoder, input, wavelet, band);
+
+		// Save the quantization factor
+		wavelet->quant[band] = codec->band.quantization;
+	}
+	else
+	{
+		// The lowpass data is always stored in wavelet band zero
+		assert(band == 0);
+
+		// Decode a lowpass band
+		error = DecodeLowpassBand(decoder, input, wavelet);
+	}
+
+	StopTimer(STAGE_TIMER(decoder->timing, decoding[subband_number]));
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// The decoded subband should not extend past the end of the codeblock
+	if (chunk_size > 0 && GetBitstreamPosition(input) - start > chunk_size * sizeof(SEGMENT)) {
+		return CODEC_ERROR_BITSTREAM_SYNTAX;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Mark a decoded subband as valid and invert the wavelet if all bands are valid
+
+	The lowpass band in the wavelet at the next lower level is reconstructed when the
+	last band in the wavelet that contains the subband has been decoded.
+*/
+CODEC_ERROR UpdateDecodedSubband(DECODER *decoder, int channel_number, int subband_number)
+{
+	// Get the index to the wavelet corresponding to this subband
+	const int index = SubbandWaveletIndex(subband_number);
+
+	// Get the index of the wavelet band corresponding to this subband
+	const int band = SubbandBandIndex(subband_number);
+
+	WAVELET *wavelet = decoder->transform[channel_number].wavelet[index];
+	assert(wavelet != NULL);
+	if (! (wavelet != NULL)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// Update the wavelet band valid flags
+	UpdateWaveletValidBandMask(wavelet, band);
+
+	// Ready to invert this wavelet to get the lowpass band in the lower wavelet?
+	if (BandsAllValid(wavelet))
+	{
+		// Apply the inverse wavelet transform to reconstruct the lower level wavelet
+		return ReconstructWaveletBand(decoder, channel_number, wavelet, index);
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Sum the prescale shifts up to the specified wavelet level
+*/
+int PrescaleSum(const PRESCALE *prescale_table, int wavelet_level)
+{
+	int sum = 0;
+	int index;
+	for (index = 0; index < wavelet_level; index++)
+	{
+		sum += prescale_table[index];
+	}
+	return sum;
+}
+
+/*!
+	@brief Skip a subband that is not used at the decoded resolution
+
+	The codeblock payload is skipped using the chunk size, so the subband is not
+	entropy decoded.  The codec state is updated as if the subband had been decoded
+	but the band in the wavelet is not marked as valid.
+*/
+CODEC_ERROR SkipChannelSubband(DECODER *decoder, BITSTREAM *input, int chunk_size)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CODEC_STATE *codec = &decoder->codec;
+
+	// Skip the codeblock payload
+	error = SkipPayload(input, chunk_size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Set the subband number for the next band expected in the bitstream
+	codec->subband_number++;
+
+	// Done with all subbands in this channel?
+	if (codec->subband_number == codec->subband_count)
+	{
+		// Advance to the next channel
+		codec->channel_number++;
+
+		// Reset the subband number
+		codec->subband_number = 0;
+	}
+
+	return error;
+}
+
+/*!
+	@brief Return true if the wavelet is used for decoding at the decoded resolution
+
+	The lowpass band in the wavelet at the level equal to the decoded resolution
+	is the decoded image, so the wavelets at lower levels are not used.
+*/
+bool IsWaveletDecoded(const DECODER *decoder, int wavelet_index)
+{
+	return (decoder->resolution == RESOLUTION_FULL || wavelet_index >= (int)decoder->resolution - 1);
+}
+
+/*!
+	@brief Return true if the subband must be decoded at the decoded resolution
+
+	The highpass bands in the wavelet at the level equal to the decoded resolution
+	and all lower levels are not required to reconstruct the decoded image.
+*/
+bool IsSubbandDecoded(const DECODER *decoder, int subband)
+{
+	if (subband == 0) {
+		// The lowpass band is always decoded
+		return true;
+	}
+
+	return (SubbandWaveletIndex(subband) >= (int)decoder->resolution);
+}
+
+/*!
+	@brief Return the number of subbands in each channel that are decoded at the decoded resolution
+*/
+int DecodedSubbandCount(const DECODER *decoder)
+{
+	int subband_count = 0;
+	int subband;
+
+	for (subband = 0; subband < decoder->codec.subband_count; subband++)
+	{
+		if (IsSubbandDecoded(decoder, subband)) {
+			subband_count++;
+		}
+	}
+
+	return subband_count;
+}
+
+/*!
+	@brief Return true if only a region of the image is decoded
+*/
+bool IsRegionDecoded(const DECODER *decoder)
+{
+	return (decoder->roi.width > 0 && decoder->roi.height > 0);
+}
+
+/*!
+	@brief Return true if the inverse transforms in each channel are computed by the line-based cascade
+
+	The cascade is used if the entire image is decoded at full resolution.  The lowpass
+	bands in the intermediate wavelets are not reconstructed when the bands in the wavelet
+	at the next higher level have been decoded.  Instead, the rows in the lowpass bands are
+	computed as needed while the component array is computed.  See @ref TransformInverseCascade.
+*/
+bool IsCascadeDecoded(const DECODER *decoder)
+{
+	return (decoder->resolution == RESOLUTION_FULL && !IsRegionDecoded(decoder));
+}
+
+/*!
+	@brief Compute the region of the image at the specified wavelet level that must be reconstructed
+
+	The region of interest is specified in the coordinates of the image at full resolution.
+	The region is aligned to the pattern elements and the decoded resolution so that the
+	regions in all channels correspond to the same part of the image, clipped to the image
+	dimensions, and scaled to the channel dimensions and the decoded resolution.
+
+	The region at the level of the decoded resolution is the region of the component array.
+	The region at each higher level is the region of the lowpass band in the wavelet one
+	level lower that is used by the inverse transform to compute the region one level lower.
+*/
+CODEC_ERROR GetChannelRegion(const DECODER *decoder, int channel_number, int level, ROI *region_out)
+{
+	const CODEC_STATE *codec = &decoder->codec;
+	const int resolution = decoder->resolution;
+
+	uint32_t image_width = codec->image_width;
+	uint32_t image_height = codec->image_height;
+	uint32_t channel_width = decoder->channel[channel_number].width;
+	uint32_t channel_height = decoder->channel[channel_number].height;
+	uint32_t align_x = 1;
+	uint32_t align_y = 1;
+	uint32_t x0, y0, x1, y1;
+	DIMENSION level_width;
+	DIMENSION level_height;
+	ROI region;
+	int wavelet_index;
+
+	assert(IsRegionDecoded(decoder));
+	assert(resolution <= level && level <= decoder->wavelet_count);
+	if (! (resolution <= level && level <= decoder->wavelet_count)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	if (image_width == 0 || image_height == 0 || channel_width == 0 || channel_height == 0) {
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+#if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
+	// Channels may be subsampled by the pattern dimensions
+	if (codec->pattern_width > 0 && codec->pattern_height > 0)
+	{
+		align_x = codec->pattern_width;
+		align_y = codec->pattern_height;
+	}
+#endif
+
+	// Each decoded value at reduced resolution corresponds to a block of full resolution values
+	align_x <<= resolution;
+	align_y <<= resolution;
+
+	// Align the region of interest and clip the region to the image
+	x0 = (decoder->roi.x / align_x) * align_x;
+	y0 = (decoder->roi.y / align_y) * align_y;
+	x1 = ((decoder->roi.x + decoder->roi.width + align_x - 1) / align_x) * align_x;
+	y1 = ((decoder->roi.y + decoder->roi.height + align_y - 1) / align_y) * align_y;
+
+	if (x1 > image_width) x1 = image_width;
+	if (y1 > image_height) y1 = image_height;
+
+	if (! (x0 < x1 && y0 < y1)) {
+		// The region of interest is outside the image
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+	// Scale the region to the channel dimensions
+	x0 = (x0 * channel_width) / image_width;
+	y0 = (y0 * channel_height) / image_height;
+	x1 = (x1 * channel_width + image_width - 1) / image_width;
+	y1 = (y1 * channel_height + image_height - 1) / image_height;
+
+	// Scale the region to the decoded resolution
+	x0 >>= resolution;
+	y0 >>= resolution;
+	x1 = (x1 + (1 << resolution) - 1) >> resolution;
+	y1 = (y1 + (1 << resolution) - 1) >> resolution;
+
+	// The dimensions of the decoded component array
+	if (resolution == RESOLUTION_FULL)
+	{
+		level_width = (DIMENSION)channel_width;
+		level_height = (DIMENSION)channel_height;
+	}
+	else
+	{
+		const WAVELET *wavelet = decoder->transform[channel_number].wavelet[resolution - 1];
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
+		level_width = wavelet->width;
+		level_height = wavelet->height;
+	}
+
+	if (x1 > level_width) x1 = level_width;
+	if (y1 > level_height) y1 = level_height;
+
+	region.x = (DIMENSION)x0;
+	region.y = (DIMENSION)y0;
+	region.width = (DIMENSION)(x1 - x0);
+	region.height = (DIMENSION)(y1 - y0);
+
+	// Compute the region at each higher level used by the inverse transform at the level below
+	for (wavelet_index = resolution; wavelet_index < level; wavelet_index++)
+	{
+		const WAVELET *wavelet = decoder->transform[channel_number].wavelet[wavelet_index];
+		CODEC_ERROR error;
+
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
+
+		error = InvertSpatialSupport(&region, wavelet->width, wavelet->height, &region);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
+
+	*region_out = region;
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Invert the wavelet to reconstruct a lowpass band
+
+	The bands in the wavelet at one level are used to compute the lowpass
+	band in the wavelet at the next lower level in the transform.  Wavelet
+	levels are numbered starting at zero for the original image.  The
+	reference codec for the baseline profile uses the classic wavelet
+	tree where each wavelet at a high level depends only on the wavelet
+	at the next lower level and each wavelet is a spatial wavelet with
+	four bands.
+
+	This routine is called during decoding after all bands in a wavelet
+	have been decoded and the lowpass band in the wavelet at the next
+	lower level can be computed by applying the inverse wavelet transform.
+
+	This routine is not called for the wavelet at level one to reconstruct the
+	decoded component arrays.  Special routines are used to compute each component
+	array using the wavelet at level one in each channel.
+	
+	See @ref ReconstructUnpackedImage.
+*/
+CODEC_ERROR ReconstructWaveletBand(DECODER *decoder, int channel, WAVELET *wavelet, int index)
+{
+	PRESCALE prescale = decoder->codec.prescale_table[index];
+    
+#if (0 && DEBUG)
+    // Dump the lowpass bands in the wavelets at the current level
+    int wavelet_level = index + 1;
+    char pathname[PATH_MAX];
+    sprintf(pathname, "decoded-%d.nv12", wavelet_level);
+    CODEC_STATE *codec = &decoder->codec;
+    DumpTransformWavelets(decoder->transform, codec->channel_count, wavelet_level, pathname);
+#endif
+
+	// Is the current wavelet at a higher level than wavelet level one?
+	if (index > 0)
+	{
+		// Reconstruct the lowpass band in the lower wavelet
+		const int lowpass_index = index - 1;
+		WAVELET *lowpass;
+		int lowpass_width;
+		int lowpass_height;
+
+		lowpass = decoder->transform[channel].wavelet[lowpass_index];
+		assert(lowpass != NULL);
+		if (! (lowpass != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
+
+		lowpass_width = lowpass->width;
+		lowpass_height = lowpass->height;
+
+		// Check that the reconstructed wavelet is valid
+		assert(lowpass_width > 0 && lowpass_height > 0);
+
+		// Check that the lowpass band has not already been reconstructed
+		assert((lowpass->valid_band_mask & BandValidMask(0)) == 0);
+
+		// Check that all of the wavelet bands have been decoded
+		assert(BandsAllValid(wavelet));
+
+		if (IsCascadeDecoded(decoder))
+		{
+			// The rows in the lowpass band are computed when the component array is computed
+		}
+		else if (IsRegionDecoded(decoder))
+		{
+			// Reconstruct only the region of the lowpass band used by the inverse transforms below
+			CODEC_ERROR error;
+			ROI region;
+			PIXEL *output;
+
+			error = GetChannelRegion(decoder, channel, index, &region);
+			if (error != CODEC_ERROR_OKAY) {
+				return error;
+			}
+
+			output = (PIXEL *)((uint8_t *)lowpass->data[0] + region.y * lowpass->pitch) + region.x;
+
+			StartTimer(STAGE_TIMER(decoder->timing, inverse[index]));
+			error = TransformInverseSpatialRegion(decoder->allocator, wavelet, output, lowpass->pitch,
+												  lowpass_width, lowpass_height, &region, prescale);
+			StopTimer(STAGE_TIMER(decoder->timing, inverse[index]));
+			if (error != CODEC_ERROR_OKAY) {
+				return error;
+			}
+		}
+		else
+		{
+			// Decode the lowpass band in the wavelet one lower level than the input wavelet
+			StartTimer(STAGE_TIMER(decoder->timing, inverse[index]));
+			TransformInverseSpatialQuantLowpass(decoder->allocator, wavelet, lowpass, prescale);
+			StopTimer(STAGE_TIMER(decoder->timing, inverse[index]));
+		}
 
 		// Update the band valid flags
 		UpdateWaveletValidBandMask(lowpass, 0);
@@ -2971,6 +3567,10 @@ CODEC_ERROR DecodeLowpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wave
 	The specified wavelet band is decoded from the bitstream
 	using the codebook and encoding method specified in the
 	bitstream.
+
+	The coefficients are dequantized as the band is decoded,
+	so the inverse wavelet transform does not dequantize the
+	highpass bands.
 */
 CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wavelet, int band)
 {
@@ -2986,8 +3586,9 @@ CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wav
 	// Encoded coefficients start on a tag boundary
 	AlignBitsSegment(stream);
 
-		// Decode this subband
-		error = DecodeBandRuns(stream, decoder->codebook, wavelet->data[band], width, height, wavelet->pitch);
+		// Decode and dequantize this subband
+		error = DecodeBandRunsDequantized(stream, decoder->codebook, decoder->decoding_table, wavelet->data[band],
+										  width, height, wavelet->pitch, decoder->codec.band.quantization);
 		assert(error == CODEC_ERROR_OKAY);
 
 	// Return failure if a problem was encountered while reading the band coefficients
@@ -3027,7 +3628,7 @@ CODEC_ERROR DecodeHighpassBand(DECODER *decoder, BITSTREAM *stream, WAVELET *wav
 	Special codewords in the codebook have a run length of zero.
 	The value indicates the type or purpose of the special codeword.
 */
-CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
+CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, PIXEL *data,
 						   DIMENSION width, DIMENSION height, DIMENSION pitch)
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
@@ -3052,7 +3653,7 @@ CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
 	while (data_count > 0)
 	{
 		// Get the next run length and value
-		error = GetRun(stream, codebook, &run);
+		error = GetRun(stream, codebook, table, &run);
 		if (error != CODEC_ERROR_OKAY) {
 			return error;
 		}
@@ -3091,7 +3692,126 @@ CODEC_ERROR DecodeBandRuns(BITSTREAM *stream, CODEBOOK *codebook, PIXEL *data,
 	assert(data_count == 0 && run.count == 0);
 
 	// Check for the special codeword that marks the end of the highpass band
-	error = GetRlv(stream, codebook, &run);
+	error = GetRlv(stream, codebook, table, &run);
+	if (error == CODEC_ERROR_OKAY) {
+		if (! (run.count == 0 || run.value == SPECIAL_MARKER_BAND_END)) {
+			error = CODEC_ERROR_BAND_END_MARKER;
+		}
+	}
+
+	return error;
+}
+
+/*!
+	@brief Decode and dequantize the highpass band from the bitstream
+
+	This routine is the same as @ref DecodeBandRuns except that the decoded
+	values are dequantized and the companding curve is inverted before the
+	coefficients are stored in the band.  The dequantized value for each value
+	in the codebook is computed once per band and runs of zeros are stored
+	using memset.
+*/
+CODEC_ERROR DecodeBandRunsDequantized(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, PIXEL *data,
+									  DIMENSION width, DIMENSION height, DIMENSION pitch,
+									  QUANT quantization)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	size_t data_count;
+	size_t row_padding;
+	PIXEL *rowptr = data;
+	DIMENSION column = 0;
+	RUN run = RUN_INITIALIZER;
+
+	// Dequantized value for each value that can be decoded using the codebook
+	PIXEL dequantized_table[DEQUANTIZATION_TABLE_LENGTH];
+
+	ComputeDequantizationTable(quantization, dequantized_table);
+
+	// Convert the pitch to units of pixels
+	pitch /= sizeof(PIXEL);
+
+	// Check that the band dimensions are reasonable
+	assert(width <= pitch);
+
+	// Compute the number of pixels encoded into the band
+	data_count = height * width;
+	row_padding = pitch - width;
+
+	while (data_count > 0)
+	{
+		size_t count;
+		PIXEL value;
+
+		// Get the next run length and value
+		error = GetRun(stream, codebook, table, &run);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		// Check that the run does not extend past the end of the band
+		assert(run.count <= data_count);
+		if (! (run.count <= data_count)) {
+			return CODEC_ERROR_DECODING_SUBBAND;
+		}
+
+		// Dequantize the value
+		if (-DEQUANTIZATION_TABLE_MAGNITUDE <= run.value && run.value <= DEQUANTIZATION_TABLE_MAGNITUDE) {
+			value = dequantized_table[run.value + DEQUANTIZATION_TABLE_MAGNITUDE];
+		}
+		else {
+			value = DequantizedValue(run.value, quantization);
+		}
+
+		count = run.count;
+		data_count -= count;
+
+		// Copy the value into the specified number of pixels in the band
+		while (count > 0)
+		{
+			size_t segment_count;
+
+			// Reached the end of the column?
+			if (column == width)
+			{
+				// Need to pad the end of the row?
+				if (row_padding > 0) {
+					memset(rowptr + width, 0, row_padding * sizeof(PIXEL));
+				}
+
+				// Advance to the next row
+				rowptr += pitch;
+				column = 0;
+			}
+
+			// Number of pixels in the run that are in the current row
+			segment_count = width - column;
+			if (segment_count > count) {
+				segment_count = count;
+			}
+
+			if (value == 0)
+			{
+				// Runs of zeros are the most common case
+				memset(rowptr + column, 0, segment_count * sizeof(PIXEL));
+			}
+			else
+			{
+				size_t index;
+				for (index = 0; index < segment_count; index++) {
+					rowptr[column + index] = value;
+				}
+			}
+
+			column += (DIMENSION)segment_count;
+			count -= segment_count;
+		}
+	}
+
+	// The last run should have ended at the end of the band
+	assert(data_count == 0);
+
+	// Check for the special codeword that marks the end of the highpass band
+	error = GetRlv(stream, codebook, table, &run);
 	if (error == CODEC_ERROR_OKAY) {
 		if (! (run.count == 0 || run.value == SPECIAL_MARKER_BAND_END)) {
 			error = CODEC_ERROR_BAND_END_MARKER;
@@ -3161,6 +3881,15 @@ bool IsHeaderComplete(DECODER *decoder)
 	It is only necessary to test the bands in the largest wavelet in each
 	channel since its lowpass band would not be finished if the wavelets
 	at the higher levels were incomplete.
+
+	If the codeblocks are recorded for decoding the channels in parallel,
+	then processing is complete when all codeblocks have been recorded.
+
+	If the image is decoded at reduced resolution, then processing is complete
+	when the lowpass band in the wavelet at the decoded resolution has been
+	reconstructed in each channel and the subbands that are not used at that
+	resolution have been skipped, so that the bitstream is positioned after
+	the last codeblock in the image (the next section or layer may follow).
 */
 bool IsDecodingComplete(DECODER *decoder)
 {
@@ -3175,10 +3904,32 @@ bool IsDecodingComplete(DECODER *decoder)
         int channel_count = decoder->codec.channel_count;
         int channel_index;
 
+        // The codec state advances to the next channel after the last subband in a channel is consumed
+        if (decoder->resolution != RESOLUTION_FULL && decoder->codec.channel_number < channel_count)
+        {
+            // Still skipping the subbands that are not used at the decoded resolution
+            return false;
+        }
+
         for (channel_index = 0; channel_index < channel_count; channel_index++)
         {
             WAVELET *wavelet = decoder->transform[channel_index].wavelet[0];
 
+            // Have all codeblocks in the channel been recorded for decoding later?
+            if (decoder->deferred.enabled)
+            {
+                if (decoder->deferred.codeblock_count[channel_index] < DecodedSubbandCount(decoder)) return false;
+                continue;
+            }
+
+            // Has the lowpass band at the decoded resolution been reconstructed?
+            if (decoder->resolution != RESOLUTION_FULL)
+            {
+                wavelet = decoder->transform[channel_index].wavelet[decoder->resolution - 1];
+                if (wavelet == NULL || (wavelet->valid_band_mask & BandValidMask(0)) == 0) return false;
+                continue;
+            }
+
             // Processing is not complete if the wavelet has not been allocated
             if (wavelet == NULL) return false;
 
@@ -3207,7 +3958,6 @@ bool IsDecodingComplete(DECODER *decoder)
 CODEC_ERROR ReconstructUnpackedImage(DECODER *decoder, UNPACKED_IMAGE *image)
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
-	ALLOCATOR *allocator = decoder->allocator;
 
 	int channel_count = decoder->codec.channel_count;
 	int channel_number;
@@ -3216,6 +3966,41 @@ CODEC_ERROR ReconstructUnpackedImage(DECODER *decoder, UNPACKED_IMAGE *image)
 	//assert(channel_count <= MAX_CHANNEL_COUNT);
 
 	// Allocate the vector of component arrays
+	error = AllocateComponentArrayList(decoder, image);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	for (channel_number = 0; channel_number < channel_count; channel_number++)
+	{
+		error = ReconstructComponentArray(decoder, image, channel_number);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
+
+	// One component array is output by the decoding process per channel in the bitstream
+	image->component_count = channel_count;
+    
+#if (0 && DEBUG)
+    DumpUnpackedImage(image, "decoded-0.nv12");
+#endif
+
+	return error;
+}
+
+/*!
+	@brief Allocate the vector of component arrays in the unpacked image
+
+	The component arrays are allocated when the final wavelet transform in each
+	channel is computed.  The component count is set after all component arrays
+	have been computed so that the unpacked image is always in a consistent state.
+*/
+CODEC_ERROR AllocateComponentArrayList(DECODER *decoder, UNPACKED_IMAGE *image)
+{
+	ALLOCATOR *allocator = decoder->allocator;
+	int channel_count = decoder->codec.channel_count;
+
 	size_t size = channel_count * sizeof(COMPONENT_ARRAY);
 	image->component_array_list = Alloc(allocator, size);
 	if (image->component_array_list == NULL) {
@@ -3226,44 +4011,152 @@ CODEC_ERROR ReconstructUnpackedImage(DECODER *decoder, UNPACKED_IMAGE *image)
 	image->component_count = 0;
 	memset(image->component_array_list, 0, size);
 
-	for (channel_number = 0; channel_number < channel_count; channel_number++)
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Compute the component array for one channel from the wavelet at the decoded resolution
+*/
+static CODEC_ERROR ComputeComponentArray(DECODER *decoder, UNPACKED_IMAGE *image, int channel_number)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	ALLOCATOR *allocator = decoder->allocator;
+
+	// Get the dimensions of this channel
+	DIMENSION channel_width = decoder->channel[channel_number].width;
+	DIMENSION channel_height = decoder->channel[channel_number].height;
+	PRECISION bits_per_component = decoder->channel[channel_number].bits_per_component;
+
+	// Amount of prescaling applied to the component array values before encoding
+	PRESCALE prescale = decoder->codec.prescale_table[0];
+
+	// Region of the component array that is decoded
+	ROI region;
+
+	if (IsRegionDecoded(decoder))
+	{
+		error = GetChannelRegion(decoder, channel_number, decoder->resolution, &region);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
+
+	// Decoding the image at reduced resolution?
+	if (decoder->resolution != RESOLUTION_FULL)
 	{
-		// Get the dimensions of this channel
-		DIMENSION channel_width = decoder->channel[channel_number].width;
-		DIMENSION channel_height = decoder->channel[channel_number].height;
-		PRECISION bits_per_component = decoder->channel[channel_number].bits_per_component;
+		// The component array is the lowpass band in the wavelet at the decoded resolution
+		const int wavelet_level = decoder->resolution;
+		WAVELET *wavelet = decoder->transform[channel_number].wavelet[wavelet_level - 1];
+
+		// Remove the gain of the forward transforms that was not offset by prescaling
+		int shift = 2 * wavelet_level - PrescaleSum(decoder->codec.prescale_table, wavelet_level);
+
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
 
-		// Amount of prescaling applied to the component array values before encoding
-		PRESCALE prescale = decoder->codec.prescale_table[0];
+		if (!IsRegionDecoded(decoder))
+		{
+			// The component array is the entire lowpass band
+			region.x = 0;
+			region.y = 0;
+			region.width = wavelet->width;
+			region.height = wavelet->height;
+		}
 
-		// Allocate the component array for this channel
 		error = AllocateComponentArray(allocator,
-                                       &image->component_array_list[channel_number],
-                                       channel_width,
-                                       channel_height,
-                                       bits_per_component);
-        if (error != CODEC_ERROR_OKAY) {
-            return error;
-        }
-        
-		error = TransformInverseSpatialQuantArray(allocator,
-                                                  decoder->transform[channel_number].wavelet[0],
-                                                  image->component_array_list[channel_number].data,
-                                                  channel_width,
-                                                  channel_height,
-                                                  image->component_array_list[channel_number].pitch,
-                                                  prescale);
-        if (error != CODEC_ERROR_OKAY) {
-            return error;
-        }
+									   &image->component_array_list[channel_number],
+									   region.width,
+									   region.height,
+									   bits_per_component);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		return TransformLowpassArray(wavelet,
+									 &region,
+									 image->component_array_list[channel_number].data,
+									 image->component_array_list[channel_number].pitch,
+									 shift,
+									 bits_per_component);
 	}
 
-	// One component array is output by the decoding process per channel in the bitstream
-	image->component_count = channel_count;
-    
-#if (0 && DEBUG)
-    DumpUnpackedImage(image, "decoded-0.nv12");
-#endif
+	if (IsRegionDecoded(decoder))
+	{
+		// Allocate a component array that is just large enough for the region
+		error = AllocateComponentArray(allocator,
+									   &image->component_array_list[channel_number],
+									   region.width,
+									   region.height,
+									   bits_per_component);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		return TransformInverseSpatialRegion(allocator,
+											 decoder->transform[channel_number].wavelet[0],
+											 (PIXEL *)image->component_array_list[channel_number].data,
+											 image->component_array_list[channel_number].pitch,
+											 channel_width,
+											 channel_height,
+											 &region,
+											 prescale);
+	}
+
+	// Allocate the component array for this channel
+	error = AllocateComponentArray(allocator,
+                                   &image->component_array_list[channel_number],
+                                   channel_width,
+                                   channel_height,
+                                   bits_per_component);
+    if (error != CODEC_ERROR_OKAY) {
+        return error;
+    }
+
+	if (IsCascadeDecoded(decoder))
+	{
+		// Compute the lowpass bands in the intermediate wavelets one row at a time
+		return TransformInverseCascade(allocator,
+									   &decoder->transform[channel_number],
+									   decoder->wavelet_count,
+									   decoder->codec.prescale_table,
+									   image->component_array_list[channel_number].data,
+									   channel_width,
+									   channel_height,
+									   image->component_array_list[channel_number].pitch);
+	}
+
+	error = TransformInverseSpatialQuantArray(allocator,
+                                              decoder->transform[channel_number].wavelet[0],
+                                              image->component_array_list[channel_number].data,
+                                              channel_width,
+                                              channel_height,
+                                              image->component_array_list[channel_number].pitch,
+                                              prescale);
+
+	return error;
+}
+
+/*!
+	@brief Perform the final wavelet transform in one channel to compute its component array
+
+	This routine only accesses the wavelets and component array for the specified channel,
+	so the component arrays for different channels can be computed concurrently.
+*/
+CODEC_ERROR ReconstructComponentArray(DECODER *decoder, UNPACKED_IMAGE *image, int channel_number)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+
+	// The component array is computed from the wavelet at the decoded resolution
+	int index = (decoder->resolution != RESOLUTION_FULL) ? decoder->resolution - 1 : 0;
+
+	// The cascade computes the inverse transforms at all levels together
+	TIMER *timer = IsCascadeDecoded(decoder) ? STAGE_TIMER(decoder->timing, cascade) : STAGE_TIMER(decoder->timing, inverse[index]);
+
+	StartTimer(timer);
+	error = ComputeComponentArray(decoder, image, channel_number);
+	StopTimer(timer);
 
 	return error;
 }
@@ -3674,10 +4567,9 @@ CODEC_ERROR DumpDecodedSubbands(DECODER *decoder,
 			int width = wavelet->width;
 			int height = wavelet->height;
 			void *data = wavelet->data[band_index];
-			size_t size = wavelet->width * wavelet->height * sizeof(PIXEL);
 
-			WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-							 band_index, BAND_TYPE_SINT16, width, height, data, size);
+			WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+							 band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 		}
 	}
 
@@ -3739,10 +4631,9 @@ CODEC_ERROR DumpWaveletBands(DECODER *decoder,
 			int width = wavelet->width;
 			int height = wavelet->height;
 			void *data = wavelet->data[band_index];
-			size_t size = wavelet->width * wavelet->height * sizeof(PIXEL);
 
-			WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-							 band_index, BAND_TYPE_SINT16, width, height, data, size);
+			WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+							 band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 		}
 	}
 
@@ -3814,10 +4705,9 @@ CODEC_ERROR DumpTransformBands(DECODER *decoder,
 							int width = wavelet->width;
 							int height = wavelet->height;
 							void *data = wavelet->data[band_index];
-							size_t size = wavelet->width * wavelet->height * sizeof(PIXEL);
 
-							WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-											 band_index, BAND_TYPE_SINT16, width, height, data, size);
+							WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+											 band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 						}
 					}
 				}
@@ -3890,10 +4780,9 @@ CODEC_ERROR DumpTransformSubbands(DECODER *decoder,
 					int width = wavelet->width;
 					int height = wavelet->height;
 					void *data = wavelet->data[band_index];
-					size_t size = wavelet->width * wavelet->height * sizeof(PIXEL);
 
-					WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-									 band_index, BAND_TYPE_SINT16, width, height, data, size);
+					WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+									 band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 				}
 			}
 		}
@@ -3904,20 +4793,6 @@ CODEC_ERROR DumpTransformSubbands(DECODER *decoder,
 	return CODEC_ERROR_OKAY;
 }
 
-/*!
-	@brief Sum the prescale shifts up to the specified wavelet level
-*/
-int PrescaleSum(const PRESCALE *prescale_table, int wavelet_level)
-{
-	int sum = 0;
-	int index;
-	for (index = 0; index < wavelet_level; index++)
-	{
-		sum += prescale_table[index];
-	}
-	return sum;
-}
-
 #include "dpxfile.h"
 #include "fileinfo.h"
 
@@ -77,3 +77,52 @@ PIXEL DequantizedValue(int32_t value, int quantization)
 
 	return ClampPixel(value);
 }
+
+/*!
+	@brief Compute a table of dequantized values for every decoded value
+
+	The table is indexed by the value decoded from the bitstream offset by
+	the largest magnitude in the table, so that dequantized values can be
+	computed while decoding a highpass band without invoking the inverse
+	companding curve for every coefficient.
+
+	The table entry is the same as the result from @ref DequantizedValue,
+	but values that cannot be represented as a pixel are saturated since
+	the table includes values that may not occur in the highpass band.
+*/
+CODEC_ERROR ComputeDequantizationTable(int quantization, PIXEL table[DEQUANTIZATION_TABLE_LENGTH])
+{
+	int index;
+
+	for (index = 0; index < DEQUANTIZATION_TABLE_LENGTH; index++)
+	{
+		int32_t value = index - DEQUANTIZATION_TABLE_MAGNITUDE;
+
+		// Invert the companding curve (if any)
+		value = UncompandedValue(value);
+
+		// Dequantize the absolute value
+		if (value > 0)
+		{
+			value = (quantization * value) + midpoint;
+		}
+		else if (value < 0)
+		{
+			value = neg(value);
+			value = (quantization * value) + midpoint;
+			value = neg(value);
+		}
+
+		// Saturate the dequantized coefficient
+		if (value < PIXEL_MIN) {
+			value = PIXEL_MIN;
+		}
+		else if (value > PIXEL_MAX) {
+			value = PIXEL_MAX;
+		}
+
+		table[index] = (PIXEL)value;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
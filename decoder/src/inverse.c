@@ -18,6 +18,24 @@
 static const int32_t rounding = 4;
 
 
+/*!
+	@brief Return a row of dequantized coefficients from a highpass band
+
+	The row is dequantized into the buffer if a quantization value is
+	provided, otherwise the coefficients in the highpass band have already
+	been dequantized and the row in the band is returned.
+*/
+static inline PIXEL *DequantizedBandRow(PIXEL *input, int width, QUANT quantization, PIXEL *buffer)
+{
+	if (quantization == 0) {
+		return input;
+	}
+
+	DequantizeBandRow16s(input, width, quantization, buffer);
+	return buffer;
+}
+
+
 /*!
 	@brief Apply the inverse spatial wavelet filter
 
@@ -45,6 +63,9 @@ static const int32_t rounding = 4;
 
 	Special formulas for the inverse vertical filter are applied to the top
 	and bottom rows.
+
+	If the quantization argument is NULL, then the highpass bands were
+	dequantized when the bands were decoded (see @ref InvertSpatial16s).
 */
 CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 								  PIXEL *lowlow_band, int lowlow_pitch,
@@ -77,29 +98,34 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 	PIXEL *highlow_line;
 	PIXEL *highhigh_line;
 
-	QUANT highlow_quantization = quantization[HL_BAND];
-	QUANT lowhigh_quantization = quantization[LH_BAND];
-	QUANT highhigh_quantization = quantization[HH_BAND];
+	PIXEL *lowhigh_buffer[3];
+	PIXEL *highlow_buffer;
+	PIXEL *highhigh_buffer;
+
+	// The highpass bands do not have to be dequantized if the quantization is not provided
+	QUANT highlow_quantization = (quantization != NULL) ? quantization[HL_BAND] : 0;
+	QUANT lowhigh_quantization = (quantization != NULL) ? quantization[LH_BAND] : 0;
+	QUANT highhigh_quantization = (quantization != NULL) ? quantization[HH_BAND] : 0;
 
 	// Pointer to the last row used from the LH band (for debugging)
 	PIXEL *last_lowhigh_row_ptr = NULL;
 
 	// Compute positions within the temporary buffer for each row of horizontal lowpass
 	// and highpass intermediate coefficients computed by the vertical inverse transform
-	buffer_row_size = input_width * sizeof(PIXEL);
+	buffer_row_size = ROW_BUFFER_SIZE(input_width * sizeof(PIXEL));
 
 	// Compute the positions of the even and odd rows of coefficients
-	even_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	even_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Compute the positions of the dequantized highpass rows
-	lowhigh_line[0] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[1] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[2] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highlow_line = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highhigh_line = (PIXEL *)Alloc(allocator, buffer_row_size);
+	lowhigh_buffer[0] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_buffer[1] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_buffer[2] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highlow_buffer = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highhigh_buffer = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Convert pitch from bytes to pixels
 	lowlow_pitch /= sizeof(PIXEL);
@@ -121,13 +147,13 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 	lowhigh_row[2] = lowhigh + 2 * lowhigh_pitch;
 
 	// Dequantize three rows of highpass coefficients in the first highpass band
-	DequantizeBandRow16s(lowhigh_row[0], input_width, lowhigh_quantization, lowhigh_line[0]);
-	DequantizeBandRow16s(lowhigh_row[1], input_width, lowhigh_quantization, lowhigh_line[1]);
-	DequantizeBandRow16s(lowhigh_row[2], input_width, lowhigh_quantization, lowhigh_line[2]);
+	lowhigh_line[0] = DequantizedBandRow(lowhigh_row[0], input_width, lowhigh_quantization, lowhigh_buffer[0]);
+	lowhigh_line[1] = DequantizedBandRow(lowhigh_row[1], input_width, lowhigh_quantization, lowhigh_buffer[1]);
+	lowhigh_line[2] = DequantizedBandRow(lowhigh_row[2], input_width, lowhigh_quantization, lowhigh_buffer[2]);
 
 	// Dequantize one row of coefficients each in the second and third highpass bands
-	DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-	DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
+	highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+	highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
 	for (column = 0; column < input_width; column++)
 	{
@@ -225,86 +251,16 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 	for (; row < last_row; row++)
 	{
 		// Dequantize one row from each of the two highpass bands
-		DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-		DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
-
-		// Process the entire row
-		for (column = 0; column < input_width; column++)
-		{
-			int32_t even = 0;		// Result of convolution with even filter
-			int32_t odd = 0;		// Result of convolution with odd filter
+		highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+		highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
+		// Compute the vertical inverse for the left two bands
+		InvertInteriorRows16s(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+							  highlow_line, even_lowpass, odd_lowpass, input_width);
 
-			/***** Compute the vertical inverse for the left two bands *****/
-
-			// Apply the even reconstruction filter to the lowpass band
-			even += lowlow[column + 0 * lowlow_pitch];
-			even -= lowlow[column + 2 * lowlow_pitch];
-			even += 4;
-			even >>= 3;
-			even += lowlow[column + 1 * lowlow_pitch];
-
-			// Add the highpass correction
-			even += highlow_line[column];
-			even >>= 1;
-
-			// The inverse of the left two bands should be a positive number
-			//assert(0 <= even && even <= INT16_MAX);
-
-			// Place the even result in the even row
-			even_lowpass[column] = ClampPixel(even);
-
-			// Apply the odd reconstruction filter to the lowpass band
-			odd -= lowlow[column + 0 * lowlow_pitch];
-			odd += lowlow[column + 2 * lowlow_pitch];
-			odd += 4;
-			odd >>= 3;
-			odd += lowlow[column + 1 * lowlow_pitch];
-
-			// Subtract the highpass correction
-			odd -= highlow_line[column];
-			odd >>= 1;
-
-			// The inverse of the left two bands should be a positive number
-			//assert(0 <= odd && odd <= INT16_MAX);
-
-			// Place the odd result in the odd row
-			odd_lowpass[column] = ClampPixel(odd);
-
-
-			/***** Compute the vertical inverse for the right two bands *****/
-
-			even = 0;
-			odd = 0;
-
-			// Apply the even reconstruction filter to the lowpass band
-			even += lowhigh_line[0][column];
-			even -= lowhigh_line[2][column];
-			even += 4;
-			even >>= 3;
-			even += lowhigh_line[1][column];
-
-			// Add the highpass correction
-			even += highhigh_line[column];
-			even >>= 1;
-
-			// Place the even result in the even row
-			even_highpass[column] = ClampPixel(even);
-
-			// Apply the odd reconstruction filter to the lowpass band
-			odd -= lowhigh_line[0][column];
-			odd += lowhigh_line[2][column];
-			odd += 4;
-			odd >>= 3;
-			odd += lowhigh_line[1][column];
-
-			// Subtract the highpass correction
-			odd -= highhigh_line[column];
-			odd >>= 1;
-
-			// Place the odd result in the odd row
-			odd_highpass[column] = ClampPixel(odd);
-		}
+		// Compute the vertical inverse for the right two bands
+		InvertInteriorRows16s(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+							  highhigh_line, even_highpass, odd_highpass, input_width);
 
 		// Apply the inverse horizontal transform to the even and odd rows and descale the results
 		InvertHorizontal16s(even_lowpass, even_highpass, even_output, input_width, output_width);
@@ -327,13 +283,16 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 			//PIXEL *lowhigh_row_ptr = (lowhigh + lowhigh_pitch);
 
 			// Shift the rows in the buffer of dequantized lowhigh bands
-			PIXEL *temp = lowhigh_line[0];
+			PIXEL *temp = lowhigh_buffer[0];
+			lowhigh_buffer[0] = lowhigh_buffer[1];
+			lowhigh_buffer[1] = lowhigh_buffer[2];
+			lowhigh_buffer[2] = temp;
+
 			lowhigh_line[0] = lowhigh_line[1];
 			lowhigh_line[1] = lowhigh_line[2];
-			lowhigh_line[2] = temp;
 
 			// Undo quantization for the next row in the lowhigh band
-			DequantizeBandRow16s(lowhigh_row_ptr, input_width, lowhigh_quantization, lowhigh_line[2]);
+			lowhigh_line[2] = DequantizedBandRow(lowhigh_row_ptr, input_width, lowhigh_quantization, lowhigh_buffer[2]);
 
 			// Save the pointer to the last row in the LH band (for debugging)
 			last_lowhigh_row_ptr = lowhigh_row_ptr;
@@ -353,8 +312,8 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 	assert(highhigh == (highhigh_band + last_row * highhigh_pitch));
 
 	// Undo quantization for the highlow and highhigh bands
-	DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-	DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
+	highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+	highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
 	// Apply the vertical border filter to the last row
 	for (column = 0; column < input_width; column++)
@@ -448,11 +407,11 @@ CODEC_ERROR InvertSpatialQuant16s(ALLOCATOR *allocator,
 	Free(allocator, odd_lowpass);
 	Free(allocator, odd_highpass);
 
-	Free(allocator, lowhigh_line[0]);
-	Free(allocator, lowhigh_line[1]);
-	Free(allocator, lowhigh_line[2]);
-	Free(allocator, highlow_line);
-	Free(allocator, highhigh_line);
+	Free(allocator, lowhigh_buffer[0]);
+	Free(allocator, lowhigh_buffer[1]);
+	Free(allocator, lowhigh_buffer[2]);
+	Free(allocator, highlow_buffer);
+	Free(allocator, highhigh_buffer);
 
 	return CODEC_ERROR_OKAY;
 }
@@ -519,51 +478,9 @@ CODEC_ERROR InvertHorizontal16s(PIXEL *lowpass,			//!< Horizontal lowpass coeffi
 	column++;
 
 	// Process the rest of the columns up to the last column in the row
-	for (; column < last_column; column++)
-	{
-		int32_t even = 0;		// Result of convolution with even filter
-		int32_t odd = 0;		// Result of convolution with odd filter
-
-		// Apply the even reconstruction filter to the lowpass band
-
-		even += lowpass[column - 1];
-		even -= lowpass[column + 1];
-		even += 4;
-		even >>= 3;
-		even += lowpass[column + 0];
-
-		// Add the highpass correction
-		even += highpass[column];
-		even >>= 1;
-
-		// The lowpass result should be a positive number
-		//assert(0 <= even && even <= INT16_MAX);
-
-		// Place the even result in the even column
-		//output[2 * column + 0] = clamp_uint12(even);
-        output[2 * column + 0] = ClampPixel(even);
-
-		// Apply the odd reconstruction filter to the lowpass band
-		odd -= lowpass[column - 1];
-		odd += lowpass[column + 1];
-		odd += 4;
-		odd >>= 3;
-		odd += lowpass[column + 0];
-
-		// Subtract the highpass correction
-		odd -= highpass[column];
-		odd >>= 1;
-
-		// The lowpass result should be a positive number
-		//assert(0 <= odd && odd <= INT16_MAX);
-
-		// Place the odd result in the odd column
-		//output[2 * column + 1] = clamp_uint12(odd);
-        output[2 * column + 1] = ClampPixel(odd);
-	}
-
-	// Should have exited the loop at the column for right border processing
-	assert(column == last_column);
+	InvertInteriorColumns16s(&lowpass[column], &highpass[column], &output[2 * column],
+							 last_column - column, -1);
+	column = last_column;
 
 	// Process the last two output points with special filters for the right border
 	even = 0;
@@ -614,6 +531,9 @@ CODEC_ERROR InvertHorizontal16s(PIXEL *lowpass,			//!< Horizontal lowpass coeffi
 
 	This routine is similar to @ref InvertSpatialQuant16s, but a scale factor
 	that was applied during encoding is removed from the output values.
+
+	If the quantization argument is NULL, then the highpass bands were
+	dequantized when the bands were decoded (see @ref InvertSpatialDescale16s).
 */
 CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 										 PIXEL *lowlow_band, int lowlow_pitch,
@@ -646,29 +566,34 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 	PIXEL *highlow_line;
 	PIXEL *highhigh_line;
 
-	QUANT highlow_quantization = quantization[HL_BAND];
-	QUANT lowhigh_quantization = quantization[LH_BAND];
-	QUANT highhigh_quantization = quantization[HH_BAND];
+	PIXEL *lowhigh_buffer[3];
+	PIXEL *highlow_buffer;
+	PIXEL *highhigh_buffer;
+
+	// The highpass bands do not have to be dequantized if the quantization is not provided
+	QUANT highlow_quantization = (quantization != NULL) ? quantization[HL_BAND] : 0;
+	QUANT lowhigh_quantization = (quantization != NULL) ? quantization[LH_BAND] : 0;
+	QUANT highhigh_quantization = (quantization != NULL) ? quantization[HH_BAND] : 0;
 
 	// Pointer to the last row used from the LH band (for debugging)
 	PIXEL *last_lowhigh_row_ptr = NULL;
 
 	// Compute positions within the temporary buffer for each row of horizontal lowpass
 	// and highpass intermediate coefficients computed by the vertical inverse transform
-	buffer_row_size = input_width * sizeof(PIXEL);
+	buffer_row_size = ROW_BUFFER_SIZE(input_width * sizeof(PIXEL));
 
 	// Allocate space for the even and odd rows of results from the inverse vertical filter
-	even_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	even_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Allocate scratch space for the dequantized highpass coefficients
-	lowhigh_line[0] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[1] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[2] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highlow_line = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highhigh_line = (PIXEL *)Alloc(allocator, buffer_row_size);
+	lowhigh_buffer[0] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_buffer[1] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_buffer[2] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highlow_buffer = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highhigh_buffer = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Convert pitch from bytes to pixels
 	lowlow_pitch /= sizeof(PIXEL);
@@ -690,13 +615,13 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 	lowhigh_row[2] = lowhigh + 2 * lowhigh_pitch;
 
 	// Dequantize three rows of highpass coefficients in the first highpass band
-	DequantizeBandRow16s(lowhigh_row[0], input_width, lowhigh_quantization, lowhigh_line[0]);
-	DequantizeBandRow16s(lowhigh_row[1], input_width, lowhigh_quantization, lowhigh_line[1]);
-	DequantizeBandRow16s(lowhigh_row[2], input_width, lowhigh_quantization, lowhigh_line[2]);
+	lowhigh_line[0] = DequantizedBandRow(lowhigh_row[0], input_width, lowhigh_quantization, lowhigh_buffer[0]);
+	lowhigh_line[1] = DequantizedBandRow(lowhigh_row[1], input_width, lowhigh_quantization, lowhigh_buffer[1]);
+	lowhigh_line[2] = DequantizedBandRow(lowhigh_row[2], input_width, lowhigh_quantization, lowhigh_buffer[2]);
 
 	// Dequantize one row of coefficients each in the second and third highpass bands
-	DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-	DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
+	highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+	highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
 	for (column = 0; column < input_width; column++)
 	{
@@ -797,86 +722,16 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 	for (; row < last_row; row++)
 	{
 		// Dequantize one row from each of the two highpass bands
-		DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-		DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
-
-		// Process the entire row
-		for (column = 0; column < input_width; column++)
-		{
-			int32_t even = 0;		// Result of convolution with even filter
-			int32_t odd = 0;		// Result of convolution with odd filter
-
-
-			/***** Compute the vertical inverse for the left two bands *****/
-
-			// Apply the even reconstruction filter to the lowpass band
-			even += lowlow[column + 0 * lowlow_pitch];
-			even -= lowlow[column + 2 * lowlow_pitch];
-			even += 4;
-			even >>= 3;
-			even += lowlow[column + 1 * lowlow_pitch];
-
-			// Add the highpass correction
-			even += highlow_line[column];
-			even = DivideByShift(even, 1);
-
-			// The inverse of the left two bands should be a positive number
-			//assert(0 <= even && even <= INT16_MAX);
-
-			// Place the even result in the even row
-			even_lowpass[column] = ClampPixel(even);
-
-			// Apply the odd reconstruction filter to the lowpass band
-			odd -= lowlow[column + 0 * lowlow_pitch];
-			odd += lowlow[column + 2 * lowlow_pitch];
-			odd += 4;
-			odd >>= 3;
-			odd += lowlow[column + 1 * lowlow_pitch];
-
-			// Subtract the highpass correction
-			odd -= highlow_line[column];
-			odd = DivideByShift(odd, 1);
-
-			// The inverse of the left two bands should be a positive number
-			//assert(0 <= odd && odd <= INT16_MAX);
-
-			// Place the odd result in the odd row
-			odd_lowpass[column] = ClampPixel(odd);
-
-
-			/***** Compute the vertical inverse for the right two bands *****/
-
-			even = 0;
-			odd = 0;
-
-			// Apply the even reconstruction filter to the lowpass band
-			even += lowhigh_line[0][column];
-			even -= lowhigh_line[2][column];
-			even += 4;
-			even >>= 3;
-			even += lowhigh_line[1][column];
-
-			// Add the highpass correction
-			even += highhigh_line[column];
-			even = DivideByShift(even, 1);
-
-			// Place the even result in the even row
-			even_highpass[column] = ClampPixel(even);
-
-			// Apply the odd reconstruction filter to the lowpass band
-			odd -= lowhigh_line[0][column];
-			odd += lowhigh_line[2][column];
-			odd += 4;
-			odd >>= 3;
-			odd += lowhigh_line[1][column];
+		highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+		highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
-			// Subtract the highpass correction
-			odd -= highhigh_line[column];
-			odd = DivideByShift(odd, 1);
+		// Compute the vertical inverse for the left two bands
+		InvertInteriorRows16s(lowlow, lowlow + lowlow_pitch, lowlow + 2 * lowlow_pitch,
+							  highlow_line, even_lowpass, odd_lowpass, input_width);
 
-			// Place the odd result in the odd row
-			odd_highpass[column] = ClampPixel(odd);
-		}
+		// Compute the vertical inverse for the right two bands
+		InvertInteriorRows16s(lowhigh_line[0], lowhigh_line[1], lowhigh_line[2],
+							  highhigh_line, even_highpass, odd_highpass, input_width);
 
 		// Apply the inverse horizontal transform to the even and odd rows and descale the results
 		InvertHorizontalDescale16s(even_lowpass, even_highpass, even_output,
@@ -901,13 +756,16 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 			PIXEL *lowhigh_row_ptr = (lowhigh + 2 * lowhigh_pitch);
 
 			// Shift the rows in the buffer of dequantized lowhigh bands
-			PIXEL *temp = lowhigh_line[0];
+			PIXEL *temp = lowhigh_buffer[0];
+			lowhigh_buffer[0] = lowhigh_buffer[1];
+			lowhigh_buffer[1] = lowhigh_buffer[2];
+			lowhigh_buffer[2] = temp;
+
 			lowhigh_line[0] = lowhigh_line[1];
 			lowhigh_line[1] = lowhigh_line[2];
-			lowhigh_line[2] = temp;
 
 			// Undo quantization for the next row in the lowhigh band
-			DequantizeBandRow16s(lowhigh_row_ptr, input_width, lowhigh_quantization, lowhigh_line[2]);
+			lowhigh_line[2] = DequantizedBandRow(lowhigh_row_ptr, input_width, lowhigh_quantization, lowhigh_buffer[2]);
 
 			// Save the pointer to the last row in the LH band (for debugging)
 			last_lowhigh_row_ptr = lowhigh_row_ptr;
@@ -927,8 +785,8 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 	assert(highhigh == (highhigh_band + last_row * highhigh_pitch));
 
 	// Undo quantization for the highlow and highhigh bands
-	DequantizeBandRow16s(highlow, input_width, highlow_quantization, highlow_line);
-	DequantizeBandRow16s(highhigh, input_width, highhigh_quantization, highhigh_line);
+	highlow_line = DequantizedBandRow(highlow, input_width, highlow_quantization, highlow_buffer);
+	highhigh_line = DequantizedBandRow(highhigh, input_width, highhigh_quantization, highhigh_buffer);
 
 	// Apply the vertical border filter to the last row
 	for (column = 0; column < input_width; column++)
@@ -1024,15 +882,70 @@ CODEC_ERROR InvertSpatialQuantDescale16s(ALLOCATOR *allocator,
 	Free(allocator, odd_lowpass);
 	Free(allocator, odd_highpass);
 
-	Free(allocator, lowhigh_line[0]);
-	Free(allocator, lowhigh_line[1]);
-	Free(allocator, lowhigh_line[2]);
-	Free(allocator, highlow_line);
-	Free(allocator, highhigh_line);
+	Free(allocator, lowhigh_buffer[0]);
+	Free(allocator, lowhigh_buffer[1]);
+	Free(allocator, lowhigh_buffer[2]);
+	Free(allocator, highlow_buffer);
+	Free(allocator, highhigh_buffer);
 
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Apply the inverse spatial wavelet filter to dequantized bands
+
+	This routine is the same as @ref InvertSpatialQuant16s except that the
+	coefficients in the highpass bands were dequantized by the entropy decoder,
+	so the rows in the highpass bands are used without another pass to undo
+	quantization.
+*/
+CODEC_ERROR InvertSpatial16s(ALLOCATOR *allocator,
+							 PIXEL *lowlow_band, int lowlow_pitch,
+							 PIXEL *lowhigh_band, int lowhigh_pitch,
+							 PIXEL *highlow_band, int highlow_pitch,
+							 PIXEL *highhigh_band, int highhigh_pitch,
+							 PIXEL *output_image, int output_pitch,
+							 DIMENSION input_width, DIMENSION input_height,
+							 DIMENSION output_width, DIMENSION output_height)
+{
+	return InvertSpatialQuant16s(allocator,
+								 lowlow_band, lowlow_pitch,
+								 lowhigh_band, lowhigh_pitch,
+								 highlow_band, highlow_pitch,
+								 highhigh_band, highhigh_pitch,
+								 output_image, output_pitch,
+								 input_width, input_height,
+								 output_width, output_height,
+								 NULL);
+}
+
+/*!
+	@brief Apply the inverse spatial transform with descaling to dequantized bands
+
+	This routine is the same as @ref InvertSpatialQuantDescale16s except that
+	the coefficients in the highpass bands were dequantized by the entropy decoder.
+*/
+CODEC_ERROR InvertSpatialDescale16s(ALLOCATOR *allocator,
+									PIXEL *lowlow_band, int lowlow_pitch,
+									PIXEL *lowhigh_band, int lowhigh_pitch,
+									PIXEL *highlow_band, int highlow_pitch,
+									PIXEL *highhigh_band, int highhigh_pitch,
+									PIXEL *output_image, int output_pitch,
+									DIMENSION input_width, DIMENSION input_height,
+									DIMENSION output_width, DIMENSION output_height,
+									int descale)
+{
+	return InvertSpatialQuantDescale16s(allocator,
+										lowlow_band, lowlow_pitch,
+										lowhigh_band, lowhigh_pitch,
+										highlow_band, highlow_pitch,
+										highhigh_band, highhigh_pitch,
+										output_image, output_pitch,
+										input_width, input_height,
+										output_width, output_height,
+										descale, NULL);
+}
+
 
 /*!
 	@brief Apply the inverse spatial transform with descaling
@@ -1079,20 +992,20 @@ CODEC_ERROR InvertSpatialWavelet(ALLOCATOR *allocator,
 
 	// Compute positions within the temporary buffer for each row of horizontal lowpass
 	// and highpass intermediate coefficients computed by the vertical inverse transform
-	buffer_row_size = input_width * sizeof(PIXEL);
+	buffer_row_size = ROW_BUFFER_SIZE(input_width * sizeof(PIXEL));
 
 	// Allocate space for the even and odd rows of results from the inverse vertical filter
-	even_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	even_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, buffer_row_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, buffer_row_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Allocate scratch space for the dequantized highpass coefficients
-	lowhigh_line[0] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[1] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	lowhigh_line[2] = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highlow_line = (PIXEL *)Alloc(allocator, buffer_row_size);
-	highhigh_line = (PIXEL *)Alloc(allocator, buffer_row_size);
+	lowhigh_line[0] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_line[1] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	lowhigh_line[2] = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highlow_line = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	highhigh_line = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// Convert pitch from bytes to pixels
 	lowlow_pitch /= sizeof(PIXEL);
@@ -1511,52 +1424,9 @@ CODEC_ERROR InvertHorizontalDescale16s(PIXEL *lowpass, PIXEL *highpass, PIXEL *o
 	column++;
 
 	// Process the rest of the columns up to the last column in the row
-	for (; column < last_column; column++)
-	{
-		int32_t even = 0;		// Result of convolution with even filter
-		int32_t odd = 0;		// Result of convolution with odd filter
-
-		// Apply the even reconstruction filter to the lowpass band
-		even += lowpass[column - 1];
-		even -= lowpass[column + 1];
-		even += 4;
-		even >>= 3;
-		even += lowpass[column + 0];
-
-		// Add the highpass correction
-		even += highpass[column];
-
-		// Remove any scaling used during encoding
-		even <<= descale_shift;
-
-		// The lowpass result should be a positive number
-		//assert(0 <= even && even <= INT16_MAX);
-
-		// Place the even result in the even column
-		output[2 * column + 0] = ClampPixel(even);
-
-		// Apply the odd reconstruction filter to the lowpass band
-		odd -= lowpass[column - 1];
-		odd += lowpass[column + 1];
-		odd += 4;
-		odd >>= 3;
-		odd += lowpass[column + 0];
-
-		// Subtract the highpass correction
-		odd -= highpass[column];
-
-		// Remove any scaling used during encoding
-		odd <<= descale_shift;
-
-		// The lowpass result should be a positive number
-		//assert(0 <= odd && odd <= INT16_MAX);
-
-		// Place the odd result in the odd column
-		output[2 * column + 1] = ClampPixel(odd);
-	}
-
-	// Should have exited the loop at the column for right border processing
-	assert(column == last_column);
+	InvertInteriorColumns16s(&lowpass[column], &highpass[column], &output[2 * column],
+							 last_column - column, descale_shift);
+	column = last_column;
 
 	// Process the last two output points with special filters for the right border
 	even = 0;
@@ -1634,7 +1504,7 @@ CODEC_ERROR InvertSpatialTopRow(PIXEL **input_data[], DIMENSION input_width[], D
 	// Compute the maximum size of the intermediate results from the inverse vertical transform
 	for (channel = 0; channel < channel_count; channel++)
 	{
-		size_t buffer_row_size = input_width[channel] * sizeof(PIXEL);
+		size_t buffer_row_size = ROW_BUFFER_SIZE(input_width[channel] * sizeof(PIXEL));
 
 		if (vertical_buffer_size < buffer_row_size) {
 			vertical_buffer_size = buffer_row_size;
@@ -1645,10 +1515,10 @@ CODEC_ERROR InvertSpatialTopRow(PIXEL **input_data[], DIMENSION input_width[], D
 	}
 
 	// Allocate buffers for the even and odd rows of vertical transform results
-	even_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	even_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// This routine should be called for the first row only
 	assert(input_row == 0);
@@ -1796,7 +1666,7 @@ CODEC_ERROR InvertSpatialMiddleRow(PIXEL **input_data[], DIMENSION input_width[]
 	// Compute the maximum size of the intermediate results from the inverse vertical transform
 	for (channel = 0; channel < channel_count; channel++)
 	{
-		size_t buffer_row_size = input_width[channel] * sizeof(PIXEL);
+		size_t buffer_row_size = ROW_BUFFER_SIZE(input_width[channel] * sizeof(PIXEL));
 
 		if (vertical_buffer_size < buffer_row_size) {
 			vertical_buffer_size = buffer_row_size;
@@ -1807,10 +1677,10 @@ CODEC_ERROR InvertSpatialMiddleRow(PIXEL **input_data[], DIMENSION input_width[]
 	}
 
 	// Allocate buffers for the even and odd rows of vertical transform results
-	even_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	even_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// This routine should not be called to process the first or last row
 	assert(input_row > 0);
@@ -1967,7 +1837,7 @@ CODEC_ERROR InvertSpatialBottomRow(PIXEL **input_data[], DIMENSION input_width[]
 	// Compute the maximum size of the intermediate results from the inverse vertical transform
 	for (channel = 0; channel < channel_count; channel++)
 	{
-		size_t buffer_row_size = input_width[channel] * sizeof(PIXEL);
+		size_t buffer_row_size = ROW_BUFFER_SIZE(input_width[channel] * sizeof(PIXEL));
 
 		if (vertical_buffer_size < buffer_row_size) {
 			vertical_buffer_size = buffer_row_size;
@@ -1978,10 +1848,10 @@ CODEC_ERROR InvertSpatialBottomRow(PIXEL **input_data[], DIMENSION input_width[]
 	}
 
 	// Allocate buffers for the even and odd rows of vertical transform results
-	even_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	even_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_lowpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
-	odd_highpass = (PIXEL *)Alloc(allocator, vertical_buffer_size);
+	even_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, vertical_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 	// This routine should be called for the last row only
 	assert(input_row > 0);
@@ -2270,3 +2140,391 @@ CODEC_ERROR InvertHorizontalScaled16s(PIXEL *lowpass,
 
 	return CODEC_ERROR_OKAY;
 }
+
+/*!
+	@brief Compute the region of the input bands used to reconstruct a region of the output
+
+	Each pair of output values depends on one coefficient in each highpass band and on
+	three coefficients in the lowpass band.  The border filters use the first three or
+	the last three lowpass coefficients.  The input region is the region of the lowpass
+	band required by the inverse transform; the highpass bands are only accessed within
+	the rows and columns that correspond to the output region.
+*/
+CODEC_ERROR InvertSpatialSupport(const ROI *output_region,
+								 DIMENSION input_width, DIMENSION input_height,
+								 ROI *input_region)
+{
+	// Input rows and columns (inclusive) that produce the rows and columns in the output region
+	int first_column = output_region->x / 2;
+	int last_column = (output_region->x + output_region->width - 1) / 2;
+	int first_row = output_region->y / 2;
+	int last_row = (output_region->y + output_region->height - 1) / 2;
+
+	assert(output_region->width > 0 && output_region->height > 0);
+	if (! (output_region->width > 0 && output_region->height > 0)) {
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+	assert(last_column < input_width && last_row < input_height);
+	if (! (last_column < input_width && last_row < input_height)) {
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+	// Extend the region by the support of the filters applied to the lowpass band
+	first_column = LowpassSupportFirst(first_column, input_width);
+	last_column = LowpassSupportLast(last_column, input_width);
+	first_row = LowpassSupportFirst(first_row, input_height);
+	last_row = LowpassSupportLast(last_row, input_height);
+
+	input_region->x = (DIMENSION)first_column;
+	input_region->y = (DIMENSION)first_row;
+	input_region->width = (DIMENSION)(last_column - first_column + 1);
+	input_region->height = (DIMENSION)(last_row - first_row + 1);
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Apply the inverse wavelet filter at one position in a row or column
+
+	The three lowpass coefficients are the coefficients used by the filter at the
+	specified position, starting with the coefficient at the position returned by
+	@ref LowpassSupportFirst, so the same filter is used for the vertical and
+	horizontal transforms.
+
+	The results do not include the final division by two, which is different
+	for the transforms that remove the scaling applied during encoding.
+*/
+static inline void InvertSpatialFilter(int32_t lowpass0, int32_t lowpass1, int32_t lowpass2,
+									   int position, int last_position,
+									   int32_t highpass,
+									   int32_t *even_out, int32_t *odd_out)
+{
+	int32_t even = 0;
+	int32_t odd = 0;
+
+	if (position == 0)
+	{
+		// Apply the border filters at the start of the row or column
+		even += 11 * lowpass0;
+		even -=  4 * lowpass1;
+		even +=  1 * lowpass2;
+		even += rounding;
+		even = DivideByShift(even, 3);
+
+		odd += 5 * lowpass0;
+		odd += 4 * lowpass1;
+		odd -= 1 * lowpass2;
+		odd += rounding;
+		odd = DivideByShift(odd, 3);
+	}
+	else if (position == last_position)
+	{
+		// Apply the border filters at the end of the row or column
+		even += 5 * lowpass2;
+		even += 4 * lowpass1;
+		even -= 1 * lowpass0;
+		even += rounding;
+		even = DivideByShift(even, 3);
+
+		odd += 11 * lowpass2;
+		odd -=  4 * lowpass1;
+		odd +=  1 * lowpass0;
+		odd += rounding;
+		odd = DivideByShift(odd, 3);
+	}
+	else
+	{
+		// Apply the interior filters
+		even += lowpass0;
+		even -= lowpass2;
+		even += 4;
+		even >>= 3;
+		even += lowpass1;
+
+		odd -= lowpass0;
+		odd += lowpass2;
+		odd += 4;
+		odd >>= 3;
+		odd += lowpass1;
+	}
+
+	// Add the highpass correction to the even result and subtract from the odd result
+	*even_out = even + highpass;
+	*odd_out = odd - highpass;
+}
+
+/*!
+	@brief Apply the inverse horizontal transform to the columns that produce a region of the output row
+
+	The output row is indexed by the output column, so the output values are computed
+	in the same positions as the output of @ref InvertHorizontal16s.  The results
+	are divided by two unless the descale argument is nonzero, which is the same as
+	the computation in @ref InvertHorizontalDescale16s.
+*/
+static void InvertHorizontalRegion16s(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+									  int first_column, int last_column,
+									  DIMENSION input_width, int descale)
+{
+	// Remove the scaling applied during encoding instead of dividing by two
+	const int descale_shift = (descale == 2) ? 1 : 0;
+	int column;
+
+	for (column = first_column; column <= last_column; column++)
+	{
+		const int first = LowpassSupportFirst(column, input_width);
+		int32_t even;
+		int32_t odd;
+
+		InvertSpatialFilter(lowpass[first], lowpass[first + 1], lowpass[first + 2],
+							column, input_width - 1, highpass[column], &even, &odd);
+
+		if (descale == 0)
+		{
+			even = DivideByShift(even, 1);
+			odd = DivideByShift(odd, 1);
+		}
+		else
+		{
+			even <<= descale_shift;
+			odd <<= descale_shift;
+		}
+
+		output[2 * column + 0] = ClampPixel(even);
+		output[2 * column + 1] = ClampPixel(odd);
+	}
+}
+
+/*!
+	@brief Apply the inverse spatial transform to reconstruct a region of the output
+
+	This routine computes the same output values as @ref InvertSpatial16s (if the descale
+	argument is zero) or @ref InvertSpatialDescale16s, but only the output values in the
+	region are computed.  The inverse vertical filter is applied only to the input rows
+	that produce output rows in the region and only to the columns required by the inverse
+	horizontal filter.  The inverse horizontal filter is applied only to the columns that
+	produce output columns in the region.
+
+	The output image points to the first value in the region and the output pitch is the
+	distance between rows in the region, so the output may be a buffer that is just large
+	enough for the region.  The highpass bands must have been dequantized when the bands
+	were decoded.
+*/
+CODEC_ERROR InvertSpatialRegion16s(ALLOCATOR *allocator,
+								   PIXEL *lowlow_band, int lowlow_pitch,
+								   PIXEL *lowhigh_band, int lowhigh_pitch,
+								   PIXEL *highlow_band, int highlow_pitch,
+								   PIXEL *highhigh_band, int highhigh_pitch,
+								   PIXEL *output_image, int output_pitch,
+								   DIMENSION input_width, DIMENSION input_height,
+								   DIMENSION output_width, DIMENSION output_height,
+								   const ROI *region, int descale)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	const int last_input_row = input_height - 1;
+	const int first_output_row = region->y;
+	const int last_output_row = region->y + region->height - 1;
+
+	// Input rows and columns that produce the output region
+	const int first_row = region->y / 2;
+	const int last_row = (region->y + region->height - 1) / 2;
+	const int first_column = region->x / 2;
+	const int last_column = (region->x + region->width - 1) / 2;
+
+	// Region of the lowpass band used by the inverse transform
+	ROI support;
+
+	PIXEL *even_lowpass;
+	PIXEL *even_highpass;
+	PIXEL *odd_lowpass;
+	PIXEL *odd_highpass;
+	PIXEL *output_buffer;
+	size_t buffer_row_size;
+	int row;
+
+	assert(region->x + region->width <= output_width && region->y + region->height <= output_height);
+	if (! (region->x + region->width <= output_width && region->y + region->height <= output_height)) {
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+	error = InvertSpatialSupport(region, input_width, input_height, &support);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Allocate rows for the results of the inverse vertical filter indexed by the input column
+	buffer_row_size = ROW_BUFFER_SIZE(input_width * sizeof(PIXEL));
+	even_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	even_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_lowpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+	odd_highpass = (PIXEL *)AllocTagged(allocator, buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+
+	// Allocate a row for the results of the inverse horizontal filter indexed by the output column
+	output_buffer = (PIXEL *)AllocTagged(allocator, 2 * buffer_row_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+
+	if (even_lowpass == NULL || even_highpass == NULL ||
+		odd_lowpass == NULL || odd_highpass == NULL || output_buffer == NULL)
+	{
+		error = CODEC_ERROR_OUTOFMEMORY;
+		goto finish;
+	}
+
+	// Convert pitch from bytes to pixels
+	lowlow_pitch /= sizeof(PIXEL);
+	lowhigh_pitch /= sizeof(PIXEL);
+	highlow_pitch /= sizeof(PIXEL);
+	highhigh_pitch /= sizeof(PIXEL);
+	output_pitch /= sizeof(PIXEL);
+
+	for (row = first_row; row <= last_row; row++)
+	{
+		// The inverse vertical filter uses three rows in the lowlow and lowhigh bands
+		const int first = LowpassSupportFirst(row, input_height);
+		const PIXEL *lowlow = lowlow_band + first * lowlow_pitch;
+		const PIXEL *lowhigh = lowhigh_band + first * lowhigh_pitch;
+		const PIXEL *highlow = highlow_band + row * highlow_pitch;
+		const PIXEL *highhigh = highhigh_band + row * highhigh_pitch;
+		int even_row = 2 * row;
+		int odd_row = 2 * row + 1;
+		int column;
+
+		// Apply the inverse vertical filter to the columns used by the inverse horizontal filter
+		for (column = support.x; column < support.x + support.width; column++)
+		{
+			int32_t even;
+			int32_t odd;
+
+			// Compute the vertical inverse for the left two bands
+			InvertSpatialFilter(lowlow[column], lowlow[column + lowlow_pitch], lowlow[column + 2 * lowlow_pitch],
+								row, last_input_row, highlow[column], &even, &odd);
+			even_lowpass[column] = ClampPixel(DivideByShift(even, 1));
+			odd_lowpass[column] = ClampPixel(DivideByShift(odd, 1));
+
+			// Compute the vertical inverse for the right two bands
+			InvertSpatialFilter(lowhigh[column], lowhigh[column + lowhigh_pitch], lowhigh[column + 2 * lowhigh_pitch],
+								row, last_input_row, highhigh[column], &even, &odd);
+			even_highpass[column] = ClampPixel(DivideByShift(even, 1));
+			odd_highpass[column] = ClampPixel(DivideByShift(odd, 1));
+		}
+
+		// Apply the inverse horizontal filter to the even and odd rows that are in the region
+		if (first_output_row <= even_row && even_row <= last_output_row)
+		{
+			PIXEL *output = output_image + (even_row - first_output_row) * output_pitch;
+			InvertHorizontalRegion16s(even_lowpass, even_highpass, output_buffer,
+									  first_column, last_column, input_width, descale);
+			memcpy(output, &output_buffer[region->x], region->width * sizeof(PIXEL));
+		}
+
+		if (first_output_row <= odd_row && odd_row <= last_output_row)
+		{
+			PIXEL *output = output_image + (odd_row - first_output_row) * output_pitch;
+			InvertHorizontalRegion16s(odd_lowpass, odd_highpass, output_buffer,
+									  first_column, last_column, input_width, descale);
+			memcpy(output, &output_buffer[region->x], region->width * sizeof(PIXEL));
+		}
+	}
+
+finish:
+	// Free the scratch buffers
+	Free(allocator, even_lowpass);
+	Free(allocator, even_highpass);
+	Free(allocator, odd_lowpass);
+	Free(allocator, odd_highpass);
+	Free(allocator, output_buffer);
+
+	return error;
+}
+
+/*!
+	@brief Apply the inverse spatial transform to one row in each wavelet band
+
+	This routine computes the even and odd output rows produced by one input row.  The
+	lowlow and lowhigh arguments are the three rows in the lowlow and lowhigh bands used
+	by the inverse vertical filter, starting with the row returned by @ref LowpassSupportFirst,
+	so the lowpass rows can be kept in a ring buffer instead of a wavelet band.  The odd
+	output row is not computed if the output height is odd and the input row is the last row.
+
+	The output rows are the same as the rows computed by @ref InvertSpatial16s (if the
+	descale argument is zero) or @ref InvertSpatialDescale16s.  The buffer must have room
+	for four rows of input coefficients with an aligned pitch and the highpass bands must
+	have been dequantized when the bands were decoded.
+*/
+CODEC_ERROR InvertSpatialRow16s(const PIXEL *lowlow_row[3],
+								const PIXEL *lowhigh_row[3],
+								const PIXEL *highlow_row,
+								const PIXEL *highhigh_row,
+								PIXEL *even_output, PIXEL *odd_output,
+								int row, PIXEL *buffer,
+								DIMENSION input_width, DIMENSION input_height,
+								DIMENSION output_width, DIMENSION output_height,
+								int descale)
+{
+	const int last_row = input_height - 1;
+
+	// Results of the inverse vertical filter in rows with aligned pitch
+	const int buffer_pitch = (int)(ALIGNED_PITCH(input_width * sizeof(PIXEL)) / sizeof(PIXEL));
+	PIXEL *even_lowpass = buffer;
+	PIXEL *even_highpass = even_lowpass + buffer_pitch;
+	PIXEL *odd_lowpass = even_highpass + buffer_pitch;
+	PIXEL *odd_highpass = odd_lowpass + buffer_pitch;
+
+	int column;
+
+	assert(0 <= row && row <= last_row);
+	if (! (0 <= row && row <= last_row)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	if (0 < row && row < last_row)
+	{
+		// Compute the vertical inverse for the left two bands
+		InvertInteriorRows16s(lowlow_row[0], lowlow_row[1], lowlow_row[2], highlow_row,
+							  even_lowpass, odd_lowpass, input_width);
+
+		// Compute the vertical inverse for the right two bands
+		InvertInteriorRows16s(lowhigh_row[0], lowhigh_row[1], lowhigh_row[2], highhigh_row,
+							  even_highpass, odd_highpass, input_width);
+	}
+	else
+	{
+		// Apply the border filters to the first or last row
+		for (column = 0; column < input_width; column++)
+		{
+			int32_t even;
+			int32_t odd;
+
+			// Compute the vertical inverse for the left two bands
+			InvertSpatialFilter(lowlow_row[0][column], lowlow_row[1][column], lowlow_row[2][column],
+								row, last_row, highlow_row[column], &even, &odd);
+			even_lowpass[column] = ClampPixel(DivideByShift(even, 1));
+			odd_lowpass[column] = ClampPixel(DivideByShift(odd, 1));
+
+			// Compute the vertical inverse for the right two bands
+			InvertSpatialFilter(lowhigh_row[0][column], lowhigh_row[1][column], lowhigh_row[2][column],
+								row, last_row, highhigh_row[column], &even, &odd);
+			even_highpass[column] = ClampPixel(DivideByShift(even, 1));
+			odd_highpass[column] = ClampPixel(DivideByShift(odd, 1));
+		}
+	}
+
+	// Apply the inverse horizontal transform to the even and odd rows
+	if (descale == 0)
+	{
+		InvertHorizontal16s(even_lowpass, even_highpass, even_output, input_width, output_width);
+
+		if (2 * row + 1 < output_height) {
+			InvertHorizontal16s(odd_lowpass, odd_highpass, odd_output, input_width, output_width);
+		}
+	}
+	else
+	{
+		InvertHorizontalDescale16s(even_lowpass, even_highpass, even_output, input_width, output_width, descale);
+
+		if (2 * row + 1 < output_height) {
+			InvertHorizontalDescale16s(odd_lowpass, odd_highpass, odd_output, input_width, output_width, descale);
+		}
+	}
+
+	return CODEC_ERROR_OKAY;
+}
@@ -0,0 +1,510 @@
+/*!	@file decoder/src/kernels.c
+
+	Implementation of the kernels that apply the interior inverse wavelet filters.
+
+	The inverse filters are computed with 32-bit intermediate results.  The vectorized
+	kernels widen the 16-bit coefficients to 32 bits, apply the same shifts as the
+	scalar kernels, and narrow the results with signed saturation, which is the same
+	as clamping the results to the range of the pixel values.  The columns that are
+	left over after the last full vector are processed by the scalar kernels.
+
+	The kernels are selected once by @ref SelectInverseKernels using the processor
+	features reported by @ref GetCPUFeatures.  The scalar kernels are used until the
+	kernels are selected and are the reference implementation for the vectorized kernels.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+#if _SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if _SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+/*!
+	@brief Apply the interior inverse vertical filter using scalar arithmetic
+*/
+static void InvertRowsScalar(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+							 const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+							 int count)
+{
+	int column;
+
+	for (column = 0; column < count; column++)
+	{
+		int32_t even = 0;		// Result of convolution with even filter
+		int32_t odd = 0;		// Result of convolution with odd filter
+
+		// Apply the even reconstruction filter to the lowpass band
+		even += lowpass0[column];
+		even -= lowpass2[column];
+		even += 4;
+		even >>= 3;
+		even += lowpass1[column];
+
+		// Add the highpass correction
+		even += highpass[column];
+		even >>= 1;
+
+		even_output[column] = ClampPixel(even);
+
+		// Apply the odd reconstruction filter to the lowpass band
+		odd -= lowpass0[column];
+		odd += lowpass2[column];
+		odd += 4;
+		odd >>= 3;
+		odd += lowpass1[column];
+
+		// Subtract the highpass correction
+		odd -= highpass[column];
+		odd >>= 1;
+
+		odd_output[column] = ClampPixel(odd);
+	}
+}
+
+/*!
+	@brief Apply the interior inverse horizontal filter using scalar arithmetic
+*/
+static void InvertColumnsScalar(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+								int count, int shift)
+{
+	int column;
+
+	for (column = 0; column < count; column++)
+	{
+		int32_t even = 0;		// Result of convolution with even filter
+		int32_t odd = 0;		// Result of convolution with odd filter
+
+		// Apply the even reconstruction filter to the lowpass band
+		even += lowpass[column - 1];
+		even -= lowpass[column + 1];
+		even += 4;
+		even >>= 3;
+		even += lowpass[column + 0];
+
+		// Add the highpass correction
+		even += highpass[column];
+
+		// Apply the odd reconstruction filter to the lowpass band
+		odd -= lowpass[column - 1];
+		odd += lowpass[column + 1];
+		odd += 4;
+		odd >>= 3;
+		odd += lowpass[column + 0];
+
+		// Subtract the highpass correction
+		odd -= highpass[column];
+
+		if (shift < 0)
+		{
+			even >>= -shift;
+			odd >>= -shift;
+		}
+		else
+		{
+			// Remove any scaling used during encoding
+			even <<= shift;
+			odd <<= shift;
+		}
+
+		output[2 * column + 0] = ClampPixel(even);
+		output[2 * column + 1] = ClampPixel(odd);
+	}
+}
+
+//! Kernels that use scalar arithmetic
+static const INVERSE_KERNELS scalar_kernels = {"scalar", InvertRowsScalar, InvertColumnsScalar};
+
+
+#if _SIMD_X86
+
+/*!
+	@brief Widen the four coefficients in the low half of a vector to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenLowSSE2(__m128i x)
+{
+	return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+/*!
+	@brief Widen the four coefficients in the high half of a vector to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenHighSSE2(__m128i x)
+{
+	return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+/*!
+	@brief Compute the even and odd results of the interior filter before the final shift
+*/
+TARGET_SSE2 static inline void InvertFilterSSE2(__m128i lowpass0, __m128i lowpass1, __m128i lowpass2,
+												__m128i highpass, __m128i *even_out, __m128i *odd_out)
+{
+	const __m128i rounding = _mm_set1_epi32(4);
+
+	__m128i even = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(lowpass0, lowpass2), rounding), 3);
+	__m128i odd = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(lowpass2, lowpass0), rounding), 3);
+
+	*even_out = _mm_add_epi32(_mm_add_epi32(even, lowpass1), highpass);
+	*odd_out = _mm_sub_epi32(_mm_add_epi32(odd, lowpass1), highpass);
+}
+
+/*!
+	@brief Apply the interior inverse vertical filter to eight columns at a time using SSE2
+*/
+TARGET_SSE2 static void InvertRowsSSE2(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+									   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+									   int count)
+{
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		__m128i l0 = _mm_loadu_si128((const __m128i *)&lowpass0[column]);
+		__m128i l1 = _mm_loadu_si128((const __m128i *)&lowpass1[column]);
+		__m128i l2 = _mm_loadu_si128((const __m128i *)&lowpass2[column]);
+		__m128i h = _mm_loadu_si128((const __m128i *)&highpass[column]);
+
+		__m128i even_low, odd_low, even_high, odd_high;
+
+		InvertFilterSSE2(WidenLowSSE2(l0), WidenLowSSE2(l1), WidenLowSSE2(l2), WidenLowSSE2(h), &even_low, &odd_low);
+		InvertFilterSSE2(WidenHighSSE2(l0), WidenHighSSE2(l1), WidenHighSSE2(l2), WidenHighSSE2(h), &even_high, &odd_high);
+
+		even_low = _mm_srai_epi32(even_low, 1);
+		even_high = _mm_srai_epi32(even_high, 1);
+		odd_low = _mm_srai_epi32(odd_low, 1);
+		odd_high = _mm_srai_epi32(odd_high, 1);
+
+		_mm_storeu_si128((__m128i *)&even_output[column], _mm_packs_epi32(even_low, even_high));
+		_mm_storeu_si128((__m128i *)&odd_output[column], _mm_packs_epi32(odd_low, odd_high));
+	}
+
+	InvertRowsScalar(&lowpass0[column], &lowpass1[column], &lowpass2[column], &highpass[column],
+					 &even_output[column], &odd_output[column], count - column);
+}
+
+/*!
+	@brief Apply the interior inverse horizontal filter to eight columns at a time using SSE2
+*/
+TARGET_SSE2 static void InvertColumnsSSE2(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+										  int count, int shift)
+{
+	// Divide by two or remove the scaling applied during encoding
+	const __m128i right_shift = _mm_cvtsi32_si128((shift < 0) ? -shift : 0);
+	const __m128i left_shift = _mm_cvtsi32_si128((shift > 0) ? shift : 0);
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		__m128i l0 = _mm_loadu_si128((const __m128i *)&lowpass[column - 1]);
+		__m128i l1 = _mm_loadu_si128((const __m128i *)&lowpass[column]);
+		__m128i l2 = _mm_loadu_si128((const __m128i *)&lowpass[column + 1]);
+		__m128i h = _mm_loadu_si128((const __m128i *)&highpass[column]);
+
+		__m128i even_low, odd_low, even_high, odd_high;
+		__m128i even, odd;
+
+		InvertFilterSSE2(WidenLowSSE2(l0), WidenLowSSE2(l1), WidenLowSSE2(l2), WidenLowSSE2(h), &even_low, &odd_low);
+		InvertFilterSSE2(WidenHighSSE2(l0), WidenHighSSE2(l1), WidenHighSSE2(l2), WidenHighSSE2(h), &even_high, &odd_high);
+
+		even_low = _mm_sll_epi32(_mm_sra_epi32(even_low, right_shift), left_shift);
+		even_high = _mm_sll_epi32(_mm_sra_epi32(even_high, right_shift), left_shift);
+		odd_low = _mm_sll_epi32(_mm_sra_epi32(odd_low, right_shift), left_shift);
+		odd_high = _mm_sll_epi32(_mm_sra_epi32(odd_high, right_shift), left_shift);
+
+		even = _mm_packs_epi32(even_low, even_high);
+		odd = _mm_packs_epi32(odd_low, odd_high);
+
+		// Interleave the even and odd results
+		_mm_storeu_si128((__m128i *)&output[2 * column + 0], _mm_unpacklo_epi16(even, odd));
+		_mm_storeu_si128((__m128i *)&output[2 * column + 8], _mm_unpackhi_epi16(even, odd));
+	}
+
+	InvertColumnsScalar(&lowpass[column], &highpass[column], &output[2 * column], count - column, shift);
+}
+
+//! Kernels that use SSE2 instructions
+static const INVERSE_KERNELS sse2_kernels = {"sse2", InvertRowsSSE2, InvertColumnsSSE2};
+
+
+/*!
+	@brief Load sixteen coefficients and widen the first eight coefficients to 32 bits
+*/
+TARGET_AVX2 static inline __m256i WidenLowAVX2(const PIXEL *input)
+{
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&input[0]));
+}
+
+/*!
+	@brief Load sixteen coefficients and widen the last eight coefficients to 32 bits
+*/
+TARGET_AVX2 static inline __m256i WidenHighAVX2(const PIXEL *input)
+{
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&input[8]));
+}
+
+/*!
+	@brief Compute the even and odd results of the interior filter before the final shift
+*/
+TARGET_AVX2 static inline void InvertFilterAVX2(__m256i lowpass0, __m256i lowpass1, __m256i lowpass2,
+												__m256i highpass, __m256i *even_out, __m256i *odd_out)
+{
+	const __m256i rounding = _mm256_set1_epi32(4);
+
+	__m256i even = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(lowpass0, lowpass2), rounding), 3);
+	__m256i odd = _mm256_srai_epi32(_mm256_add_epi32(_mm256_sub_epi32(lowpass2, lowpass0), rounding), 3);
+
+	*even_out = _mm256_add_epi32(_mm256_add_epi32(even, lowpass1), highpass);
+	*odd_out = _mm256_sub_epi32(_mm256_add_epi32(odd, lowpass1), highpass);
+}
+
+/*!
+	@brief Apply the interior inverse vertical filter to sixteen columns at a time using AVX2
+
+	The results are narrowed within each 128-bit lane, so the 64-bit quarters of the
+	packed results are permuted to restore the column order.
+*/
+TARGET_AVX2 static void InvertRowsAVX2(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+									   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+									   int count)
+{
+	int column;
+
+	for (column = 0; column + 16 <= count; column += 16)
+	{
+		__m256i even_low, odd_low, even_high, odd_high;
+		__m256i even, odd;
+
+		InvertFilterAVX2(WidenLowAVX2(&lowpass0[column]), WidenLowAVX2(&lowpass1[column]),
+						 WidenLowAVX2(&lowpass2[column]), WidenLowAVX2(&highpass[column]),
+						 &even_low, &odd_low);
+
+		InvertFilterAVX2(WidenHighAVX2(&lowpass0[column]), WidenHighAVX2(&lowpass1[column]),
+						 WidenHighAVX2(&lowpass2[column]), WidenHighAVX2(&highpass[column]),
+						 &even_high, &odd_high);
+
+		even = _mm256_packs_epi32(_mm256_srai_epi32(even_low, 1), _mm256_srai_epi32(even_high, 1));
+		odd = _mm256_packs_epi32(_mm256_srai_epi32(odd_low, 1), _mm256_srai_epi32(odd_high, 1));
+
+		_mm256_storeu_si256((__m256i *)&even_output[column], _mm256_permute4x64_epi64(even, 0xD8));
+		_mm256_storeu_si256((__m256i *)&odd_output[column], _mm256_permute4x64_epi64(odd, 0xD8));
+	}
+
+	InvertRowsScalar(&lowpass0[column], &lowpass1[column], &lowpass2[column], &highpass[column],
+					 &even_output[column], &odd_output[column], count - column);
+}
+
+/*!
+	@brief Apply the interior inverse horizontal filter to sixteen columns at a time using AVX2
+
+	The packed results are in the order of the columns within each 128-bit lane, which
+	is the order required to interleave the even and odd results without a permutation.
+*/
+TARGET_AVX2 static void InvertColumnsAVX2(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+										  int count, int shift)
+{
+	// Divide by two or remove the scaling applied during encoding
+	const __m128i right_shift = _mm_cvtsi32_si128((shift < 0) ? -shift : 0);
+	const __m128i left_shift = _mm_cvtsi32_si128((shift > 0) ? shift : 0);
+	int column;
+
+	for (column = 0; column + 16 <= count; column += 16)
+	{
+		__m256i even_low, odd_low, even_high, odd_high;
+		__m256i even, odd;
+
+		InvertFilterAVX2(WidenLowAVX2(&lowpass[column - 1]), WidenLowAVX2(&lowpass[column]),
+						 WidenLowAVX2(&lowpass[column + 1]), WidenLowAVX2(&highpass[column]),
+						 &even_low, &odd_low);
+
+		InvertFilterAVX2(WidenHighAVX2(&lowpass[column - 1]), WidenHighAVX2(&lowpass[column]),
+						 WidenHighAVX2(&lowpass[column + 1]), WidenHighAVX2(&highpass[column]),
+						 &even_high, &odd_high);
+
+		even_low = _mm256_sll_epi32(_mm256_sra_epi32(even_low, right_shift), left_shift);
+		even_high = _mm256_sll_epi32(_mm256_sra_epi32(even_high, right_shift), left_shift);
+		odd_low = _mm256_sll_epi32(_mm256_sra_epi32(odd_low, right_shift), left_shift);
+		odd_high = _mm256_sll_epi32(_mm256_sra_epi32(odd_high, right_shift), left_shift);
+
+		even = _mm256_packs_epi32(even_low, even_high);
+		odd = _mm256_packs_epi32(odd_low, odd_high);
+
+		// Interleave the even and odd results
+		_mm256_storeu_si256((__m256i *)&output[2 * column + 0], _mm256_unpacklo_epi16(even, odd));
+		_mm256_storeu_si256((__m256i *)&output[2 * column + 16], _mm256_unpackhi_epi16(even, odd));
+	}
+
+	InvertColumnsScalar(&lowpass[column], &highpass[column], &output[2 * column], count - column, shift);
+}
+
+//! Kernels that use AVX2 instructions
+static const INVERSE_KERNELS avx2_kernels = {"avx2", InvertRowsAVX2, InvertColumnsAVX2};
+
+#endif
+
+
+#if _SIMD_NEON
+
+/*!
+	@brief Compute the even and odd results of the interior filter before the final shift
+*/
+static inline void InvertFilterNEON(int32x4_t lowpass0, int32x4_t lowpass1, int32x4_t lowpass2,
+									int32x4_t highpass, int32x4_t *even_out, int32x4_t *odd_out)
+{
+	const int32x4_t rounding = vdupq_n_s32(4);
+
+	int32x4_t even = vshrq_n_s32(vaddq_s32(vsubq_s32(lowpass0, lowpass2), rounding), 3);
+	int32x4_t odd = vshrq_n_s32(vaddq_s32(vsubq_s32(lowpass2, lowpass0), rounding), 3);
+
+	*even_out = vaddq_s32(vaddq_s32(even, lowpass1), highpass);
+	*odd_out = vsubq_s32(vaddq_s32(odd, lowpass1), highpass);
+}
+
+/*!
+	@brief Apply the interior inverse vertical filter to eight columns at a time using NEON
+*/
+static void InvertRowsNEON(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+						   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+						   int count)
+{
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		int16x8_t l0 = vld1q_s16(&lowpass0[column]);
+		int16x8_t l1 = vld1q_s16(&lowpass1[column]);
+		int16x8_t l2 = vld1q_s16(&lowpass2[column]);
+		int16x8_t h = vld1q_s16(&highpass[column]);
+
+		int32x4_t even_low, odd_low, even_high, odd_high;
+
+		InvertFilterNEON(vmovl_s16(vget_low_s16(l0)), vmovl_s16(vget_low_s16(l1)),
+						 vmovl_s16(vget_low_s16(l2)), vmovl_s16(vget_low_s16(h)),
+						 &even_low, &odd_low);
+
+		InvertFilterNEON(vmovl_s16(vget_high_s16(l0)), vmovl_s16(vget_high_s16(l1)),
+						 vmovl_s16(vget_high_s16(l2)), vmovl_s16(vget_high_s16(h)),
+						 &even_high, &odd_high);
+
+		vst1q_s16(&even_output[column], vcombine_s16(vqmovn_s32(vshrq_n_s32(even_low, 1)),
+													 vqmovn_s32(vshrq_n_s32(even_high, 1))));
+		vst1q_s16(&odd_output[column], vcombine_s16(vqmovn_s32(vshrq_n_s32(odd_low, 1)),
+													vqmovn_s32(vshrq_n_s32(odd_high, 1))));
+	}
+
+	InvertRowsScalar(&lowpass0[column], &lowpass1[column], &lowpass2[column], &highpass[column],
+					 &even_output[column], &odd_output[column], count - column);
+}
+
+/*!
+	@brief Apply the interior inverse horizontal filter to eight columns at a time using NEON
+*/
+static void InvertColumnsNEON(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+							  int count, int shift)
+{
+	// Divide by two (negative shift) or remove the scaling applied during encoding
+	const int32x4_t shift_vector = vdupq_n_s32(shift);
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		int16x8_t l0 = vld1q_s16(&lowpass[column - 1]);
+		int16x8_t l1 = vld1q_s16(&lowpass[column]);
+		int16x8_t l2 = vld1q_s16(&lowpass[column + 1]);
+		int16x8_t h = vld1q_s16(&highpass[column]);
+
+		int32x4_t even_low, odd_low, even_high, odd_high;
+		int16x8x2_t result;
+
+		InvertFilterNEON(vmovl_s16(vget_low_s16(l0)), vmovl_s16(vget_low_s16(l1)),
+						 vmovl_s16(vget_low_s16(l2)), vmovl_s16(vget_low_s16(h)),
+						 &even_low, &odd_low);
+
+		InvertFilterNEON(vmovl_s16(vget_high_s16(l0)), vmovl_s16(vget_high_s16(l1)),
+						 vmovl_s16(vget_high_s16(l2)), vmovl_s16(vget_high_s16(h)),
+						 &even_high, &odd_high);
+
+		result.val[0] = vcombine_s16(vqmovn_s32(vshlq_s32(even_low, shift_vector)), vqmovn_s32(vshlq_s32(even_high, shift_vector)));
+		result.val[1] = vcombine_s16(vqmovn_s32(vshlq_s32(odd_low, shift_vector)), vqmovn_s32(vshlq_s32(odd_high, shift_vector)));
+
+		// Store the even and odd results interleaved
+		vst2q_s16(&output[2 * column], result);
+	}
+
+	InvertColumnsScalar(&lowpass[column], &highpass[column], &output[2 * column], count - column, shift);
+}
+
+//! Kernels that use NEON instructions
+static const INVERSE_KERNELS neon_kernels = {"neon", InvertRowsNEON, InvertColumnsNEON};
+
+#endif
+
+
+//! Kernels used for the interior inverse filters
+static const INVERSE_KERNELS *inverse_kernels = &scalar_kernels;
+
+
+/*!
+	@brief Select the fastest kernels supported by the processor
+
+	This routine should be called before the inverse transforms are computed
+	by any thread.  The scalar kernels are used if no processor features are
+	provided or the vectorized kernels are not compiled into the program.
+*/
+const INVERSE_KERNELS *SelectInverseKernels(uint32_t cpu_features)
+{
+	const INVERSE_KERNELS *kernels = &scalar_kernels;
+
+#if _SIMD_X86
+	if (cpu_features & CPU_FEATURE_AVX2) {
+		kernels = &avx2_kernels;
+	}
+	else if (cpu_features & CPU_FEATURE_SSE2) {
+		kernels = &sse2_kernels;
+	}
+#endif
+
+#if _SIMD_NEON
+	if (cpu_features & CPU_FEATURE_NEON) {
+		kernels = &neon_kernels;
+	}
+#endif
+
+	inverse_kernels = kernels;
+
+	return kernels;
+}
+
+/*!
+	@brief Return the kernels used for the interior inverse filters
+*/
+const INVERSE_KERNELS *GetInverseKernels(void)
+{
+	return inverse_kernels;
+}
+
+/*!
+	@brief Apply the interior inverse vertical filter using the selected kernel
+*/
+void InvertInteriorRows16s(const PIXEL *lowpass0, const PIXEL *lowpass1, const PIXEL *lowpass2,
+						   const PIXEL *highpass, PIXEL *even_output, PIXEL *odd_output,
+						   int count)
+{
+	inverse_kernels->invert_rows(lowpass0, lowpass1, lowpass2, highpass, even_output, odd_output, count);
+}
+
+/*!
+	@brief Apply the interior inverse horizontal filter using the selected kernel
+*/
+void InvertInteriorColumns16s(const PIXEL *lowpass, const PIXEL *highpass, PIXEL *output,
+							  int count, int shift)
+{
+	inverse_kernels->invert_columns(lowpass, highpass, output, count, shift);
+}
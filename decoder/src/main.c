@@ -245,6 +245,56 @@ CODEC_ERROR DisplayProcess(const PACKED_IMAGE *image,
 	return WriteImageDPX(image, pathname);
 }
 
+/*!
+	@brief Read the entire sample in the input file into a buffer in memory
+
+	The bitstream reads the sample directly from the buffer, which avoids
+	a call to the byte stream for every word in the sample.  This routine
+	is used if the input file cannot be mapped into memory.
+
+	The caller must free the buffer.
+*/
+CODEC_ERROR ReadSampleFile(const char *pathname, void **buffer_out, size_t *size_out)
+{
+	FILE *file;
+	long size;
+	void *buffer;
+
+	file = fopen(pathname, "rb");
+	if (file == NULL) {
+		return CODEC_ERROR_OPEN_FILE_FAILED;
+	}
+
+	// Get the size of the sample
+	if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0)
+	{
+		fclose(file);
+		return CODEC_ERROR_FILE_SIZE_FAILED;
+	}
+
+	// Allocate at least one byte so that an empty file does not return a null pointer
+	buffer = malloc(size > 0 ? size : 1);
+	if (buffer == NULL)
+	{
+		fclose(file);
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	if (size > 0 && fread(buffer, size, 1, file) != 1)
+	{
+		free(buffer);
+		fclose(file);
+		return CODEC_ERROR_FILE_READ;
+	}
+
+	fclose(file);
+
+	*buffer_out = buffer;
+	*size_out = (size_t)size;
+
+	return CODEC_ERROR_OKAY;
+}
+
 /*!
 	@brief Main entry point for the reference decoder
 
@@ -263,11 +313,15 @@ int main(int argc, char *argv[])
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	PARAMETERS parameters;
+	ALLOCATOR allocator;
+	DECODER_TIMING timing;
     FILELIST input_filelist;
     FILELIST output_filelist;
     //FILE_INFO info;
     char input_pathname[PATH_MAX];
 	STREAM input_stream;
+	void *input_buffer = NULL;
+	size_t input_size = 0;
 
 	DATABASE *database = NULL;
 
@@ -284,6 +338,17 @@ int main(int argc, char *argv[])
 		return error;
 	}
 
+	// Initialize the memory allocator selected on the command line
+	InitAllocator(&allocator, parameters.allocator_type);
+	parameters.allocator = &allocator;
+	if (parameters.stats_flag) {
+		EnableAllocatorStats(&allocator);
+
+		// Record the time spent in each stage of the decoding process
+		InitDecoderTiming(&timing);
+		parameters.timing = &timing;
+	}
+
 	// Must provide exactly one input bitstream file on the command line
     assert(FileListHasSinglePathname(&input_filelist));
 	if (! (FileListHasSinglePathname(&input_filelist))) {
@@ -381,8 +446,23 @@ int main(int argc, char *argv[])
     }
 #endif
 
-	// Open a stream to the input file
-	error = OpenStream(&input_stream, input_pathname);
+	// Map the input file into memory or read the sample into a buffer if the file cannot be mapped
+	StartTimer(STAGE_TIMER(parameters.timing, read));
+	error = OpenMappedStream(&input_stream, input_pathname);
+	if (error != CODEC_ERROR_OKAY)
+	{
+		error = ReadSampleFile(input_pathname, &input_buffer, &input_size);
+		if (error == CODEC_ERROR_OKAY)
+		{
+			// Open a stream to the sample in memory
+			error = OpenStreamBuffer(&input_stream, input_buffer, input_size);
+			if (error != CODEC_ERROR_OKAY) {
+				free(input_buffer);
+				return error;
+			}
+		}
+	}
+	StopTimer(STAGE_TIMER(parameters.timing, read));
 	if (error != CODEC_ERROR_OKAY) {
 		fprintf(stderr, "Could not open input file: %s\n", input_pathname);
 		return error;
@@ -425,8 +505,8 @@ int main(int argc, char *argv[])
 //     // }
 // #endif
 
-        // Initialize the decoder with a default allocator
-        PrepareDecoder(&decoder, NULL, database, &parameters);
+        // Initialize the decoder with the allocator selected on the command line
+        PrepareDecoder(&decoder, parameters.allocator, database, &parameters);
         
         // Get the bitstream start marker
         segment = GetSegment(&bitstream);
@@ -498,6 +578,9 @@ int main(int argc, char *argv[])
             }
             
             printf("Output pathname: %s\n", pathname);
+
+            // The buffer can be reused for the output image in the next image section
+            ReleaseImage(decoder.allocator, &output_image);
             
             if (AllImageSectionsDecoded(&decoder)) {
                 break;
@@ -516,13 +599,13 @@ int main(int argc, char *argv[])
                 if (AllLayersDecoded(&decoder))
                 {
                     // Update decoder and codec state to indicate that the image section has been decoded
-                    ResetDecoderImageSection(&decoder, NULL, &parameters);
+                    ResetDecoderImageSection(&decoder, parameters.allocator, &parameters);
                 }
             }
             else
             {
                 // Update decoder and codec state to indicate that the image section has been decoded
-                ResetDecoderImageSection(&decoder, NULL, &parameters);
+                ResetDecoderImageSection(&decoder, parameters.allocator, &parameters);
             }
        }
     }
@@ -563,8 +646,8 @@ int main(int argc, char *argv[])
 
 // #endif
 
-        // Initialize the decoder with a default allocator
-        PrepareDecoder(&decoder, NULL, database, &parameters);
+        // Initialize the decoder with the allocator selected on the command line
+        PrepareDecoder(&decoder, parameters.allocator, database, &parameters);
         
         /*
             Set the output file format in the parameters.  This method only works for
@@ -609,6 +692,9 @@ int main(int argc, char *argv[])
                 fprintf(stderr, "Could not write output image to file: %s\n", pathname);
                 return error;
             }
+
+            // The buffer can be reused for the output image in the next layer
+            ReleaseImage(decoder.allocator, &output_image);
             
             // Update decoder and codec state to indicate that the layer has been decoded
             UpdateLayerParameters(&decoder);
@@ -683,8 +769,16 @@ int main(int argc, char *argv[])
     // }
 #endif
 
-		// Decode the stream into a packed output image
-		error = DecodeImage(&input_stream, &output_image, database, &parameters);
+		if (parameters.thumbnail_flag)
+		{
+			// Decode a thumbnail from the lowpass bands into a packed output image
+			error = DecodeThumbnail(&input_stream, &output_image, database, &parameters);
+		}
+		else
+		{
+			// Decode the stream into a packed output image
+			error = DecodeImage(&input_stream, &output_image, database, &parameters);
+		}
 		if (error != CODEC_ERROR_OKAY) {
 			fprintf(stderr, "Error decoding bitstream: %s\n", input_pathname);
 			return error;
@@ -703,6 +797,13 @@ int main(int argc, char *argv[])
 			fprintf(stderr, "Could not write output image to file: %s\n", argv[2]);
 			return error;
 		}
+
+		if (parameters.stats_flag)
+		{
+			// The memory statistics depend on the dimensions and format of the decoded image
+			printf("Image: %d x %d, format: %s, resolution: 1/%d\n", output_image.width, output_image.height,
+				   PixelFormatName(output_image.format), 1 << parameters.resolution);
+		}
 #if 0
 		if (argc > 3)
 		{
@@ -746,6 +847,15 @@ int main(int argc, char *argv[])
 #endif
 
     CloseStream(&input_stream);
+    free(input_buffer);
+
+    if (parameters.stats_flag) {
+        PrintDecoderTiming(&timing, stdout);
+        PrintAllocatorStats(&allocator, stdout);
+    }
+
+    // Free all memory obtained by the allocator including blocks that were not freed
+    ReleaseAllocator(&allocator);
 
 	return CODEC_ERROR_OKAY;
 }
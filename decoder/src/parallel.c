@@ -0,0 +1,449 @@
+/*!	@file decoder/src/parallel.c
+
+	Implementation of the routines for decoding the channels in parallel.
+
+	The codeblocks in the bitstream are recorded instead of decoded by @ref UpdateCodecState
+	when parallel decoding is enabled.  The chunk size of each codeblock is used to skip the
+	codeblock payload so that the bitstream header, channel headers, and subband headers can
+	be parsed without decoding any subbands.  The wavelets for each channel are allocated as
+	the codeblocks are recorded.
+
+	After the entire bitstream has been parsed, the work of decoding the image is described
+	by a graph of tasks that is run by a thread pool.  There are three kinds of tasks:
+
+	1. Decode one codeblock into its wavelet band.
+
+	2. Invert one wavelet to reconstruct the lowpass band in the wavelet at the next lower level.
+	This task depends on the tasks that provide the lowpass band and the three highpass bands
+	in the wavelet: the task that decodes the lowpass codeblock (wavelet at the highest level)
+	or the task that inverts the wavelet at the next higher level, and the tasks that decode
+	the highpass codeblocks in the wavelet.
+
+	3. Compute the component array for one channel.  This task depends on all other tasks in
+	the channel.
+
+	The tasks that invert the wavelets are only added if the image is decoded at reduced
+	resolution or only a region of the image is decoded.  The inverse transform for a wavelet
+	starts as soon as its bands are available, so the wavelets at the highest levels are
+	inverted while the largest highpass bands in the same and other channels are still being
+	decoded.
+
+	If the entire image is decoded at full resolution, then the inverse transforms at all
+	levels are computed by the line-based cascade (see @ref IsCascadeDecoded) in the task that
+	computes the component array, since the cascade does not reconstruct the lowpass bands
+	in the intermediate wavelets.  The codeblocks in all channels are decoded in parallel and
+	the cascade in each channel runs while the codeblocks in the other channels are decoded.
+
+	Each task reads the codeblock payloads directly from the sample using a private bitstream
+	and uses a private copy of the decoder with the codec state that was recorded with the
+	codeblock.  The tasks in the graph are created in the same order as the bands would be
+	decoded by @ref DecodeChannelSubband, so the wavelets are inverted at the same points in
+	the sequence of codeblocks and the decoded image is the same as when the codeblocks are
+	decoded on the calling thread.  Each band is written by only one task and the valid band
+	masks in each wavelet are only updated by the tasks that invert the wavelet or compute the
+	component array, which are ordered by the dependencies.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+//! Maximum number of tasks in the graph for decoding all channels
+#define MAX_DECODING_TASKS	(MAX_CHANNEL_COUNT * (MAX_SUBBAND_COUNT + MAX_WAVELET_COUNT + 1))
+
+/*!
+	@brief Argument for a task in the graph for decoding the channels
+
+	The codeblock index is the codeblock decoded by the task or the codeblock that
+	completed the wavelet inverted by the task.  The band mask is the set of bands
+	in the wavelet that are provided by codeblocks in the channel.
+*/
+typedef struct _decoding_task
+{
+	DECODER *decoder;			//!< Decoder that recorded the codeblocks
+	const uint8_t *sample;		//!< Sample that contains the codeblock payloads
+	UNPACKED_IMAGE *image;		//!< Unpacked image for the decoded component arrays
+	int channel_number;			//!< Channel processed by this task
+	int codeblock_index;		//!< Index of the codeblock in the channel
+	int wavelet_index;			//!< Index of the wavelet inverted by this task
+	uint32_t band_mask;			//!< Bands in the wavelet that were decoded from codeblocks
+
+} DECODING_TASK;
+
+
+/*!
+	@brief Record the location of the current codeblock and skip the codeblock payload
+
+	The codec state is saved with the offset and size of the codeblock payload and then
+	updated as if the subband had been decoded, so that the rest of the bitstream can be
+	parsed before any subbands are decoded.  The chunk size is in units of segments.
+*/
+CODEC_ERROR RecordChannelSubband(DECODER *decoder, BITSTREAM *stream, int chunk_size)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CODEC_STATE *codec = &decoder->codec;
+
+	const int channel_number = codec->channel_number;
+	const int subband_number = codec->subband_number;
+
+	CODEBLOCK *codeblock;
+	int codeblock_count;
+
+	assert(0 <= channel_number && channel_number < MAX_CHANNEL_COUNT);
+	if (! (0 <= channel_number && channel_number < MAX_CHANNEL_COUNT)) {
+		return CODEC_ERROR_BITSTREAM_SYNTAX;
+	}
+
+	codeblock_count = decoder->deferred.codeblock_count[channel_number];
+
+	assert(0 <= codeblock_count && codeblock_count < MAX_SUBBAND_COUNT);
+	if (! (0 <= codeblock_count && codeblock_count < MAX_SUBBAND_COUNT)) {
+		return CODEC_ERROR_BITSTREAM_SYNTAX;
+	}
+
+	assert(chunk_size > 0);
+	if (! (chunk_size > 0)) {
+		return CODEC_ERROR_BITSTREAM_SYNTAX;
+	}
+
+	// Save the codec state and the location of the codeblock payload in the sample
+	codeblock = &decoder->deferred.codeblock[channel_number][codeblock_count];
+	codeblock->codec = *codec;
+	codeblock->offset = GetBitstreamPosition(stream);
+	codeblock->size = chunk_size * sizeof(SEGMENT);
+	decoder->deferred.codeblock_count[channel_number]++;
+
+	// Allocate the wavelets for this channel before the channels are decoded in parallel
+	error = AllocateChannelWavelets(decoder, channel_number);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Skip the codeblock payload
+	error = SkipPayload(stream, chunk_size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Set the subband number for the next band expected in the bitstream
+	codec->subband_number++;
+
+	// Record that this subband has been found in the bitstream
+	SetDecodedBandMask(codec, subband_number);
+
+	// Found all subbands in this channel?
+	if (codec->subband_number == codec->subband_count)
+	{
+		// Advance to the next channel
+		codec->channel_number++;
+
+		// Reset the subband number
+		codec->subband_number = 0;
+	}
+
+	return error;
+}
+
+/*!
+	@brief Decode one recorded codeblock into its wavelet band
+*/
+static CODEC_ERROR DecodeCodeblockTask(void *argument)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	DECODING_TASK *task = (DECODING_TASK *)argument;
+	const CODEBLOCK *codeblock = &task->decoder->deferred.codeblock[task->channel_number][task->codeblock_index];
+	DECODER subband_decoder = *task->decoder;
+	BITSTREAM stream;
+
+	// Restore the codec state at the start of the codeblock
+	subband_decoder.codec = codeblock->codec;
+
+	// Read the codeblock payload using a private bitstream
+	InitBitstream(&stream);
+	AttachBitstreamBuffer(&stream, task->sample + codeblock->offset, codeblock->size);
+
+	error = DecodeSubbandCoefficients(&subband_decoder, &stream, codeblock->size / sizeof(SEGMENT));
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// The codeblock payload should not extend past the chunk
+	if (stream.error != BITSTREAM_ERROR_OKAY) {
+		return CodecErrorBitstream(stream.error);
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Mark the decoded bands in a wavelet as valid and invert the wavelet
+*/
+static CODEC_ERROR InvertWaveletTask(void *argument)
+{
+	DECODING_TASK *task = (DECODING_TASK *)argument;
+	const CODEBLOCK *codeblock = &task->decoder->deferred.codeblock[task->channel_number][task->codeblock_index];
+	DECODER channel_decoder = *task->decoder;
+	WAVELET *wavelet = channel_decoder.transform[task->channel_number].wavelet[task->wavelet_index];
+	int band;
+
+	// Restore the codec state after the codeblock that completed the wavelet
+	channel_decoder.codec = codeblock->codec;
+
+	for (band = 0; band < wavelet->band_count; band++)
+	{
+		if ((task->band_mask & BandValidMask(band)) != 0) {
+			UpdateWaveletValidBandMask(wavelet, band);
+		}
+	}
+
+	return ReconstructWaveletBand(&channel_decoder, task->channel_number, wavelet, task->wavelet_index);
+}
+
+/*!
+	@brief Mark all decoded bands in a channel as valid and compute the component array
+*/
+static CODEC_ERROR ReconstructChannelTask(void *argument)
+{
+	DECODING_TASK *task = (DECODING_TASK *)argument;
+	DECODER *decoder = task->decoder;
+	int channel_number = task->channel_number;
+	int codeblock_count = decoder->deferred.codeblock_count[channel_number];
+	DECODER channel_decoder = *decoder;
+	int codeblock_index;
+
+	for (codeblock_index = 0; codeblock_index < codeblock_count; codeblock_index++)
+	{
+		const CODEBLOCK *codeblock = &decoder->deferred.codeblock[channel_number][codeblock_index];
+		int subband_number = codeblock->codec.subband_number;
+		WAVELET *wavelet = decoder->transform[channel_number].wavelet[SubbandWaveletIndex(subband_number)];
+
+		// Restore the codec state at the start of the codeblock
+		channel_decoder.codec = codeblock->codec;
+
+		UpdateWaveletValidBandMask(wavelet, SubbandBandIndex(subband_number));
+	}
+
+	// Compute the component array for this channel
+	return ReconstructComponentArray(&channel_decoder, task->image, channel_number);
+}
+
+/*!
+	@brief Add the tasks for decoding one channel to the graph
+
+	The valid band masks in the wavelets are tracked as the tasks are added, in the
+	same way as the masks are updated by @ref DecodeChannelSubband, to find the
+	codeblock that completes each wavelet.  The task for each band in a wavelet is
+	recorded so that the task that inverts the wavelet can depend on those tasks.
+
+	No tasks are added for inverting the wavelets if the inverse transforms are
+	computed by the cascade in the task that computes the component array.
+*/
+static CODEC_ERROR AddChannelTasks(TASK_GRAPH *graph, DECODING_TASK *task_table, int *task_count,
+								   DECODER *decoder, const uint8_t *sample, UNPACKED_IMAGE *image,
+								   int channel_number)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	int codeblock_count = decoder->deferred.codeblock_count[channel_number];
+	bool cascade_flag = IsCascadeDecoded(decoder);
+	int provider[MAX_WAVELET_COUNT][MAX_BAND_COUNT];
+	uint32_t valid_band_mask[MAX_WAVELET_COUNT];
+	uint32_t decoded_band_mask[MAX_WAVELET_COUNT];
+	int channel_task[MAX_SUBBAND_COUNT + MAX_WAVELET_COUNT];
+	int channel_task_count = 0;
+	DECODING_TASK *task;
+	int codeblock_index;
+	int wavelet_index;
+	int final_task;
+	int index;
+
+	for (wavelet_index = 0; wavelet_index < MAX_WAVELET_COUNT; wavelet_index++)
+	{
+		WAVELET *wavelet = decoder->transform[channel_number].wavelet[wavelet_index];
+		int band;
+
+		for (band = 0; band < MAX_BAND_COUNT; band++) {
+			provider[wavelet_index][band] = -1;
+		}
+
+		valid_band_mask[wavelet_index] = (wavelet != NULL) ? wavelet->valid_band_mask : 0;
+		decoded_band_mask[wavelet_index] = 0;
+	}
+
+	for (codeblock_index = 0; codeblock_index < codeblock_count; codeblock_index++)
+	{
+		const CODEBLOCK *codeblock = &decoder->deferred.codeblock[channel_number][codeblock_index];
+		int subband_number = codeblock->codec.subband_number;
+		int band = SubbandBandIndex(subband_number);
+		WAVELET *wavelet;
+		uint32_t all_bands_valid_mask;
+		bool all_bands_valid;
+		int decode_task;
+
+		wavelet_index = SubbandWaveletIndex(subband_number);
+		assert(0 <= wavelet_index && wavelet_index < MAX_WAVELET_COUNT && 0 <= band && band < MAX_BAND_COUNT);
+		if (! (0 <= wavelet_index && wavelet_index < MAX_WAVELET_COUNT && 0 <= band && band < MAX_BAND_COUNT)) {
+			return CODEC_ERROR_BITSTREAM_SYNTAX;
+		}
+
+		wavelet = decoder->transform[channel_number].wavelet[wavelet_index];
+		assert(wavelet != NULL);
+		if (! (wavelet != NULL)) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
+
+		all_bands_valid_mask = ((1 << wavelet->band_count) - 1);
+		all_bands_valid = (valid_band_mask[wavelet_index] == all_bands_valid_mask);
+
+		// Add the task that decodes the codeblock
+		task = &task_table[(*task_count)++];
+		task->decoder = decoder;
+		task->sample = sample;
+		task->image = image;
+		task->channel_number = channel_number;
+		task->codeblock_index = codeblock_index;
+
+		decode_task = AddGraphTask(graph, DecodeCodeblockTask, task);
+		if (decode_task < 0) {
+			return CODEC_ERROR_UNEXPECTED;
+		}
+		channel_task[channel_task_count++] = decode_task;
+
+		provider[wavelet_index][band] = decode_task;
+		valid_band_mask[wavelet_index] |= BandValidMask(band);
+		decoded_band_mask[wavelet_index] |= BandValidMask(band);
+
+		// Did this codeblock complete the bands in a wavelet that is not inverted by the cascade?
+		if (!cascade_flag && !all_bands_valid && valid_band_mask[wavelet_index] == all_bands_valid_mask)
+		{
+			int invert_task;
+
+			task = &task_table[(*task_count)++];
+			task->decoder = decoder;
+			task->sample = sample;
+			task->image = image;
+			task->channel_number = channel_number;
+			task->codeblock_index = codeblock_index;
+			task->wavelet_index = wavelet_index;
+			task->band_mask = decoded_band_mask[wavelet_index];
+
+			invert_task = AddGraphTask(graph, InvertWaveletTask, task);
+			if (invert_task < 0) {
+				return CODEC_ERROR_UNEXPECTED;
+			}
+			channel_task[channel_task_count++] = invert_task;
+
+			// The inverse transform depends on the tasks that provide the bands in the wavelet
+			for (band = 0; band < wavelet->band_count; band++)
+			{
+				if (provider[wavelet_index][band] >= 0)
+				{
+					error = AddGraphDependency(graph, provider[wavelet_index][band], invert_task);
+					if (error != CODEC_ERROR_OKAY) {
+						return error;
+					}
+				}
+			}
+
+			// The inverse transform provides the lowpass band in the wavelet at the next lower level
+			if (wavelet_index > 0)
+			{
+				provider[wavelet_index - 1][0] = invert_task;
+				valid_band_mask[wavelet_index - 1] |= BandValidMask(0);
+			}
+		}
+	}
+
+	// Add the task that computes the component array after all other tasks in the channel
+	task = &task_table[(*task_count)++];
+	task->decoder = decoder;
+	task->sample = sample;
+	task->image = image;
+	task->channel_number = channel_number;
+
+	final_task = AddGraphTask(graph, ReconstructChannelTask, task);
+	if (final_task < 0) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	for (index = 0; index < channel_task_count; index++)
+	{
+		error = AddGraphDependency(graph, channel_task[index], final_task);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Decode the recorded codeblocks and reconstruct the unpacked image
+
+	The tasks for decoding all channels are run by a thread pool with the number
+	of threads specified in the decoding parameters.
+*/
+CODEC_ERROR DecodeDeferredChannels(DECODER *decoder, BITSTREAM *input, UNPACKED_IMAGE *image)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	int channel_count = decoder->codec.channel_count;
+	DECODING_TASK *task_table;
+	int task_count = 0;
+	TASK_GRAPH graph;
+	THREAD_POOL pool;
+	int channel_number;
+
+	assert(input->span != NULL);
+	if (! (input->span != NULL)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	assert(0 < channel_count && channel_count <= MAX_CHANNEL_COUNT);
+	if (! (0 < channel_count && channel_count <= MAX_CHANNEL_COUNT)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// Allocate the vector of component arrays before any channels are decoded
+	error = AllocateComponentArrayList(decoder, image);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	task_table = (DECODING_TASK *)Alloc(decoder->allocator, MAX_DECODING_TASKS * sizeof(DECODING_TASK));
+	if (task_table == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+	memset(task_table, 0, MAX_DECODING_TASKS * sizeof(DECODING_TASK));
+
+	error = InitTaskGraph(&graph, decoder->allocator, MAX_DECODING_TASKS);
+	if (error != CODEC_ERROR_OKAY) {
+		Free(decoder->allocator, task_table);
+		return error;
+	}
+
+	for (channel_number = 0; error == CODEC_ERROR_OKAY && channel_number < channel_count; channel_number++) {
+		error = AddChannelTasks(&graph, task_table, &task_count, decoder, input->span, image, channel_number);
+	}
+
+	if (error == CODEC_ERROR_OKAY)
+	{
+		error = InitThreadPool(&pool, decoder->allocator, decoder->thread_count);
+		if (error == CODEC_ERROR_OKAY)
+		{
+			error = RunTaskGraph(&graph, &pool);
+			ReleaseThreadPool(&pool);
+		}
+	}
+
+	ReleaseTaskGraph(&graph);
+	Free(decoder->allocator, task_table);
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// One component array is output by the decoding process per channel in the bitstream
+	image->component_count = channel_count;
+
+	return error;
+}
@@ -56,6 +56,25 @@ static char usage_message[] =
 	"\t\tPathname of the bandfile with optional channel and subband masks\n"
 	"\t\tthat specify which subbands to write to the bandfile.\n"
 	"\n"
+	"\t-t <thread count>\n"
+	"\t\tNumber of threads used for decoding the channels in parallel.\n"
+	"\n"
+	"\t-a default|arena\n"
+	"\t\tAllocate memory from the C library (default) or from an arena that reuses\n"
+	"\t\tthe blocks freed by the decoder.\n"
+	"\n"
+	"\t-s\n"
+	"\t\tPrint statistics about the memory and time used by the decoder.\n"
+	"\n"
+	"\t-r <resolution>\n"
+	"\t\tDecode the image at reduced resolution (full, half, quarter, or eighth).\n"
+	"\n"
+	"\t-T\n"
+	"\t\tDecode a thumbnail image (same as -r eighth, overrides -r).\n"
+	"\n"
+	"\t-R <x>,<y>,<width>,<height>\n"
+	"\t\tDecode only the specified region of the image (in full resolution coordinates).\n"
+	"\n"
     "\t-v\n\t\tEnable verbose output.\n"
 	"\n"
     "\t-z\n"
@@ -220,6 +239,12 @@ CODEC_ERROR ParseParameters(int argc, char *argv[], PARAMETERS *parameters, FILE
         //{"names",  no_argument,       NULL, 'N'},    //!< Parse and output information for image filenames
         {"metadata", required_argument, NULL, 'M'},    //!< Metadata output file in XML format
         {"bandfile", required_argument, NULL, 'B'},    //!< Write intermediate results to a band file (for debugging)
+        {"threads",  required_argument, NULL, 't'},    //!< Number of threads used for decoding
+        {"allocator", required_argument, NULL, 'a'},   //!< Memory allocation scheme
+        {"stats",    no_argument,       NULL, 's'},    //!< Print statistics after decoding
+        {"resolution", required_argument, NULL, 'r'},  //!< Resolution of the decoded image
+        {"thumbnail", no_argument,     NULL, 'T'},    //!< Decode a thumbnail from the lowpass bands
+        {"roi",      required_argument, NULL, 'R'},    //!< Region of the image to decode
         {"verbose",  no_argument,       NULL, 'v'},    //!< Enable verbose output (for debugging)
 		{"debug",    no_argument,       NULL, 'z'},    //!< Enable extra output for debugging
         {"quiet",    no_argument,       NULL, 'q'},    //!< Suppress all output to the terminal
@@ -239,7 +264,7 @@ CODEC_ERROR ParseParameters(int argc, char *argv[], PARAMETERS *parameters, FILE
 
 	// Process the command-line options
 	//while ((c = getopt_long(argc, argv, "i:w:h:p:o:P:LS:B:v", long_options, &option_index)) != -1)
-	while ((c = getopt_long(argc, argv, "w:h:p:o:P:S:M:B:vzq", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, argv, "w:h:p:o:P:S:M:B:t:a:sr:TR:vzq", long_options, &option_index)) != -1)
 	{
         assert(c != 0);
 
@@ -292,6 +317,42 @@ CODEC_ERROR ParseParameters(int argc, char *argv[], PARAMETERS *parameters, FILE
 				help_flag = true;
 			}
 			break;
+
+		case 't':
+			if (!GetThreadCount(optarg, &parameters->thread_count)) {
+				printf("Bad thread count\n");
+				help_flag = true;
+			}
+			break;
+
+		case 'a':
+			if (!GetAllocatorType(optarg, &parameters->allocator_type)) {
+				printf("Bad allocator\n");
+				help_flag = true;
+			}
+			break;
+
+		case 's':
+			parameters->stats_flag = true;
+			break;
+
+		case 'r':
+			if (!GetResolution(optarg, &parameters->resolution)) {
+				printf("Bad decoded resolution: %s\n", optarg);
+				help_flag = true;
+			}
+			break;
+
+		case 'T':
+			parameters->thumbnail_flag = true;
+			break;
+
+		case 'R':
+			if (!GetRegionOfInterest(optarg, &parameters->roi)) {
+				printf("Bad region of interest: %s\n", optarg);
+				help_flag = true;
+			}
+			break;
                 
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
         case 'L':
@@ -344,6 +405,11 @@ CODEC_ERROR ParseParameters(int argc, char *argv[], PARAMETERS *parameters, FILE
 			break;
 		}
 	}
+
+    // The thumbnail is the image decoded at the lowest resolution in every decoding mode
+    if (parameters->thumbnail_flag) {
+        parameters->resolution = RESOLUTION_EIGHTH;
+    }
     
     // The remaining command line arguments must be input pathname followed by the output pathnames
     
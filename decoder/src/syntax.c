@@ -114,18 +114,14 @@ bool IsValidSegment(BITSTREAM *stream, TAGVALUE segment, TAGWORD tag)
 */
 CODEC_ERROR AlignBitsSegment(BITSTREAM *bitstream)
 {
-	STREAM *stream = bitstream->stream;
 	size_t byte_count;
 
 	// Byte align the bitstream
 	AlignBitsByte(bitstream);
 	assert((bitstream->count % 8) == 0);
 
-	// Compute the number of bytes in the bit buffer
-	byte_count = bitstream->count / 8;
-
-	// Add the number of bytes read from the stream
-	byte_count += stream->byte_count;
+	// Compute the number of bytes read from the sample
+	byte_count = GetBitstreamPosition(bitstream);
 
 	while ((byte_count % sizeof(TAGVALUE)) != 0)
 	{
@@ -134,7 +130,7 @@ CODEC_ERROR AlignBitsSegment(BITSTREAM *bitstream)
 	}
 
 	// The bitstream should be aligned to the next segment
-	assert((bitstream->count == 0) || (bitstream->count == bit_word_count));
+	assert(IsAlignedSegment(bitstream));
 	assert((byte_count % sizeof(TAGVALUE)) == 0);
 
 	return CODEC_ERROR_OKAY;
@@ -153,5 +149,5 @@ bool IsTagValue(TAGVALUE segment, int tag, TAGWORD value)
 */
 bool IsAlignedTag(BITSTREAM *stream)
 {
-	return ((stream->count % BITSTREAM_TAG_SIZE) == 0);
+	return ((GetBitstreamBitCount(stream) % BITSTREAM_TAG_SIZE) == 0);
 }
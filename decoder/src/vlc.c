@@ -10,9 +10,12 @@
 
 
 /*!
-	@brief Parse a run length coded magnitude in the bitstream
+	@brief Parse a run length coded magnitude by searching the codebook
+
+	This routine reads the codeword from the bitstream one codeword size at a time
+	and compares the bits with every codeword of that size in the codebook.
 */
-CODEC_ERROR GetRlv(BITSTREAM *stream, CODEBOOK *codebook, RUN *run)
+static CODEC_ERROR SearchCodebook(BITSTREAM *stream, CODEBOOK *codebook, RUN *run)
 {
 	BITWORD bitstream_bits = 0;			// Buffer of bits read from the stream
 	BITCOUNT bitstream_count = 0;		// Number of bits read from the stream
@@ -59,16 +62,112 @@ found:
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Parse a run length coded value using the table for decoding codewords
+
+	The next bits in the bit buffer are used to index the decoding table and the
+	sub-tables for longer codewords.  The unused bits in the bit buffer are zero,
+	so the decoded entry is only valid if the codeword (and the sign bit if the
+	sign was decoded) is contained in the bits remaining in the bit buffer.
+
+	If the signed flag is true and the codeword is a coefficient magnitude, then
+	the value returned by this routine includes the sign that follows the magnitude.
+
+	Returns false if the codeword could not be decoded from the bit buffer and must
+	be parsed by searching the codebook.  The bitstream is not changed in that case.
+*/
+static inline bool LookupRun(BITSTREAM *stream, const VLD_TABLE *table, RUN *run, bool signed_flag)
+{
+	const VLD *entries = (const VLD *)((const uint8_t *)table + sizeof(VLD_TABLE));
+	const VLD *entry;
+	BITCOUNT index_count = VLD_TABLE_BITS;
+	BITCOUNT shift = 0;
+	BITCOUNT size;
+	int32_t value;
+
+	// Fill the bit buffer so that most codewords can be decoded without a refill
+	FillBits(stream);
+
+	// Look up the next bits in the primary table
+	entry = &entries[PeekBits(stream, index_count)];
+
+	// Follow the links to the sub-tables for longer codewords
+	while (entry->flags & VLD_FLAGS_SUBTABLE)
+	{
+		BITWORD index;
+
+		shift += index_count;
+		index_count = entry->size;
+		index = (BITWORD)((stream->buffer << shift) >> (bit_buffer_count - index_count));
+		entry = &entries[entry->count + index];
+	}
+
+	// Compute the number of bits used by the codeword (including the sign bit if decoded)
+	size = entry->size;
+	value = entry->value;
+
+	if (entry->flags & VLD_FLAGS_SIGNED)
+	{
+		if (signed_flag) {
+			size += VLC_SIGNCODE_SIZE;
+		}
+		else {
+			value = abs(value);
+		}
+	}
+
+	// Is the entry a codeword that was decoded from bits in the bit buffer?
+	if (! (0 < size && size <= stream->count)) {
+		return false;
+	}
+
+	// Remove the codeword from the bit buffer
+	ConsumeBits(stream, size);
+
+	// Read the sign bit if it was not included in the bits used to index the table
+	if (signed_flag && (entry->flags & VLD_FLAGS_SIGN_FOLLOWS))
+	{
+		BITWORD sign = GetBits(stream, VLC_SIGNCODE_SIZE);
+		value = ((sign == VLC_NEGATIVE_CODE) ? neg(value) : value);
+	}
+
+	run->count = entry->count;
+	run->value = value;
+
+	return true;
+}
+
+/*!
+	@brief Parse a run length coded magnitude in the bitstream
+
+	The decoding table is computed from the codebook by @ref CreateDecodingTable.
+	The codeword is parsed by searching the codebook if the table is null.
+*/
+CODEC_ERROR GetRlv(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, RUN *run)
+{
+	// Decode the codeword using the decoding table if possible
+	if (table != NULL && LookupRun(stream, table, run, false)) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	return SearchCodebook(stream, codebook, run);
+}
+
 /*!
 	Parse a run length coded signed value in the bitstream
 */
-CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, RUN *run)
+CODEC_ERROR GetRun(BITSTREAM *stream, CODEBOOK *codebook, const VLD_TABLE *table, RUN *run)
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	int32_t value;
 
+	// Decode the codeword and the sign bit using the decoding table if possible
+	if (table != NULL && LookupRun(stream, table, run, true)) {
+		return CODEC_ERROR_OKAY;
+	}
+
 	// Get the magnitude of the number from the bitstream
-	error = GetRlv(stream, codebook, run);
+	error = SearchCodebook(stream, codebook, run);
 
 	// Error while parsing the bitstream?
 	if (error != CODEC_ERROR_OKAY) {
@@ -30,7 +30,9 @@ CODEC_ERROR InitWavelet(WAVELET *wavelet, DIMENSION width, DIMENSION height)
 /*!
 	@brief Allocate a wavelet data structure with the specified dimensions
 
-	@todo Is it necessary to align the pitch?
+	The pitch is rounded up to a multiple of the allocator alignment and each
+	band is followed by tail padding, so the vectorized filters can process
+	whole vectors at the end of each row.
 */
 CODEC_ERROR AllocWavelet(ALLOCATOR *allocator, WAVELET *wavelet, DIMENSION width, DIMENSION height)
 {
@@ -39,15 +41,15 @@ CODEC_ERROR AllocWavelet(ALLOCATOR *allocator, WAVELET *wavelet, DIMENSION width
 
 	if (width > 0 && height > 0)
 	{
-		DIMENSION pitch = width * sizeof(PIXEL);
+		DIMENSION pitch = (DIMENSION)ALIGNED_PITCH(width * sizeof(PIXEL));
 
-		size_t band_data_size = height * pitch;
+		size_t band_data_size = height * pitch + ALLOCATOR_TAIL_PADDING;
 		int band;
 
 		// Allocate the wavelet bands
 		for (band = 0; band < MAX_BAND_COUNT; band++)
 		{
-			wavelet->data[band] = (PIXEL *)Alloc(allocator, band_data_size);
+			wavelet->data[band] = (PIXEL *)AllocTagged(allocator, band_data_size, ALLOCATOR_TAG_WAVELET);
 			if (wavelet->data[band] == NULL) {
 				ReleaseWavelet(allocator, wavelet);
 				return CODEC_ERROR_OUTOFMEMORY;
@@ -122,6 +124,8 @@ CODEC_ERROR DeleteWavelet(ALLOCATOR *allocator, WAVELET *wavelet)
 	This routine reconstructs the lowpass band in the output wavelet from the
 	decoded bands in the input wavelet.  The prescale argument is used to undo
 	scaling that may have been performed during encoding to prevent overflow.
+
+	The highpass bands were dequantized when the bands were decoded.
 	
 	@todo Replace the two different routines for different prescale shifts with
 	a single routine that can handle any prescale shift.
@@ -164,15 +168,15 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(ALLOCATOR *allocator, WAVELET *i
 		assert(prescale == 2);
 
 		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuantDescale16s(allocator,
-									 (PIXEL *)input->data[0], input->pitch,
-									 (PIXEL *)input->data[1], input->pitch,
-									 (PIXEL *)input->data[2], input->pitch,
-									 (PIXEL *)input->data[3], input->pitch,
-									 output->data[0], output->pitch,
-									 input_width, input_height,
-									 output_width, output_height,
-									 prescale, input->quant);
+		InvertSpatialDescale16s(allocator,
+								(PIXEL *)input->data[0], input->pitch,
+								(PIXEL *)input->data[1], input->pitch,
+								(PIXEL *)input->data[2], input->pitch,
+								(PIXEL *)input->data[3], input->pitch,
+								output->data[0], output->pitch,
+								input_width, input_height,
+								output_width, output_height,
+								prescale);
 	}
 	else
 	{
@@ -180,15 +184,14 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(ALLOCATOR *allocator, WAVELET *i
 		assert(prescale == 0);
 
 		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuant16s(allocator,
-							  (PIXEL *)input->data[0], input->pitch,
-							  (PIXEL *)input->data[1], input->pitch,
-							  (PIXEL *)input->data[2], input->pitch,
-							  (PIXEL *)input->data[3], input->pitch,
-							  output->data[0], output->pitch,
-							  input_width, input_height,
-							  output_width, output_height,
-							  input->quant);
+		InvertSpatial16s(allocator,
+						 (PIXEL *)input->data[0], input->pitch,
+						 (PIXEL *)input->data[1], input->pitch,
+						 (PIXEL *)input->data[2], input->pitch,
+						 (PIXEL *)input->data[3], input->pitch,
+						 output->data[0], output->pitch,
+						 input_width, input_height,
+						 output_width, output_height);
 	}
 
 	return CODEC_ERROR_OKAY;
@@ -200,6 +203,8 @@ CODEC_ERROR TransformInverseSpatialQuantLowpass(ALLOCATOR *allocator, WAVELET *i
 	This routine reconstructs the lowpass band in the output wavelet from the
 	decoded bands in the input wavelet.  The prescale argument is used to undo
 	scaling that may have been performed during encoding to prevent overflow.
+
+	The highpass bands were dequantized when the bands were decoded.
 */
 CODEC_ERROR TransformInverseSpatialQuantArray(ALLOCATOR *allocator,
 											  WAVELET *input,
@@ -240,15 +245,15 @@ CODEC_ERROR TransformInverseSpatialQuantArray(ALLOCATOR *allocator,
 		assert(prescale == 2);
 
 		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuantDescale16s(allocator,
-									 (PIXEL *)input->data[0], input->pitch,
-									 (PIXEL *)input->data[1], input->pitch,
-									 (PIXEL *)input->data[2], input->pitch,
-									 (PIXEL *)input->data[3], input->pitch,
-									 (PIXEL *)output_buffer, (int)output_pitch,
-									 input_width, input_height,
-									 output_width, output_height,
-									 prescale, input->quant);
+		InvertSpatialDescale16s(allocator,
+								(PIXEL *)input->data[0], input->pitch,
+								(PIXEL *)input->data[1], input->pitch,
+								(PIXEL *)input->data[2], input->pitch,
+								(PIXEL *)input->data[3], input->pitch,
+								(PIXEL *)output_buffer, (int)output_pitch,
+								input_width, input_height,
+								output_width, output_height,
+								prescale);
 	}
 	else
 	{
@@ -256,15 +261,113 @@ CODEC_ERROR TransformInverseSpatialQuantArray(ALLOCATOR *allocator,
 		assert(prescale == 0);
 
 		// Apply the inverse spatial transform for a lowpass band that is not prescaled
-		InvertSpatialQuant16s(allocator,
-							  (PIXEL *)input->data[0], input->pitch,
-							  (PIXEL *)input->data[1], input->pitch,
-							  (PIXEL *)input->data[2], input->pitch,
-							  (PIXEL *)input->data[3], input->pitch,
-							  (PIXEL *)output_buffer, (int)output_pitch,
-							  input_width, input_height,
-							  output_width, output_height,
-							  input->quant);
+		InvertSpatial16s(allocator,
+						 (PIXEL *)input->data[0], input->pitch,
+						 (PIXEL *)input->data[1], input->pitch,
+						 (PIXEL *)input->data[2], input->pitch,
+						 (PIXEL *)input->data[3], input->pitch,
+						 (PIXEL *)output_buffer, (int)output_pitch,
+						 input_width, input_height,
+						 output_width, output_height);
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Apply the inverse wavelet transform to reconstruct a region of the output
+
+	The output buffer contains the region of the output (a lowpass band or a component
+	array) with the specified dimensions.  The output values outside the region are not
+	computed.  The prescale argument is used to undo scaling that may have been performed
+	during encoding to prevent overflow.
+
+	The highpass bands were dequantized when the bands were decoded.
+*/
+CODEC_ERROR TransformInverseSpatialRegion(ALLOCATOR *allocator,
+										  WAVELET *input,
+										  PIXEL *output_buffer,
+										  size_t output_pitch,
+										  DIMENSION output_width,
+										  DIMENSION output_height,
+										  const ROI *region,
+										  PRESCALE prescale)
+{
+	// Check that a valid input image has been provided
+	assert(input != NULL);
+	assert(input->data[0] != NULL);
+	assert(input->data[1] != NULL);
+	assert(input->data[2] != NULL);
+	assert(input->data[3] != NULL);
+
+	assert(output_buffer != NULL && output_pitch > 0);
+
+	// Only the prescale values used by the other inverse transforms are supported
+	assert(prescale == 0 || prescale == 2);
+
+	return InvertSpatialRegion16s(allocator,
+								  (PIXEL *)input->data[0], input->pitch,
+								  (PIXEL *)input->data[1], input->pitch,
+								  (PIXEL *)input->data[2], input->pitch,
+								  (PIXEL *)input->data[3], input->pitch,
+								  output_buffer, (int)output_pitch,
+								  input->width, input->height,
+								  output_width, output_height,
+								  region, (prescale > 1) ? prescale : 0);
+}
+
+/*!
+	@brief Compute a component array from the lowpass band in a wavelet
+
+	This routine is used for decoding an image at reduced resolution.  The
+	lowpass band is reduced by the gain of the forward wavelet transforms less
+	the prescale shifts applied during encoding and clamped to the range of the
+	component values.
+
+	The region is the part of the lowpass band that is copied into the output.
+*/
+CODEC_ERROR TransformLowpassArray(WAVELET *input,
+								  const ROI *region,
+								  COMPONENT_VALUE *output_buffer,
+								  size_t output_pitch,
+								  int shift,
+								  PRECISION bits_per_component)
+{
+	const int32_t maximum = (1 << bits_per_component) - 1;
+	const int32_t rounding = (shift > 0) ? (1 << (shift - 1)) : 0;
+	int row;
+
+	assert(input != NULL && input->data[0] != NULL);
+	if (! (input != NULL && input->data[0] != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	assert(region->x + region->width <= input->width && region->y + region->height <= input->height);
+	if (! (region->x + region->width <= input->width && region->y + region->height <= input->height)) {
+		return CODEC_ERROR_IMAGE_DIMENSIONS;
+	}
+
+	assert(0 <= shift);
+
+	for (row = 0; row < region->height; row++)
+	{
+		const PIXEL *lowpass = (PIXEL *)((uint8_t *)input->data[0] + (region->y + row) * input->pitch) + region->x;
+		COMPONENT_VALUE *output = (COMPONENT_VALUE *)((uint8_t *)output_buffer + row * output_pitch);
+		int column;
+
+		for (column = 0; column < region->width; column++)
+		{
+			int32_t value = (lowpass[column] + rounding) >> shift;
+
+			if (value < 0) {
+				value = 0;
+			}
+			else if (value > maximum) {
+				value = maximum;
+			}
+
+			output[column] = (COMPONENT_VALUE)value;
+		}
 	}
 
 	return CODEC_ERROR_OKAY;
@@ -0,0 +1,179 @@
+#!/usr/bin/env bash
+#
+# Check the encoder and decoder options for threads, resolution, and regions
+#
+# The reference bitstream is encoded on one thread and the reference images are
+# decoded on one thread.  The bitstreams encoded with more threads or written to
+# the standard output must be identical to the reference bitstream.  The images
+# decoded with more threads must be identical to the reference image decoded at
+# the same resolution, a thumbnail must be identical to the image decoded at one
+# eighth resolution, and a region must be identical to the same region cropped
+# from the image decoded at full resolution.
+
+# Default input image (RG48 with six bytes per pixel)
+imagefile=../media/boxes/1280x720/rg48/boxes-1280x720-0000.rg48
+
+# Default image width and height
+width=1280
+height=720
+
+# Location of the reference encoder and decoder
+encoder=../encoder/build/linux/debug/encoder
+decoder=./build/linux/debug/decoder
+
+# Location for the bitstreams and decoded images
+outdir=./test
+
+# Define the usage message
+usage() { echo "Usage: $0 [-i imagefile] [-w width] [-h height] [-d <outdir>]" 1>&2; exit 1; }
+
+# Parse the command-line options
+while getopts "i:w:h:d:" arg; do
+
+	case $arg in
+
+	i) # Input image file
+		imagefile=${OPTARG}
+		;;
+
+	w) # Image width
+		width=${OPTARG}
+		;;
+
+	h) # Image height
+		height=${OPTARG}
+		;;
+
+	d) # Specify the output directory
+		outdir=${OPTARG}
+		;;
+
+    ?) # Display the usage message
+		usage
+		;;
+
+	esac
+
+done
+
+# Create the output directory
+if [ ! -d "$outdir" ]; then
+	echo "Creating directory: $outdir"
+	mkdir -p $outdir
+fi
+
+# Number of bytes per pixel in the decoded images
+pixel_size=6
+
+status=0
+
+# Report the result of comparing an output file with the reference file
+report() {
+	name=$1
+	output=$2
+	reference=$3
+
+	if [ -s "$output" ] && cmp -s "$output" "$reference"; then
+		echo "${name}: ok"
+	else
+		echo "${name}: FAILED"
+		status=1
+	fi
+}
+
+# Crop a region from an image decoded at full resolution
+crop() {
+	input=$1
+	x=$2
+	y=$3
+	w=$4
+	h=$5
+	output=$6
+
+	rm -f "$output"
+	for ((row = y; row < y + h; row++)); do
+		dd if="$input" bs=$pixel_size skip=$((row * width + x)) count=$w status=none >> "$output"
+	done
+}
+
+# Encode the reference bitstream on one thread
+bitstream=${outdir}/options.vc5
+rm -f "$bitstream"
+$encoder -q -t 1 -w $width -h $height "$imagefile" "$bitstream"
+
+if ! [ -s "$bitstream" ]; then
+	echo "Could not encode the reference bitstream: $bitstream"
+	exit 1
+fi
+
+# The bitstream must not depend on the number of threads or the parallel mode
+for threads in 2 4; do
+	for mode in channels subbands; do
+		output=${outdir}/options-t${threads}-${mode}.vc5
+		rm -f "$output"
+		$encoder -q -t $threads -m $mode -w $width -h $height "$imagefile" "$output"
+		report "encode -t ${threads} -m ${mode}" "$output" "$bitstream"
+	done
+done
+
+# The bitstream written to the standard output must be the same as the file
+output=${outdir}/options-stdout.vc5
+$encoder -t 4 -w $width -h $height "$imagefile" - > "$output"
+report "encode to standard output" "$output" "$bitstream"
+
+# Decode the reference image at each resolution on one thread
+scale=1
+for resolution in full half quarter eighth; do
+	reference=${outdir}/options-${resolution}.rg48
+	rm -f "$reference"
+	$decoder -q -t 1 -r $resolution "$bitstream" "$reference" > /dev/null
+
+	# The reference image must have the dimensions of the decoded resolution
+	size=$(( (width / scale) * (height / scale) * pixel_size ))
+	if [ -f "$reference" ] && [ $(wc -c < "$reference") -eq $size ]; then
+		echo "decode -r ${resolution}: ok"
+	else
+		echo "decode -r ${resolution}: FAILED"
+		status=1
+	fi
+
+	for threads in 2 4; do
+		output=${outdir}/options-${resolution}-t${threads}.rg48
+		rm -f "$output"
+		$decoder -q -t $threads -r $resolution "$bitstream" "$output" > /dev/null
+		report "decode -r ${resolution} -t ${threads}" "$output" "$reference"
+	done
+
+	scale=$((scale * 2))
+done
+
+# The image decoded without a resolution must be the full resolution image
+output=${outdir}/options-default.rg48
+rm -f "$output"
+$decoder -q "$bitstream" "$output" > /dev/null
+report "decode" "$output" ${outdir}/options-full.rg48
+
+# A thumbnail is decoded at one eighth resolution
+for threads in 1 4; do
+	output=${outdir}/options-thumbnail-t${threads}.rg48
+	rm -f "$output"
+	$decoder -q -t $threads -T "$bitstream" "$output" > /dev/null
+	report "decode -T -t ${threads}" "$output" ${outdir}/options-eighth.rg48
+done
+
+# Each region must be the same as the region cropped from the full resolution image
+for region in "0,0,64,64" "100,50,200,120" "$((width - 64)),$((height - 32)),64,32" "3,5,7,9" "0,$((height / 2)),${width},16"; do
+	IFS=, read x y w h <<< "$region"
+
+	reference=${outdir}/options-crop.rg48
+	crop ${outdir}/options-full.rg48 $x $y $w $h "$reference"
+
+	for threads in 1 4; do
+		output=${outdir}/options-region-t${threads}.rg48
+		rm -f "$output"
+		$decoder -q -t $threads -R $region "$bitstream" "$output" > /dev/null
+		report "decode -R ${region} -t ${threads}" "$output" "$reference"
+	done
+done
+
+exit $status
@@ -0,0 +1,85 @@
+#!/usr/bin/env bash
+#
+# Check that every image section is decoded at each decoded resolution
+#
+# The same input image is encoded twice as image sections in one bitstream.
+# The decoder must write both sections at full, half, quarter, and eighth
+# resolution and the two decoded images must be identical.
+
+# Default input image (the dimensions are obtained from the pathname)
+imagefile=../media/boxes/1280x720/rg48/boxes-1280x720-0000.rg48
+
+# Location of the reference encoder and decoder
+encoder=../encoder/build/linux/debug/encoder
+decoder=./build/linux/debug/decoder
+
+# Location for the bitstream and decoded images
+outdir=./test
+
+# Define the usage message
+usage() { echo "Usage: $0 [-i imagefile] [-d <outdir>]" 1>&2; exit 1; }
+
+# Parse the command-line options
+while getopts "i:d:" arg; do
+
+	case $arg in
+
+	i) # Input image file
+		imagefile=${OPTARG}
+		;;
+
+	d) # Specify the output directory
+		outdir=${OPTARG}
+		;;
+
+    ?) # Display the usage message
+		usage
+		;;
+
+	esac
+
+done
+
+# Create the output directory
+if [ ! -d "$outdir" ]; then
+	echo "Creating directory: $outdir"
+	mkdir -p $outdir
+fi
+
+# The section encoder obtains the dimensions of each image from the pathname
+filename=${imagefile##*/}
+extension=${filename##*.}
+section0=${outdir}/${filename%.*}-section0.${extension}
+section1=${outdir}/${filename%.*}-section1.${extension}
+bitstream=${outdir}/${filename%.*}-sections.vc5
+
+ln -sf "$(cd "$(dirname "$imagefile")" && pwd)/${filename}" "$section0"
+ln -sf "$(cd "$(dirname "$imagefile")" && pwd)/${filename}" "$section1"
+
+# Encode the image twice as image sections in a single bitstream
+if ! $encoder -q -P 6 -S 1,2,4,5,6 "$section0" "$section1" "$bitstream"; then
+	echo "Could not encode the image sections: $bitstream"
+	exit 1
+fi
+
+status=0
+
+for resolution in full half quarter eighth; do
+
+	output0=${outdir}/${filename%.*}-${resolution}-0.${extension}
+	output1=${outdir}/${filename%.*}-${resolution}-1.${extension}
+	rm -f "$output0" "$output1"
+
+	$decoder -q -P 6 -S 1,2,4,5,6 -r $resolution "$bitstream" "$output0" "$output1"
+
+	# Both sections must be decoded and the decoded images must be the same
+	if [ -s "$output0" ] && [ -s "$output1" ] && cmp -s "$output0" "$output1"; then
+		echo "${resolution}: ok"
+	else
+		echo "${resolution}: FAILED"
+		status=1
+	fi
+
+done
+
+exit $status
@@ -38,12 +38,20 @@ static const BITCOUNT bit_word_count = 32;
 //! Sample offset stack depth
 #define MAX_SAMPLE_OFFSET_COUNT		8
 
+//! Number of bytes collected by the bitstream before writing to a file
+#define BITSTREAM_BLOCK_SIZE		16384
+
 /*!
 	@brief Declaration of the bitstream data structure
 
 	The bitstream uses a byte stream to read bytes from a file or a buffer
 	in memory.  This isolates that bitstream module from the type of byte
 	stream.
+
+	Each full bit buffer written to a file is appended to a block of bytes
+	that is written to the file when the block is full, so the file is not
+	written one word at a time.  The words written to a memory stream are
+	stored directly in the memory buffer.
 */
 typedef struct _bitstream
 {
@@ -69,6 +77,12 @@ typedef struct _bitstream
 	//! Number of entries in the sample offset stack
 	uint_fast8_t sample_offset_count;
 
+	//! Words that have not been written to the file
+	uint8_t block[BITSTREAM_BLOCK_SIZE];
+
+	//! Number of bytes in the block
+	size_t block_count;
+
 	//! File for bitstream debugging output
 	FILE *logfile;
 
@@ -119,4 +133,6 @@ uint32_t PopSampleOffsetStack(BITSTREAM *bitstream);
 
 CODEC_ERROR PutByteArray(BITSTREAM *bitstream, const uint8_t *block, size_t size);
 
+CODEC_ERROR AppendBitstream(BITSTREAM *bitstream, BITSTREAM *payload);
+
 #endif
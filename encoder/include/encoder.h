@@ -21,6 +21,24 @@ typedef struct _aspect_ratio
 
 } ASPECT_RATIO;
 
+/*!
+	@brief Timers for the stages of the encoding process
+
+	The timers record the time spent by all threads in each stage, so the time
+	for a stage can exceed the elapsed time if the channels or subbands are
+	encoded in parallel.  In the modes that encode the subbands into separate
+	bitstreams, the time for copying the encoded subbands into the output
+	bitstream is recorded by the write timer.
+*/
+typedef struct _encoder_timing
+{
+	TIMER unpack;						//!< Time for unpacking the input image into component arrays
+	TIMER transform[MAX_WAVELET_COUNT];	//!< Time for the forward wavelet transforms at each level
+	TIMER encoding[MAX_SUBBAND_COUNT];	//!< Time for entropy coding each subband
+	TIMER write;						//!< Time for writing headers and encoded subbands into the bitstream
+
+} ENCODER_TIMING;
+
 /*!
 	@brief Data structure for the buffers and information used by the encoder
 
@@ -177,12 +195,6 @@ typedef struct _encoder
 	//! Scratch buffer for unpacking the input image
 	PIXEL *unpacked_buffer[MAX_CHANNEL_COUNT];
 
-	//! Six rows of horizontal lowpass results for each channel
-	PIXEL *lowpass_buffer[MAX_CHANNEL_COUNT][6];
-
-	//! Six rows of horizontal highpass results for each channel
-	PIXEL *highpass_buffer[MAX_CHANNEL_COUNT][6];
-
 	//! Parameter that controls the amount of rounding before quantization
 	int midpoint_prequant;
 
@@ -198,12 +210,15 @@ typedef struct _encoder
 	//! Number of entries in the channel order table (may be less than the channel count)
 	int channel_order_count;
 
-	struct _timing
-	{
-		TIMER transform;	//!< Time for wavelet transforms
-		TIMER encoding;		//!< Time for entropy coding
+	int thread_count;			//!< Number of threads used for encoding the channels
+	PARALLEL_MODE parallel_mode;	//!< Method used for dividing the work among the threads
+	THREAD_POOL *pool;			//!< Thread pool used while encoding the channels (or null)
+
+	//! Entropy coded subbands that are appended to the bitstream (when encoding subbands in parallel)
+	BITSTREAM *encoded_subband[MAX_CHANNEL_COUNT][MAX_SUBBAND_COUNT];
 
-	} timing;		//!< Timers for measuring encoder performance
+	//! Timers for measuring encoder performance (null if the stages are not timed)
+	ENCODER_TIMING *timing;
 
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
     uint8_t image_sequence_identifier[16];      //!< UUID used for the unique image identifier
@@ -252,6 +267,10 @@ extern "C" {
 
 CODEC_ERROR InitEncoder(ENCODER *encoder, const ALLOCATOR *allocator, const VERSION *version);
 
+CODEC_ERROR InitEncoderTiming(ENCODER_TIMING *timing);
+
+CODEC_ERROR PrintEncoderTiming(ENCODER_TIMING *timing, FILE *file);
+
 //TAGWORD PackedEncoderVersion(ENCODER *encoder);
 
 CODEC_ERROR CodecErrorBitstream(BITSTREAM_ERROR error);
@@ -279,6 +298,8 @@ CODEC_ERROR AllocEncoderBuffers(ENCODER *encoder);
 
 CODEC_ERROR EncodeImage(IMAGE *image, STREAM *stream, const PARAMETERS *parameters);
 
+CODEC_ERROR EncodeImageToBuffer(IMAGE *image, void **buffer, size_t *size, const PARAMETERS *parameters);
+
 CODEC_ERROR EncodingProcess(ENCODER *encoder,
 							const UNPACKED_IMAGE *image,
 							BITSTREAM *stream,
@@ -315,6 +336,8 @@ CODEC_ERROR EncodeExtensionTrailer(ENCODER *encoder, BITSTREAM *bitstream);
 
 CODEC_ERROR EncodeMultipleChannels(ENCODER *encoder, const UNPACKED_IMAGE *image, BITSTREAM *stream);
 
+CODEC_ERROR TransformChannelWavelets(ENCODER *encoder, const UNPACKED_IMAGE *image, int channel_index);
+
     
 #if VC5_ENABLED_PART(VC5_PART_LAYERS) || VC5_ENABLED_PART(VC5_PART_SECTIONS)
 CODEC_ERROR EncodeImageList(IMAGE_LIST *image_list, STREAM *stream, const PARAMETERS *parameters);
@@ -392,10 +415,6 @@ CODEC_ERROR PutVideoSubbandTrailer(ENCODER *encoder, BITSTREAM *stream);
 
 CODEC_ERROR TransformForwardSpatialQuantFrame(ENCODER *encoder, void *buffer, size_t pitch);
 
-CODEC_ERROR AllocateEncoderHorizontalBuffers(ENCODER *encoder, int buffer_width);
-
-CODEC_ERROR DeallocateEncoderHorizontalBuffers(ENCODER *encoder);
-
 CODEC_ERROR AllocateEncoderUnpackingBuffers(ENCODER *encoder, int frame_width);
 
 CODEC_ERROR DeallocateEncoderUnpackingBuffers(ENCODER *encoder);
@@ -411,19 +430,33 @@ CODEC_ERROR DeallocateHorizontalBuffers(ALLOCATOR *allocator,
 
 //CODEC_ERROR UnpackImageRow(ENCODER *encoder, uint8_t *input_row_ptr);
 
-CODEC_ERROR ShiftHorizontalResultBuffers(ENCODER *encoder);
-
 CODEC_ERROR ShiftHorizontalBuffers(PIXEL *lowpass[], PIXEL *highpass[]);
 
 CODEC_ERROR TransformForwardSpatialChannel(ENCODER *encoder, const UNPACKED_IMAGE *image, int channel_number);
 
 CODEC_ERROR TransformForwardSpatialLowpass(ENCODER *encoder, WAVELET *input, WAVELET *output, int prescale);
 
+CODEC_ERROR TransformForwardSpatialStrip(ALLOCATOR *allocator,
+										 PIXEL *input,
+										 size_t input_pitch,
+										 DIMENSION input_width,
+										 DIMENSION input_height,
+										 WAVELET *output,
+										 DIMENSION wavelet_width,
+										 int prescale,
+										 int midpoint_prequant,
+										 int first_row,
+										 int last_row);
+
 CODEC_ERROR PadWaveletBands(ENCODER *encoder, WAVELET *wavelet);
 
 CODEC_ERROR EncodeLowpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_number, BITSTREAM *stream);
 
-CODEC_ERROR EncodeHighpassBand(ENCODER *encoder, WAVELET *wavelet, int band, int subband, BITSTREAM *stream);
+CODEC_ERROR EncodeHighpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_number, int band, int subband, BITSTREAM *stream);
+
+CODEC_ERROR EncodeLowpassCoefficients(ENCODER *encoder, WAVELET *wavelet, int channel_number, BITSTREAM *stream);
+
+CODEC_ERROR EncodeHighpassCoefficients(ENCODER *encoder, WAVELET *wavelet, int band, BITSTREAM *stream);
 
 CODEC_ERROR EncodeHighpassBandLongRuns(BITSTREAM *stream, CODESET *codeset, PIXEL *data,
 									   DIMENSION width, DIMENSION height, DIMENSION pitch);
@@ -43,6 +43,9 @@
 #include "macros.h"
 #include "error.h"
 #include "allocator.h"
+#include "filemap.h"
+#include "cpu.h"
+#include "threadpool.h"
 #include "pixel.h"
 #include "color.h"
 #include "unpack.h"
@@ -56,6 +59,7 @@
 #include "stream.h"
 #include "swap.h"
 #include "forward.h"
+#include "kernels.h"
 #include "companding.h"
 #include "quantize.h"
 #include "codec.h"
@@ -78,6 +82,7 @@
 #endif
 
 #include "encoder.h"
+#include "parallel.h"
 #include "utilities.h"
 #include "unique.h"
 #include "identifier.h"
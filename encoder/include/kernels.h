@@ -0,0 +1,70 @@
+/*! @file encoder/include/kernels.h
+
+	Declaration of the kernels that apply the interior forward wavelet filters.
+
+	The kernels compute the lowpass and highpass results of the forward filter at
+	the interior positions in a row (horizontal filter) or across six rows (vertical
+	filter).  The scalar kernels are the reference implementation and the vectorized
+	kernels, selected at runtime using the processor features, compute the same results.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _KERNELS_H
+#define _KERNELS_H
+
+/*!
+	@brief Apply the interior forward horizontal filter to the pairs of columns in a row
+
+	The input argument points to the first input column in the first pair of columns
+	and the filter uses the pairs of columns before and after each pair, so the input
+	row must contain the pair of columns before the first pair and the pair after
+	the last pair.  The input values are prescaled before the highpass filter is applied.
+	The lowpass results are not clamped and the highpass results are clamped to the
+	range of the pixel values.
+*/
+typedef void (*FORWARD_COLUMNS_KERNEL)(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+									   int count, int prescale);
+
+/*!
+	@brief Apply the interior forward vertical filter to the columns in six rows of results
+
+	The six input rows are the horizontal results in the rows before, at, and after
+	the pair of input rows.  The lowpass and highpass results are quantized using the
+	quantization divisors and the midpoint setting (a divisor of one clamps the results
+	to the range of the pixel values).
+*/
+typedef void (*FORWARD_ROWS_KERNEL)(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+									QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant);
+
+/*!
+	@brief Table of the kernels used for the interior forward wavelet filters
+*/
+typedef struct _forward_kernels
+{
+	const char *name;						//!< Name of the instruction set used by the kernels
+	FORWARD_COLUMNS_KERNEL filter_columns;	//!< Forward horizontal filter
+	FORWARD_ROWS_KERNEL filter_rows;		//!< Forward vertical filter
+
+} FORWARD_KERNELS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const FORWARD_KERNELS *SelectForwardKernels(uint32_t cpu_features);
+
+const FORWARD_KERNELS *GetForwardKernels(void);
+
+void FilterInteriorColumns16s(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+							  int count, int prescale);
+
+void FilterInteriorRows16s(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+						   QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
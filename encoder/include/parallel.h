@@ -0,0 +1,46 @@
+/*! @file encoder/include/parallel.h
+
+	Declaration of the routines for encoding the channels in parallel.
+
+	Each channel is transformed and entropy coded by a task in the thread pool into a private
+	bitstream in memory.  The channel payloads are appended to the output bitstream
+	in the channel encoding order after all channels have been encoded.
+
+	Alternatively, the wavelet transforms for all channels are computed before the
+	subbands in all channels are entropy coded by tasks in the thread pool into private bitstreams
+	that are appended to the output bitstream after the subband headers.
+
+	Each wavelet transform can also be divided into horizontal strips of output rows
+	that are computed by separate tasks in the same thread pool.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool IsChannelOrderPermutation(const ENCODER *encoder);
+
+CODEC_ERROR EncodeChannelsParallel(ENCODER *encoder, const UNPACKED_IMAGE *image, BITSTREAM *stream);
+
+CODEC_ERROR EncodeSubbandsParallel(ENCODER *encoder, const UNPACKED_IMAGE *image, BITSTREAM *stream);
+
+CODEC_ERROR TransformForwardSpatialStrips(ENCODER *encoder,
+										  PIXEL *input,
+										  size_t input_pitch,
+										  DIMENSION input_width,
+										  DIMENSION input_height,
+										  WAVELET *output,
+										  DIMENSION wavelet_width,
+										  int prescale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -92,6 +92,20 @@ typedef struct bandfile_info
 } BANDFILE_INFO;
 
 
+/*!
+	@brief Method used for dividing the encoding work among threads
+
+	The channels can be transformed and encoded on separate threads or the
+	wavelet transforms can be computed for all channels before the subbands
+	in all channels are entropy coded on separate threads.
+*/
+typedef enum _parallel_mode
+{
+	PARALLEL_MODE_CHANNELS = 0,		//!< Transform and encode each channel on a separate thread
+	PARALLEL_MODE_SUBBANDS,			//!< Entropy code each subband on a separate thread
+
+} PARALLEL_MODE;
+
 /*!
 	@brief Declaration of a data structure for passing parameters to the encoder
 
@@ -114,6 +128,7 @@ typedef struct _parameters
     bool verbose_flag;                  //!< Control verbose output
     bool debug_flag;                    //!< Enable extra output for debugging
     bool quiet_flag;                    //!< Suppress all output to the terminal (overrides verbose and debug)
+    bool stats_flag;                    //!< Print statistics about the memory and time used by the encoder
 	ENABLED_PARTS enabled_parts;        //!< Parts of the VC-5 standard that are enabled
     
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
@@ -154,6 +169,21 @@ typedef struct _parameters
     //TODO: Consider changing the output pathname ro a pathname list
 
     BANDFILE_INFO bandfile;             //!< Information needed for writing the bandfile
+
+    //! Number of threads used for encoding (values less than two encode on the calling thread)
+    int thread_count;
+
+    //! Method used for dividing the encoding work among the threads
+    PARALLEL_MODE parallel_mode;
+
+    //! Memory allocation scheme selected on the command line
+    ALLOCATOR_TYPE allocator_type;
+
+    //! Memory allocator used by the encoder (null for the default allocator)
+    ALLOCATOR *allocator;
+
+    //! Timers for the stages of the encoding process (null if the stages are not timed)
+    struct _encoder_timing *timing;
     
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS) && VC5_ENABLED_PART(VC5_PART_LAYERS)
     //! Number of image sections and layers nexted within each image section
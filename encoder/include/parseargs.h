@@ -13,6 +13,8 @@
 CODEC_ERROR PrintHelpMessage(int argc, const char *argv[]);
 CODEC_ERROR ParseParameters(int argc, const char *argv[], PARAMETERS *parameters);
 
+bool GetParallelMode(const char *string, PARALLEL_MODE *parallel_mode_out);
+
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS) && VC5_ENABLED_PART(VC5_PART_LAYERS)
 bool GetImageSectionLayers(const char *string, PARAMETERS *parameters);
 #endif
@@ -14,6 +14,9 @@
 
 #include "headers.h"
 
+// Local functions
+static CODEC_ERROR PutBlockBytes(BITSTREAM *bitstream);
+
 /*!
 	@brief Return a mask with the specified number of bits set to one
 */
@@ -46,6 +49,7 @@ CODEC_ERROR InitBitstream(BITSTREAM *bitstream)
 		bitstream->stream = NULL;
 		bitstream->buffer = 0;
 		bitstream->count = 0;
+		bitstream->block_count = 0;
 
 		// Initialize the stack of sample offsets
 		memset(bitstream->sample_offset_stack, 0, sizeof(bitstream->sample_offset_stack));
@@ -71,6 +75,10 @@ CODEC_ERROR InitBitstream(BITSTREAM *bitstream)
 CODEC_ERROR AttachBitstream(struct _bitstream *bitstream, struct _stream *stream)
 {
 	assert(bitstream != NULL);
+
+	// Words collected for the previous byte stream must not be written to the new stream
+	assert(bitstream->block_count == 0);
+
 	bitstream->stream = stream;
 	return CODEC_ERROR_OKAY;
 }
@@ -178,8 +186,24 @@ CODEC_ERROR PutBuffer(BITSTREAM *bitstream)
 	// The bit buffer should be full
 	assert(bitstream->count == bit_word_count);
 
-	// Write the bit buffer to the byte stream
-	PutWord(bitstream->stream, Swap32(bitstream->buffer));
+	if (bitstream->stream->type == STREAM_TYPE_FILE)
+	{
+		uint32_t word = Swap32(bitstream->buffer);
+
+		// Write the block to the file when there is no room for another word
+		if (bitstream->block_count + sizeof(word) > sizeof(bitstream->block)) {
+			PutBlockBytes(bitstream);
+		}
+
+		// Append the bit buffer to the block
+		memcpy(&bitstream->block[bitstream->block_count], &word, sizeof(word));
+		bitstream->block_count += sizeof(word);
+	}
+	else
+	{
+		// Write the bit buffer to the byte stream
+		PutWord(bitstream->stream, Swap32(bitstream->buffer));
+	}
 
 	// Empty the bit buffer
 	bitstream->buffer = 0;
@@ -188,6 +212,22 @@ CODEC_ERROR PutBuffer(BITSTREAM *bitstream)
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Write the block of words collected by the bitstream to the byte stream
+*/
+static CODEC_ERROR PutBlockBytes(BITSTREAM *bitstream)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+
+	if (bitstream->block_count > 0)
+	{
+		error = PutBytes(bitstream->stream, bitstream->block, bitstream->block_count);
+		bitstream->block_count = 0;
+	}
+
+	return error;
+}
+
 /*!
 	@brief Write a longword (32 bits) to the stream
 */
@@ -260,6 +300,10 @@ CODEC_ERROR BitstreamCodecError(BITSTREAM *bitstream)
 	(and the associated byte stream) to be restored to the saved
 	position.
 
+	The block of words collected by the bitstream is written to the
+	byte stream, so the bytes before the position can be read and
+	updated in the byte stream.
+
 	@todo Need to record the state of the bitstream buffer and
 	bit count so that the entire bitstream state can be restored.
 */
@@ -272,6 +316,8 @@ size_t GetBitstreamPosition(BITSTREAM *bitstream)
 	// The bit buffer must be empty
 	assert(bitstream->count == 0);
 
+	PutBlockBytes(bitstream);
+
 	return (bitstream->stream->byte_count);
 }
 
@@ -333,6 +379,9 @@ CODEC_ERROR FlushBitstream(BITSTREAM *bitstream)
 	bitstream->count = 0;
 	bitstream->buffer = 0;
 
+	// Write the block of words to the byte stream
+	PutBlockBytes(bitstream);
+
 	// Flush the output stream
 	FlushStream(bitstream->stream);
 
@@ -362,3 +411,59 @@ CODEC_ERROR PutByteArray(BITSTREAM *bitstream, const uint8_t *array, size_t size
     
     return CODEC_ERROR_OKAY;
 }
+
+/*!
+	@brief Append the bytes written to another bitstream
+
+	The payload bitstream must be bound to a memory stream and both bitstreams
+	must be aligned to a segment boundary.  The bytes in the memory stream are
+	already in bitstream order, so the bytes are copied to the byte stream
+	without passing through the bit buffer.
+
+	The offsets in the sample offset stack of the payload bitstream are relative
+	to the start of its memory stream, so all chunk sizes in the payload must have
+	been updated before the payload is appended.
+*/
+CODEC_ERROR AppendBitstream(BITSTREAM *bitstream, BITSTREAM *payload)
+{
+	void *buffer;
+	size_t size;
+	CODEC_ERROR error;
+
+	assert(bitstream != NULL && payload != NULL);
+	if (! (bitstream != NULL && payload != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	assert(payload->sample_offset_count == 0);
+	if (! (payload->sample_offset_count == 0)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// Write the bits remaining in the payload to its memory stream
+	FlushBitstream(payload);
+
+	// Write out a full bit buffer before appending the payload
+	if (bitstream->count == bit_word_count) {
+		PutBuffer(bitstream);
+	}
+
+	// The payload must start on a word boundary in the bitstream
+	assert(bitstream->count == 0);
+	if (! (bitstream->count == 0)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// The payload follows the words collected by the bitstream
+	error = PutBlockBytes(bitstream);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	error = GetStreamBuffer(payload->stream, &buffer, &size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	return PutBytes(bitstream->stream, buffer, size);
+}
@@ -35,7 +35,7 @@ CODEC_ERROR PrepareCodebooks(ALLOCATOR *allocator, CODESET *cs)
 
 	size_t runs_table_size = runs_table_length * sizeof(RLC) + sizeof(RUNS_TABLE);
 
-	RUNS_TABLE *runs_table = Alloc(allocator, runs_table_size);
+	RUNS_TABLE *runs_table = AllocTagged(allocator, runs_table_size, ALLOCATOR_TAG_CODEBOOK);
 	RLC *new_codes = (RLC *)(((uint8_t *)runs_table) + sizeof(RUNS_TABLE));
 	int new_length = runs_table_length;
 
@@ -55,7 +55,7 @@ CODEC_ERROR PrepareCodebooks(ALLOCATOR *allocator, CODESET *cs)
 	// Allocate the table for encoding coefficient magnitudes
 	mags_table_length = (1 << mags_table_shift);
 	mags_table_size = mags_table_length * sizeof(VLE) + sizeof(MAGS_TABLE);
-	mags_table = Alloc(allocator, mags_table_size);
+	mags_table = AllocTagged(allocator, mags_table_size, ALLOCATOR_TAG_CODEBOOK);
 	if (mags_table == NULL) {
 		return CODEC_ERROR_OUTOFMEMORY;
 	}
@@ -107,7 +107,7 @@ CODEC_ERROR ComputeRunLengthCodeTable(ALLOCATOR *allocator,
 	// Need enough space for the codebook and the code for a single value
 	int runs_codebook_length = input_length + 1;
 	size_t runs_codebook_size = runs_codebook_length * sizeof(RLC);
-	RLC *runs_codebook = (RLC *)Alloc(allocator, runs_codebook_size);
+	RLC *runs_codebook = (RLC *)AllocTagged(allocator, runs_codebook_size, ALLOCATOR_TAG_CODEBOOK);
 	bool single_zero_run_flag = false;
 	int input_index;
 	int runs_codebook_count = 0;
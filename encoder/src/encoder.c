@@ -320,6 +320,13 @@ CODEC_ERROR PrepareEncoderState(ENCODER *encoder,
 		encoder->channel_order_count = channel_count;
 	}
 
+	// Set the number of threads used for encoding the channels
+	encoder->thread_count = parameters->thread_count;
+	encoder->parallel_mode = parameters->parallel_mode;
+
+	// Record the time spent in each stage if requested by the application
+	encoder->timing = parameters->timing;
+
 #if VC5_ENABLED_PART(VC5_PART_IMAGE_FORMATS)
 	encoder->image_width = pathname_data->image_width;
 	encoder->image_height = pathname_data->image_height;
@@ -383,10 +390,6 @@ CODEC_ERROR InitEncoder(ENCODER *encoder, const ALLOCATOR *allocator, const VERS
 	encoder->encoded_band_bitstream = NULL;
 #endif
 
-	// Initialize the performance measurements
-	InitTimer(&encoder->timing.transform);
-	InitTimer(&encoder->timing.encoding);
-
 	if (version)
 	{
 		// Store the version number in the encoder
@@ -401,6 +404,106 @@ CODEC_ERROR InitEncoder(ENCODER *encoder, const ALLOCATOR *allocator, const VERS
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Initialize the timers for the stages of the encoding process
+
+	The application passes the timers to the encoder in the encoding parameters,
+	so the times are accumulated over all images encoded with the same parameters.
+*/
+CODEC_ERROR InitEncoderTiming(ENCODER_TIMING *timing)
+{
+	int index;
+
+	assert(timing != NULL);
+	if (! (timing != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	InitTimer(&timing->unpack);
+
+	for (index = 0; index < MAX_WAVELET_COUNT; index++) {
+		InitTimer(&timing->transform[index]);
+	}
+
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++) {
+		InitTimer(&timing->encoding[index]);
+	}
+
+	InitTimer(&timing->write);
+
+	return CODEC_ERROR_OKAY;
+}
+
+#if _TIMING
+/*!
+	@brief Print one row in the table of encoding times
+*/
+static void PrintTimingRow(FILE *file, const char *stage, TIMER *timer, TIMER *total)
+{
+	fprintf(file, "%-18s %8lld %12.3f %7.1f%%\n", stage, (long long)timer->count,
+			TimeMS(timer), TimerPercentage(timer, total));
+}
+#endif
+
+/*!
+	@brief Print the time spent in each stage of the encoding process
+
+	The wavelet transforms and subbands that were not computed are omitted
+	from the table.  The percentages are relative to the sum of the times for
+	all stages.
+*/
+CODEC_ERROR PrintEncoderTiming(ENCODER_TIMING *timing, FILE *file)
+{
+#if _TIMING
+	TIMER total;
+	char stage[32];
+	int index;
+
+	if (timing == NULL) {
+		return CODEC_ERROR_OKAY;
+	}
+
+	InitTimer(&total);
+	AddTimer(&total, &timing->unpack);
+	for (index = 0; index < MAX_WAVELET_COUNT; index++) {
+		AddTimer(&total, &timing->transform[index]);
+	}
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++) {
+		AddTimer(&total, &timing->encoding[index]);
+	}
+	AddTimer(&total, &timing->write);
+
+	fprintf(file, "%-18s %8s %12s %8s\n", "Stage", "Calls", "Time (ms)", "Percent");
+
+	PrintTimingRow(file, "unpack", &timing->unpack, &total);
+
+	for (index = 0; index < MAX_WAVELET_COUNT; index++)
+	{
+		if (timing->transform[index].count > 0) {
+			sprintf(stage, "transform level %d", index + 1);
+			PrintTimingRow(file, stage, &timing->transform[index], &total);
+		}
+	}
+
+	for (index = 0; index < MAX_SUBBAND_COUNT; index++)
+	{
+		if (timing->encoding[index].count > 0) {
+			sprintf(stage, "encode subband %d", index);
+			PrintTimingRow(file, stage, &timing->encoding[index], &total);
+		}
+	}
+
+	PrintTimingRow(file, "write", &timing->write, &total);
+
+	fprintf(file, "%-18s %8s %12.3f %7.1f%%\n", "total", "", TimeMS(&total), 100.0);
+#else
+	(void)timing;
+	(void)file;
+#endif
+
+	return CODEC_ERROR_OKAY;
+}
+
 /*!
 	@brief Encode the image into the output stream
 
@@ -434,7 +537,7 @@ CODEC_ERROR EncodeImage(IMAGE *image, STREAM *stream, const PARAMETERS *paramete
 	UNPACKED_IMAGE unpacked_image;
     
 	// Unpack the image into a set of component arrays
-	error = ImageUnpackingProcess(image, &unpacked_image, parameters, NULL);
+	error = ImageUnpackingProcess(image, &unpacked_image, parameters, parameters->allocator);
 	if (error != CODEC_ERROR_OKAY) {
 		return error;
 	}
@@ -459,7 +562,7 @@ CODEC_ERROR EncodeImage(IMAGE *image, STREAM *stream, const PARAMETERS *paramete
 		return error;
 	}
 
-    error = ReleaseComponentArrays(NULL, &unpacked_image, unpacked_image.component_count);
+    error = ReleaseComponentArrays(parameters->allocator, &unpacked_image, unpacked_image.component_count);
     if (error != CODEC_ERROR_OKAY) {
         return error;
     }
@@ -473,6 +576,72 @@ CODEC_ERROR EncodeImage(IMAGE *image, STREAM *stream, const PARAMETERS *paramete
 	return error;
 }
 
+/*!
+	@brief Encode the image into a buffer in memory
+
+	If the buffer argument points to a buffer provided by the caller, then the
+	size argument is the capacity of the buffer.  The error code
+	@ref CODEC_ERROR_BUFFER_OVERFLOW is returned if the encoded sample does not fit
+	and the size argument is set to the size of the buffer that is required.
+
+	If the buffer argument points to a null pointer, then the encoded sample is
+	written into a buffer that is enlarged as needed.  The buffer is returned to
+	the caller, who must free the buffer using the allocator in the parameters.
+	The size argument is the initial size of the buffer or zero to use a size
+	based on the size of the image.
+
+	The size argument is set to the number of bytes in the encoded sample.
+*/
+CODEC_ERROR EncodeImageToBuffer(IMAGE *image, void **buffer, size_t *size, const PARAMETERS *parameters)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	STREAM stream;
+
+	assert(image != NULL && buffer != NULL && size != NULL && parameters != NULL);
+	if (! (image != NULL && buffer != NULL && size != NULL && parameters != NULL)) {
+		return CODEC_ERROR_NULLPTR;
+	}
+
+	if (*buffer != NULL)
+	{
+		// Write the encoded sample into the buffer provided by the caller
+		error = CreateStreamBuffer(&stream, *buffer, *size);
+	}
+	else
+	{
+		// The encoded sample is usually much smaller than the packed image
+		size_t initial_size = (*size > 0) ? *size : (image->height * image->pitch) / 4;
+
+		error = CreateGrowableStream(&stream, parameters->allocator, initial_size);
+	}
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	error = EncodeImage(image, &stream, parameters);
+
+	// Were some bytes in the encoded sample discarded because the buffer was full?
+	if (stream.location.memory.count > stream.location.memory.size)
+	{
+		// Return the size of the buffer that is required for the encoded sample
+		*size = stream.location.memory.count;
+		CloseStream(&stream);
+		return (*buffer != NULL) ? CODEC_ERROR_BUFFER_OVERFLOW : CODEC_ERROR_OUTOFMEMORY;
+	}
+
+	if (error != CODEC_ERROR_OKAY) {
+		CloseStream(&stream);
+		return error;
+	}
+
+	// Return the encoded sample to the caller
+	error = DetachStreamBuffer(&stream, buffer, size);
+	CloseStream(&stream);
+
+	return error;
+}
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS) || VC5_ENABLED_PART(VC5_PART_SECTIONS)
 
 /*!
@@ -517,7 +686,7 @@ CODEC_ERROR EncodeImageList(IMAGE_LIST *image_list, STREAM *stream, const PARAME
     InitUnpackedImageList(&unpacked_image_list, image_list->image_count);
     
     // Unpack the list of packed images into a list of unpacked images (component array list)
-    error = ImageListUnpackingProcess(image_list, &unpacked_image_list, parameters, NULL);
+    error = ImageListUnpackingProcess(image_list, &unpacked_image_list, parameters, parameters->allocator);
     if (error != CODEC_ERROR_OKAY) {
         return error;
     }
@@ -542,7 +711,7 @@ CODEC_ERROR EncodeImageList(IMAGE_LIST *image_list, STREAM *stream, const PARAME
         return error;
     }
     
-    error = ReleaseUnpackedImageList(NULL, &unpacked_image_list);
+    error = ReleaseUnpackedImageList(parameters->allocator, &unpacked_image_list);
     if (error != CODEC_ERROR_OKAY) {
         return error;
     }
@@ -577,8 +746,7 @@ CODEC_ERROR ImageListEncodingProcess(ENCODER *encoder,
 #if VC5_ENABLED_PART(VC5_PART_LAYERS)
     if (IsPartEnabled(parameters->enabled_parts, VC5_PART_LAYERS))
     {
-        //TODO: Modkfy rhis routine to accept other allocators
-        ALLOCATOR *allocator = NULL;
+        ALLOCATOR *allocator = parameters->allocator;
         
         // Each image in a list of unpacked images has the same dimensions and number of channels
         UNPACKED_IMAGE *image = unpacked_image_list->image_list[0];
@@ -599,14 +767,17 @@ CODEC_ERROR ImageListEncodingProcess(ENCODER *encoder,
         if (encoder->image_format == IMAGE_FORMAT_UNKNOWN) {
             return CODEC_ERROR_BAD_IMAGE_FORMAT;
         }
-        printf("Image format: %s\n", ImageFormatString(encoder->image_format));
-        printf("Pattern width: %d\n", encoder->pattern_width);
-        printf("Pattern height: %d\n", encoder->pattern_height);
-        if (!IsPartEnabled(encoder->enabled_parts, VC5_PART_COLOR_SAMPLING)) {
-            printf("Components per sample: %d\n", encoder->components_per_sample);
+        if (parameters->verbose_flag)
+        {
+            printf("Image format: %s\n", ImageFormatString(encoder->image_format));
+            printf("Pattern width: %d\n", encoder->pattern_width);
+            printf("Pattern height: %d\n", encoder->pattern_height);
+            if (!IsPartEnabled(encoder->enabled_parts, VC5_PART_COLOR_SAMPLING)) {
+                printf("Components per sample: %d\n", encoder->components_per_sample);
+            }
+            printf("Internal precision: %d\n", encoder->internal_precision);
+            printf("\n");
         }
-        printf("Internal precision: %d\n", encoder->internal_precision);
-        printf("\n");
 #endif
 
         // Write the bitstream start marker
@@ -644,12 +815,6 @@ CODEC_ERROR ImageListEncodingProcess(ENCODER *encoder,
     DumpTransformBands(&encoder, channel_mask, wavelet_mask, wavelet_band_mask, pathname);
 #endif
 
-#if _TIMING
-    // Print out performance measurements before releasing the encoder
-    printf("Transform time: %.3f ms\n", TimeMS(&encoder->timing.transform));
-    printf("Entropy coding: %.3f ms\n", TimeMS(&encoder->timing.encoding));
-#endif
-    
     return error;
 }
 
@@ -667,6 +832,8 @@ CODEC_ERROR EncodeImageLayers(ENCODER *encoder, const UNPACKED_IMAGE_LIST *image
     
     assert(layer_count == image_list->image_count);
     
+    StartTimer(STAGE_TIMER(encoder->timing, write));
+
     // Write the sample header that is common to all layers
     error = EncodeBitstreamHeader(encoder, stream);
     assert(error == CODEC_ERROR_OKAY);
@@ -680,6 +847,8 @@ CODEC_ERROR EncodeImageLayers(ENCODER *encoder, const UNPACKED_IMAGE_LIST *image
     if (! (error == CODEC_ERROR_OKAY)) {
         return error;
     }
+
+    StopTimer(STAGE_TIMER(encoder->timing, write));
     
     for (layer_index = 0; layer_index < layer_count; layer_index++)
     {
@@ -716,6 +885,8 @@ CODEC_ERROR EncodeImageLayers(ENCODER *encoder, const UNPACKED_IMAGE_LIST *image
     }
 #endif
     
+    StartTimer(STAGE_TIMER(encoder->timing, write));
+
     // Finish the encoded sample after the last layer
     error = EncodeBitstreamTrailer(encoder, stream);
     assert(error == CODEC_ERROR_OKAY);
@@ -725,6 +896,8 @@ CODEC_ERROR EncodeImageLayers(ENCODER *encoder, const UNPACKED_IMAGE_LIST *image
     
     // Force any data remaining in the bitstream to be written into the sample
     FlushBitstream(stream);
+
+    StopTimer(STAGE_TIMER(encoder->timing, write));
     
     // Check that the sample offset stack has been emptied
     assert(stream->sample_offset_count == 0);
@@ -936,7 +1109,7 @@ CODEC_ERROR EncodeImageSections(ENCODER *encoder,
                                 const PARAMETERS *parameters)
 {
     CODEC_ERROR error = CODEC_ERROR_OKAY;
-    ALLOCATOR *allocator = NULL;                    //TODO: Need to pass the allocator into this routine
+    ALLOCATOR *allocator = parameters->allocator;
     int section_count = image_list->image_count;
     int section_index;
 
@@ -954,6 +1127,8 @@ CODEC_ERROR EncodeImageSections(ENCODER *encoder,
         // Write the image section header into the bitstream
         BeginImageSection(encoder, stream);
         
+        StartTimer(STAGE_TIMER(encoder->timing, write));
+
         // Write the bitstream header for each image section into the bitstream
         error = EncodeBitstreamHeader(encoder, stream);
         assert(error == CODEC_ERROR_OKAY);
@@ -967,6 +1142,8 @@ CODEC_ERROR EncodeImageSections(ENCODER *encoder,
         if (! (error == CODEC_ERROR_OKAY)) {
             return error;
         }
+
+        StopTimer(STAGE_TIMER(encoder->timing, write));
        
         // Encode each component array as a separate channel in the bitstream
         error = EncodeMultipleChannels(encoder, image, stream);
@@ -995,6 +1172,8 @@ CODEC_ERROR EncodeImageSections(ENCODER *encoder,
         }
     }
     
+    StartTimer(STAGE_TIMER(encoder->timing, write));
+
     // Finish the encoded bitstream after the last image section
     error = EncodeBitstreamTrailer(encoder, stream);
     assert(error == CODEC_ERROR_OKAY);
@@ -1004,6 +1183,8 @@ CODEC_ERROR EncodeImageSections(ENCODER *encoder,
     
     // Force any data remaining in the bitstream to be written into the sample
     FlushBitstream(stream);
+
+    StopTimer(STAGE_TIMER(encoder->timing, write));
     
     // Check that the sample offset stack has been emptied
     assert(stream->sample_offset_count == 0);
@@ -1046,7 +1227,7 @@ CODEC_ERROR EncodeImageSectionLayers(IMAGE_LIST *image_list, STREAM *stream, con
     InitUnpackedImageList(&unpacked_image_list, image_list->image_count);
     
     // Unpack the list of packed images into a list of unpacked images (component array list)
-    error = ImageListUnpackingProcess(image_list, &unpacked_image_list, parameters, NULL);
+    error = ImageListUnpackingProcess(image_list, &unpacked_image_list, parameters, parameters->allocator);
     if (error != CODEC_ERROR_OKAY) {
         return error;
     }
@@ -1071,7 +1252,7 @@ CODEC_ERROR EncodeImageSectionLayers(IMAGE_LIST *image_list, STREAM *stream, con
         return error;
     }
     
-    error = ReleaseUnpackedImageList(NULL, &unpacked_image_list);
+    error = ReleaseUnpackedImageList(parameters->allocator, &unpacked_image_list);
     if (error != CODEC_ERROR_OKAY) {
         return error;
     }
@@ -1105,8 +1286,7 @@ CODEC_ERROR ImageSectionLayersEncodingProcess(ENCODER *encoder,
 {
     CODEC_ERROR error = CODEC_ERROR_OKAY;
     
-    //TODO: Modkfy rhis routine to accept other allocators
-    ALLOCATOR *allocator = NULL;
+    ALLOCATOR *allocator = parameters->allocator;
 
     int section_count;      //!< Number of image sections to encode into the bitstream
     int section_index;      //!< Index of the image section that is being encoded
@@ -1180,6 +1360,8 @@ CODEC_ERROR ImageSectionLayersEncodingProcess(ENCODER *encoder,
         // Write the image section header into the bitstream
         BeginImageSection(encoder, bitstream);
         
+        StartTimer(STAGE_TIMER(encoder->timing, write));
+
         // Write the bitstream header that is common to all layers
         error = EncodeBitstreamHeader(encoder, bitstream);
         assert(error == CODEC_ERROR_OKAY);
@@ -1193,6 +1375,8 @@ CODEC_ERROR ImageSectionLayersEncodingProcess(ENCODER *encoder,
         if (! (error == CODEC_ERROR_OKAY)) {
             return error;
         }
+
+        StopTimer(STAGE_TIMER(encoder->timing, write));
         
         for (layer_index = 0; layer_index < layer_count; layer_index++, image_index++)
         {
@@ -1258,6 +1442,8 @@ CODEC_ERROR ImageSectionLayersEncodingProcess(ENCODER *encoder,
     }
 #endif
     
+    StartTimer(STAGE_TIMER(encoder->timing, write));
+
     // Finish the bitstream after the last section
     error = EncodeBitstreamTrailer(encoder, bitstream);
     assert(error == CODEC_ERROR_OKAY);
@@ -1267,6 +1453,8 @@ CODEC_ERROR ImageSectionLayersEncodingProcess(ENCODER *encoder,
     
     // Force any data remaining in the bitstream to be written into the sample
     FlushBitstream(bitstream);
+
+    StopTimer(STAGE_TIMER(encoder->timing, write));
     
     // Check that the sample offset stack has been emptied
     assert(bitstream->sample_offset_count == 0);
@@ -1300,7 +1488,7 @@ CODEC_ERROR EncodingProcess(ENCODER *encoder,
 							const PARAMETERS *parameters)
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
-	ALLOCATOR *allocator = NULL;
+	ALLOCATOR *allocator = parameters->allocator;
 
 	// Initialize the encoder using the parameters provided by the application
 	error = PrepareEncoder(encoder, image, allocator, parameters, 0);
@@ -1367,6 +1555,8 @@ CODEC_ERROR EncodingProcess(ENCODER *encoder,
 	}
 #endif
 
+	StartTimer(STAGE_TIMER(encoder->timing, write));
+
 	// Finish the encoded bitstream
 	error = EncodeBitstreamTrailer(encoder, bitstream);
 	assert(error == CODEC_ERROR_OKAY);
@@ -1377,6 +1567,8 @@ CODEC_ERROR EncodingProcess(ENCODER *encoder,
 	// Force any data remaining in the bitstream to be written into the sample
 	FlushBitstream(bitstream);
 
+	StopTimer(STAGE_TIMER(encoder->timing, write));
+
 	// Check that the sample offset stack has been emptied
 	assert(bitstream->sample_offset_count == 0);
 
@@ -1389,12 +1581,6 @@ CODEC_ERROR EncodingProcess(ENCODER *encoder,
 	wavelet_band_mask = 0x0F;
 	DumpTransformBands(&encoder, channel_mask, wavelet_mask, wavelet_band_mask, pathname);
 #endif
-#if _TIMING
-	// Print out performance measurements before releasing the encoder
-	printf("Transform time: %.3f ms\n", TimeMS(&encoder->timing.transform));
-	printf("Entropy coding: %.3f ms\n", TimeMS(&encoder->timing.encoding));
-#endif
-
 	return CODEC_ERROR_OKAY;
 }
 
@@ -1452,6 +1638,9 @@ CODEC_ERROR PrepareEncoder(ENCODER *encoder,
 	// Initialize the encoding parameters and the codec state
 	PrepareEncoderState(encoder, image, parameters, input_image_index);
 
+	// Use the fastest forward wavelet filters supported by the processor
+	SelectForwardKernels(GetCPUFeatures());
+
 	// Allocate the wavelet transforms
 	AllocEncoderTransforms(encoder);
 
@@ -1578,6 +1767,8 @@ CODEC_ERROR EncodeSingleImage(ENCODER *encoder, const UNPACKED_IMAGE *image, BIT
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
+	StartTimer(STAGE_TIMER(encoder->timing, write));
+
 	// Write the bitstream header into the bitstream
 	error = EncodeBitstreamHeader(encoder, stream);
 	assert(error == CODEC_ERROR_OKAY);
@@ -1592,6 +1783,8 @@ CODEC_ERROR EncodeSingleImage(ENCODER *encoder, const UNPACKED_IMAGE *image, BIT
 		return error;
 	}
 
+	StopTimer(STAGE_TIMER(encoder->timing, write));
+
 	// Encode each component array as a separate channel in the bitstream
 	error = EncodeMultipleChannels(encoder, image, stream);
 	assert(error == CODEC_ERROR_OKAY);
@@ -1803,9 +1996,13 @@ CODEC_ERROR ImageUnpackingProcess(const PACKED_IMAGE *input,
 	AllocateComponentArrays(allocator, output, channel_count, max_channel_width, max_channel_height,
 		input->format, bits_per_component);
 
+	StartTimer(STAGE_TIMER(parameters->timing, unpack));
+
 	// Unpack the image into component arrays
 	UnpackImage(input, output, enabled_parts);
 
+	StopTimer(STAGE_TIMER(parameters->timing, unpack));
+
 	return CODEC_ERROR_OKAY;
 }
 
@@ -2239,70 +2436,48 @@ CODEC_ERROR EncodeMultipleChannels(ENCODER *encoder, const UNPACKED_IMAGE *image
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
 	int channel_count;
-	int wavelet_count;
 	int channel_index;
-	int wavelet_index;
 
 	channel_count = encoder->channel_count;
-	wavelet_count = encoder->wavelet_count;
-
-	// Start computing the wavelet transform for each channel
-	StartTimer(&encoder->timing.transform);
 
-	// Compute the wavelet transform tree for each channel
-	for (channel_index = 0; channel_index < channel_count; channel_index++)
+	// Create the thread pool shared by the channels, subbands, and strips in the wavelet transforms
+	if (_THREADED && encoder->thread_count > 1 && encoder->pool == NULL)
 	{
-		// Compute the number of transforms in the rest of the wavelet tree
-		int transform_count = wavelet_count - 1;
+		THREAD_POOL pool;
 
-#if (0 && DEBUG)
-		printf("Wavelet transforms for channel: %d\n", channel_index);
-#endif
-
-		// Apply the first wavelet transform to the component array
-		error = TransformForwardSpatialChannel(encoder, image, channel_index);
+		error = InitThreadPool(&pool, encoder->allocator, encoder->thread_count);
 		if (error != CODEC_ERROR_OKAY) {
 			return error;
 		}
 
-		// Compute the remaining wavelet transforms for this channel
-		for (wavelet_index = 0; wavelet_index < transform_count; wavelet_index++)
-		{
-			// Transform the current wavelet to the next wavelet in the tree
-			int output_index = wavelet_index + 1;
+		encoder->pool = &pool;
+		error = EncodeMultipleChannels(encoder, image, stream);
+		encoder->pool = NULL;
 
-			// Get the input and output wavelets for the next transform
-			WAVELET *input = encoder->transform[channel_index].wavelet[wavelet_index];
-			WAVELET *output = encoder->transform[channel_index].wavelet[output_index];
-            
-#if (0 && DEBUG)
-            int wavelet_level = wavelet_index + 1;
-            char pathname[PATH_MAX];
-            sprintf(pathname, "encoded-%d.nv12", wavelet_level);
-            DumpTransformWavelets(encoder->transform, channel_count, wavelet_level, pathname);
-#endif
-			// The prescale is applied to the input values before the wavelet transform
-			int prescale = encoder->transform[channel_index].prescale[output_index];
+		ReleaseThreadPool(&pool);
+		return error;
+	}
 
-			// The wavelet should have already been created
-			assert(input != NULL && output != NULL);
+	// Transform and encode the channels or subbands on separate threads if requested
+	if (_THREADED && encoder->thread_count > 1)
+	{
+		if (encoder->parallel_mode == PARALLEL_MODE_SUBBANDS) {
+			return EncodeSubbandsParallel(encoder, image, stream);
+		}
 
-#if (0 && DEBUG)
-			printf("Wavelet transform channel: %d, wavelet: %d\n", channel_index, wavelet_index);
-#endif
-			// Apply the forward wavelet transform to the lowpass band in the wavelet at this level
-			error = TransformForwardSpatialLowpass(encoder, input, output, prescale);
-			if (error != CODEC_ERROR_OKAY) {
-				return error;
-			}
+		if (IsChannelOrderPermutation(encoder)) {
+			return EncodeChannelsParallel(encoder, image, stream);
 		}
 	}
 
-	// Finished computing the wavelet transform for each channel
-	StopTimer(&encoder->timing.transform);
-
-	// Start encoding the wavelets in each channel
-	StartTimer(&encoder->timing.encoding);
+	// Compute the wavelet transform tree for each channel
+	for (channel_index = 0; channel_index < channel_count; channel_index++)
+	{
+		error = TransformChannelWavelets(encoder, image, channel_index);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
 
 	// Output the encoded wavelet tree in each channel to the bitstream
 	//error = EncodeLayerChannels(encoder, stream);
@@ -2312,8 +2487,64 @@ CODEC_ERROR EncodeMultipleChannels(ENCODER *encoder, const UNPACKED_IMAGE *image
 		return error;
 	}
 
-	// Finished encoding the wavelets in each channel
-	StopTimer(&encoder->timing.encoding);
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Compute the wavelet transform tree for one channel
+
+	The first wavelet transform is applied to the component array and the remaining
+	transforms are applied to the lowpass band of the wavelet at the previous level.
+	The transforms for different channels do not share any buffers, so this routine
+	can be called for different channels concurrently.
+*/
+CODEC_ERROR TransformChannelWavelets(ENCODER *encoder, const UNPACKED_IMAGE *image, int channel_index)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+
+	// Compute the number of transforms in the rest of the wavelet tree
+	int transform_count = encoder->wavelet_count - 1;
+	int wavelet_index;
+
+#if (0 && DEBUG)
+	printf("Wavelet transforms for channel: %d\n", channel_index);
+#endif
+
+	// Apply the first wavelet transform to the component array
+	StartTimer(STAGE_TIMER(encoder->timing, transform[0]));
+	error = TransformForwardSpatialChannel(encoder, image, channel_index);
+	StopTimer(STAGE_TIMER(encoder->timing, transform[0]));
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Compute the remaining wavelet transforms for this channel
+	for (wavelet_index = 0; wavelet_index < transform_count; wavelet_index++)
+	{
+		// Transform the current wavelet to the next wavelet in the tree
+		int output_index = wavelet_index + 1;
+
+		// Get the input and output wavelets for the next transform
+		WAVELET *input = encoder->transform[channel_index].wavelet[wavelet_index];
+		WAVELET *output = encoder->transform[channel_index].wavelet[output_index];
+
+		// The prescale is applied to the input values before the wavelet transform
+		int prescale = encoder->transform[channel_index].prescale[output_index];
+
+		// The wavelet should have already been created
+		assert(input != NULL && output != NULL);
+
+#if (0 && DEBUG)
+		printf("Wavelet transform channel: %d, wavelet: %d\n", channel_index, wavelet_index);
+#endif
+		// Apply the forward wavelet transform to the lowpass band in the wavelet at this level
+		StartTimer(STAGE_TIMER(encoder->timing, transform[output_index]));
+		error = TransformForwardSpatialLowpass(encoder, input, output, prescale);
+		StopTimer(STAGE_TIMER(encoder->timing, transform[output_index]));
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+	}
 
 	return CODEC_ERROR_OKAY;
 }
@@ -2579,7 +2810,7 @@ CODEC_ERROR EncodeChannelSubbands(ENCODER *encoder, int channel_number, BITSTREA
 				uint32_t wavelet_mask = 0x04;
 				uint32_t band_mask = 0x08;
 
-				error = EncodeHighpassBand(encoder, wavelet, band_index, subband, bitstream);
+				error = EncodeHighpassBand(encoder, wavelet, channel_number, band_index, subband, bitstream);
 				if (error != CODEC_ERROR_OKAY) {
 					return error;
 				}
@@ -2600,7 +2831,7 @@ CODEC_ERROR EncodeChannelSubbands(ENCODER *encoder, int channel_number, BITSTREA
 				continue;
 			}
 #endif
-			error = EncodeHighpassBand(encoder, wavelet, band_index, subband, stream);
+			error = EncodeHighpassBand(encoder, wavelet, channel_number, band_index, subband, stream);
 			if (error != CODEC_ERROR_OKAY) {
 				return error;
 			}
@@ -2649,80 +2880,6 @@ CODEC_ERROR EncodeChannelTrailer(ENCODER *encoder, int channel, BITSTREAM *strea
 	return CODEC_ERROR_OKAY;
 }
 
-/*!
-	@brief Allocate intermediate buffers for the horizontal transform results
-
-	@todo Need to return an error code if allocation fails
-*/
-CODEC_ERROR AllocateEncoderHorizontalBuffers(ENCODER *encoder, int buffer_width)
-{
-	ALLOCATOR *allocator = encoder->allocator;
-
-	int channel_count = encoder->channel_count;
-	int channel_index;
-
-	for (channel_index = 0; channel_index < channel_count; channel_index++)
-	{
-		size_t row_buffer_size;
-		int row;
-
-//#if VC5_ENABLED_PART(VC5_PART_COLOR_SAMPLING)
-		//int channel_width = ChannelWidth(encoder, channel_index, buffer_width);
-//#else
-		int channel_width = buffer_width;
-//#endif
-		row_buffer_size = channel_width * sizeof(PIXEL);
-
-		for (row = 0; row < ROW_BUFFER_COUNT; row++)
-		{
-			encoder->lowpass_buffer[channel_index][row] = Alloc(allocator, row_buffer_size);
-			encoder->highpass_buffer[channel_index][row] = Alloc(allocator, row_buffer_size);
-
-			// Check that the memory allocation was successful
-			assert(encoder->lowpass_buffer[channel_index][row] != NULL);
-			if (! (encoder->lowpass_buffer[channel_index][row] != NULL)) {
-				return CODEC_ERROR_OUTOFMEMORY;
-			}
-			assert(encoder->highpass_buffer[channel_index][row] != NULL);
-			if (! (encoder->highpass_buffer[channel_index][row] != NULL)) {
-				return CODEC_ERROR_OUTOFMEMORY;
-			}
-		}
-	}
-
-	return CODEC_ERROR_OKAY;
-}
-
-/*!
-	@brief Deallocate the intermediate buffers for the horizontal transform results
-
-	It is possible to avoid reallocating the buffers for the horizontal transform
-	results if the buffers were not deallocated between encoded frames.  In this case,
-	it would be necessary to call this routine inside @ref ReleaseEncoder and it would
-	also be necessary to modify @ref AllocateEncoderHorizontalBuffers to not allocate
-	the buffers if they are already allocated.
-*/
-CODEC_ERROR DeallocateEncoderHorizontalBuffers(ENCODER *encoder)
-{
-	ALLOCATOR *allocator = encoder->allocator;
-
-	int channel_count = encoder->channel_count;
-	int channel_index;
-
-	for (channel_index = 0; channel_index < channel_count; channel_index++)
-	{
-		int row;
-
-		for (row = 0; row < ROW_BUFFER_COUNT; row++)
-		{
-			Free(allocator, encoder->lowpass_buffer[channel_index][row]);
-			Free(allocator, encoder->highpass_buffer[channel_index][row]);
-		}
-	}
-
-	return CODEC_ERROR_OKAY;
-}
-
 #if 0
 /*!
 	@brief Allocate buffers for unpacking rows of the input frame
@@ -2741,11 +2898,11 @@ CODEC_ERROR AllocateEncoderUnpackingBuffers(ENCODER *encoder, int frame_width)
 	{
 		// Compute the actual buffer size for each channel
 		int channel_width = ChannelWidth(encoder, channel_index, frame_width);
-		size_t row_buffer_size = channel_width * sizeof(PIXEL);
+		size_t row_buffer_size = ROW_BUFFER_SIZE(channel_width * sizeof(PIXEL));
 		assert(row_buffer_size > 0);
 
 		// Allocate an unpacking buffer for this channel
-		encoder->unpacked_buffer[channel_index] = Alloc(allocator, row_buffer_size);
+		encoder->unpacked_buffer[channel_index] = AllocTagged(allocator, row_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 		// Check that the memory allocation was successful
 		assert(encoder->unpacked_buffer[channel_index] != NULL);
@@ -2766,14 +2923,14 @@ CODEC_ERROR AllocateHorizontalBuffers(ALLOCATOR *allocator,
 									  PIXEL *highpass_buffer[],
 									  int buffer_width)
 {
-	const size_t row_buffer_size = buffer_width * sizeof(PIXEL);
+	const size_t row_buffer_size = ROW_BUFFER_SIZE(buffer_width * sizeof(PIXEL));
 
 	int row;
 
 	for (row = 0; row < ROW_BUFFER_COUNT; row++)
 	{
-		lowpass_buffer[row] = Alloc(allocator, row_buffer_size);
-		highpass_buffer[row] = Alloc(allocator, row_buffer_size);
+		lowpass_buffer[row] = AllocTagged(allocator, row_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
+		highpass_buffer[row] = AllocTagged(allocator, row_buffer_size, ALLOCATOR_TAG_TRANSFORM_BUFFER);
 
 		// Check that the memory allocation was successful
 		assert(lowpass_buffer[row] != NULL);
@@ -2807,46 +2964,6 @@ CODEC_ERROR DeallocateHorizontalBuffers(ALLOCATOR *allocator,
 	return CODEC_ERROR_OKAY;
 }
 
-/*!
-	@brief Shift the buffers of horizontal highpass results
-
-	The encoder contains six rows of horizontal lowpass and highpass results
-	for each channel.  This routine shifts the buffers by two rows to make
-	room for two more rows of horizontal results for each channel.
-*/
-CODEC_ERROR ShiftHorizontalResultBuffers(ENCODER *encoder)
-{
-	int channel;
-
-	for (channel = 0; channel < encoder->channel_count; channel++)
-	{
-		PIXEL *buffer0;
-		PIXEL *buffer1;
-
-		// Shift the rows of lowpass results
-		buffer0 = encoder->lowpass_buffer[channel][0];
-		buffer1 = encoder->lowpass_buffer[channel][1];
-		encoder->lowpass_buffer[channel][0] = encoder->lowpass_buffer[channel][2];
-		encoder->lowpass_buffer[channel][1] = encoder->lowpass_buffer[channel][3];
-		encoder->lowpass_buffer[channel][2] = encoder->lowpass_buffer[channel][4];
-		encoder->lowpass_buffer[channel][3] = encoder->lowpass_buffer[channel][5];
-		encoder->lowpass_buffer[channel][4] = buffer0;
-		encoder->lowpass_buffer[channel][5] = buffer1;
-
-		// Shift the rows of highpass results
-		buffer0 = encoder->highpass_buffer[channel][0];
-		buffer1 = encoder->highpass_buffer[channel][1];
-		encoder->highpass_buffer[channel][0] = encoder->highpass_buffer[channel][2];
-		encoder->highpass_buffer[channel][1] = encoder->highpass_buffer[channel][3];
-		encoder->highpass_buffer[channel][2] = encoder->highpass_buffer[channel][4];
-		encoder->highpass_buffer[channel][3] = encoder->highpass_buffer[channel][5];
-		encoder->highpass_buffer[channel][4] = buffer0;
-		encoder->highpass_buffer[channel][5] = buffer1;
-	}
-
-	return CODEC_ERROR_OKAY;
-}
-
 /*!
 	@brief Shift the array of buffers of horizontal highpass results
 
@@ -2882,205 +2999,192 @@ CODEC_ERROR ShiftHorizontalBuffers(PIXEL *lowpass_buffer[], PIXEL *highpass_buff
 }
 
 /*!
-	@brief Apply the forward spatial wavelet transform to the component array
-
-	Each channel in the bitstream represents a single component array.
-	
-	This routine applies the forward spatial wavelet transform to the
-	component array for the specified channel.
+	@brief Apply the forward spatial wavelet transform to a strip of output rows
+
+	The strip contains the output rows from the first row up to but not including
+	the last row.  The six rows of horizontal results used by the vertical filter
+	for the first output row in the strip are computed from the input rows before
+	and after the pair of input rows for that output row, so strips can overlap in
+	the input rows and can be computed concurrently.  The results are the same as
+	the results computed for the entire wavelet in one strip.
+
+	The first output row uses the boundary filter for the top row and the last output
+	row in the wavelet uses the boundary filter for the bottom row.  The other output
+	rows in a strip must be middle rows.
 */
-CODEC_ERROR TransformForwardSpatialChannel(ENCODER *encoder,
-										   const UNPACKED_IMAGE *image,
-										   int channel_number)
+CODEC_ERROR TransformForwardSpatialStrip(ALLOCATOR *allocator,
+										 PIXEL *input,
+										 size_t input_pitch,
+										 DIMENSION input_width,
+										 DIMENSION input_height,
+										 WAVELET *output,
+										 DIMENSION wavelet_width,
+										 int prescale,
+										 int midpoint_prequant,
+										 int first_row,
+										 int last_row)
 {
-	//ALLOCATOR *allocator = encoder->allocator;
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
-	DIMENSION input_width = encoder->channel[channel_number].width;
-	DIMENSION input_height = encoder->channel[channel_number].height;
 	DIMENSION output_width = ((input_width % 2) == 0) ? input_width / 2 : (input_width + 1) / 2;
 
-	size_t input_pitch = image->component_array_list[channel_number].pitch;
-	void *buffer = image->component_array_list[channel_number].data;
-
-	// The prescale is applied to the input values before the wavelet transform
-	int prescale = encoder->transform[channel_number].prescale[0];
-
 	// Last row of the wavelet result
-	//int bottom_input_row = input_height - 2;
 	int bottom_input_row = ((input_height % 2) == 0) ? input_height - 2 : input_height - 1;
 
-	// Calculate the last row for unpacking more rows from the input frame
-	int last_unpacked_row = bottom_input_row - 2;
+	// Input row after the last middle row in this strip
+	int end_input_row = min(2 * last_row, bottom_input_row);
 
-	// The midpoint prequant offset is added during quantization
-	int midpoint_prequant = encoder->midpoint_prequant;
+	int input_row = 2 * first_row;
 
-	int input_row;
+	// Buffers for the horizontal results are private to this call so that
+	// channels and strips can be transformed concurrently
+	PIXEL *lowpass_buffer[ROW_BUFFER_COUNT] = {NULL};
+	PIXEL *highpass_buffer[ROW_BUFFER_COUNT] = {NULL};
 
-	int unpacked_buffer_row;
-	//PIXEL *unpacked_buffer_row_ptr;
+	int buffer_row;
 
-	// Allocate six pairs of lowpass and highpass buffers for each channel
-	AllocateEncoderHorizontalBuffers(encoder, output_width);
+	assert(0 <= first_row && first_row < last_row);
+	assert(2 * first_row <= bottom_input_row);
 
-	// Allocate buffers for unpacking a row of packed pixels from each channel
-	//AllocateEncoderUnpackingBuffers(encoder, input_width);
+	// Allocate six pairs of lowpass and highpass buffers
+	error = AllocateHorizontalBuffers(allocator, lowpass_buffer, highpass_buffer, output_width);
+	if (error != CODEC_ERROR_OKAY) {
+		DeallocateHorizontalBuffers(allocator, lowpass_buffer, highpass_buffer);
+		return error;
+	}
 
-	// Compute six pairs of horizontal transform results for each channel
-	for (unpacked_buffer_row = 0; unpacked_buffer_row < ROW_BUFFER_COUNT; unpacked_buffer_row++)
+	// Compute six pairs of horizontal transform results starting two rows before the first middle row
+	for (buffer_row = 0; buffer_row < ROW_BUFFER_COUNT; buffer_row++)
 	{
-		PIXEL *unpacked_buffer_row_ptr = (PIXEL *)((uintptr_t)buffer + unpacked_buffer_row * input_pitch);
+		int next_input_row = (first_row == 0) ? buffer_row : input_row - 2 + buffer_row;
+		PIXEL *input_row_ptr;
+
+		if (first_row > 0 && next_input_row >= input_height)
+		{
+			// Duplicate the last input row
+			next_input_row = input_height - 1;
+		}
 
-		// The width of each input row may depend on the channel
-		//int channel_width = ChannelWidth(encoder, channel_index, input_width);
+		input_row_ptr = (PIXEL *)((uintptr_t)input + next_input_row * input_pitch);
 
-		FilterHorizontalRow(unpacked_buffer_row_ptr,
-							encoder->lowpass_buffer[channel_number][unpacked_buffer_row],
-							encoder->highpass_buffer[channel_number][unpacked_buffer_row],
+		FilterHorizontalRow(input_row_ptr,
+							lowpass_buffer[buffer_row],
+							highpass_buffer[buffer_row],
 							input_width,
 							prescale);
 	}
 
-	// Start applying the vertical transform to the first row
-	input_row = 0;
-
-	// Process all channels in the first row as a special case
-	//for (channel_index = 0; channel_index < channel_count; channel_index++)
+	if (first_row == 0)
 	{
-		// The output wavelet is at the first level in the wavelet tree
-		WAVELET *wavelet = encoder->transform[channel_number].wavelet[0];
-
-		// The width of each output row may depend on the channel
-		int wavelet_width = wavelet->width;
-
-#if (0 && DEBUG)
-		printf("TransformForwardSpatialQuantFrame output width: %d, quant: %d %d %d %d\n",
-			wavelet_width, wavelet->quant[0], wavelet->quant[1], wavelet->quant[2], wavelet->quant[3]);
-#endif
 		// Process the first row as a special case for the boundary condition
-		FilterVerticalTopRow(encoder->lowpass_buffer[channel_number],
-							 encoder->highpass_buffer[channel_number],
-							 wavelet->data,
-							 wavelet->pitch,
-							 wavelet->band_count,
+		FilterVerticalTopRow(lowpass_buffer,
+							 highpass_buffer,
+							 output->data,
+							 output->pitch,
+							 output->band_count,
 							 input_row,
 							 wavelet_width,
-							 wavelet->quant,
+							 output->quant,
 							 midpoint_prequant);
-	}
 
-	// Advance to the second pair of input rows and use the first six horizontal results
-	input_row += 2;
+		// Advance to the second pair of input rows and use the first six horizontal results
+		input_row += 2;
+	}
 
 	// Process the middle rows
-	for (; input_row < bottom_input_row; input_row += 2)
+	for (; input_row < end_input_row; input_row += 2)
 	{
-		//printf("Processing middle rows, input_row: %d\n", input_row);
-
 		// Check for errors in the row calculation
 		assert((input_row % 2) == 0);
 
-		//for (channel_index = 0; channel_index < channel_count; channel_index++)
-		{
-			// The output wavelet is at the first level in the wavelet tree
-			WAVELET *wavelet = encoder->transform[channel_number].wavelet[0];
-
-			// The width of each output row may depend on the channel
-			int wavelet_width = wavelet->width;
-
-			FilterVerticalMiddleRow(encoder->lowpass_buffer[channel_number],
-									encoder->highpass_buffer[channel_number],
-									wavelet->data,
-									wavelet->pitch,
-									wavelet->band_count,
-									input_row,
-									wavelet_width,
-									wavelet->quant,
-									midpoint_prequant);
-		}
+		FilterVerticalMiddleRow(lowpass_buffer,
+								highpass_buffer,
+								output->data,
+								output->pitch,
+								output->band_count,
+								input_row,
+								wavelet_width,
+								output->quant,
+								midpoint_prequant);
 
-		if (input_row < last_unpacked_row)
+		// Are more horizontal results needed for the next middle row in this strip?
+		if (input_row + 2 < end_input_row)
 		{
-			//printf("Unpacking two more rows, input_row: %d, last_unpacked_row: %d\n", input_row, last_unpacked_row);
-
 			// Shift the intermediate horizontal results to make room for the next two rows
-			ShiftHorizontalResultBuffers(encoder);
+			ShiftHorizontalBuffers(lowpass_buffer, highpass_buffer);
 
 			// Get two more rows of horizontal lowpass and highpass results
-			for (unpacked_buffer_row = 4; unpacked_buffer_row < ROW_BUFFER_COUNT; unpacked_buffer_row++)
+			for (buffer_row = 4; buffer_row < ROW_BUFFER_COUNT; buffer_row++)
 			{
-				int component_array_row = input_row + unpacked_buffer_row;
-				PIXEL *component_array_row_ptr;
+				int next_input_row = input_row + buffer_row;
+				PIXEL *input_row_ptr;
 
-				if (component_array_row >= input_height)
+				if (next_input_row >= input_height)
 				{
-					//printf("Duplicating last row\n");
-
 					// Duplicate the last input row
-					component_array_row = input_height - 1;
+					next_input_row = input_height - 1;
 				}
 
-				component_array_row_ptr = (PIXEL *)((uintptr_t)buffer + component_array_row * input_pitch);
-
-				// Unpack the row in the frame buffer
-				//UnpackFrameRow(encoder, unpacked_frame_row_ptr);
+				input_row_ptr = (PIXEL *)((uintptr_t)input + next_input_row * input_pitch);
 
-				// Apply the horizontal wavelet transform to each unpacked component
-				//for (channel_index = 0; channel_index < channel_count; channel_index++)
-				{
-					// The width of each input row may depend on the channel
-					//int channel_width = ChannelWidth(encoder, channel_index, input_width);
-
-					// The prescale is applied to the input values before the wavelet transform
-					int prescale = encoder->transform[channel_number].prescale[0];
-
-					FilterHorizontalRow(component_array_row_ptr,
-										encoder->lowpass_buffer[channel_number][unpacked_buffer_row],
-										encoder->highpass_buffer[channel_number][unpacked_buffer_row],
-										input_width,
-										prescale);
-				}
+				FilterHorizontalRow(input_row_ptr,
+									lowpass_buffer[buffer_row],
+									highpass_buffer[buffer_row],
+									input_width,
+									prescale);
 			}
 		}
 	}
 
-	// Should have exited the loop at the last row
-	assert(input_row == bottom_input_row);
-
-	// Process the last row as a special case for the boundary conditions
-	//for (channel_index = 0; channel_index < channel_count; channel_index++)
+	if (input_row == bottom_input_row && 2 * last_row > bottom_input_row)
 	{
-		// The output wavelet is at the first level in the wavelet tree
-		WAVELET *wavelet = encoder->transform[channel_number].wavelet[0];
-
-		// The width of each output row may depend on the channel
-		int wavelet_width = wavelet->width;
-
-		FilterVerticalBottomRow(encoder->lowpass_buffer[channel_number],
-								encoder->highpass_buffer[channel_number],
-								wavelet->data,
-								wavelet->pitch,
-								wavelet->band_count,
+		// Process the last row as a special case for the boundary conditions
+		FilterVerticalBottomRow(lowpass_buffer,
+								highpass_buffer,
+								output->data,
+								output->pitch,
+								output->band_count,
 								input_row,
 								wavelet_width,
-								wavelet->quant,
+								output->quant,
 								midpoint_prequant);
-
-		// Does the encoded frame including padding?
-		//PadWaveletBands(encoder, wavelet);
-
-		//TODO: Set the valid band mask for all bands in the wavelet in each channel
 	}
 
 	// Deallocate the buffers for horizontal results
-	DeallocateEncoderHorizontalBuffers(encoder);
-
-	// Deallocate the buffers for unpacking input rows
-	//DeallocateEncoderUnpackingBuffers(encoder);
+	DeallocateHorizontalBuffers(allocator, lowpass_buffer, highpass_buffer);
 
 	return CODEC_ERROR_OKAY;
 }
 
+/*!
+	@brief Apply the forward spatial wavelet transform to the component array
+
+	Each channel in the bitstream represents a single component array.
+	
+	This routine applies the forward spatial wavelet transform to the
+	component array for the specified channel.  The component array may
+	be divided into strips that are transformed concurrently.
+*/
+CODEC_ERROR TransformForwardSpatialChannel(ENCODER *encoder,
+										   const UNPACKED_IMAGE *image,
+										   int channel_number)
+{
+	DIMENSION input_width = encoder->channel[channel_number].width;
+	DIMENSION input_height = encoder->channel[channel_number].height;
+
+	size_t input_pitch = image->component_array_list[channel_number].pitch;
+	void *buffer = image->component_array_list[channel_number].data;
+
+	// The output wavelet is at the first level in the wavelet tree
+	WAVELET *wavelet = encoder->transform[channel_number].wavelet[0];
+
+	// The prescale is applied to the input values before the wavelet transform
+	int prescale = encoder->transform[channel_number].prescale[0];
+
+	return TransformForwardSpatialStrips(encoder, (PIXEL *)buffer, input_pitch, input_width, input_height,
+										 wavelet, wavelet->width, prescale);
+}
+
 /*!
 	@brief Apply the forward spatial wavelet transform to the lowpass band
 
@@ -3092,169 +3196,13 @@ CODEC_ERROR TransformForwardSpatialChannel(ENCODER *encoder,
 */
 CODEC_ERROR TransformForwardSpatialLowpass(ENCODER *encoder, WAVELET *input, WAVELET *output, int prescale)
 {
-	ALLOCATOR *allocator = encoder->allocator;
-
 	DIMENSION input_width = input->width;
 	DIMENSION input_height = input->height;
 
 	DIMENSION output_width = ((input_width % 2) == 0) ? input_width / 2 : (input_width + 1) / 2;
 
-	//TODO: Need to calculate the actual bottom row without padding
-
-	int horizontal_buffer_row;
-
-	// The last row of the transform is calculated using the display height
-	int bottom_input_row = input_height - 2;
-
-	// Calculate the last row for reading more rows from the input wavelet
-	//int last_input_row = bottom_input_row - 2;
-	//int last_input_row = input_height - 2;
-	int last_input_row;
-
-	int input_row = 0;
-
-	//int midpoint_prequant = encoder->q.midpoint_prequant;
-	int midpoint_prequant = encoder->midpoint_prequant;
-
-	PIXEL *lowpass_buffer[ROW_BUFFER_COUNT];
-	PIXEL *highpass_buffer[ROW_BUFFER_COUNT];
-
-	PIXEL *prescaled_buffer;
-	size_t prescaled_size;
-
-	int row;
-
-#if (0 && DEBUG)
-	printf("TransformForwardSpatialLowpass output width: %d, quant: %d %d %d %d\n",
-		output_width, output->quant[0], output->quant[1], output->quant[2], output->quant[3]);
-#endif
-
-	// Adjust the bottom input row if the wavelet height is odd
-	if ((input_height % 2) != 0) {
-		bottom_input_row++;
-	}
-
-	// The bottom input row must be even
-	assert((bottom_input_row % 2) == 0);
-
-	// Calculate the last row for reading more rows from the input wavelet
-	last_input_row = bottom_input_row - 2;
-
-	// The last input row must be even
-	assert((last_input_row % 2) == 0);
-
-	// Allocate six pairs of lowpass and highpass buffers
-	AllocateHorizontalBuffers(allocator, lowpass_buffer, highpass_buffer, output_width);
-
-	// Allocate a buffer for the prescaled input values
-	prescaled_size = input_width * sizeof(PIXEL);
-	prescaled_buffer = Alloc(allocator, prescaled_size);
-
-	// Compute six pairs of horizontal transform results
-	for (row = 0; row < ROW_BUFFER_COUNT; row++)
-	{
-		PIXEL *input_row_ptr = WaveletRowAddress(input, LL_BAND, row);
-
-		//PrescaleInputRow(input_row_ptr, prescaled_buffer, input_width, prescale);
-
-		// Apply the horizontal wavelet transform to each input row
-		//FilterHorizontalRow(prescaled_buffer,
-		FilterHorizontalRow(input_row_ptr,
-							lowpass_buffer[row],
-							highpass_buffer[row],
-							input_width,
-							prescale);
-	}
-
-	// Process the first row as a special case
-	input_row = 0;
-
-	FilterVerticalTopRow(lowpass_buffer,
-						 highpass_buffer,
-						 output->data,
-						 output->pitch,
-						 output->band_count,
-						 input_row,
-						 output_width,
-						 output->quant,
-						 midpoint_prequant);
-
-	// Advance to the second pair of rows and use the first six horizontal results
-	input_row += 2;
-
-	// Process the middle rows
-	for (; input_row < bottom_input_row; input_row += 2)
-	//for (; input_row < last_input_row; input_row += 2)
-	{
-		// Check for errors in the row calculation
-		assert((input_row % 2) == 0);
-
-		FilterVerticalMiddleRow(lowpass_buffer,
-								highpass_buffer,
-								output->data,
-								output->pitch,
-								output->band_count,
-								input_row,
-								output_width,
-								output->quant,
-								midpoint_prequant);
-
-		if (input_row < last_input_row)
-		{
-			// Shift the intermediate horizontal results to make room for the next two rows
-			ShiftHorizontalBuffers(lowpass_buffer, highpass_buffer);
-
-			// Get two more rows of horizontal lowpass and highpass results
-			for (horizontal_buffer_row = 4; horizontal_buffer_row < ROW_BUFFER_COUNT; horizontal_buffer_row++)
-			{
-				int next_input_row = input_row + horizontal_buffer_row;
-				PIXEL *input_row_ptr;
-
-				if (next_input_row >= input_height)
-				{
-					// Duplicate the last input row
-					next_input_row = input_height - 1;
-				}
-
-				input_row_ptr = WaveletRowAddress(input, LL_BAND, next_input_row);
-
-				//PrescaleInputRow(input_row_ptr, prescaled_buffer, input_width, prescale);
-
-				//FilterHorizontalRow(prescaled_buffer,
-				FilterHorizontalRow(input_row_ptr,
-									lowpass_buffer[horizontal_buffer_row],
-									highpass_buffer[horizontal_buffer_row],
-									input_width,
-									prescale);
-			}
-		}
-	}
-
-	// Should have exited the loop at the last row
-	assert(input_row == bottom_input_row);
-	//assert(input_row == last_input_row);
-
-	// Process the last row as a special case
-	FilterVerticalBottomRow(lowpass_buffer,
-							highpass_buffer,
-							output->data,
-							output->pitch,
-							output->band_count,
-							input_row,
-							output_width,
-							output->quant,
-							midpoint_prequant);
-
-	// Fill the unused rows in the wavelet bands
-	//PadWaveletBands(output, actual_height);
-
-	//TODO: Set the valid band mask for all bands in the wavelet in each channel
-
-	DeallocateHorizontalBuffers(allocator, lowpass_buffer, highpass_buffer);
-
-	Free(allocator, prescaled_buffer);
-
-	return CODEC_ERROR_OKAY;
+	return TransformForwardSpatialStrips(encoder, input->data[LL_BAND], input->pitch, input_width, input_height,
+										 output, output_width, prescale);
 }
 
 #if 0
@@ -3732,20 +3680,12 @@ CODEC_ERROR SetEncodedBandMask(CODEC_STATE *codec, int subband)
 */
 CODEC_ERROR EncodeLowpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_number, BITSTREAM *stream)
 {
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	CODEC_STATE *codec = &encoder->codec;
 	//FILE *logfile = encoder->logfile;
 	//int subband = 0;
 	//int level = encoder->wavelet_count;
-	int width = wavelet->width;
-	int height = wavelet->height;
-	uint8_t *lowpass_row_ptr;
-	int lowpass_pitch;
-	int row;
-
-	PRECISION lowpass_precision = encoder->channel[channel_number].lowpass_precision;
-
-	lowpass_row_ptr = (uint8_t *)wavelet->data[LL_BAND];
-	lowpass_pitch = wavelet->pitch;
+	BITSTREAM *encoded_subband = encoder->encoded_subband[channel_number][0];
     
 #if VC5_ENABLED_PART(VC5_PART_SECTIONS)
     if (IsEncoderSectionEnabled(encoder, SECTION_NUMBER_SUBBAND))
@@ -3764,6 +3704,62 @@ CODEC_ERROR EncodeLowpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_nu
 	// Check that the bitstream is tag aligned before writing the pixels
 	assert(IsAlignedSegment(stream));
 
+	if (encoded_subband != NULL)
+	{
+		// The lowpass coefficients have already been encoded
+		StartTimer(STAGE_TIMER(encoder->timing, write));
+		error = AppendBitstream(stream, encoded_subband);
+		StopTimer(STAGE_TIMER(encoder->timing, write));
+	}
+	else
+	{
+		StartTimer(STAGE_TIMER(encoder->timing, encoding[0]));
+		error = EncodeLowpassCoefficients(encoder, wavelet, channel_number, stream);
+		StopTimer(STAGE_TIMER(encoder->timing, encoding[0]));
+	}
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	PutVideoLowpassTrailer(stream);
+
+	// Update the subband number in the codec state
+	codec->subband_number++;
+
+#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
+    if (IsEncoderSectionEnabled(encoder, SECTION_NUMBER_SUBBAND))
+    {
+        // Make sure that the bitstream is aligned to a segment boundary
+        AlignBitsSegment(stream);
+        
+        // Update the section header with the actual size of the subband section
+        EndSection(stream);
+    }
+#endif
+
+    return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Encode the lowpass coefficients without the lowpass band header and trailer
+
+	The lowpass coefficients are written into the bitstream using the lowpass
+	precision for the channel and the bitstream is aligned to a segment boundary.
+*/
+CODEC_ERROR EncodeLowpassCoefficients(ENCODER *encoder, WAVELET *wavelet, int channel_number, BITSTREAM *stream)
+{
+	int width = wavelet->width;
+	int height = wavelet->height;
+	uint8_t *lowpass_row_ptr;
+	int lowpass_pitch;
+	int row;
+
+	PRECISION lowpass_precision = encoder->channel[channel_number].lowpass_precision;
+
+	lowpass_row_ptr = (uint8_t *)wavelet->data[LL_BAND];
+	lowpass_pitch = wavelet->pitch;
+
 	for (row = 0; row < height; row++)
 	{
 		uint16_t *lowpass = (uint16_t *)lowpass_row_ptr;
@@ -3784,23 +3780,37 @@ CODEC_ERROR EncodeLowpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_nu
 	// Align the bitstream to a segment boundary
 	AlignBitsSegment(stream);
 
-	PutVideoLowpassTrailer(stream);
+	return CODEC_ERROR_OKAY;
+}
 
-	// Update the subband number in the codec state
-	codec->subband_number++;
+/*!
+	@brief Encode the highpass coefficients without the subband header and trailer
 
-#if VC5_ENABLED_PART(VC5_PART_SECTIONS)
-    if (IsEncoderSectionEnabled(encoder, SECTION_NUMBER_SUBBAND))
-    {
-        // Make sure that the bitstream is aligned to a segment boundary
-        AlignBitsSegment(stream);
-        
-        // Update the section header with the actual size of the subband section
-        EndSection(stream);
-    }
-#endif
+	The coefficients are encoded using run lengths and the codebook in the encoder
+	and the bitstream is aligned to a segment boundary.
+*/
+CODEC_ERROR EncodeHighpassCoefficients(ENCODER *encoder, WAVELET *wavelet, int band, BITSTREAM *stream)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
 
-    return CODEC_ERROR_OKAY;
+	DIMENSION band_width = wavelet->width;
+	DIMENSION band_height = wavelet->height;
+
+	void *band_data = wavelet->data[band];
+	DIMENSION band_pitch = wavelet->pitch;
+
+	CODESET *codeset = encoder->codeset;
+
+	// Encode the highpass coefficients for this subband into the bitstream
+	error = EncodeHighpassBandRowRuns(stream, codeset, band_data, band_width, band_height, band_pitch);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	// Align the bitstream to a segment boundary
+	AlignBitsSegment(stream);
+
+	return CODEC_ERROR_OKAY;
 }
 
 /*!
@@ -3809,25 +3819,22 @@ CODEC_ERROR EncodeLowpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_nu
 	The specified wavelet band is decoded from the bitstream
 	using the codebook and encoding method specified in the
 	bitstream.
+
+	If the subband has already been entropy coded into a separate
+	bitstream, the encoded subband is appended after the subband header.
 */
-CODEC_ERROR EncodeHighpassBand(ENCODER *encoder, WAVELET *wavelet, int band, int subband, BITSTREAM *stream)
+CODEC_ERROR EncodeHighpassBand(ENCODER *encoder, WAVELET *wavelet, int channel_number, int band, int subband, BITSTREAM *stream)
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	CODEC_STATE *codec = &encoder->codec;
 
-	DIMENSION band_width = wavelet->width;
-	DIMENSION band_height = wavelet->height;
-
-	void *band_data = wavelet->data[band];
-	DIMENSION band_pitch = wavelet->pitch;
-
 	QUANT quantization = wavelet->quant[band];
 	//uint16_t scale = wavelet->scale[band];
 
 	//int divisor = 0;
 	//int peaks_coding = 0;
 
-	CODESET *codeset = encoder->codeset;
+	BITSTREAM *encoded_subband = encoder->encoded_subband[channel_number][subband];
 
 	//int encoding_method = BAND_ENCODING_RUNLENGTHS;
 
@@ -3848,15 +3855,24 @@ CODEC_ERROR EncodeHighpassBand(ENCODER *encoder, WAVELET *wavelet, int band, int
     // Output the tag-value pairs for this subband
 	PutVideoSubbandHeader(encoder, subband, quantization, stream);
 
-	// Encode the highpass coefficients for this subband into the bitstream
-	error = EncodeHighpassBandRowRuns(stream, codeset, band_data, band_width, band_height, band_pitch);
+	if (encoded_subband != NULL)
+	{
+		// The highpass coefficients have already been encoded
+		StartTimer(STAGE_TIMER(encoder->timing, write));
+		error = AppendBitstream(stream, encoded_subband);
+		StopTimer(STAGE_TIMER(encoder->timing, write));
+	}
+	else
+	{
+		StartTimer(STAGE_TIMER(encoder->timing, encoding[subband]));
+		error = EncodeHighpassCoefficients(encoder, wavelet, band, stream);
+		StopTimer(STAGE_TIMER(encoder->timing, encoding[subband]));
+	}
+
 	if (error != CODEC_ERROR_OKAY) {
 		return error;
 	}
 
-	// Align the bitstream to a segment boundary
-	AlignBitsSegment(stream);
-
 	// Output the band trailer
 	PutVideoSubbandTrailer(encoder, stream);
 
@@ -4041,7 +4057,6 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, CODESET *codeset, PIXEL
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	size_t data_count;
-	int row_padding;
 	int row = 0;
 	//int column = 0;
 	//size_t index = 0;
@@ -4079,9 +4094,6 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, CODESET *codeset, PIXEL
 	// Compute the number of values in the band to be encoded
 	data_count = height * width;
 
-	// Compute the number of values of padding at the end of each row
-	row_padding = pitch - width;
-
 	for (row = 0; row < height; row++)
 	{
 		int index = 0;			// Start at the beginning of the row
@@ -4129,9 +4141,6 @@ CODEC_ERROR EncodeHighpassBandRowRuns(BITSTREAM *stream, CODESET *codeset, PIXEL
 				// Advance to the next column
 				index++;
 			}
-
-			// Add the end of row padding to the encoded length
-			if (index == width) count += row_padding;
 		}
 
 		// Should have processed the entire row
@@ -4365,10 +4374,9 @@ CODEC_ERROR DumpEncodedSubbands(ENCODER *encoder,
 			DIMENSION width = wavelet->width;
 			DIMENSION height = wavelet->height;
 			void *data = wavelet->data[band_index];
-			size_t size = width * height * sizeof(PIXEL);
 
-			WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-				band_index, BAND_TYPE_SINT16, width, height, data, size);
+			WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+				band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 		}
 	}
 
@@ -4431,10 +4439,9 @@ CODEC_ERROR DumpWaveletBands(ENCODER *encoder,
 			DIMENSION width = wavelet->width;
 			DIMENSION height = wavelet->height;
 			void *data = wavelet->data[band_index];
-			size_t size = width * height * sizeof(PIXEL);
 
-			WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-				band_index, BAND_TYPE_SINT16, width, height, data, size);
+			WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+				band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 		}
 	}
 
@@ -4505,10 +4512,9 @@ CODEC_ERROR DumpTransformBands(ENCODER *encoder,
 						DIMENSION width = wavelet->width;
 						DIMENSION height = wavelet->height;
 						void *data = wavelet->data[band_index];
-						size_t size = wavelet->width * wavelet->height * sizeof(PIXEL);
 
-						WriteWaveletBand(&file, frame_index, channel_index, wavelet_index,
-							band_index, BAND_TYPE_SINT16, width, height, data, size);
+						WriteWaveletBandRows(&file, frame_index, channel_index, wavelet_index,
+							band_index, BAND_TYPE_SINT16, width, height, data, wavelet->pitch);
 					}
 				}
 			}
@@ -17,6 +17,7 @@ static const int32_t rounding = 4;
 CODEC_ERROR FilterHorizontalRow(PIXEL *input, PIXEL *lowpass, PIXEL *highpass, int width, int prescale)
 {
 	int last_input_column;		// Column at which right border processing is done
+	int interior_count;			// Number of pairs of columns processed by the interior filter
 	int column = 0;
 	int32_t sum;
 
@@ -52,11 +53,18 @@ CODEC_ERROR FilterHorizontalRow(PIXEL *input, PIXEL *lowpass, PIXEL *highpass, i
 
 	/***** Process the internal pixels using the normal wavelet formula *****/
 
-	for (column = 2; column < last_input_column; column += 2)
-	{
-		// Column index should always be divisible by two
-		assert((column % 2) == 0);
+	// The pair of columns before the right border duplicates the last column if the width is odd
+	interior_count = (last_input_column - 2) / 2;
+	if ((width % 2) != 0 && interior_count > 0) {
+		interior_count--;
+	}
+
+	FilterInteriorColumns16s(&input[2], &lowpass[1], &highpass[1], interior_count, prescale);
+
+	column = 2 + 2 * interior_count;
 
+	if (column < last_input_column)
+	{
 		// Compute the lowpass coefficient
 		lowpass[column/2] = (input[column + 0] + input[column + 1] + prescale_rounding) >> prescale;
 
@@ -65,22 +73,18 @@ CODEC_ERROR FilterHorizontalRow(PIXEL *input, PIXEL *lowpass, PIXEL *highpass, i
 
 		sum -= (input[column - 2] + prescale_rounding) >> prescale;
 		sum -= (input[column - 1] + prescale_rounding) >> prescale;
+
+		// Duplicate the value in the last column
 		sum += (input[column + 2] + prescale_rounding) >> prescale;
-		if ((column + 3) < width)
-		{
-			// Use the value in the last column
-			sum += (input[column + 3] + prescale_rounding) >> prescale;
-		} 
-		else
-		{
-			// Duplicate the value in the last column
-			sum += (input[column + 2] + prescale_rounding) >> prescale;
-		}
+		sum += (input[column + 2] + prescale_rounding) >> prescale;
+
 		sum += rounding;
 		sum = DivideByShift(sum, 3);
 		sum += (input[column + 0] + prescale_rounding) >> prescale;
 		sum -= (input[column + 1] + prescale_rounding) >> prescale;
 		highpass[column/2] = ClampPixel(sum);
+
+		column += 2;
 	}
 
 	// Should have exited the loop at the last column
@@ -203,7 +207,6 @@ CODEC_ERROR FilterVerticalMiddleRow(PIXEL *lowpass[], PIXEL *highpass[],
 									int32_t midpoint_prequant)
 {
 	PIXEL *result[MAX_BAND_COUNT];
-	int column;
 	int band;
 
 	//uint16_t **lowpass = (uint16_t **)lowpass_buffer;
@@ -220,47 +223,13 @@ CODEC_ERROR FilterVerticalMiddleRow(PIXEL *lowpass[], PIXEL *highpass[],
 		result[band] = (PIXEL *)band_row_ptr;
 	}
 
-	for (column = 0; column < wavelet_width; column++)
-	{
-		int32_t sum;
-
-		// Apply the lowpass vertical filter to the lowpass horizontal results
-		sum  = lowpass[2][column];
-		sum += lowpass[3][column];
-		result[LL_BAND][column] = ClampPixel(sum);
-		assert(result[LL_BAND][column] >= 0);
+	// Apply the vertical filters to the lowpass horizontal results (the lowpass band is not quantized)
+	FilterInteriorRows16s(lowpass, result[LL_BAND], result[HL_BAND], wavelet_width,
+						  1, quant[HL_BAND], midpoint_prequant);
 
-		// Apply the highpass vertical filter to the lowpass horizontal results
-		sum  = -1 * lowpass[0][column];
-		sum += -1 * lowpass[1][column];
-		sum +=  1 * lowpass[4][column];
-		sum +=  1 * lowpass[5][column];
-		//sum += 4;
-		//sum >>= 3;
-		sum +=	rounding;
-		sum = DivideByShift(sum, 3);
-		sum +=  1 * lowpass[2][column];
-		sum += -1 * lowpass[3][column];
-		result[HL_BAND][column] = QuantizePixel(sum, quant[HL_BAND], midpoint_prequant);
-
-		// Apply the lowpass vertical filter to the highpass horizontal results
-		sum  = highpass[2][column];
-		sum += highpass[3][column];
-		result[LH_BAND][column] = QuantizePixel(sum, quant[LH_BAND], midpoint_prequant);
-
-		// Apply the highpass vertical filter to the highpass horizontal results
-		sum  = -1 * highpass[0][column];
-		sum += -1 * highpass[1][column];
-		sum +=  1 * highpass[4][column];
-		sum +=  1 * highpass[5][column];
-		//sum += 4;
-		//sum >>= 3;
-		sum +=	rounding;
-		sum = DivideByShift(sum, 3);
-		sum +=  1 * highpass[2][column];
-		sum += -1 * highpass[3][column];
-		result[HH_BAND][column] = QuantizePixel(sum, quant[HH_BAND], midpoint_prequant);
-	}
+	// Apply the vertical filters to the highpass horizontal results
+	FilterInteriorRows16s(highpass, result[LH_BAND], result[HH_BAND], wavelet_width,
+						  quant[LH_BAND], quant[HH_BAND], midpoint_prequant);
 
 	return CODEC_ERROR_OKAY;
 }
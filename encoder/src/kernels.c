@@ -0,0 +1,708 @@
+/*!	@file encoder/src/kernels.c
+
+	Implementation of the kernels that apply the interior forward wavelet filters.
+
+	The forward filters are computed with 32-bit intermediate results.  The vectorized
+	kernels widen the 16-bit inputs to 32 bits, apply the same prescale shifts and
+	quantization as the scalar kernels, and narrow the results with signed saturation,
+	which is the same as clamping the results to the range of the pixel values.  The
+	horizontal lowpass results are not clamped, so they are truncated to 16 bits before
+	narrowing.  The columns that are left over after the last full vector are processed
+	by the scalar kernels.
+
+	Quantization multiplies the magnitude of each value plus the midpoint by the
+	reciprocal of the divisor and keeps the upper half of the 32-bit product, which
+	is the computation in @ref QuantizePixel.
+
+	The kernels are selected once by @ref SelectForwardKernels using the processor
+	features reported by @ref GetCPUFeatures.  The scalar kernels are used until the
+	kernels are selected and are the reference implementation for the vectorized kernels.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+#if _SIMD_X86
+#include <immintrin.h>
+#endif
+
+#if _SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+
+//! Rounding added to the highpass sum before division
+static const int32_t rounding = 4;
+
+
+/*!
+	@brief Apply the interior forward horizontal filter using scalar arithmetic
+*/
+static void FilterColumnsScalar(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+								int count, int prescale)
+{
+	int prescale_rounding = (1 << prescale) - 1;
+	int column;
+
+	for (column = 0; column < count; column++)
+	{
+		const PIXEL *pair = &input[2 * column];
+		int32_t sum;
+
+		// Compute the lowpass coefficient
+		lowpass[column] = (pair[0] + pair[1] + prescale_rounding) >> prescale;
+
+		// Compute the highpass coefficient
+		sum = 0;
+
+		sum -= (pair[-2] + prescale_rounding) >> prescale;
+		sum -= (pair[-1] + prescale_rounding) >> prescale;
+		sum += (pair[2] + prescale_rounding) >> prescale;
+		sum += (pair[3] + prescale_rounding) >> prescale;
+		sum += rounding;
+		sum = DivideByShift(sum, 3);
+		sum += (pair[0] + prescale_rounding) >> prescale;
+		sum -= (pair[1] + prescale_rounding) >> prescale;
+		highpass[column] = ClampPixel(sum);
+	}
+}
+
+/*!
+	@brief Apply the interior forward vertical filter using scalar arithmetic
+*/
+static void FilterRowsScalar(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+							 QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant)
+{
+	int column;
+
+	for (column = 0; column < count; column++)
+	{
+		int32_t sum;
+
+		// Apply the lowpass vertical filter
+		sum  = input[2][column];
+		sum += input[3][column];
+		lowpass[column] = QuantizePixel(sum, lowpass_quant, midpoint_prequant);
+
+		// Apply the highpass vertical filter
+		sum  = -1 * input[0][column];
+		sum += -1 * input[1][column];
+		sum +=  1 * input[4][column];
+		sum +=  1 * input[5][column];
+		sum += rounding;
+		sum = DivideByShift(sum, 3);
+		sum +=  1 * input[2][column];
+		sum += -1 * input[3][column];
+		highpass[column] = QuantizePixel(sum, highpass_quant, midpoint_prequant);
+	}
+}
+
+//! Kernels that use scalar arithmetic
+static const FORWARD_KERNELS scalar_kernels = {"scalar", FilterColumnsScalar, FilterRowsScalar};
+
+
+/*!
+	@brief Return the multiplier used to quantize by the specified divisor (zero if not quantized)
+*/
+static uint32_t QuantizerMultiplier(QUANT divisor)
+{
+	return (divisor <= 1) ? 0 : (uint32_t)(1 << 16) / divisor;
+}
+
+
+#if _SIMD_X86
+
+/*!
+	@brief Widen the four coefficients in the low half of a vector to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenLowSSE2(__m128i x)
+{
+	return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+
+/*!
+	@brief Widen the four coefficients in the high half of a vector to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenHighSSE2(__m128i x)
+{
+	return _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+}
+
+/*!
+	@brief Widen the even columns in four pairs of columns to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenEvenSSE2(__m128i x)
+{
+	return _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+}
+
+/*!
+	@brief Widen the odd columns in four pairs of columns to 32 bits
+*/
+TARGET_SSE2 static inline __m128i WidenOddSSE2(__m128i x)
+{
+	return _mm_srai_epi32(x, 16);
+}
+
+/*!
+	@brief Compute the lower 32 bits of the products of the unsigned values in two vectors
+*/
+TARGET_SSE2 static inline __m128i MultiplyLowSSE2(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08), _mm_shuffle_epi32(odd, 0x08));
+}
+
+/*!
+	@brief Quantize four values using the midpoint and the reciprocal of the divisor
+*/
+TARGET_SSE2 static inline __m128i QuantizeSSE2(__m128i value, __m128i midpoint, __m128i multiplier)
+{
+	__m128i sign = _mm_srai_epi32(value, 31);
+	__m128i magnitude = _mm_sub_epi32(_mm_xor_si128(value, sign), sign);
+
+	magnitude = MultiplyLowSSE2(_mm_add_epi32(magnitude, midpoint), multiplier);
+	magnitude = _mm_srli_epi32(magnitude, 16);
+
+	return _mm_sub_epi32(_mm_xor_si128(magnitude, sign), sign);
+}
+
+/*!
+	@brief Compute the forward horizontal filter for four pairs of columns
+
+	The lowpass results are truncated to 16 bits and the highpass results are not clamped.
+*/
+TARGET_SSE2 static inline void FilterPairsSSE2(const PIXEL *input, __m128i prescale_rounding, __m128i prescale,
+											   __m128i *lowpass_out, __m128i *highpass_out)
+{
+	const __m128i round = _mm_set1_epi32(rounding);
+
+	__m128i before = _mm_loadu_si128((const __m128i *)&input[-2]);
+	__m128i pair = _mm_loadu_si128((const __m128i *)&input[0]);
+	__m128i after = _mm_loadu_si128((const __m128i *)&input[2]);
+
+	__m128i even = WidenEvenSSE2(pair);
+	__m128i odd = WidenOddSSE2(pair);
+	__m128i lowpass, sum;
+
+	lowpass = _mm_sra_epi32(_mm_add_epi32(_mm_add_epi32(even, odd), prescale_rounding), prescale);
+	*lowpass_out = _mm_srai_epi32(_mm_slli_epi32(lowpass, 16), 16);
+
+	sum = _mm_add_epi32(_mm_sra_epi32(_mm_add_epi32(WidenEvenSSE2(after), prescale_rounding), prescale),
+						_mm_sra_epi32(_mm_add_epi32(WidenOddSSE2(after), prescale_rounding), prescale));
+	sum = _mm_sub_epi32(sum, _mm_sra_epi32(_mm_add_epi32(WidenEvenSSE2(before), prescale_rounding), prescale));
+	sum = _mm_sub_epi32(sum, _mm_sra_epi32(_mm_add_epi32(WidenOddSSE2(before), prescale_rounding), prescale));
+	sum = _mm_srai_epi32(_mm_add_epi32(sum, round), 3);
+	sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_add_epi32(even, prescale_rounding), prescale));
+	*highpass_out = _mm_sub_epi32(sum, _mm_sra_epi32(_mm_add_epi32(odd, prescale_rounding), prescale));
+}
+
+/*!
+	@brief Apply the interior forward horizontal filter to eight pairs of columns at a time using SSE2
+*/
+TARGET_SSE2 static void FilterColumnsSSE2(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+										  int count, int prescale)
+{
+	const __m128i prescale_rounding = _mm_set1_epi32((1 << prescale) - 1);
+	const __m128i prescale_shift = _mm_cvtsi32_si128(prescale);
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		__m128i lowpass_low, highpass_low, lowpass_high, highpass_high;
+
+		FilterPairsSSE2(&input[2 * column + 0], prescale_rounding, prescale_shift, &lowpass_low, &highpass_low);
+		FilterPairsSSE2(&input[2 * column + 8], prescale_rounding, prescale_shift, &lowpass_high, &highpass_high);
+
+		_mm_storeu_si128((__m128i *)&lowpass[column], _mm_packs_epi32(lowpass_low, lowpass_high));
+		_mm_storeu_si128((__m128i *)&highpass[column], _mm_packs_epi32(highpass_low, highpass_high));
+	}
+
+	FilterColumnsScalar(&input[2 * column], &lowpass[column], &highpass[column], count - column, prescale);
+}
+
+/*!
+	@brief Compute the forward vertical filter for four columns before quantization
+*/
+TARGET_SSE2 static inline void FilterRowsHalfSSE2(const __m128i row[6], __m128i *lowpass_out, __m128i *highpass_out)
+{
+	const __m128i round = _mm_set1_epi32(rounding);
+
+	__m128i sum = _mm_sub_epi32(_mm_add_epi32(row[4], row[5]), _mm_add_epi32(row[0], row[1]));
+
+	sum = _mm_srai_epi32(_mm_add_epi32(sum, round), 3);
+
+	*lowpass_out = _mm_add_epi32(row[2], row[3]);
+	*highpass_out = _mm_sub_epi32(_mm_add_epi32(sum, row[2]), row[3]);
+}
+
+/*!
+	@brief Apply the interior forward vertical filter to eight columns at a time using SSE2
+*/
+TARGET_SSE2 static void FilterRowsSSE2(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+									   QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant)
+{
+	const uint32_t lowpass_multiplier = QuantizerMultiplier(lowpass_quant);
+	const uint32_t highpass_multiplier = QuantizerMultiplier(highpass_quant);
+
+	const __m128i lowpass_midpoint = _mm_set1_epi32(QuantizerMidpoint(midpoint_prequant, lowpass_quant));
+	const __m128i highpass_midpoint = _mm_set1_epi32(QuantizerMidpoint(midpoint_prequant, highpass_quant));
+	const __m128i lowpass_reciprocal = _mm_set1_epi32((int32_t)lowpass_multiplier);
+	const __m128i highpass_reciprocal = _mm_set1_epi32((int32_t)highpass_multiplier);
+
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		__m128i low[6], high[6];
+		__m128i lowpass_low, highpass_low, lowpass_high, highpass_high;
+		int i;
+
+		for (i = 0; i < 6; i++)
+		{
+			__m128i x = _mm_loadu_si128((const __m128i *)&input[i][column]);
+			low[i] = WidenLowSSE2(x);
+			high[i] = WidenHighSSE2(x);
+		}
+
+		FilterRowsHalfSSE2(low, &lowpass_low, &highpass_low);
+		FilterRowsHalfSSE2(high, &lowpass_high, &highpass_high);
+
+		if (lowpass_multiplier != 0)
+		{
+			lowpass_low = QuantizeSSE2(lowpass_low, lowpass_midpoint, lowpass_reciprocal);
+			lowpass_high = QuantizeSSE2(lowpass_high, lowpass_midpoint, lowpass_reciprocal);
+		}
+
+		if (highpass_multiplier != 0)
+		{
+			highpass_low = QuantizeSSE2(highpass_low, highpass_midpoint, highpass_reciprocal);
+			highpass_high = QuantizeSSE2(highpass_high, highpass_midpoint, highpass_reciprocal);
+		}
+
+		_mm_storeu_si128((__m128i *)&lowpass[column], _mm_packs_epi32(lowpass_low, lowpass_high));
+		_mm_storeu_si128((__m128i *)&highpass[column], _mm_packs_epi32(highpass_low, highpass_high));
+	}
+
+	if (column < count)
+	{
+		PIXEL *remainder[6];
+		int i;
+
+		for (i = 0; i < 6; i++) {
+			remainder[i] = &input[i][column];
+		}
+
+		FilterRowsScalar(remainder, &lowpass[column], &highpass[column], count - column,
+						 lowpass_quant, highpass_quant, midpoint_prequant);
+	}
+}
+
+//! Kernels that use SSE2 instructions
+static const FORWARD_KERNELS sse2_kernels = {"sse2", FilterColumnsSSE2, FilterRowsSSE2};
+
+
+/*!
+	@brief Load sixteen coefficients and widen the first eight coefficients to 32 bits
+*/
+TARGET_AVX2 static inline __m256i WidenLowAVX2(const PIXEL *input)
+{
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&input[0]));
+}
+
+/*!
+	@brief Load sixteen coefficients and widen the last eight coefficients to 32 bits
+*/
+TARGET_AVX2 static inline __m256i WidenHighAVX2(const PIXEL *input)
+{
+	return _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&input[8]));
+}
+
+/*!
+	@brief Quantize eight values using the midpoint and the reciprocal of the divisor
+*/
+TARGET_AVX2 static inline __m256i QuantizeAVX2(__m256i value, __m256i midpoint, __m256i multiplier)
+{
+	__m256i sign = _mm256_srai_epi32(value, 31);
+	__m256i magnitude = _mm256_abs_epi32(value);
+
+	magnitude = _mm256_mullo_epi32(_mm256_add_epi32(magnitude, midpoint), multiplier);
+	magnitude = _mm256_srli_epi32(magnitude, 16);
+
+	return _mm256_sub_epi32(_mm256_xor_si256(magnitude, sign), sign);
+}
+
+/*!
+	@brief Compute the forward horizontal filter for eight pairs of columns
+
+	The lowpass results are truncated to 16 bits and the highpass results are not clamped.
+*/
+TARGET_AVX2 static inline void FilterPairsAVX2(const PIXEL *input, __m256i prescale_rounding, __m128i prescale,
+											   __m256i *lowpass_out, __m256i *highpass_out)
+{
+	const __m256i round = _mm256_set1_epi32(rounding);
+
+	__m256i before = _mm256_loadu_si256((const __m256i *)&input[-2]);
+	__m256i pair = _mm256_loadu_si256((const __m256i *)&input[0]);
+	__m256i after = _mm256_loadu_si256((const __m256i *)&input[2]);
+
+	// Separate the even and odd columns in each pair and widen to 32 bits
+	__m256i even = _mm256_srai_epi32(_mm256_slli_epi32(pair, 16), 16);
+	__m256i odd = _mm256_srai_epi32(pair, 16);
+	__m256i before_even = _mm256_srai_epi32(_mm256_slli_epi32(before, 16), 16);
+	__m256i before_odd = _mm256_srai_epi32(before, 16);
+	__m256i after_even = _mm256_srai_epi32(_mm256_slli_epi32(after, 16), 16);
+	__m256i after_odd = _mm256_srai_epi32(after, 16);
+	__m256i lowpass, sum;
+
+	lowpass = _mm256_sra_epi32(_mm256_add_epi32(_mm256_add_epi32(even, odd), prescale_rounding), prescale);
+	*lowpass_out = _mm256_srai_epi32(_mm256_slli_epi32(lowpass, 16), 16);
+
+	sum = _mm256_add_epi32(_mm256_sra_epi32(_mm256_add_epi32(after_even, prescale_rounding), prescale),
+						   _mm256_sra_epi32(_mm256_add_epi32(after_odd, prescale_rounding), prescale));
+	sum = _mm256_sub_epi32(sum, _mm256_sra_epi32(_mm256_add_epi32(before_even, prescale_rounding), prescale));
+	sum = _mm256_sub_epi32(sum, _mm256_sra_epi32(_mm256_add_epi32(before_odd, prescale_rounding), prescale));
+	sum = _mm256_srai_epi32(_mm256_add_epi32(sum, round), 3);
+	sum = _mm256_add_epi32(sum, _mm256_sra_epi32(_mm256_add_epi32(even, prescale_rounding), prescale));
+	*highpass_out = _mm256_sub_epi32(sum, _mm256_sra_epi32(_mm256_add_epi32(odd, prescale_rounding), prescale));
+}
+
+/*!
+	@brief Apply the interior forward horizontal filter to sixteen pairs of columns at a time using AVX2
+
+	The results are narrowed within each 128-bit lane, so the 64-bit quarters of the
+	packed results are permuted to restore the column order.
+*/
+TARGET_AVX2 static void FilterColumnsAVX2(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+										  int count, int prescale)
+{
+	const __m256i prescale_rounding = _mm256_set1_epi32((1 << prescale) - 1);
+	const __m128i prescale_shift = _mm_cvtsi32_si128(prescale);
+	int column;
+
+	for (column = 0; column + 16 <= count; column += 16)
+	{
+		__m256i lowpass_low, highpass_low, lowpass_high, highpass_high;
+
+		FilterPairsAVX2(&input[2 * column + 0], prescale_rounding, prescale_shift, &lowpass_low, &highpass_low);
+		FilterPairsAVX2(&input[2 * column + 16], prescale_rounding, prescale_shift, &lowpass_high, &highpass_high);
+
+		_mm256_storeu_si256((__m256i *)&lowpass[column],
+							_mm256_permute4x64_epi64(_mm256_packs_epi32(lowpass_low, lowpass_high), 0xD8));
+		_mm256_storeu_si256((__m256i *)&highpass[column],
+							_mm256_permute4x64_epi64(_mm256_packs_epi32(highpass_low, highpass_high), 0xD8));
+	}
+
+	FilterColumnsScalar(&input[2 * column], &lowpass[column], &highpass[column], count - column, prescale);
+}
+
+/*!
+	@brief Compute the forward vertical filter for eight columns before quantization
+*/
+TARGET_AVX2 static inline void FilterRowsHalfAVX2(const __m256i row[6], __m256i *lowpass_out, __m256i *highpass_out)
+{
+	const __m256i round = _mm256_set1_epi32(rounding);
+
+	__m256i sum = _mm256_sub_epi32(_mm256_add_epi32(row[4], row[5]), _mm256_add_epi32(row[0], row[1]));
+
+	sum = _mm256_srai_epi32(_mm256_add_epi32(sum, round), 3);
+
+	*lowpass_out = _mm256_add_epi32(row[2], row[3]);
+	*highpass_out = _mm256_sub_epi32(_mm256_add_epi32(sum, row[2]), row[3]);
+}
+
+/*!
+	@brief Apply the interior forward vertical filter to sixteen columns at a time using AVX2
+*/
+TARGET_AVX2 static void FilterRowsAVX2(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+									   QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant)
+{
+	const uint32_t lowpass_multiplier = QuantizerMultiplier(lowpass_quant);
+	const uint32_t highpass_multiplier = QuantizerMultiplier(highpass_quant);
+
+	const __m256i lowpass_midpoint = _mm256_set1_epi32(QuantizerMidpoint(midpoint_prequant, lowpass_quant));
+	const __m256i highpass_midpoint = _mm256_set1_epi32(QuantizerMidpoint(midpoint_prequant, highpass_quant));
+	const __m256i lowpass_reciprocal = _mm256_set1_epi32((int32_t)lowpass_multiplier);
+	const __m256i highpass_reciprocal = _mm256_set1_epi32((int32_t)highpass_multiplier);
+
+	int column;
+
+	for (column = 0; column + 16 <= count; column += 16)
+	{
+		__m256i low[6], high[6];
+		__m256i lowpass_low, highpass_low, lowpass_high, highpass_high;
+		int i;
+
+		for (i = 0; i < 6; i++)
+		{
+			low[i] = WidenLowAVX2(&input[i][column]);
+			high[i] = WidenHighAVX2(&input[i][column]);
+		}
+
+		FilterRowsHalfAVX2(low, &lowpass_low, &highpass_low);
+		FilterRowsHalfAVX2(high, &lowpass_high, &highpass_high);
+
+		if (lowpass_multiplier != 0)
+		{
+			lowpass_low = QuantizeAVX2(lowpass_low, lowpass_midpoint, lowpass_reciprocal);
+			lowpass_high = QuantizeAVX2(lowpass_high, lowpass_midpoint, lowpass_reciprocal);
+		}
+
+		if (highpass_multiplier != 0)
+		{
+			highpass_low = QuantizeAVX2(highpass_low, highpass_midpoint, highpass_reciprocal);
+			highpass_high = QuantizeAVX2(highpass_high, highpass_midpoint, highpass_reciprocal);
+		}
+
+		_mm256_storeu_si256((__m256i *)&lowpass[column],
+							_mm256_permute4x64_epi64(_mm256_packs_epi32(lowpass_low, lowpass_high), 0xD8));
+		_mm256_storeu_si256((__m256i *)&highpass[column],
+							_mm256_permute4x64_epi64(_mm256_packs_epi32(highpass_low, highpass_high), 0xD8));
+	}
+
+	if (column < count)
+	{
+		PIXEL *remainder[6];
+		int i;
+
+		for (i = 0; i < 6; i++) {
+			remainder[i] = &input[i][column];
+		}
+
+		FilterRowsScalar(remainder, &lowpass[column], &highpass[column], count - column,
+						 lowpass_quant, highpass_quant, midpoint_prequant);
+	}
+}
+
+//! Kernels that use AVX2 instructions
+static const FORWARD_KERNELS avx2_kernels = {"avx2", FilterColumnsAVX2, FilterRowsAVX2};
+
+#endif
+
+
+#if _SIMD_NEON
+
+/*!
+	@brief Quantize four values using the midpoint and the reciprocal of the divisor
+*/
+static inline int32x4_t QuantizeNEON(int32x4_t value, int32x4_t midpoint, uint32x4_t multiplier)
+{
+	int32x4_t sign = vshrq_n_s32(value, 31);
+	uint32x4_t magnitude = vreinterpretq_u32_s32(vaddq_s32(vabsq_s32(value), midpoint));
+
+	magnitude = vshrq_n_u32(vmulq_u32(magnitude, multiplier), 16);
+
+	return vsubq_s32(veorq_s32(vreinterpretq_s32_u32(magnitude), sign), sign);
+}
+
+/*!
+	@brief Compute the forward horizontal filter for four pairs of columns
+
+	The arguments are the even and odd columns in the pairs before, at, and after each
+	pair of columns.  The lowpass results are truncated to 16 bits by the caller.
+*/
+static inline void FilterPairsNEON(int32x4_t before_even, int32x4_t before_odd,
+								   int32x4_t even, int32x4_t odd,
+								   int32x4_t after_even, int32x4_t after_odd,
+								   int32x4_t prescale_rounding, int32x4_t prescale,
+								   int32x4_t *lowpass_out, int32x4_t *highpass_out)
+{
+	const int32x4_t round = vdupq_n_s32(rounding);
+	int32x4_t sum;
+
+	// Shifting left by the negative prescale is an arithmetic right shift
+	*lowpass_out = vshlq_s32(vaddq_s32(vaddq_s32(even, odd), prescale_rounding), prescale);
+
+	sum = vaddq_s32(vshlq_s32(vaddq_s32(after_even, prescale_rounding), prescale),
+					vshlq_s32(vaddq_s32(after_odd, prescale_rounding), prescale));
+	sum = vsubq_s32(sum, vshlq_s32(vaddq_s32(before_even, prescale_rounding), prescale));
+	sum = vsubq_s32(sum, vshlq_s32(vaddq_s32(before_odd, prescale_rounding), prescale));
+	sum = vshrq_n_s32(vaddq_s32(sum, round), 3);
+	sum = vaddq_s32(sum, vshlq_s32(vaddq_s32(even, prescale_rounding), prescale));
+	*highpass_out = vsubq_s32(sum, vshlq_s32(vaddq_s32(odd, prescale_rounding), prescale));
+}
+
+/*!
+	@brief Apply the interior forward horizontal filter to eight pairs of columns at a time using NEON
+*/
+static void FilterColumnsNEON(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+							  int count, int prescale)
+{
+	const int32x4_t prescale_rounding = vdupq_n_s32((1 << prescale) - 1);
+	const int32x4_t prescale_shift = vdupq_n_s32(-prescale);
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		// Load the pairs of columns with the even and odd columns in separate vectors
+		int16x8x2_t before = vld2q_s16(&input[2 * column - 2]);
+		int16x8x2_t pair = vld2q_s16(&input[2 * column]);
+		int16x8x2_t after = vld2q_s16(&input[2 * column + 2]);
+
+		int32x4_t lowpass_low, highpass_low, lowpass_high, highpass_high;
+
+		FilterPairsNEON(vmovl_s16(vget_low_s16(before.val[0])), vmovl_s16(vget_low_s16(before.val[1])),
+						vmovl_s16(vget_low_s16(pair.val[0])), vmovl_s16(vget_low_s16(pair.val[1])),
+						vmovl_s16(vget_low_s16(after.val[0])), vmovl_s16(vget_low_s16(after.val[1])),
+						prescale_rounding, prescale_shift, &lowpass_low, &highpass_low);
+
+		FilterPairsNEON(vmovl_s16(vget_high_s16(before.val[0])), vmovl_s16(vget_high_s16(before.val[1])),
+						vmovl_s16(vget_high_s16(pair.val[0])), vmovl_s16(vget_high_s16(pair.val[1])),
+						vmovl_s16(vget_high_s16(after.val[0])), vmovl_s16(vget_high_s16(after.val[1])),
+						prescale_rounding, prescale_shift, &lowpass_high, &highpass_high);
+
+		// The lowpass results are truncated and the highpass results are clamped
+		vst1q_s16(&lowpass[column], vcombine_s16(vmovn_s32(lowpass_low), vmovn_s32(lowpass_high)));
+		vst1q_s16(&highpass[column], vcombine_s16(vqmovn_s32(highpass_low), vqmovn_s32(highpass_high)));
+	}
+
+	FilterColumnsScalar(&input[2 * column], &lowpass[column], &highpass[column], count - column, prescale);
+}
+
+/*!
+	@brief Compute the forward vertical filter for four columns before quantization
+*/
+static inline void FilterRowsHalfNEON(const int32x4_t row[6], int32x4_t *lowpass_out, int32x4_t *highpass_out)
+{
+	const int32x4_t round = vdupq_n_s32(rounding);
+
+	int32x4_t sum = vsubq_s32(vaddq_s32(row[4], row[5]), vaddq_s32(row[0], row[1]));
+
+	sum = vshrq_n_s32(vaddq_s32(sum, round), 3);
+
+	*lowpass_out = vaddq_s32(row[2], row[3]);
+	*highpass_out = vsubq_s32(vaddq_s32(sum, row[2]), row[3]);
+}
+
+/*!
+	@brief Apply the interior forward vertical filter to eight columns at a time using NEON
+*/
+static void FilterRowsNEON(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+						   QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant)
+{
+	const uint32_t lowpass_multiplier = QuantizerMultiplier(lowpass_quant);
+	const uint32_t highpass_multiplier = QuantizerMultiplier(highpass_quant);
+
+	const int32x4_t lowpass_midpoint = vdupq_n_s32(QuantizerMidpoint(midpoint_prequant, lowpass_quant));
+	const int32x4_t highpass_midpoint = vdupq_n_s32(QuantizerMidpoint(midpoint_prequant, highpass_quant));
+	const uint32x4_t lowpass_reciprocal = vdupq_n_u32(lowpass_multiplier);
+	const uint32x4_t highpass_reciprocal = vdupq_n_u32(highpass_multiplier);
+
+	int column;
+
+	for (column = 0; column + 8 <= count; column += 8)
+	{
+		int32x4_t low[6], high[6];
+		int32x4_t lowpass_low, highpass_low, lowpass_high, highpass_high;
+		int i;
+
+		for (i = 0; i < 6; i++)
+		{
+			int16x8_t x = vld1q_s16(&input[i][column]);
+			low[i] = vmovl_s16(vget_low_s16(x));
+			high[i] = vmovl_s16(vget_high_s16(x));
+		}
+
+		FilterRowsHalfNEON(low, &lowpass_low, &highpass_low);
+		FilterRowsHalfNEON(high, &lowpass_high, &highpass_high);
+
+		if (lowpass_multiplier != 0)
+		{
+			lowpass_low = QuantizeNEON(lowpass_low, lowpass_midpoint, lowpass_reciprocal);
+			lowpass_high = QuantizeNEON(lowpass_high, lowpass_midpoint, lowpass_reciprocal);
+		}
+
+		if (highpass_multiplier != 0)
+		{
+			highpass_low = QuantizeNEON(highpass_low, highpass_midpoint, highpass_reciprocal);
+			highpass_high = QuantizeNEON(highpass_high, highpass_midpoint, highpass_reciprocal);
+		}
+
+		vst1q_s16(&lowpass[column], vcombine_s16(vqmovn_s32(lowpass_low), vqmovn_s32(lowpass_high)));
+		vst1q_s16(&highpass[column], vcombine_s16(vqmovn_s32(highpass_low), vqmovn_s32(highpass_high)));
+	}
+
+	if (column < count)
+	{
+		PIXEL *remainder[6];
+		int i;
+
+		for (i = 0; i < 6; i++) {
+			remainder[i] = &input[i][column];
+		}
+
+		FilterRowsScalar(remainder, &lowpass[column], &highpass[column], count - column,
+						 lowpass_quant, highpass_quant, midpoint_prequant);
+	}
+}
+
+//! Kernels that use NEON instructions
+static const FORWARD_KERNELS neon_kernels = {"neon", FilterColumnsNEON, FilterRowsNEON};
+
+#endif
+
+
+//! Kernels used for the interior forward filters
+static const FORWARD_KERNELS *forward_kernels = &scalar_kernels;
+
+
+/*!
+	@brief Select the fastest kernels supported by the processor
+
+	This routine should be called before the forward transforms are computed
+	by any thread.  The scalar kernels are used if no processor features are
+	provided or the vectorized kernels are not compiled into the program.
+*/
+const FORWARD_KERNELS *SelectForwardKernels(uint32_t cpu_features)
+{
+	const FORWARD_KERNELS *kernels = &scalar_kernels;
+
+#if _SIMD_X86
+	if (cpu_features & CPU_FEATURE_AVX2) {
+		kernels = &avx2_kernels;
+	}
+	else if (cpu_features & CPU_FEATURE_SSE2) {
+		kernels = &sse2_kernels;
+	}
+#endif
+
+#if _SIMD_NEON
+	if (cpu_features & CPU_FEATURE_NEON) {
+		kernels = &neon_kernels;
+	}
+#endif
+
+	forward_kernels = kernels;
+
+	return kernels;
+}
+
+/*!
+	@brief Return the kernels used for the interior forward filters
+*/
+const FORWARD_KERNELS *GetForwardKernels(void)
+{
+	return forward_kernels;
+}
+
+/*!
+	@brief Apply the interior forward horizontal filter using the selected kernel
+*/
+void FilterInteriorColumns16s(const PIXEL *input, PIXEL *lowpass, PIXEL *highpass,
+							  int count, int prescale)
+{
+	forward_kernels->filter_columns(input, lowpass, highpass, count, prescale);
+}
+
+/*!
+	@brief Apply the interior forward vertical filter using the selected kernel
+*/
+void FilterInteriorRows16s(PIXEL *input[], PIXEL *lowpass, PIXEL *highpass, int count,
+						   QUANT lowpass_quant, QUANT highpass_quant, int32_t midpoint_prequant)
+{
+	forward_kernels->filter_rows(input, lowpass, highpass, count, lowpass_quant, highpass_quant, midpoint_prequant);
+}
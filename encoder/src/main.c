@@ -15,6 +15,11 @@
 
 #include "headers.h"
 
+//! Initial size of the buffer for assembling the bitstream (enlarged as needed)
+#define SAMPLE_BUFFER_SIZE	(1024 * 1024)
+
+static CODEC_ERROR WriteOutputSample(STREAM *output, STREAM *sample, const PARAMETERS *parameters);
+
 
 /*!
 	@brief Main entry point for the reference encoder
@@ -26,14 +31,26 @@
 	input file can be a DPX file or an unformatted file that contains the input image
 	without a header, in which case the filename extension indicates the pixel format
 	of the input image.  The output argument is the pathname to a file that will contain
-	the encoded bitstream.  Media containers are not currently supported by the reference
-	encoder.  The command-line options are described in @ref ParseParameters.
+	the encoded bitstream or "-" to write the bitstream to the standard output.  Media
+	containers are not currently supported by the reference encoder.  The command-line
+	options are described in @ref ParseParameters.
+
+	The bitstream is assembled in memory and written to the output in one block,
+	so the output does not have to support seeking and can be a pipe.  The metadata
+	chunks are written directly to the output file, so the bitstream is encoded
+	into the output file if the metadata part is enabled.
 */
 int main(int argc, const char *argv[])
 {
 	CODEC_ERROR error = CODEC_ERROR_OKAY;
 	STREAM output;
+	STREAM sample;
+	STREAM *stream = &sample;
+	bool standard_output;
+	bool image_list_flag = false;
 	PARAMETERS parameters;
+	ALLOCATOR allocator;
+	ENCODER_TIMING timing;
 
 	// Performance timer
 	TIMER timer;
@@ -49,14 +66,28 @@ int main(int argc, const char *argv[])
 		return error;
 	}
 
+    // Messages must not be mixed with the bitstream written to the standard output
+    standard_output = (strcmp(parameters.output_pathname, "-") == 0);
+
     // The quiet flag overrides the verbose and debug flags
-    if (parameters.quiet_flag) {
+    if (parameters.quiet_flag || standard_output) {
         parameters.verbose_flag = false;
         parameters.debug_flag = false;
     }
 
     // Fill missing values in the parameters obtained from the command line
     SetMissingParameters(&parameters);
+
+    // Initialize the memory allocator selected on the command line
+    InitAllocator(&allocator, parameters.allocator_type);
+    parameters.allocator = &allocator;
+    if (parameters.stats_flag) {
+        EnableAllocatorStats(&allocator);
+
+        // Record the time spent in each stage of the encoding process
+        InitEncoderTiming(&timing);
+        parameters.timing = &timing;
+    }
     
 	// Check that the enabled parts are correct
 	error = CheckEnabledParts(&parameters.enabled_parts);
@@ -83,7 +114,15 @@ int main(int argc, const char *argv[])
         fprintf(stderr, "Could not create output file: %s\n", parameters.output_pathname);
         return error;
     }
-    
+
+#if VC5_ENABLED_PART(VC5_PART_METADATA)
+    if (IsPartEnabled(parameters.enabled_parts, VC5_PART_METADATA))
+    {
+        // The metadata parser writes the metadata chunks directly into the output file
+        stream = &output;
+    }
+#endif
+
 #if VC5_ENABLED_PART(VC5_PART_LAYERS) && VC5_ENABLED_PART(VC5_PART_SECTIONS)
     if (IsPartEnabled(parameters.enabled_parts, VC5_PART_LAYERS) &&
         IsPartEnabled(parameters.enabled_parts, VC5_PART_SECTIONS) &&
@@ -112,16 +151,36 @@ int main(int argc, const char *argv[])
                     PrintImageList(&image_list);
                 }
 #endif
+                if (stream == &sample)
+                {
+                    // Assemble the bitstream in memory so that chunk sizes can be filled in without seeking
+                    error = CreateGrowableStream(&sample, &allocator, SAMPLE_BUFFER_SIZE);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
                 StartTimer(&timer);
                 
                 // Encode the list of images into the byte stream
-                error = EncodeImageSectionLayers(&image_list, &output, &parameters);
+                error = EncodeImageSectionLayers(&image_list, stream, &parameters);
                 if (error != CODEC_ERROR_OKAY) {
                     //fprintf(stderr, "Error encoding image list: %s\n", argv[1]);
                     return error;
                 }
                 
                 StopTimer(&timer);
+
+                if (stream == &sample)
+                {
+                    error = WriteOutputSample(&output, &sample, &parameters);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
+                // The images in the list were encoded into a single bitstream
+                image_list_flag = true;
             }
         }
     }
@@ -153,16 +212,36 @@ int main(int argc, const char *argv[])
                     PrintImageList(&image_list);
                 }
 #endif
+                if (stream == &sample)
+                {
+                    // Assemble the bitstream in memory so that chunk sizes can be filled in without seeking
+                    error = CreateGrowableStream(&sample, &allocator, SAMPLE_BUFFER_SIZE);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
                 StartTimer(&timer);
                 
                 // Encode the list of images into the byte stream
-                error = EncodeImageList(&image_list, &output, &parameters);
+                error = EncodeImageList(&image_list, stream, &parameters);
                 if (error != CODEC_ERROR_OKAY) {
                     //fprintf(stderr, "Error encoding image list: %s\n", argv[1]);
                     return error;
                 }
                 
                 StopTimer(&timer);
+
+                if (stream == &sample)
+                {
+                    error = WriteOutputSample(&output, &sample, &parameters);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
+                // The images in the list were encoded into a single bitstream
+                image_list_flag = true;
             }
         }
     }
@@ -195,16 +274,36 @@ int main(int argc, const char *argv[])
                     PrintImageList(&image_list);
                 }
 #endif
+                if (stream == &sample)
+                {
+                    // Assemble the bitstream in memory so that chunk sizes can be filled in without seeking
+                    error = CreateGrowableStream(&sample, &allocator, SAMPLE_BUFFER_SIZE);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
                 StartTimer(&timer);
                  
                 // Encode the list of images into the byte stream
-                error = EncodeImageList(&image_list, &output, &parameters);
+                error = EncodeImageList(&image_list, stream, &parameters);
                 if (error != CODEC_ERROR_OKAY) {
                     //fprintf(stderr, "Error encoding image list: %s\n", argv[1]);
                     return error;
                 }
                  
                 StopTimer(&timer);
+
+                if (stream == &sample)
+                {
+                    error = WriteOutputSample(&output, &sample, &parameters);
+                    if (error != CODEC_ERROR_OKAY) {
+                        return error;
+                    }
+                }
+
+                // The images in the list were encoded into a single bitstream
+                image_list_flag = true;
             }
         }
     }
@@ -222,6 +321,7 @@ int main(int argc, const char *argv[])
         printf("\n");
     }
 
+    if (! image_list_flag)
     {
         // Encode one input image without layers or image sections in a single bitstream
        	IMAGE image;
@@ -264,26 +364,85 @@ int main(int argc, const char *argv[])
         
         StartTimer(&timer);
         
-        // Encode the image into the byte stream
-        error = EncodeImage(&image, &output, &parameters);
-        if (error != CODEC_ERROR_OKAY) {
-            fprintf(stderr, "Error encoding image: %s (%d)\n", parameters.output_pathname, error);
-            return error;
+        if (stream == &sample)
+        {
+            // Encode the image into a buffer in memory that is enlarged as needed
+            void *buffer = NULL;
+            size_t size = SAMPLE_BUFFER_SIZE;
+
+            error = EncodeImageToBuffer(&image, &buffer, &size, &parameters);
+            if (error != CODEC_ERROR_OKAY) {
+                fprintf(stderr, "Error encoding image: %s (%d)\n", parameters.output_pathname, error);
+                return error;
+            }
+
+            StopTimer(&timer);
+
+            // Write the encoded sample to the output in one block
+            error = PutBytes(&output, buffer, size);
+            if (error == CODEC_ERROR_OKAY) {
+                error = FlushStream(&output);
+            }
+            Free(&allocator, buffer);
+            if (error != CODEC_ERROR_OKAY) {
+                fprintf(stderr, "Could not write output file: %s (%d)\n", parameters.output_pathname, error);
+                return error;
+            }
+        }
+        else
+        {
+            // Encode the image into the output file
+            error = EncodeImage(&image, stream, &parameters);
+            if (error != CODEC_ERROR_OKAY) {
+                fprintf(stderr, "Error encoding image: %s (%d)\n", parameters.output_pathname, error);
+                return error;
+            }
+
+            StopTimer(&timer);
         }
-        
-        StopTimer(&timer);
     }
 
+    if (parameters.stats_flag)
+    {
+        // The statistics are not written to the standard output if it contains the bitstream
+        FILE *report = standard_output ? stderr : stdout;
+
+        // Report the time and memory used for encoding an image with these dimensions and format
+        fprintf(report, "Image: %d x %d, format: %s\n", parameters.width, parameters.height, PixelFormatName(parameters.pixel_format));
 #if _TIMING
-	printf("Encoding time: %.3f ms\n", TimeMS(&timer));
-	printf("\n");
+        fprintf(report, "Encoding time: %.3f ms\n", TimeMS(&timer));
 #endif
-    
+        PrintEncoderTiming(&timing, report);
+        PrintAllocatorStats(&allocator, report);
+    }
+
+    // All blocks used for encoding the frame can be reused for encoding another frame
+    ResetAllocator(&allocator);
+
     // Close the output stream
     CloseStream(&output);
     
     // Cleanup all memory allocated by the program
     ReleaseParameters(&parameters, NULL);
+    ReleaseAllocator(&allocator);
 
 	return CODEC_ERROR_OKAY;
 }
+
+/*!
+	@brief Write the bitstream assembled in memory to the output in one block
+
+	The memory stream is closed after the bitstream is written.
+*/
+static CODEC_ERROR WriteOutputSample(STREAM *output, STREAM *sample, const PARAMETERS *parameters)
+{
+	CODEC_ERROR error;
+
+	error = PutStreamBuffer(output, sample);
+	CloseStream(sample);
+	if (error != CODEC_ERROR_OKAY) {
+		fprintf(stderr, "Could not write output file: %s (%d)\n", parameters->output_pathname, error);
+	}
+
+	return error;
+}
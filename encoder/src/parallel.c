@@ -0,0 +1,642 @@
+/*!	@file encoder/src/parallel.c
+
+	Implementation of the routines for encoding the channels in parallel.
+
+	The channels are independent until the encoded subbands are written into the
+	bitstream, so the wavelet transforms and the entropy coding of the subbands in
+	each channel are performed by a task in the thread pool.  Each task encodes the subbands
+	into a private bitstream bound to a memory stream that grows as the subbands are
+	encoded.  The chunk sizes of the codeblocks and sections within the channel are
+	updated in the private bitstream as the channel is encoded.
+
+	The codec state at the start of each channel is predicted from the channel encoding
+	order before the tasks are started, since the tags written into the bitstream
+	depend on the codec state.  After all channels have been encoded, the channel headers
+	and trailers are written into the output bitstream in the channel encoding order
+	and the channel payloads are appended between them.  A channel is encoded again on
+	the calling thread if the codec state does not match the predicted state, so the
+	bitstream is the same as the bitstream that is encoded without threads.
+
+	A wavelet transform can be divided into strips of output rows that are computed
+	concurrently.  Each strip recomputes the horizontal results for the two input rows
+	before and after its first pair of input rows that are needed by the vertical filter,
+	so the strips only share the input rows and the coefficients are the same as the
+	coefficients computed without strips.  The strips are tasks in the same thread pool
+	as the channels, so a thread that has finished its channel helps with the strips in
+	the channels that are still being transformed.
+
+	The subbands can also be entropy coded in parallel after the wavelet transforms
+	for all channels have been computed.  The coefficients in each subband are encoded
+	into a private bitstream by a task in the thread pool and the channels are then
+	written into the bitstream in the usual order with the encoded coefficients in
+	each subband appended after the subband header.  The chunk size of each subband
+	is updated as the subbands are written into the bitstream.
+
+	(c) 2013-2017 Society of Motion Picture & Television Engineers LLC and Woodman Labs, Inc.
+	All rights reserved--use subject to compliance with end user license agreement.
+*/
+
+#include "headers.h"
+
+//! Minimum number of output rows in each strip of a wavelet transform
+#define MIN_STRIP_ROWS		16
+
+/*!
+	@brief Encoded subbands for one channel in the channel encoding order
+*/
+typedef struct _channel_payload
+{
+	int channel_number;			//!< Channel encoded into the payload
+	CODEC_STATE start;			//!< Predicted codec state at the start of the channel subbands
+	CODEC_STATE codec;			//!< Codec state after the channel subbands were encoded
+	STREAM stream;				//!< Memory stream that contains the encoded subbands
+	BITSTREAM bitstream;		//!< Bitstream used for encoding the subbands
+	bool encoded;				//!< True if the payload contains the encoded subbands
+
+} CHANNEL_PAYLOAD;
+
+/*!
+	@brief Channel that is transformed and encoded by a task in the thread pool
+
+	If there is no payload, the task only computes the wavelet transforms for the channel.
+*/
+typedef struct _channel_task
+{
+	ENCODER *encoder;			//!< Encoder that contains the wavelet transforms
+	const UNPACKED_IMAGE *image;	//!< Component arrays for the channels
+	CHANNEL_PAYLOAD *payload;	//!< Payload for the encoded subbands in the channel (or null)
+	int channel_number;			//!< Channel that is transformed by the task
+	CODEC_ERROR error;			//!< Error code from encoding the channel
+
+} CHANNEL_TASK;
+
+/*!
+	@brief Arguments for the wavelet transform applied to each strip of output rows
+*/
+typedef struct _strip_transform
+{
+	ALLOCATOR *allocator;		//!< Allocator for the buffers of horizontal results
+	PIXEL *input;				//!< First row of the input to the wavelet transform
+	size_t input_pitch;			//!< Distance between input rows (in bytes)
+	DIMENSION input_width;		//!< Number of input columns
+	DIMENSION input_height;		//!< Number of input rows
+	WAVELET *output;			//!< Wavelet that receives the transform results
+	DIMENSION wavelet_width;	//!< Number of output columns
+	int prescale;				//!< Prescale applied to the input values
+	int midpoint_prequant;		//!< Rounding added during quantization
+
+} STRIP_TRANSFORM;
+
+/*!
+	@brief Subband in one channel that is entropy coded into a private bitstream
+*/
+typedef struct _subband_payload
+{
+	ENCODER *encoder;			//!< Encoder that contains the codebook
+	int channel_number;			//!< Channel that contains the subband
+	int subband_number;			//!< Subband number in the bitstream
+	WAVELET *wavelet;			//!< Wavelet that contains the subband
+	int band;					//!< Band in the wavelet
+	STREAM stream;				//!< Memory stream that contains the encoded coefficients
+	BITSTREAM bitstream;		//!< Bitstream used for encoding the coefficients
+	CODEC_ERROR error;			//!< Error code from encoding the coefficients
+
+} SUBBAND_PAYLOAD;
+
+
+/*!
+	@brief Return true if each channel occurs exactly once in the channel encoding order
+
+	Channels are only encoded in parallel if no channel is transformed by more than one task.
+*/
+bool IsChannelOrderPermutation(const ENCODER *encoder)
+{
+	uint32_t channel_mask = 0;
+	int channel_index;
+
+	for (channel_index = 0; channel_index < encoder->channel_count; channel_index++)
+	{
+		int channel_number = encoder->channel_order_table[channel_index];
+
+		if (! (0 <= channel_number && channel_number < encoder->channel_count)) {
+			return false;
+		}
+
+		if ((channel_mask & (1 << channel_number)) != 0) {
+			return false;
+		}
+
+		channel_mask |= (1 << channel_number);
+	}
+
+	return true;
+}
+
+/*!
+	@brief Return true if the codec state parameters used for encoding the subbands are the same
+*/
+static bool IsSameChannelState(const CODEC_STATE *codec, const CODEC_STATE *start)
+{
+	return (codec->channel_number == start->channel_number &&
+			codec->channel_width == start->channel_width &&
+			codec->channel_height == start->channel_height &&
+			codec->bits_per_component == start->bits_per_component &&
+			codec->subband_number == start->subband_number &&
+			codec->lowpass_precision == start->lowpass_precision &&
+			codec->band.quantization == start->band.quantization);
+}
+
+/*!
+	@brief Predict the codec state at the start of the subbands in each channel
+
+	The channel header sets the channel number, dimensions, and precision in the
+	codec state.  The lowpass precision and quantization are the values for the
+	last subbands encoded in the previous channel.
+*/
+static void PredictChannelStates(ENCODER *encoder, CHANNEL_PAYLOAD *payload, int payload_count)
+{
+	CODEC_STATE codec = encoder->codec;
+	int index;
+
+	for (index = 0; index < payload_count; index++)
+	{
+		int channel_number = encoder->channel_order_table[index];
+		WAVELET *wavelet = encoder->transform[channel_number].wavelet[0];
+
+		codec.channel_number = channel_number;
+		codec.channel_width = encoder->channel[channel_number].width;
+		codec.channel_height = encoder->channel[channel_number].height;
+		codec.bits_per_component = encoder->channel[channel_number].bits_per_component;
+
+		payload[index].channel_number = channel_number;
+		payload[index].start = codec;
+
+		// The subbands in each channel start with the lowpass band
+		codec.lowpass_precision = encoder->channel[channel_number].lowpass_precision;
+
+		// The last subband in the channel is the last highpass band in the first wavelet
+		if (wavelet != NULL) {
+			codec.band.quantization = wavelet->quant[wavelet->band_count - 1];
+		}
+
+		// Update the codec state for the next channel in the bitstream
+		codec.channel_number = channel_number + 1;
+		codec.subband_number = 0;
+	}
+}
+
+/*!
+	@brief Transform one channel and encode its subbands into a private bitstream
+
+	The encoder is copied so that the codec state can be updated without affecting
+	the encoders used for the other channels.  The copy shares the wavelet transforms
+	with the original encoder.
+*/
+static CODEC_ERROR EncodeChannelPayload(ENCODER *encoder, const UNPACKED_IMAGE *image, CHANNEL_PAYLOAD *payload)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	ENCODER channel_encoder = *encoder;
+	int channel_number = payload->channel_number;
+
+	// Initial size of the memory stream for the encoded subbands
+	size_t size = (size_t)encoder->channel[channel_number].width * encoder->channel[channel_number].height;
+
+	error = TransformChannelWavelets(&channel_encoder, image, channel_number);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	error = CreateGrowableStream(&payload->stream, encoder->allocator, size);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	InitBitstream(&payload->bitstream);
+	AttachBitstream(&payload->bitstream, &payload->stream);
+
+	// Encode the subbands starting with the predicted codec state
+	channel_encoder.codec = payload->start;
+
+	error = EncodeChannelSubbands(&channel_encoder, channel_number, &payload->bitstream);
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	FlushBitstream(&payload->bitstream);
+
+	payload->codec = channel_encoder.codec;
+	payload->encoded = true;
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Transform and encode the channel assigned to a task
+*/
+static void EncodeChannelTask(void *argument)
+{
+	CHANNEL_TASK *task = (CHANNEL_TASK *)argument;
+
+	if (task->payload != NULL) {
+		task->error = EncodeChannelPayload(task->encoder, task->image, task->payload);
+	}
+	else {
+		task->error = TransformChannelWavelets(task->encoder, task->image, task->channel_number);
+	}
+}
+
+/*!
+	@brief Submit a task for each channel to the thread pool and wait for the tasks to finish
+
+	The table of payloads is in the channel encoding order.  If there is no table of
+	payloads, the tasks only compute the wavelet transforms for the channels.
+*/
+static CODEC_ERROR RunChannelTasks(ENCODER *encoder, const UNPACKED_IMAGE *image,
+								   CHANNEL_PAYLOAD *payload, int payload_count)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CHANNEL_TASK task_table[MAX_CHANNEL_COUNT];
+	WAIT_GROUP group;
+	int index;
+
+	InitWaitGroup(&group);
+
+	for (index = 0; index < payload_count; index++)
+	{
+		CHANNEL_TASK *task = &task_table[index];
+
+		task->encoder = encoder;
+		task->image = image;
+		task->payload = (payload != NULL) ? &payload[index] : NULL;
+		task->channel_number = (payload != NULL) ? payload[index].channel_number : index;
+		task->error = CODEC_ERROR_OKAY;
+
+		if (SubmitGroupTask(encoder->pool, &group, EncodeChannelTask, task) != CODEC_ERROR_OKAY) {
+			// Encode the channel on the calling thread if the task cannot be submitted
+			EncodeChannelTask(task);
+		}
+	}
+
+	WaitForGroup(encoder->pool, &group);
+
+	// Return the first error reported by any task
+	for (index = 0; error == CODEC_ERROR_OKAY && index < payload_count; index++) {
+		error = task_table[index].error;
+	}
+
+	return error;
+}
+
+/*!
+	@brief Write the channel headers and trailers and append the encoded subbands
+
+	The payload for a channel is only used if the codec state after writing the
+	channel header matches the state that was used for encoding the payload.
+*/
+static CODEC_ERROR AppendChannelPayloads(ENCODER *encoder, CHANNEL_PAYLOAD *payload, int payload_count, BITSTREAM *stream)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CODEC_STATE *codec = &encoder->codec;
+	int index;
+
+	for (index = 0; index < payload_count; index++)
+	{
+		int channel_number = payload[index].channel_number;
+
+		// Encode the tag value pairs in the header for this channel
+		error = EncodeChannelHeader(encoder, channel_number, stream);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		if (payload[index].encoded && IsSameChannelState(codec, &payload[index].start))
+		{
+			// Check that the payload starts on a segment boundary
+			assert(IsAlignedSegment(stream));
+
+			StartTimer(STAGE_TIMER(encoder->timing, write));
+			error = AppendBitstream(stream, &payload[index].bitstream);
+			StopTimer(STAGE_TIMER(encoder->timing, write));
+			if (error != CODEC_ERROR_OKAY) {
+				return error;
+			}
+
+			// Update the codec state with the subbands in the payload
+			codec->subband_number = payload[index].codec.subband_number;
+			codec->lowpass_precision = payload[index].codec.lowpass_precision;
+			codec->band.quantization = payload[index].codec.band.quantization;
+		}
+		else
+		{
+			// Encode the lowpass and highpass bands in the wavelet tree for this channel
+			error = EncodeChannelSubbands(encoder, channel_number, stream);
+			if (error != CODEC_ERROR_OKAY) {
+				return error;
+			}
+		}
+
+		// Encode the tag value pairs in the trailer for this channel
+		error = EncodeChannelTrailer(encoder, channel_number, stream);
+		if (error != CODEC_ERROR_OKAY) {
+			return error;
+		}
+
+		// Check that the bitstream is aligned to a segment boundary
+		assert(IsAlignedSegment(stream));
+
+		// Update the codec state for the next channel in the bitstream
+		codec->channel_number = (channel_number + 1);
+		codec->subband_number = 0;
+	}
+
+	return CODEC_ERROR_OKAY;
+}
+
+/*!
+	@brief Transform and encode the channels in parallel
+
+	Each channel is encoded by a task in the thread pool created with the number of
+	threads specified in the encoding parameters.
+*/
+CODEC_ERROR EncodeChannelsParallel(ENCODER *encoder, const UNPACKED_IMAGE *image, BITSTREAM *stream)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	CHANNEL_PAYLOAD *payload;
+	int payload_count = encoder->channel_count;
+	int index;
+
+	assert(0 < payload_count && payload_count <= MAX_CHANNEL_COUNT);
+	if (! (0 < payload_count && payload_count <= MAX_CHANNEL_COUNT)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	payload = (CHANNEL_PAYLOAD *)Alloc(encoder->allocator, payload_count * sizeof(CHANNEL_PAYLOAD));
+	if (payload == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+	memset(payload, 0, payload_count * sizeof(CHANNEL_PAYLOAD));
+
+	PredictChannelStates(encoder, payload, payload_count);
+
+	// Compute the wavelet transform and encode the subbands in each channel
+	error = RunChannelTasks(encoder, image, payload, payload_count);
+
+	if (error == CODEC_ERROR_OKAY)
+	{
+		// Write the channels into the bitstream in the channel encoding order
+		error = AppendChannelPayloads(encoder, payload, payload_count, stream);
+	}
+
+	for (index = 0; index < payload_count; index++) {
+		CloseStream(&payload[index].stream);
+	}
+
+	Free(encoder->allocator, payload);
+
+	return error;
+}
+
+/*!
+	@brief Entropy code the subband assigned to a task
+*/
+static void EncodeSubbandTask(void *argument)
+{
+	SUBBAND_PAYLOAD *payload = (SUBBAND_PAYLOAD *)argument;
+	ENCODER *encoder = payload->encoder;
+
+	// Initial size of the memory stream for the encoded coefficients
+	size_t size = (size_t)payload->wavelet->width * payload->wavelet->height;
+
+	payload->error = CreateGrowableStream(&payload->stream, encoder->allocator, size);
+	if (payload->error != CODEC_ERROR_OKAY) {
+		return;
+	}
+
+	InitBitstream(&payload->bitstream);
+	AttachBitstream(&payload->bitstream, &payload->stream);
+
+	StartTimer(STAGE_TIMER(encoder->timing, encoding[payload->subband_number]));
+
+	if (payload->subband_number == 0) {
+		payload->error = EncodeLowpassCoefficients(encoder, payload->wavelet, payload->channel_number, &payload->bitstream);
+	}
+	else {
+		payload->error = EncodeHighpassCoefficients(encoder, payload->wavelet, payload->band, &payload->bitstream);
+	}
+
+	StopTimer(STAGE_TIMER(encoder->timing, encoding[payload->subband_number]));
+
+	if (payload->error != CODEC_ERROR_OKAY) {
+		return;
+	}
+
+	FlushBitstream(&payload->bitstream);
+}
+
+/*!
+	@brief Fill the table of subbands in the channels that are encoded into the bitstream
+
+	The subbands in each channel are numbered in the same order as the subbands
+	are written into the bitstream, but the table is sorted so that the subbands
+	in the largest wavelets are encoded first.
+
+	Returns the number of entries in the table of subbands.
+*/
+static int PrepareSubbandPayloads(ENCODER *encoder, SUBBAND_PAYLOAD *payload)
+{
+	bool channel_used[MAX_CHANNEL_COUNT];
+	int wavelet_count = encoder->wavelet_count;
+	int last_wavelet_index = wavelet_count - 1;
+	int payload_count = 0;
+	int wavelet_index;
+	int channel_index;
+
+	memset(channel_used, 0, sizeof(channel_used));
+
+	// Channels may be repeated or omitted in the channel encoding order
+	for (channel_index = 0; channel_index < encoder->channel_order_count; channel_index++)
+	{
+		int channel_number = encoder->channel_order_table[channel_index];
+		if (0 <= channel_number && channel_number < encoder->channel_count) {
+			channel_used[channel_number] = true;
+		}
+	}
+
+	for (wavelet_index = 0; wavelet_index < wavelet_count; wavelet_index++)
+	{
+		int channel_number;
+
+		for (channel_number = 0; channel_number < encoder->channel_count; channel_number++)
+		{
+			WAVELET *wavelet = encoder->transform[channel_number].wavelet[wavelet_index];
+			int subband_number;
+			int band;
+
+			if (! channel_used[channel_number]) {
+				continue;
+			}
+
+			// Subband number of the first highpass band in this wavelet
+			subband_number = 1 + (last_wavelet_index - wavelet_index) * (wavelet->band_count - 1);
+
+			for (band = 1; band < wavelet->band_count; band++)
+			{
+				payload[payload_count].channel_number = channel_number;
+				payload[payload_count].subband_number = subband_number++;
+				payload[payload_count].wavelet = wavelet;
+				payload[payload_count].band = band;
+				payload_count++;
+			}
+
+			if (wavelet_index == last_wavelet_index)
+			{
+				// The lowpass band in the wavelet at the highest level is the first subband
+				payload[payload_count].channel_number = channel_number;
+				payload[payload_count].subband_number = 0;
+				payload[payload_count].wavelet = wavelet;
+				payload[payload_count].band = LL_BAND;
+				payload_count++;
+			}
+		}
+	}
+
+	return payload_count;
+}
+
+/*!
+	@brief Transform the channels and entropy code the subbands in all channels in parallel
+
+	The wavelet transforms for all channels are computed before the subbands are entropy
+	coded into private bitstreams.  The channels are then written into the bitstream in
+	the channel encoding order by the same routines used for encoding the channels on the
+	calling thread, with each encoded subband appended after the subband header, so the
+	headers, trailers, sections, and chunk sizes are the same as if the subbands had been
+	encoded directly into the bitstream.
+*/
+CODEC_ERROR EncodeSubbandsParallel(ENCODER *encoder, const UNPACKED_IMAGE *image, BITSTREAM *stream)
+{
+	CODEC_ERROR error = CODEC_ERROR_OKAY;
+	SUBBAND_PAYLOAD *payload;
+	WAIT_GROUP group;
+	int payload_count;
+	int index;
+
+	assert(0 < encoder->channel_count && encoder->channel_count <= MAX_CHANNEL_COUNT);
+	if (! (0 < encoder->channel_count && encoder->channel_count <= MAX_CHANNEL_COUNT)) {
+		return CODEC_ERROR_UNEXPECTED;
+	}
+
+	// Compute the wavelet transforms for all channels
+	error = RunChannelTasks(encoder, image, NULL, encoder->channel_count);
+
+	if (error != CODEC_ERROR_OKAY) {
+		return error;
+	}
+
+	payload = (SUBBAND_PAYLOAD *)Alloc(encoder->allocator, MAX_CHANNEL_COUNT * MAX_SUBBAND_COUNT * sizeof(SUBBAND_PAYLOAD));
+	if (payload == NULL) {
+		return CODEC_ERROR_OUTOFMEMORY;
+	}
+	memset(payload, 0, MAX_CHANNEL_COUNT * MAX_SUBBAND_COUNT * sizeof(SUBBAND_PAYLOAD));
+
+	payload_count = PrepareSubbandPayloads(encoder, payload);
+
+	InitWaitGroup(&group);
+
+	for (index = 0; index < payload_count; index++)
+	{
+		payload[index].encoder = encoder;
+		payload[index].error = CODEC_ERROR_OKAY;
+
+		if (SubmitGroupTask(encoder->pool, &group, EncodeSubbandTask, &payload[index]) != CODEC_ERROR_OKAY) {
+			// Encode the subband on the calling thread if the task cannot be submitted
+			EncodeSubbandTask(&payload[index]);
+		}
+	}
+
+	WaitForGroup(encoder->pool, &group);
+
+	// Return the first error reported by any task
+	for (index = 0; error == CODEC_ERROR_OKAY && index < payload_count; index++) {
+		error = payload[index].error;
+	}
+
+	if (error == CODEC_ERROR_OKAY)
+	{
+		// Append the encoded subbands while writing the channels into the bitstream
+		for (index = 0; index < payload_count; index++) {
+			encoder->encoded_subband[payload[index].channel_number][payload[index].subband_number] = &payload[index].bitstream;
+		}
+
+		error = EncodeChannelWavelets(encoder, stream);
+
+		memset(encoder->encoded_subband, 0, sizeof(encoder->encoded_subband));
+	}
+
+	for (index = 0; index < payload_count; index++) {
+		CloseStream(&payload[index].stream);
+	}
+
+	Free(encoder->allocator, payload);
+
+	return error;
+}
+
+/*!
+	@brief Compute the output rows in a strip of the wavelet transform
+*/
+static CODEC_ERROR TransformStripRows(void *argument, int first_row, int last_row)
+{
+	STRIP_TRANSFORM *strip = (STRIP_TRANSFORM *)argument;
+
+	return TransformForwardSpatialStrip(strip->allocator,
+										strip->input,
+										strip->input_pitch,
+										strip->input_width,
+										strip->input_height,
+										strip->output,
+										strip->wavelet_width,
+										strip->prescale,
+										strip->midpoint_prequant,
+										first_row,
+										last_row);
+}
+
+/*!
+	@brief Apply the forward spatial wavelet transform in strips of output rows
+
+	The output rows are divided into one strip per thread in the thread pool used by
+	the encoder, but each strip must contain enough rows to justify the horizontal
+	results that are computed again at the start of each strip.  Each strip after
+	the first starts with a middle row.
+*/
+CODEC_ERROR TransformForwardSpatialStrips(ENCODER *encoder,
+										  PIXEL *input,
+										  size_t input_pitch,
+										  DIMENSION input_width,
+										  DIMENSION input_height,
+										  WAVELET *output,
+										  DIMENSION wavelet_width,
+										  int prescale)
+{
+	STRIP_TRANSFORM strip;
+
+	// Last row of the wavelet result
+	int bottom_input_row = ((input_height % 2) == 0) ? input_height - 2 : input_height - 1;
+
+	// Number of output rows including the top and bottom rows
+	int row_count = bottom_input_row / 2 + 1;
+
+	strip.allocator = encoder->allocator;
+	strip.input = input;
+	strip.input_pitch = input_pitch;
+	strip.input_width = input_width;
+	strip.input_height = input_height;
+	strip.output = output;
+	strip.wavelet_width = wavelet_width;
+	strip.prescale = prescale;
+	strip.midpoint_prequant = encoder->midpoint_prequant;
+
+	// The entire wavelet is computed on the calling thread if the encoder does not have a thread pool
+	return ParallelForRows(encoder->pool, row_count, MIN_STRIP_ROWS, TransformStripRows, &strip);
+}
@@ -76,6 +76,20 @@ static const char usage_message[] =
 	"\t\tPathname of the bandfile with optional channel and subband masks\n"
 	"\t\tthat specify which subbands to write to the bandfile.\n"
     "\n"
+    "\t-t <thread count>\n"
+    "\t\tNumber of threads used for encoding the channels in parallel.\n"
+    "\n"
+    "\t-m channels|subbands\n"
+    "\t\tEncode each channel on a separate thread (default) or transform all channels\n"
+    "\t\tbefore entropy coding each subband on a separate thread.\n"
+    "\n"
+    "\t-a default|arena\n"
+    "\t\tAllocate memory from the C library (default) or from an arena that reuses\n"
+    "\t\tthe blocks freed by the encoder.\n"
+    "\n"
+    "\t-s\n"
+    "\t\tPrint statistics about the memory and time used by the encoder.\n"
+    "\n"
     "\t-v\n"
     "\t\tEnable verbose output.\n"
 	"\n"
@@ -85,6 +99,9 @@ static const char usage_message[] =
     "\t-q\n"
     "\t\tSuppress all output to the terminal (overrides verbose and debug).\n"
 	"\n"
+	"\tThe bitstream is written to the standard output if the bitstream file is -\n"
+	"\t(the statistics are printed to the standard error).\n"
+	"\n"
 };
 
 /*!
@@ -229,6 +246,24 @@ bool GetPathname(const char *string, char *pathname)
 
 #endif
 
+/*!
+	@brief Parse the method used for dividing the encoding work among the threads
+ */
+bool GetParallelMode(const char *string, PARALLEL_MODE *parallel_mode_out)
+{
+	if (strcmp(string, "channels") == 0) {
+		*parallel_mode_out = PARALLEL_MODE_CHANNELS;
+		return true;
+	}
+
+	if (strcmp(string, "subbands") == 0) {
+		*parallel_mode_out = PARALLEL_MODE_SUBBANDS;
+		return true;
+	}
+
+	return false;
+}
+
 
 /*!
 	@brief Parse the program command-line arguments to get the encoding parameters
@@ -269,6 +304,10 @@ CODEC_ERROR ParseParameters(int argc, const char *argv[], PARAMETERS *parameters
         {"layers", 1, 0, 0},            // Number of nested layers per image section
         {"metadata", 1, 0, 0},			// Pathname of an XML file containing metadata
         {"bandfile", 1, 0, 0},			// Write wavelet bands to a bandfile
+        {"threads", 1, 0, 0},			// Number of threads used for encoding
+        {"parallel", 1, 0, 0},			// Method for dividing the encoding among threads
+        {"allocator", 1, 0, 0},			// Memory allocation scheme
+        {"stats", 0, 0, 0},				// Print statistics after encoding
         {"verbose", 0, 0, 0},			// Enable verbose output to the terminal
         {"debug", 0, 0, 0},				// Enable extra output for debugging
         {"quiet", 0, 0, 0},				// Suppress all output to the terminal
@@ -280,7 +319,7 @@ CODEC_ERROR ParseParameters(int argc, const char *argv[], PARAMETERS *parameters
 	static char short_options[] = {
 		//'w', 'h', 'p', 'f', 'b', 'q', 'c', 'l', 'P', 'L', 'N', 'S', 'B', 'v', '?', 0
         //'w', 'h', 'p', 'f', 'b', 'q', 'c', 'l', 'P', 'S', 'L', 'B', 'v', '?', 0
-        'w', 'h', 'p', 'f', 'b', 'Q', 'c', 'l', 'P', 'S', 'L', 'M', 'B', 'v', 'z', 'q', '?', 0
+        'w', 'h', 'p', 'f', 'b', 'Q', 'c', 'l', 'P', 'S', 'L', 'M', 'B', 't', 'm', 'a', 's', 'v', 'z', 'q', '?', 0
 	};
 	//const int short_options_length = sizeof(short_options)/sizeof(short_options[0]);
 
@@ -306,7 +345,7 @@ CODEC_ERROR ParseParameters(int argc, const char *argv[], PARAMETERS *parameters
 
 	// Process the command-line options
 	//while ((c = getopt_long(argc, (char **)argv, "w:h:p:f:b:q:c:l:P:L:N:S:B:v", long_options, &option_index)) != -1)
-	while ((c = getopt_long(argc, (char **)argv, "w:h:p:f:b:Q:c:l:P:S:L:M:B:vzq", long_options, &option_index)) != -1)
+	while ((c = getopt_long(argc, (char **)argv, "w:h:p:f:b:Q:c:l:P:S:L:M:B:t:m:a:svzq", long_options, &option_index)) != -1)
 	{
 		//int this_option_optind = optind ? optind : 1;
 
@@ -424,6 +463,31 @@ CODEC_ERROR ParseParameters(int argc, const char *argv[], PARAMETERS *parameters
         	}
         	break;
 #endif
+		case 't':
+			if (!GetThreadCount(optarg, &parameters->thread_count)) {
+				printf("Bad thread count: %s\n", optarg);
+				help_flag = true;
+			}
+			break;
+
+		case 'm':
+			if (!GetParallelMode(optarg, &parameters->parallel_mode)) {
+				printf("Bad parallel mode: %s\n", optarg);
+				help_flag = true;
+			}
+			break;
+
+		case 'a':
+			if (!GetAllocatorType(optarg, &parameters->allocator_type)) {
+				printf("Bad allocator: %s\n", optarg);
+				help_flag = true;
+			}
+			break;
+
+		case 's':
+			parameters->stats_flag = true;
+			break;
+
 		case 'v':
 			parameters->verbose_flag = true;
 			break;
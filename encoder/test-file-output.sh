@@ -0,0 +1,128 @@
+#!/usr/bin/env bash
+#
+# Check the bitstreams that are encoded directly into the output file
+#
+# The encoder assembles the bitstream in memory unless the metadata part is enabled,
+# in which case the bitstream is written to the output file in blocks of words that
+# are flushed before chunk sizes are filled in and before payloads are appended.
+# Each case is encoded with embedded metadata and without metadata, and the images
+# decoded from the two bitstreams must be identical.
+
+# Default metadata test case in XML format
+metadata=../metadata/python/testcases/intrinsic/simple/simple-c01.xml
+
+# Default input images (the second image is used for layers and sections)
+imagefile1=../media/boxes/1280x720/rg48/boxes-1280x720-0000.rg48
+imagefile2=../media/boxes/1280x720/rg48/boxes-1280x720-0001.rg48
+
+# Default image width and height
+width=1280
+height=720
+
+# Location of the reference encoder and decoder
+encoder=./build/linux/debug/encoder
+decoder=../decoder/build/linux/debug/decoder
+
+# Location for the bitstreams and decoded images
+outdir=./test
+
+# Define the usage message
+usage() { echo "Usage: $0 [-m metadata] [-w width] [-h height] [-d <outdir>] [image file 1] [image file 2]" 1>&2; exit 1; }
+
+# Parse the command-line options
+while getopts "m:w:h:d:" arg; do
+
+	case $arg in
+
+	m) # Metadata test case
+		metadata=${OPTARG}
+		;;
+
+	w) # Image width
+		width=${OPTARG}
+		;;
+
+	h) # Image height
+		height=${OPTARG}
+		;;
+
+	d) # Specify the output directory
+		outdir=${OPTARG}
+		;;
+
+    ?) # Display the usage message
+		usage
+		;;
+
+	esac
+
+done
+
+shift $((OPTIND - 1))
+
+# Get the optional input images
+[ -n "$1" ] && imagefile1=$1
+[ -n "$2" ] && imagefile2=$2
+
+# Create the output directory
+if [ ! -d "$outdir" ]; then
+	echo "Creating directory: $outdir"
+	mkdir -p $outdir
+fi
+
+status=0
+
+# Encode with and without metadata and compare the decoded images
+#
+# Usage: check name parts decoder-options encoder-options -- image files
+check() {
+	name=$1
+	parts=$2
+	decoder_flags=$3
+	encoder_flags=$4
+	shift 5
+
+	filestream=${outdir}/file-${name}-metadata.vc5
+	memorystream=${outdir}/file-${name}-memory.vc5
+	rm -f "$filestream" "$memorystream" ${outdir}/file-${name}-*.rg48
+
+	$encoder -q -P ${parts},7 $encoder_flags -w $width -h $height -M "$metadata" "$@" "$filestream"
+	$encoder -q -P ${parts} $encoder_flags -w $width -h $height "$@" "$memorystream"
+
+	result=ok
+	outputs1=()
+	outputs2=()
+	for ((index = 0; index < $#; index++)); do
+		outputs1+=(${outdir}/file-${name}-metadata-${index}.rg48)
+		outputs2+=(${outdir}/file-${name}-memory-${index}.rg48)
+	done
+
+	$decoder -q -P ${parts} $decoder_flags "$filestream" "${outputs1[@]}" > /dev/null
+	$decoder -q -P ${parts} $decoder_flags "$memorystream" "${outputs2[@]}" > /dev/null
+
+	for ((index = 0; index < $#; index++)); do
+		if ! [ -s "${outputs1[$index]}" ] || ! cmp -s "${outputs1[$index]}" "${outputs2[$index]}"; then
+			result=FAILED
+		fi
+	done
+
+	echo "${name}: ${result}"
+	[ "$result" == "ok" ] || status=1
+}
+
+# One image encoded on one thread
+check image 1 "" "" -- "$imagefile1"
+
+# Channel payloads encoded on separate threads are appended to the bitstream
+check channels 1 "" "-t 4 -m channels" -- "$imagefile1"
+
+# Subband payloads encoded on separate threads are appended to the bitstream
+check subbands 1 "" "-t 4 -m subbands" -- "$imagefile1"
+
+# Two images encoded as layers
+check layers 5 "" "" -- "$imagefile1" "$imagefile2"
+
+# Section sizes are filled in after each section is written to the file
+check sections 6 "-S 1,2,4,5,6" "-S 1,2,4,5,6 -t 4" -- "$imagefile1" "$imagefile2"
+
+exit $status
@@ -0,0 +1,94 @@
+#!/usr/bin/env bash
+#
+# Check that the bitstream written to the standard output is the same as the file
+#
+# Each input image is encoded twice, once into a file and once into the standard
+# output, and the two bitstreams must be identical.  Nothing else may be printed
+# to the standard output when the bitstream is written to it.
+
+# Default input images (two frames are encoded as layers)
+imagefile1=../media/boxes/1280x720/rg48/boxes-1280x720-0000.rg48
+imagefile2=../media/boxes/1280x720/rg48/boxes-1280x720-0001.rg48
+
+# Default image width and height
+width=1280
+height=720
+
+# Location of the reference encoder
+encoder=./build/linux/debug/encoder
+
+# Location for the bitstream files
+outdir=./test
+
+# Define the usage message
+usage() { echo "Usage: $0 [-w width] [-h height] [-d <outdir>] [image file 1] [image file 2]" 1>&2; exit 1; }
+
+# Parse the command-line options
+while getopts "w:h:d:" arg; do
+
+	case $arg in
+
+	w) # Image width
+		width=${OPTARG}
+		;;
+
+	h) # Image height
+		height=${OPTARG}
+		;;
+
+	d) # Specify the output directory
+		outdir=${OPTARG}
+		;;
+
+    ?) # Display the usage message
+		usage
+		;;
+
+	esac
+
+done
+
+shift $((OPTIND - 1))
+
+# Get the optional input images
+[ -n "$1" ] && imagefile1=$1
+[ -n "$2" ] && imagefile2=$2
+
+# Create the output directory
+if [ ! -d "$outdir" ]; then
+	echo "Creating directory: $outdir"
+	mkdir -p $outdir
+fi
+
+status=0
+
+# Encode the bitstream into a file and into the standard output and compare the results
+check() {
+	name=$1
+	shift
+
+	filestream=${outdir}/stdout-${name}-file.vc5
+	pipestream=${outdir}/stdout-${name}-pipe.vc5
+	rm -f "$filestream" "$pipestream"
+
+	$encoder -q "$@" "$filestream"
+	$encoder "$@" - > "$pipestream"
+
+	if [ -s "$filestream" ] && cmp -s "$filestream" "$pipestream"; then
+		echo "${name}: ok"
+	else
+		echo "${name}: FAILED"
+		status=1
+	fi
+}
+
+# Encode one image without layers
+check image -P 1 -w $width -h $height "$imagefile1"
+
+# Encode the two images as layers with the part 3 image format messages enabled
+check layers -P 3,5 -w $width -h $height "$imagefile1" "$imagefile2"
+
+# Encode the two images as layers with more than one thread
+check layers-threads -P 3,5 -t 4 -w $width -h $height "$imagefile1" "$imagefile2"
+
+exit $status